@@ -22,6 +22,7 @@
 #include <audio/conversion/float_to_s16.h>
 #include <audio/conversion/s16_to_float.h>
 #include <audio/audio_resampler.h>
+#include <audio/audio_mix.h>
 #include <audio/dsp_filter.h>
 #include <file/file_path.h>
 #include <lists/dir_list.h>
@@ -46,6 +47,7 @@
 #include "../retroarch.h"
 #include "../verbosity.h"
 #include "../list_special.h"
+#include "../performance_counters.h"
 #include "../file_path_special.h"
 #include "../content.h"
 
@@ -425,6 +427,7 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
 
    convert_s16_to_float_init_simd();
    convert_float_to_s16_init_simd();
+   audio_mix_init_simd();
 
    conv_buf = (int16_t*)malloc(outsamples_max
          * sizeof(int16_t));
@@ -555,6 +558,17 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
 
    audio_driver_output_samples_buf = samples_buf;
    audio_driver_control            = false;
+   audio_driver_buffer_size        = 0;
+
+   /* Also wanted without rate control, for the buffer fill metric */
+   if (
+         !audio_cb_inited
+         && audio_driver_active
+         && current_audio->buffer_size
+         && current_audio->write_avail
+      )
+      audio_driver_buffer_size =
+         current_audio->buffer_size(audio_driver_context_audio_data);
 
    if (
          !audio_cb_inited
@@ -564,12 +578,8 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
    {
       /* Audio rate control requires write_avail
        * and buffer_size to be implemented. */
-      if (current_audio->buffer_size)
-      {
-         audio_driver_buffer_size =
-            current_audio->buffer_size(audio_driver_context_audio_data);
+      if (audio_driver_buffer_size)
          audio_driver_control     = true;
-      }
       else
          RARCH_WARN("Audio rate control was desired, but driver does not support needed features.\n");
    }
@@ -627,6 +637,7 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
    bool is_active                    = false;
    const void *output_data           = NULL;
    unsigned output_frames            = 0;
+   int avail                         = 0;
    float audio_volume_gain           = !audio_driver_mute_enable ?
       audio_driver_volume_gain : 0.0f;
 
@@ -645,6 +656,8 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
 		   !audio_driver_output_samples_buf)
       return;
 
+   PERF_TRACE_BEGIN("audio_driver_flush");
+
    convert_s16_to_float(audio_driver_input_data, data, samples,
          audio_volume_gain);
 
@@ -674,12 +687,21 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
 
    src_data.data_out = audio_driver_output_samples_buf;
 
+   if (audio_driver_buffer_size)
+   {
+      avail = (int)current_audio->write_avail(
+            audio_driver_context_audio_data);
+
+      perf_metrics_record(PERF_METRIC_AUDIO_FILL, (uint32_t)
+            ((audio_driver_buffer_size - MIN((size_t)avail,
+                  audio_driver_buffer_size)) * 100
+             / audio_driver_buffer_size));
+   }
+
    if (audio_driver_control)
    {
       /* Readjust the audio input rate. */
       int      half_size   = (int)(audio_driver_buffer_size / 2);
-      int      avail       =
-         (int)current_audio->write_avail(audio_driver_context_audio_data);
       int      delta_mid   = avail - half_size;
       double   direction   = (double)delta_mid / half_size;
       double   adjust      = 1.0 + audio_driver_rate_control_delta * direction;
@@ -742,6 +764,8 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
    if (current_audio->write(audio_driver_context_audio_data,
             output_data, output_frames * 2) < 0)
       audio_driver_active = false;
+
+   PERF_TRACE_END("audio_driver_flush");
 }
 
 /**
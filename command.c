@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 
 #include <compat/strl.h>
 #include <compat/posix_string.h>
@@ -104,6 +105,10 @@
 #include "input/input_remapping.h"
 #include "version.h"
 
+#ifdef HAVE_RUNAHEAD
+#include "runahead/run_ahead.h"
+#endif
+
 #define DEFAULT_NETWORK_CMD_PORT 55355
 #define STDIN_BUF_SIZE           4096
 
@@ -152,7 +157,7 @@ static struct sockaddr_storage lastcmd_net_source;
 static socklen_t lastcmd_net_source_len;
 #endif
 
-#if defined(HAVE_CHEEVOS) && (defined(HAVE_STDIN_CMD) || defined(HAVE_NETWORK_CMD) && defined(HAVE_NETWORKING))
+#if defined(HAVE_STDIN_CMD) || defined(HAVE_NETWORK_CMD) && defined(HAVE_NETWORKING)
 static void command_reply(const char * data, size_t len)
 {
    switch (lastcmd_source)
@@ -160,6 +165,8 @@ static void command_reply(const char * data, size_t len)
       case CMD_STDIN:
 #ifdef HAVE_STDIN_CMD
          fwrite(data, 1,len, stdout);
+         /* stdout is fully buffered when piped */
+         fflush(stdout);
 #endif
          break;
       case CMD_NETWORK:
@@ -180,13 +187,99 @@ static bool command_version(const char* arg)
    char reply[256] = {0};
 
    snprintf(reply, sizeof(reply), "%s\n", PACKAGE_VERSION);
-#if defined(HAVE_CHEEVOS) && (defined(HAVE_STDIN_CMD) || defined(HAVE_NETWORK_CMD) && defined(HAVE_NETWORKING))
+#if defined(HAVE_STDIN_CMD) || defined(HAVE_NETWORK_CMD) && defined(HAVE_NETWORKING)
    command_reply(reply, strlen(reply));
 #endif
 
    return true;
 }
 
+static bool command_get_metrics(const char *arg)
+{
+   unsigned i;
+   char reply[1024];
+   size_t len   = 0;
+   bool matched = false;
+
+   reply[0]     = '\0';
+
+   for (i = 0; i < PERF_METRIC_LAST; i++)
+   {
+      perf_metric_stats_t stats;
+      const char *name = perf_metrics_name((enum perf_metric_type)i);
+
+      if (!string_is_empty(arg) && !string_is_equal(arg, name))
+         continue;
+
+      matched = true;
+      perf_metrics_get((enum perf_metric_type)i, &stats);
+
+      snprintf(reply + len, sizeof(reply) - len,
+            "GET_METRICS %s samples=%u p50=%u p95=%u p99=%u max=%u\n",
+            name, stats.samples,
+            (unsigned)stats.p50, (unsigned)stats.p95,
+            (unsigned)stats.p99, (unsigned)stats.max);
+      len += strlen(reply + len);
+   }
+
+   if (!matched)
+      return false;
+
+#if defined(HAVE_STDIN_CMD) || defined(HAVE_NETWORK_CMD) && defined(HAVE_NETWORKING)
+   command_reply(reply, len);
+#endif
+
+   return true;
+}
+
+static bool command_trace_enable(const char *arg)
+{
+   bool enable = string_is_empty(arg) || !string_is_equal(arg, "0");
+
+   if (!perf_trace_set_enabled(enable))
+      return false;
+
+   RARCH_LOG("[Trace]: Tracing %s.\n", enable ? "enabled" : "disabled");
+   return true;
+}
+
+static bool command_trace_dump(const char *arg)
+{
+   char path[PATH_MAX_LENGTH];
+
+   path[0] = '\0';
+
+   if (!string_is_empty(arg))
+      strlcpy(path, arg, sizeof(path));
+   else
+   {
+      char name[64];
+      settings_t *settings = config_get_ptr();
+      time_t cur_time      = time(NULL);
+
+      strftime(name, sizeof(name),
+            "retroarch-trace-%Y%m%d-%H%M%S.json", localtime(&cur_time));
+
+      if (settings && !string_is_empty(settings->paths.log_dir))
+         fill_pathname_join(path, settings->paths.log_dir,
+               name, sizeof(path));
+      else
+         strlcpy(path, name, sizeof(path));
+   }
+
+   /* Writes whatever is in the ring, also after tracing
+    * was stopped with TRACE_ENABLE 0 */
+   if (!perf_trace_dump(path))
+   {
+      RARCH_WARN("[Trace]: Nothing recorded, set perf_trace_enable "
+            "or send TRACE_ENABLE first.\n");
+      return false;
+   }
+
+   RARCH_LOG("[Trace]: Wrote %s.\n", path);
+   return true;
+}
+
 #if defined(HAVE_CHEEVOS)
 static bool command_read_ram(const char *arg);
 static bool command_write_ram(const char *arg);
@@ -195,6 +288,9 @@ static bool command_write_ram(const char *arg);
 static const struct cmd_action_map action_map[] = {
    { "SET_SHADER",      command_set_shader,  "<shader path>" },
    { "VERSION",         command_version,     "No argument"},
+   { "TRACE_ENABLE",    command_trace_enable, "[0|1]" },
+   { "TRACE_DUMP",      command_trace_dump,  "[<file path>]" },
+   { "GET_METRICS",     command_get_metrics, "[<metric name>]" },
 #if defined(HAVE_CHEEVOS)
    { "READ_CORE_RAM",   command_read_ram,    "<address> <number of bytes>" },
    { "WRITE_CORE_RAM",  command_write_ram,   "<address> <byte1> <byte2> ..." },
@@ -345,6 +441,9 @@ static bool command_write_ram(const char *arg)
          *data = strtoul(arg, (char**)&arg, 16);
          data++;
       }
+#ifdef HAVE_RUNAHEAD
+      runahead_invalidate();
+#endif
       return true;
    }
 
@@ -382,7 +481,7 @@ static bool command_get_arg(const char *tok,
             return false;
 
          if (arg)
-            *arg = argument + 1;
+            *arg = (*argument == '\0') ? argument : argument + 1;
 
          if (index)
             *index = i;
@@ -741,6 +840,10 @@ static void command_event_disk_control_set_eject(bool new_state, bool print_log)
    if (!control || !control->get_num_images)
       return;
 
+#ifdef HAVE_RUNAHEAD
+   runahead_invalidate();
+#endif
+
    if (control->set_eject_state(new_state))
       snprintf(msg, sizeof(msg), "%s %s",
             new_state ?
@@ -793,6 +896,10 @@ static void command_event_disk_control_set_index(unsigned idx)
 
    num_disks = control->get_num_images();
 
+#ifdef HAVE_RUNAHEAD
+   runahead_invalidate();
+#endif
+
    if (control->set_image_index(idx))
    {
       if (idx < num_disks)
@@ -860,6 +967,9 @@ static bool command_event_disk_control_append_image(const char *path)
 
    info.path = path;
    control->replace_image_index(new_idx, &info);
+#ifdef HAVE_RUNAHEAD
+   runahead_invalidate();
+#endif
 
    snprintf(msg, sizeof(msg), "%s: ", msg_hash_to_str(MSG_APPENDED_DISK));
    strlcat(msg, path, sizeof(msg));
@@ -1105,6 +1215,9 @@ static void command_event_deinit_core(bool reinit)
    RARCH_LOG("Unloading core symbols..\n");
    core_uninit_symbols();
 
+   /* The metrics describe the content just unloaded */
+   perf_metrics_reset();
+
    if (reinit)
       driver_uninit(DRIVERS_CMD_ALL);
 
@@ -1277,6 +1390,10 @@ static bool event_init_content(void)
    if (!content_init())
       return false;
 
+   /* Start the frame time and latency metrics from scratch,
+    * not with samples from the menu or previous content */
+   perf_metrics_reset();
+
    content_get_status(&contentless, &is_inited);
 
    command_event_set_savestate_auto_index();
@@ -2043,7 +2160,9 @@ TODO: Add a setting for these tweaks */
                if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL))
 #endif
                {
-                  state_manager_event_init((unsigned)settings->sizes.rewind_buffer_size);
+                  state_manager_event_init(
+                        (unsigned)settings->sizes.rewind_buffer_size,
+                        settings->bools.rewind_threaded);
                }
             }
          }
@@ -202,6 +202,15 @@ static const bool threaded_data_runloop_enable = true;
 static const bool threaded_data_runloop_enable = false;
 #endif
 
+/* Number of worker threads used by the threaded task queue.
+ * With more than one, task handlers run concurrently; not all of
+ * them have been checked for shared state yet, so keep a single
+ * worker by default. */
+static const unsigned task_queue_workers = 1;
+
+/* Record frame timing spans for the TRACE_DUMP command. */
+static const bool perf_trace_enable = false;
+
 /* Set to true if HW render cores should get their private context. */
 static const bool video_shared_context = false;
 
@@ -603,6 +612,11 @@ static const bool statistics_show = false;
  * depending on the save state buffer. */
 static const bool rewind_enable = false;
 
+/* Compresses rewind states on a separate thread.
+ * Helps cores with large savestates, at the cost of
+ * one more savestate worth of memory. */
+static const bool rewind_threaded = false;
+
 /* When set, any time a cheat is toggled it is immediately applied. */
 static const bool apply_cheats_after_toggle = false;
 
@@ -690,6 +704,11 @@ static const bool savestate_auto_load = false;
 
 static const bool savestate_thumbnail_enable = false;
 
+/* Write savestates as compressed containers instead of raw
+ * core data. Raw states can always be loaded, but older
+ * versions cannot load containers, so this is opt-in for now. */
+static const bool savestate_file_compression = false;
+
 /* Slowmotion ratio. */
 static const float slowmotion_ratio = 3.0;
 
@@ -791,6 +810,13 @@ static const unsigned menu_thumbnails_default = 3;
 
 static const unsigned menu_left_thumbnails_default = 0;
 
+/* Texture memory kept for playlist thumbnails, in MB */
+static const unsigned menu_thumbnail_cache_size = 64;
+
+/* Playlist entries on each side of the selection whose
+ * thumbnails are loaded ahead of time */
+static const unsigned menu_thumbnail_prefetch = 4;
+
 static const unsigned menu_timedate_style = 5;
 
 static const bool xmb_vertical_thumbnails = false;
@@ -260,12 +260,14 @@ typedef struct settings
       /* Misc. */
       bool discord_enable;
       bool threaded_data_runloop_enable;
+      bool perf_trace_enable;
       bool set_supports_no_game_enable;
       bool auto_screenshot_filename;
       bool history_list_enable;
       bool playlist_entry_remove;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_threaded;
       bool vrr_runloop_enable;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
@@ -278,6 +280,7 @@ typedef struct settings
       bool savestate_auto_save;
       bool savestate_auto_load;
       bool savestate_thumbnail_enable;
+      bool savestate_file_compression;
       bool network_cmd_enable;
       bool stdin_cmd_enable;
       bool keymapper_enable;
@@ -404,6 +407,7 @@ typedef struct settings
       unsigned rewind_granularity;
       unsigned rewind_buffer_size_step;
       unsigned autosave_interval;
+      unsigned task_queue_workers;
       unsigned network_cmd_port;
       unsigned network_remote_base_port;
       unsigned keymapper_port;
@@ -433,6 +437,8 @@ typedef struct settings
       unsigned menu_timedate_style;
       unsigned menu_thumbnails;
       unsigned menu_left_thumbnails;
+      unsigned menu_thumbnail_cache_size;
+      unsigned menu_thumbnail_prefetch;
       unsigned menu_rgui_thumbnail_downscaler;
       unsigned menu_dpi_override_value;
       unsigned menu_rgui_color_theme;
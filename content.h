@@ -42,9 +42,6 @@ typedef struct content_ctx_info
 /* Load a RAM state from disk to memory. */
 bool content_load_ram_file(unsigned slot);
 
-/* Save a RAM state from memory to disk. */
-bool content_save_ram_file(unsigned slot);
-
 /* Load a state from disk to memory. */
 bool content_load_state(const char* path, bool load_to_backup_buffer, bool autoload);
 
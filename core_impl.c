@@ -40,6 +40,7 @@
 #include "dynamic.h"
 #include "msg_hash.h"
 #include "managers/state_manager.h"
+#include "performance_counters.h"
 #include "verbosity.h"
 #include "gfx/video_driver.h"
 #include "audio/audio_driver.h"
@@ -48,6 +49,7 @@
 #ifdef HAVE_RUNAHEAD
 #include "runahead/copy_load_info.h"
 #include "runahead/secondary_core.h"
+#include "runahead/run_ahead.h"
 #endif
 
 struct                     retro_callbacks retro_ctx;
@@ -270,6 +272,7 @@ bool core_set_controller_port_device(retro_ctx_controller_info_t *pad)
 
 #ifdef HAVE_RUNAHEAD
    remember_controller_port_device(pad->port, pad->device);
+   runahead_invalidate();
 #endif
 
    current_core.retro_set_controller_port_device(pad->port, pad->device);
@@ -418,8 +421,22 @@ bool core_unload_game(void)
    return true;
 }
 
+static void core_run_timed(void)
+{
+   retro_time_t start = cpu_features_get_time_usec();
+
+   PERF_TRACE_BEGIN("retro_run");
+   current_core.retro_run();
+   PERF_TRACE_END("retro_run");
+
+   perf_metrics_record(PERF_METRIC_CORE_RUN,
+         (uint32_t)(cpu_features_get_time_usec() - start));
+}
+
 bool core_run(void)
 {
+   PERF_TRACE_BEGIN("core_run");
+
 #ifdef HAVE_NETWORKING
    if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_PRE_FRAME, NULL))
    {
@@ -427,6 +444,7 @@ bool core_run(void)
        * netplay peer pausing doesn't just hang. */
       input_poll();
       video_driver_cached_frame();
+      PERF_TRACE_END("core_run");
       return true;
    }
 #endif
@@ -443,7 +461,7 @@ bool core_run(void)
          break;
    }
 
-   current_core.retro_run();
+   core_run_timed();
 
    if (current_core.poll_type == POLL_TYPE_LATE && !current_core.input_polled)
       input_poll();
@@ -452,12 +470,23 @@ bool core_run(void)
    netplay_driver_ctl(RARCH_NETPLAY_CTL_POST_FRAME, NULL);
 #endif
 
+   PERF_TRACE_END("core_run");
    return true;
 }
 
+/* For a frame that input_poll was already called for,
+ * so the core must not poll again. */
 bool core_run_no_input_polling(void)
 {
-   current_core.retro_run();
+   retro_input_poll_t old_poll_function = retro_ctx.poll_cb;
+
+   retro_ctx.poll_cb = retro_input_poll_null;
+   current_core.retro_set_input_poll(retro_ctx.poll_cb);
+
+   core_run_timed();
+
+   retro_ctx.poll_cb = old_poll_function;
+   current_core.retro_set_input_poll(retro_ctx.poll_cb);
    return true;
 }
 
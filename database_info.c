@@ -36,7 +36,7 @@ int database_info_build_query_enum(char *s, size_t len,
       const char *path)
 {
    bool add_quotes = true;
-   bool add_glob   = false;
+   bool add_has    = false;
 
    string_add_bracket_open(s, len);
    string_add_single_quote(s, len);
@@ -50,8 +50,9 @@ int database_info_build_query_enum(char *s, size_t len,
          strlcat(s, "publisher", len);
          break;
       case DATABASE_QUERY_ENTRY_DEVELOPER:
+         /* Developers are stored as a '|'-separated list */
          strlcat(s, "developer", len);
-         add_glob = true;
+         add_has    = true;
          add_quotes = false;
          break;
       case DATABASE_QUERY_ENTRY_ORIGIN:
@@ -112,13 +113,13 @@ int database_info_build_query_enum(char *s, size_t len,
 
    string_add_single_quote(s, len);
    string_add_colon(s, len);
-   if (add_glob)
-      string_add_glob_open(s, len);
+   if (add_has)
+      strlcat(s, "has('", len);
    if (add_quotes)
       string_add_quote(s, len);
    strlcat(s, path, len);
-   if (add_glob)
-      string_add_glob_close(s, len);
+   if (add_has)
+      strlcat(s, "')", len);
    if (add_quotes)
       string_add_quote(s, len);
 
@@ -148,21 +149,35 @@ char *bin_to_hex_alloc(const uint8_t *data, size_t len)
    return ret;
 }
 
+/* Values come straight out of the database image and are
+ * not NUL-terminated, so strings are duplicated by length */
+static char *database_info_strdup_view(const struct rmsgpack_dom_value *val)
+{
+   char *str = NULL;
+
+   if (val->type != RDT_STRING || val->val.string.len == 0)
+      return NULL;
+
+   if (!(str = (char*)malloc(val->val.string.len + 1)))
+      return NULL;
+
+   memcpy(str, val->val.string.buff, val->val.string.len);
+   str[val->val.string.len] = '\0';
+   return str;
+}
+
 static int database_cursor_iterate(libretrodb_cursor_t *cur,
       database_info_t *db_info)
 {
    unsigned i;
    struct rmsgpack_dom_value item;
-   const char* str                = NULL;
+   char str[32];
 
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
+   if (libretrodb_cursor_read_item_view(cur, &item) != 0)
       return -1;
 
    if (item.type != RDT_MAP)
-   {
-      rmsgpack_dom_value_free(&item);
       return 1;
-   }
 
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
@@ -172,93 +187,85 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
    {
       struct rmsgpack_dom_value *key = &item.val.map.items[i].key;
       struct rmsgpack_dom_value *val = &item.val.map.items[i].value;
-      const char *val_string         = NULL;
+      size_t key_len                 = 0;
 
-      if (!key || !val)
+      if (!key || !val || key->type != RDT_STRING)
          continue;
 
-      val_string                     = val->val.string.buff;
-      str                            = key->val.string.buff;
+      key_len = key->val.string.len;
+      if (key_len >= sizeof(str))
+         key_len = sizeof(str) - 1;
+      memcpy(str, key->val.string.buff, key_len);
+      str[key_len] = '\0';
 
       if (string_is_equal(str, "publisher"))
       {
-         if (!string_is_empty(val_string))
-            db_info->publisher = strdup(val_string);
+         db_info->publisher = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "developer"))
       {
-         if (!string_is_empty(val_string))
-            db_info->developer = string_split(val_string, "|");
+         char *developer = database_info_strdup_view(val);
+         if (developer)
+         {
+            db_info->developer = string_split(developer, "|");
+            free(developer);
+         }
       }
       else if (string_is_equal(str, "serial"))
       {
-         if (!string_is_empty(val_string))
-            db_info->serial = strdup(val_string);
+         db_info->serial = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "rom_name"))
       {
-         if (!string_is_empty(val_string))
-            db_info->rom_name = strdup(val_string);
+         db_info->rom_name = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "name"))
       {
-         if (!string_is_empty(val_string))
-            db_info->name = strdup(val_string);
+         db_info->name = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "description"))
       {
-         if (!string_is_empty(val_string))
-            db_info->description = strdup(val_string);
+         db_info->description = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "genre"))
       {
-         if (!string_is_empty(val_string))
-            db_info->genre = strdup(val_string);
+         db_info->genre = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "origin"))
       {
-         if (!string_is_empty(val_string))
-            db_info->origin = strdup(val_string);
+         db_info->origin = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "franchise"))
       {
-         if (!string_is_empty(val_string))
-            db_info->franchise = strdup(val_string);
+         db_info->franchise = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "bbfc_rating"))
       {
-         if (!string_is_empty(val_string))
-            db_info->bbfc_rating = strdup(val_string);
+         db_info->bbfc_rating = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "esrb_rating"))
       {
-         if (!string_is_empty(val_string))
-            db_info->esrb_rating = strdup(val_string);
+         db_info->esrb_rating = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "elspa_rating"))
       {
-         if (!string_is_empty(val_string))
-            db_info->elspa_rating = strdup(val_string);
+         db_info->elspa_rating = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "cero_rating"))
       {
-         if (!string_is_empty(val_string))
-            db_info->cero_rating          = strdup(val_string);
+         db_info->cero_rating          = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "pegi_rating"))
       {
-         if (!string_is_empty(val_string))
-            db_info->pegi_rating          = strdup(val_string);
+         db_info->pegi_rating          = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "enhancement_hw"))
       {
-         if (!string_is_empty(val_string))
-            db_info->enhancement_hw       = strdup(val_string);
+         db_info->enhancement_hw       = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "edge_review"))
       {
-         if (!string_is_empty(val_string))
-            db_info->edge_magazine_review = strdup(val_string);
+         db_info->edge_magazine_review = database_info_strdup_view(val);
       }
       else if (string_is_equal(str, "edge_rating"))
          db_info->edge_magazine_rating    = (unsigned)val->val.uint_;
@@ -283,8 +290,12 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
       else if (string_is_equal(str, "size"))
          db_info->size                    = (unsigned)val->val.uint_;
       else if (string_is_equal(str, "crc"))
-         db_info->crc32 = swap_if_little32(
-               *(uint32_t*)val->val.binary.buff);
+      {
+         uint32_t crc32 = 0;
+         if (val->type == RDT_BINARY && val->val.binary.len >= sizeof(crc32))
+            memcpy(&crc32, val->val.binary.buff, sizeof(crc32));
+         db_info->crc32 = swap_if_little32(crc32);
+      }
       else if (string_is_equal(str, "sha1"))
          db_info->sha1 = bin_to_hex_alloc(
                (uint8_t*)val->val.binary.buff, val->val.binary.len);
@@ -297,8 +308,6 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
       }
    }
 
-   rmsgpack_dom_value_free(&item);
-
    return 0;
 }
 
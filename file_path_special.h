@@ -34,6 +34,8 @@ enum file_path_enum
    FILE_PATH_DETECT,
    FILE_PATH_NUL,
    FILE_PATH_LUTRO_PLAYLIST,
+   FILE_PATH_CONTENT_SCAN_CACHE,
+   FILE_PATH_CONTENT_SCAN_RESUME,
    FILE_PATH_LOG_WARN,
    FILE_PATH_LOG_ERROR,
    FILE_PATH_LOG_INFO,
@@ -80,6 +82,7 @@ enum file_path_enum
    FILE_PATH_CHT_EXTENSION,
    FILE_PATH_LPL_EXTENSION,
    FILE_PATH_LPL_EXTENSION_NO_DOT,
+   FILE_PATH_PLAYLIST_CACHE_EXTENSION,
    FILE_PATH_RDB_EXTENSION,
    FILE_PATH_BSV_EXTENSION,
    FILE_PATH_AUTO_EXTENSION,
@@ -41,6 +41,12 @@ const char *file_path_str(enum file_path_enum enum_idx)
       case FILE_PATH_LUTRO_PLAYLIST:
          str = "Lutro.lpl";
          break;
+      case FILE_PATH_CONTENT_SCAN_CACHE:
+         str = "content_scan.cache";
+         break;
+      case FILE_PATH_CONTENT_SCAN_RESUME:
+         str = "content_scan.resume";
+         break;
       case FILE_PATH_NUL:
          str = "nul";
          break;
@@ -98,6 +104,9 @@ const char *file_path_str(enum file_path_enum enum_idx)
       case FILE_PATH_LPL_EXTENSION_NO_DOT:
          str = "lpl";
          break;
+      case FILE_PATH_PLAYLIST_CACHE_EXTENSION:
+         str = ".lpc";
+         break;
       case FILE_PATH_PNG_EXTENSION:
          str = ".png";
          break;
@@ -115,7 +115,7 @@ static void emscripten_mainloop(void)
 
 void cmd_savefiles(void)
 {
-   event_save_files();
+   event_save_files(false);
 }
 
 void cmd_save_state(void)
@@ -384,6 +384,61 @@ void vulkan_copy_staging_to_dynamic(vk_t *vk, VkCommandBuffer cmd,
    dynamic->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 }
 
+void vulkan_copy_staging_to_dynamic_region(vk_t *vk, VkCommandBuffer cmd,
+      struct vk_texture *dynamic,
+      struct vk_texture *staging,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   VkBufferImageCopy region;
+
+   retro_assert(dynamic->type == VULKAN_TEXTURE_DYNAMIC);
+   retro_assert(staging->type == VULKAN_TEXTURE_STAGING);
+
+   /* Contents of an image in UNDEFINED layout are lost
+    * on the transition, so it has to be copied whole. */
+   if (dynamic->layout != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+   {
+      vulkan_copy_staging_to_dynamic(vk, cmd, dynamic, staging);
+      return;
+   }
+
+   vulkan_sync_texture_to_gpu(vk, staging);
+
+   vulkan_image_layout_transition(vk, cmd, dynamic->image,
+         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+   memset(&region, 0, sizeof(region));
+   region.bufferOffset                = y * staging->stride
+      + x * vulkan_format_to_bpp(staging->format);
+   region.bufferRowLength             = staging->stride
+      / vulkan_format_to_bpp(staging->format);
+   region.imageOffset.x               = x;
+   region.imageOffset.y               = y;
+   region.imageExtent.width           = width;
+   region.imageExtent.height          = height;
+   region.imageExtent.depth           = 1;
+   region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+   region.imageSubresource.layerCount = 1;
+
+   vkCmdCopyBufferToImage(cmd,
+         staging->buffer,
+         dynamic->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         1, &region);
+
+   vulkan_image_layout_transition(vk, cmd,
+         dynamic->image,
+         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+         VK_ACCESS_TRANSFER_WRITE_BIT,
+         VK_ACCESS_SHADER_READ_BIT,
+         VK_PIPELINE_STAGE_TRANSFER_BIT,
+         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+}
+
 #ifdef VULKAN_DEBUG_TEXTURE_ALLOC
 static VkImage vk_images[4 * 1024];
 static unsigned vk_count;
@@ -370,6 +370,8 @@ typedef struct vk
       VkDescriptorSetLayout set_layout;
       VkPipelineLayout layout;
       VkPipelineCache cache;
+      /* Size of the cache data last written to disk */
+      size_t cache_saved_size;
    } pipelines;
 
    struct
@@ -472,6 +474,14 @@ void vulkan_copy_staging_to_dynamic(vk_t *vk, VkCommandBuffer cmd,
       struct vk_texture *dynamic,
       struct vk_texture *staging);
 
+/* Like vulkan_copy_staging_to_dynamic(), but only copies the
+ * given region and keeps the rest of @dynamic. Falls back to
+ * a full copy if @dynamic has not been written yet. */
+void vulkan_copy_staging_to_dynamic_region(vk_t *vk, VkCommandBuffer cmd,
+      struct vk_texture *dynamic,
+      struct vk_texture *staging,
+      unsigned x, unsigned y, unsigned width, unsigned height);
+
 /* VBO will be written to here. */
 void vulkan_draw_quad(vk_t *vk, const struct vk_draw_quad *quad);
 
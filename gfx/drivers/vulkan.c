@@ -20,6 +20,8 @@
 #include <string.h>
 
 #include <compat/strl.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <formats/image.h>
@@ -28,6 +30,7 @@
 #include <retro_math.h>
 #include <retro_assert.h>
 #include <string/stdstring.h>
+#include <streams/file_stream.h>
 #include <libretro.h>
 
 #ifdef HAVE_CONFIG_H
@@ -795,6 +798,7 @@ static bool vulkan_init_default_filter_chain(vk_t *vk)
 static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
 {
    struct vulkan_filter_chain_create_info info;
+   retro_time_t start_time    = cpu_features_get_time_usec();
 
    memset(&info, 0, sizeof(info));
 
@@ -823,6 +827,13 @@ static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
       return false;
    }
 
+   /* Compare a first run against later ones (or against an
+    * empty cache directory) to see what the cache saves. */
+   RARCH_LOG("[Vulkan]: Built filter chain in %.2f ms"
+         " (pipeline cache: %u bytes on disk).\n",
+         (cpu_features_get_time_usec() - start_time) / 1000.0,
+         (unsigned)vk->pipelines.cache_saved_size);
+
    return true;
 }
 
@@ -865,6 +876,159 @@ static void vulkan_init_resources(vk_t *vk)
    vulkan_init_command_buffers(vk);
 }
 
+/* The pipeline cache is kept in <cache_directory>/vulkan,
+ * one file per device and driver build, so switching GPUs or
+ * updating drivers never feeds a driver someone else's data. */
+static bool vulkan_pipeline_cache_path(vk_t *vk, char *s, size_t len)
+{
+   unsigned i;
+   char name[128];
+   char dir[PATH_MAX_LENGTH];
+   settings_t *settings                   = config_get_ptr();
+   const VkPhysicalDeviceProperties *props =
+      &vk->context->gpu_properties;
+   size_t pos                             = 0;
+
+   if (string_is_empty(settings->paths.directory_cache))
+      return false;
+
+   fill_pathname_join(dir, settings->paths.directory_cache,
+         "vulkan", sizeof(dir));
+
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      return false;
+
+   pos = snprintf(name, sizeof(name), "pipeline-%04x-%04x-",
+         (unsigned)props->vendorID, (unsigned)props->deviceID);
+   for (i = 0; i < VK_UUID_SIZE; i++)
+      pos += snprintf(name + pos, sizeof(name) - pos, "%02x",
+            (unsigned)props->pipelineCacheUUID[i]);
+   strlcat(name, ".bin", sizeof(name));
+
+   fill_pathname_join(s, dir, name, len);
+   return true;
+}
+
+/* Checks the header every pipeline cache blob starts with.
+ * Drivers are supposed to reject foreign data themselves,
+ * but not all of them do so gracefully. */
+static bool vulkan_pipeline_cache_valid(vk_t *vk,
+      const uint8_t *data, size_t size)
+{
+   uint32_t header_size, header_version, vendor_id, device_id;
+   const VkPhysicalDeviceProperties *props =
+      &vk->context->gpu_properties;
+
+   if (size < 16 + VK_UUID_SIZE)
+      return false;
+
+   memcpy(&header_size,    data +  0, sizeof(uint32_t));
+   memcpy(&header_version, data +  4, sizeof(uint32_t));
+   memcpy(&vendor_id,      data +  8, sizeof(uint32_t));
+   memcpy(&device_id,      data + 12, sizeof(uint32_t));
+
+   return header_size    >= 16 + VK_UUID_SIZE
+      && header_size     <= size
+      && header_version  == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+      && vendor_id       == props->vendorID
+      && device_id       == props->deviceID
+      && !memcmp(data + 16, props->pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+static void *vulkan_pipeline_cache_read(vk_t *vk,
+      const char *path, size_t *size)
+{
+   void *data  = NULL;
+   int64_t len = 0;
+
+   if (!path_is_valid(path) || !filestream_read_file(path, &data, &len))
+      return NULL;
+
+   if (!vulkan_pipeline_cache_valid(vk, (const uint8_t*)data, (size_t)len))
+   {
+      RARCH_WARN("[Vulkan]: Ignoring incompatible pipeline cache \"%s\".\n",
+            path);
+      free(data);
+      return NULL;
+   }
+
+   *size = (size_t)len;
+   return data;
+}
+
+static void vulkan_pipeline_cache_save(vk_t *vk)
+{
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   size_t disk_size = 0;
+   size_t size      = 0;
+   void *disk_data  = NULL;
+   void *data       = NULL;
+
+   if (!vk->pipelines.cache || !vulkan_pipeline_cache_path(vk, path, sizeof(path)))
+      return;
+
+   /* Another instance may have saved in the meantime;
+    * fold its pipelines in rather than overwrite them. */
+   disk_data = vulkan_pipeline_cache_read(vk, path, &disk_size);
+   if (disk_data && disk_size != vk->pipelines.cache_saved_size)
+   {
+      VkPipelineCache disk_cache     = VK_NULL_HANDLE;
+      VkPipelineCacheCreateInfo info = {
+         VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+
+      info.initialDataSize = disk_size;
+      info.pInitialData    = disk_data;
+
+      if (vkCreatePipelineCache(vk->context->device,
+               &info, NULL, &disk_cache) == VK_SUCCESS)
+      {
+         vkMergePipelineCaches(vk->context->device,
+               vk->pipelines.cache, 1, &disk_cache);
+         vkDestroyPipelineCache(vk->context->device, disk_cache, NULL);
+      }
+   }
+   free(disk_data);
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, NULL) != VK_SUCCESS || !size)
+      return;
+
+   /* Pipelines are only ever added, so an unchanged size
+    * means there is nothing new to write. */
+   if (size == vk->pipelines.cache_saved_size)
+      return;
+
+   if (!(data = malloc(size)))
+      return;
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &size, data) != VK_SUCCESS)
+   {
+      free(data);
+      return;
+   }
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (filestream_write_file(tmp_path, data, size))
+   {
+      if (filestream_rename(tmp_path, path) != 0)
+      {
+         /* Windows does not rename over an existing file. */
+         filestream_delete(path);
+         filestream_rename(tmp_path, path);
+      }
+
+      vk->pipelines.cache_saved_size = size;
+      RARCH_LOG("[Vulkan]: Saved %u bytes of pipeline cache.\n",
+            (unsigned)size);
+   }
+
+   free(data);
+}
+
 static void vulkan_init_static_resources(vk_t *vk)
 {
    unsigned i;
@@ -876,12 +1040,34 @@ static void vulkan_init_static_resources(vk_t *vk)
    /* Create the pipeline cache. */
    VkPipelineCacheCreateInfo cache   = {
       VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+   char cache_path[PATH_MAX_LENGTH];
+   void *cache_data                  = NULL;
+   size_t cache_size                 = 0;
 
    if (!vk->context)
       return;
 
-   vkCreatePipelineCache(vk->context->device,
-         &cache, NULL, &vk->pipelines.cache);
+   vk->pipelines.cache_saved_size = 0;
+
+   if (vulkan_pipeline_cache_path(vk, cache_path, sizeof(cache_path)))
+      cache_data = vulkan_pipeline_cache_read(vk, cache_path, &cache_size);
+
+   cache.initialDataSize = cache_size;
+   cache.pInitialData    = cache_data;
+
+   if (vkCreatePipelineCache(vk->context->device,
+         &cache, NULL, &vk->pipelines.cache) == VK_SUCCESS)
+      vk->pipelines.cache_saved_size = cache_size;
+   else if (cache_data)
+   {
+      /* Start over with an empty cache. */
+      cache.initialDataSize = 0;
+      cache.pInitialData    = NULL;
+      vkCreatePipelineCache(vk->context->device,
+            &cache, NULL, &vk->pipelines.cache);
+   }
+
+   free(cache_data);
 
    pool_info.queueFamilyIndex = vk->context->graphics_queue_index;
 
@@ -899,6 +1085,7 @@ static void vulkan_init_static_resources(vk_t *vk)
 static void vulkan_deinit_static_resources(vk_t *vk)
 {
    unsigned i;
+   vulkan_pipeline_cache_save(vk);
    vkDestroyPipelineCache(vk->context->device,
          vk->pipelines.cache, NULL);
    vulkan_destroy_texture(
@@ -1381,6 +1568,8 @@ static bool vulkan_set_shader(void *data,
       return false;
    }
 
+   vulkan_pipeline_cache_save(vk);
+
    return true;
 }
 
@@ -94,6 +94,27 @@ static bool gl_core_raster_font_upload_atlas(gl_core_raster_t *font)
    return true;
 }
 
+/* Uploads only the part of the atlas the font renderer
+ * changed since the last upload. */
+static void gl_core_raster_font_update_atlas(gl_core_raster_t *font)
+{
+   unsigned x      = font->atlas->dirty_x0;
+   unsigned y      = font->atlas->dirty_y0;
+   unsigned width  = MIN(font->atlas->dirty_x1, font->atlas->width)  - x;
+   unsigned height = MIN(font->atlas->dirty_y1, font->atlas->height) - y;
+
+   glBindTexture(GL_TEXTURE_2D, font->tex);
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, font->atlas->width);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+         GL_RED, GL_UNSIGNED_BYTE,
+         font->atlas->buffer + y * font->atlas->width + x);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+   glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 static void *gl_core_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -122,7 +143,7 @@ static void *gl_core_raster_font_init_font(void *data,
    if (!gl_core_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font_atlas_clear_dirty(font->atlas);
    return font;
 
 error:
@@ -166,8 +187,11 @@ static void gl_core_raster_font_draw_vertices(gl_core_raster_t *font,
 {
    if (font->atlas->dirty)
    {
-      gl_core_raster_font_upload_atlas(font);
-      font->atlas->dirty   = false;
+      if (font_atlas_has_dirty_rect(font->atlas))
+         gl_core_raster_font_update_atlas(font);
+      else
+         gl_core_raster_font_upload_atlas(font);
+      font_atlas_clear_dirty(font->atlas);
    }
 
    glActiveTexture(GL_TEXTURE1);
@@ -48,6 +48,9 @@ typedef struct
    gl_t *gl;
    GLuint tex;
    unsigned tex_width, tex_height;
+   /* Texture format chosen by the last full upload */
+   GLenum gl_format;
+   size_t ncomponents;
 
    const font_renderer_driver_t *font_driver;
    void *font_data;
@@ -109,9 +112,66 @@ static bool gl_raster_font_upload_atlas_components_4(gl_raster_t *font)
 }
 #endif
 
-static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+/* Copies a region of the atlas into @dst, @dst_stride texels
+ * apart, expanded to the texture format. */
+static void gl_raster_font_convert_atlas(gl_raster_t *font,
+      uint8_t *dst, unsigned dst_stride, size_t ncomponents,
+      unsigned x, unsigned y, unsigned width, unsigned height)
 {
    unsigned i, j;
+
+   for (i = 0; i < height; ++i)
+   {
+      const uint8_t *src = &font->atlas->buffer[
+         (y + i) * font->atlas->width + x];
+      uint8_t       *out = &dst[i * dst_stride * ncomponents];
+
+      switch (ncomponents)
+      {
+         case 1:
+            memcpy(out, src, width);
+            break;
+         case 2:
+            for (j = 0; j < width; ++j)
+            {
+               *out++ = 0xff;
+               *out++ = *src++;
+            }
+            break;
+      }
+   }
+}
+
+/* Uploads only the part of the atlas the font renderer
+ * changed since the last upload. */
+static void gl_raster_font_update_atlas(gl_raster_t *font)
+{
+   uint8_t *tmp       = NULL;
+   unsigned x         = font->atlas->dirty_x0;
+   unsigned y         = font->atlas->dirty_y0;
+   unsigned width     = MIN(font->atlas->dirty_x1, font->atlas->width)  - x;
+   unsigned height    = MIN(font->atlas->dirty_y1, font->atlas->height) - y;
+   GLenum gl_format   = font->gl_format;
+   size_t ncomponents = font->ncomponents;
+
+   tmp = (uint8_t*)malloc(width * height * ncomponents);
+   if (!tmp)
+      return;
+
+   gl_raster_font_convert_atlas(font, tmp, width, ncomponents,
+         x, y, width, height);
+
+   /* Rows of the region are tightly packed. */
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+         gl_format, GL_UNSIGNED_BYTE, tmp);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+   free(tmp);
+}
+
+static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+{
    GLint  gl_internal                   = GL_LUMINANCE_ALPHA;
    GLenum gl_format                     = GL_LUMINANCE_ALPHA;
    size_t ncomponents                   = 2;
@@ -132,33 +192,13 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
    }
 #endif
 
-   tmp = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
+   font->gl_format   = gl_format;
+   font->ncomponents = ncomponents;
 
-   switch (ncomponents)
-   {
-      case 1:
-         for (i = 0; i < font->atlas->height; ++i)
-         {
-            const uint8_t *src = &font->atlas->buffer[i * font->atlas->width];
-            uint8_t       *dst = &tmp[i * font->tex_width * ncomponents];
-
-            memcpy(dst, src, font->atlas->width);
-         }
-         break;
-      case 2:
-         for (i = 0; i < font->atlas->height; ++i)
-         {
-            const uint8_t *src = &font->atlas->buffer[i * font->atlas->width];
-            uint8_t       *dst = &tmp[i * font->tex_width * ncomponents];
+   tmp = (uint8_t*)calloc(font->tex_height, font->tex_width * ncomponents);
 
-            for (j = 0; j < font->atlas->width; ++j)
-            {
-               *dst++ = 0xff;
-               *dst++ = *src++;
-            }
-         }
-         break;
-   }
+   gl_raster_font_convert_atlas(font, tmp, font->tex_width, ncomponents,
+         0, 0, font->atlas->width, font->atlas->height);
 
    glTexImage2D(GL_TEXTURE_2D, 0, gl_internal, font->tex_width, font->tex_height,
          0, gl_format, GL_UNSIGNED_BYTE, tmp);
@@ -202,7 +242,7 @@ static void *gl_raster_font_init_font(void *data,
    if (!gl_raster_font_upload_atlas(font))
       goto error;
 
-   font->atlas->dirty = false;
+   font_atlas_clear_dirty(font->atlas);
 
    glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
 
@@ -251,8 +291,11 @@ static void gl_raster_font_draw_vertices(gl_raster_t *font,
 {
    if (font->atlas->dirty)
    {
-      gl_raster_font_upload_atlas(font);
-      font->atlas->dirty   = false;
+      if (font_atlas_has_dirty_rect(font->atlas))
+         gl_raster_font_update_atlas(font);
+      else
+         gl_raster_font_upload_atlas(font);
+      font_atlas_clear_dirty(font->atlas);
    }
 
    font->gl->shader->set_coords(font->gl->shader_data, coords);
@@ -31,6 +31,9 @@ typedef struct
    void *font_data;
    struct font_atlas *atlas;
    bool needs_update;
+   /* Region of the staging texture not yet copied to
+    * texture_optimal, [x0, x1) x [y0, y1). */
+   unsigned update_x0, update_y0, update_x1, update_y1;
 
    struct vk_vertex *pv;
    struct vk_buffer_range range;
@@ -82,6 +85,9 @@ static void *vulkan_raster_font_init_font(void *data,
          NULL /*&swizzle*/, VULKAN_TEXTURE_DYNAMIC);
 
    font->needs_update = true;
+   font->update_x1    = font->atlas->width;
+   font->update_y1    = font->atlas->height;
+   font_atlas_clear_dirty(font->atlas);
 
    return font;
 }
@@ -109,14 +115,44 @@ static INLINE void vulkan_raster_font_update_glyph(vulkan_raster_t *font, const
    if(font->atlas->dirty)
    {
       unsigned row;
-      for (row = glyph->atlas_offset_y; row < (glyph->atlas_offset_y + glyph->height); row++)
+      unsigned x0 = 0;
+      unsigned y0 = 0;
+      unsigned x1 = font->atlas->width;
+      unsigned y1 = font->atlas->height;
+
+      /* Renderers that track changes tell us exactly what
+       * to copy, the others may have changed anything. */
+      if (font_atlas_has_dirty_rect(font->atlas))
       {
-         uint8_t *src = font->atlas->buffer + row * font->atlas->width + glyph->atlas_offset_x;
-         uint8_t *dst = (uint8_t*)font->texture.mapped + row * font->texture.stride + glyph->atlas_offset_x;
-         memcpy(dst, src, glyph->width);
+         x0 = font->atlas->dirty_x0;
+         y0 = font->atlas->dirty_y0;
+         x1 = MIN(font->atlas->dirty_x1, font->atlas->width);
+         y1 = MIN(font->atlas->dirty_y1, font->atlas->height);
       }
 
-      font->atlas->dirty = false;
+      for (row = y0; row < y1; row++)
+      {
+         uint8_t *src = font->atlas->buffer + row * font->atlas->width + x0;
+         uint8_t *dst = (uint8_t*)font->texture.mapped + row * font->texture.stride + x0;
+         memcpy(dst, src, x1 - x0);
+      }
+
+      if (!font->needs_update)
+      {
+         font->update_x0 = x0;
+         font->update_y0 = y0;
+         font->update_x1 = x1;
+         font->update_y1 = y1;
+      }
+      else
+      {
+         font->update_x0 = MIN(font->update_x0, x0);
+         font->update_y0 = MIN(font->update_y0, y0);
+         font->update_x1 = MAX(font->update_x1, x1);
+         font->update_y1 = MAX(font->update_y1, y1);
+      }
+
+      font_atlas_clear_dirty(font->atlas);
       font->needs_update = true;
    }
 }
@@ -297,8 +333,11 @@ static void vulkan_raster_font_flush(vulkan_raster_t *font)
       begin_info.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
       vkBeginCommandBuffer(staging, &begin_info);
 
-      vulkan_copy_staging_to_dynamic(font->vk, staging,
-            &font->texture_optimal, &font->texture);
+      vulkan_copy_staging_to_dynamic_region(font->vk, staging,
+            &font->texture_optimal, &font->texture,
+            font->update_x0, font->update_y0,
+            font->update_x1 - font->update_x0,
+            font->update_y1 - font->update_y0);
 
       vkEndCommandBuffer(staging);
 
@@ -15,6 +15,7 @@
  */
 
 #include <ctype.h>
+#include <string.h>
 
 #include <file/file_path.h>
 #include <streams/file_stream.h>
@@ -25,6 +26,7 @@
 #endif
 
 #include "../font_driver.h"
+#include "../video_driver.h"
 #include "../../verbosity.h"
 
 #ifndef STB_TRUETYPE_IMPLEMENTATION
@@ -40,16 +42,60 @@
 
 #define STB_UNICODE_ATLAS_ROWS 16
 #define STB_UNICODE_ATLAS_COLS 16
-#define STB_UNICODE_ATLAS_SIZE (STB_UNICODE_ATLAS_ROWS * STB_UNICODE_ATLAS_COLS)
+
+/* Glyphs are packed into horizontal shelves of the atlas and
+ * looked up through a hash of their codepoint. When the atlas
+ * is full, the shelf used longest ago is emptied as a whole;
+ * shelf packing cannot reuse the space of a single glyph.
+ * Shelves used in the current frame are never emptied, since
+ * text drawn earlier in the frame still points at them; a glyph
+ * that does not fit then is kept without pixels and retried in
+ * a later frame. */
+#define STB_UNICODE_MAX_GLYPHS  1024
+#define STB_UNICODE_MAX_SHELVES 256
+#define STB_UNICODE_HASH_BITS   10
+#define STB_UNICODE_HASH_SIZE   (1 << STB_UNICODE_HASH_BITS)
+/* Shelf heights are rounded up to this, so glyphs of
+ * similar height share shelves. */
+#define STB_UNICODE_SHELF_ALIGN 4
+/* Empty texels kept right of and below each glyph so
+ * linear filtering does not pick up its neighbours. */
+#define STB_UNICODE_GLYPH_PAD   1
+
+struct stb_unicode_shelf;
 
 typedef struct stb_unicode_atlas_slot
 {
    struct font_glyph glyph;
    unsigned charcode;
-   unsigned last_used;
-   struct stb_unicode_atlas_slot* next;
+   /* Video frame the glyph was last used in */
+   unsigned frame;
+   /* Set when the atlas had no room for its pixels */
+   bool no_room;
+   /* NULL for glyphs without pixels (e.g. space) */
+   struct stb_unicode_shelf *shelf;
+   /* Hash chain, or free list when unused */
+   struct stb_unicode_atlas_slot *next;
+   /* LRU list, most recently used first */
+   struct stb_unicode_atlas_slot *lru_prev;
+   struct stb_unicode_atlas_slot *lru_next;
+   /* Other glyphs on the same shelf */
+   struct stb_unicode_atlas_slot *shelf_next;
 }stb_unicode_atlas_slot_t;
 
+typedef struct stb_unicode_shelf
+{
+   unsigned y;
+   unsigned height;
+   /* First free column */
+   unsigned x;
+   /* Last video frame any of its glyphs was used in */
+   unsigned frame;
+   stb_unicode_atlas_slot_t *glyphs;
+   /* Next shelf down the atlas, or free list when unused */
+   struct stb_unicode_shelf *next;
+} stb_unicode_shelf_t;
+
 typedef struct
 {
    uint8_t *font_data;
@@ -61,9 +107,18 @@ typedef struct
    float scale_factor;
 
    struct font_atlas atlas;
-   stb_unicode_atlas_slot_t atlas_slots[STB_UNICODE_ATLAS_SIZE];
-   stb_unicode_atlas_slot_t* uc_map[0x100];
-   unsigned usage_counter;
+   stb_unicode_atlas_slot_t atlas_slots[STB_UNICODE_MAX_GLYPHS];
+   stb_unicode_atlas_slot_t *free_slots;
+   stb_unicode_atlas_slot_t *uc_map[STB_UNICODE_HASH_SIZE];
+   stb_unicode_atlas_slot_t *lru_head;
+   stb_unicode_atlas_slot_t *lru_tail;
+
+   stb_unicode_shelf_t shelf_pool[STB_UNICODE_MAX_SHELVES];
+   stb_unicode_shelf_t *free_shelves;
+   /* Shelves in atlas order, top to bottom */
+   stb_unicode_shelf_t *shelves;
+   /* First row below the last shelf */
+   unsigned shelf_end;
 } stb_unicode_font_renderer_t;
 
 /* Ugly little thing... */
@@ -73,6 +128,16 @@ static int INLINE round_away_from_zero(float f)
    return (int)round;
 }
 
+static INLINE unsigned stb_unicode_hash(uint32_t charcode)
+{
+   return (charcode * 2654435761u) >> (32 - STB_UNICODE_HASH_BITS);
+}
+
+static INLINE unsigned stb_unicode_frame(void)
+{
+   return (unsigned)video_driver_get_frame_count();
+}
+
 static struct font_atlas *font_renderer_stb_unicode_get_atlas(void *data)
 {
    stb_unicode_font_renderer_t *self = (stb_unicode_font_renderer_t*)data;
@@ -88,29 +153,221 @@ static void font_renderer_stb_unicode_free(void *data)
    free(self);
 }
 
-static stb_unicode_atlas_slot_t* font_renderer_stb_unicode_get_slot(stb_unicode_font_renderer_t *handle)
+static void stb_unicode_lru_unlink(stb_unicode_font_renderer_t *self,
+      stb_unicode_atlas_slot_t *slot)
+{
+   if (slot->lru_prev)
+      slot->lru_prev->lru_next = slot->lru_next;
+   else
+      self->lru_head           = slot->lru_next;
+
+   if (slot->lru_next)
+      slot->lru_next->lru_prev = slot->lru_prev;
+   else
+      self->lru_tail           = slot->lru_prev;
+
+   slot->lru_prev = slot->lru_next = NULL;
+}
+
+static void stb_unicode_lru_push_front(stb_unicode_font_renderer_t *self,
+      stb_unicode_atlas_slot_t *slot)
+{
+   slot->lru_prev = NULL;
+   slot->lru_next = self->lru_head;
+
+   if (self->lru_head)
+      self->lru_head->lru_prev = slot;
+   else
+      self->lru_tail           = slot;
+
+   self->lru_head = slot;
+}
+
+/* Removes a glyph from the hash and the LRU list and
+ * returns its slot to the pool. */
+static void stb_unicode_release_slot(stb_unicode_font_renderer_t *self,
+      stb_unicode_atlas_slot_t *slot)
+{
+   stb_unicode_atlas_slot_t **link =
+      &self->uc_map[stb_unicode_hash(slot->charcode)];
+
+   while (*link && *link != slot)
+      link = &(*link)->next;
+   if (*link)
+      *link = slot->next;
+
+   stb_unicode_lru_unlink(self, slot);
+
+   slot->shelf      = NULL;
+   slot->shelf_next = NULL;
+   slot->next       = self->free_slots;
+   self->free_slots = slot;
+}
+
+/* Drops a single glyph whose shelf is still in use. Its space
+ * is only reclaimed once the rest of the shelf is evicted. */
+static void stb_unicode_detach_slot(stb_unicode_font_renderer_t *self,
+      stb_unicode_atlas_slot_t *slot)
 {
-   int i, map_id;
-   unsigned oldest = 0;
-
-   for (i = 1; i < STB_UNICODE_ATLAS_SIZE; i++)
-      if((handle->usage_counter - handle->atlas_slots[i].last_used) >
-         (handle->usage_counter - handle->atlas_slots[oldest].last_used))
-         oldest = i;
-
-   /* remove from map */
-   map_id = handle->atlas_slots[oldest].charcode & 0xFF;
-   if(handle->uc_map[map_id] == &handle->atlas_slots[oldest])
-      handle->uc_map[map_id] = handle->atlas_slots[oldest].next;
-   else if (handle->uc_map[map_id])
+   stb_unicode_atlas_slot_t **link = &slot->shelf->glyphs;
+
+   while (*link && *link != slot)
+      link = &(*link)->shelf_next;
+   if (*link)
+      *link = slot->shelf_next;
+
+   stb_unicode_release_slot(self, slot);
+}
+
+static void stb_unicode_evict_shelf(stb_unicode_font_renderer_t *self,
+      stb_unicode_shelf_t *shelf)
+{
+   stb_unicode_atlas_slot_t *slot = shelf->glyphs;
+
+   while (slot)
    {
-      stb_unicode_atlas_slot_t* ptr = handle->uc_map[map_id];
-      while(ptr->next && ptr->next != &handle->atlas_slots[oldest])
-         ptr = ptr->next;
-      ptr->next = handle->atlas_slots[oldest].next;
+      stb_unicode_atlas_slot_t *next = slot->shelf_next;
+      stb_unicode_release_slot(self, slot);
+      slot = next;
    }
 
-   return &handle->atlas_slots[oldest];
+   shelf->glyphs = NULL;
+   shelf->x      = 0;
+}
+
+/* Merges runs of empty shelves and gives an empty last
+ * shelf back to the unused area, so space freed by short
+ * shelves can be reused for taller glyphs. */
+static void stb_unicode_merge_shelves(stb_unicode_font_renderer_t *self)
+{
+   stb_unicode_shelf_t **link = &self->shelves;
+
+   while (*link)
+   {
+      stb_unicode_shelf_t *shelf = *link;
+      stb_unicode_shelf_t *next  = shelf->next;
+
+      if (!shelf->glyphs && next && !next->glyphs)
+      {
+         shelf->height     += next->height;
+         shelf->next        = next->next;
+         next->next         = self->free_shelves;
+         self->free_shelves = next;
+      }
+      else if (!shelf->glyphs && !next)
+      {
+         self->shelf_end    = shelf->y;
+         *link              = NULL;
+         shelf->next        = self->free_shelves;
+         self->free_shelves = shelf;
+      }
+      else
+         link = &shelf->next;
+   }
+}
+
+static stb_unicode_shelf_t *stb_unicode_find_shelf(
+      stb_unicode_font_renderer_t *self, unsigned width, unsigned height)
+{
+   stb_unicode_shelf_t *shelf = NULL;
+   stb_unicode_shelf_t *best  = NULL;
+   stb_unicode_shelf_t *last  = NULL;
+
+   /* Best fit: the shortest shelf with room left */
+   for (shelf = self->shelves; shelf; shelf = shelf->next)
+   {
+      last = shelf;
+
+      if (shelf->height < height || self->atlas.width - shelf->x < width)
+         continue;
+      if (!best || shelf->height < best->height)
+         best = shelf;
+   }
+
+   if (best)
+      return best;
+
+   height = (height + STB_UNICODE_SHELF_ALIGN - 1)
+      & ~(STB_UNICODE_SHELF_ALIGN - 1);
+
+   if (!self->free_shelves || self->shelf_end + height > self->atlas.height)
+      return NULL;
+
+   shelf              = self->free_shelves;
+   self->free_shelves = shelf->next;
+
+   shelf->y           = self->shelf_end;
+   shelf->height      = height;
+   shelf->x           = 0;
+   shelf->glyphs      = NULL;
+   shelf->next        = NULL;
+   self->shelf_end   += height;
+
+   if (last)
+      last->next      = shelf;
+   else
+      self->shelves   = shelf;
+
+   return shelf;
+}
+
+static stb_unicode_shelf_t *stb_unicode_alloc_rect(
+      stb_unicode_font_renderer_t *self, unsigned width, unsigned height,
+      unsigned frame)
+{
+   stb_unicode_shelf_t *shelf = stb_unicode_find_shelf(self, width, height);
+
+   while (!shelf)
+   {
+      stb_unicode_shelf_t *victim = NULL;
+
+      /* The shelf used longest ago, skipping this frame's shelves */
+      for (shelf = self->shelves; shelf; shelf = shelf->next)
+      {
+         if (!shelf->glyphs || shelf->frame == frame)
+            continue;
+         if (!victim || frame - shelf->frame > frame - victim->frame)
+            victim = shelf;
+      }
+
+      if (!victim)
+         return NULL;
+
+      stb_unicode_evict_shelf(self, victim);
+      stb_unicode_merge_shelves(self);
+
+      shelf = stb_unicode_find_shelf(self, width, height);
+   }
+
+   return shelf;
+}
+
+static stb_unicode_atlas_slot_t* font_renderer_stb_unicode_get_slot(
+      stb_unicode_font_renderer_t *handle, unsigned frame)
+{
+   stb_unicode_atlas_slot_t *slot = NULL;
+
+   while (!handle->free_slots && handle->lru_tail)
+   {
+      stb_unicode_atlas_slot_t *victim = handle->lru_tail;
+
+      /* Every glyph in the pool was used this frame */
+      if (victim->frame == frame)
+         return NULL;
+
+      if (!victim->shelf)
+         stb_unicode_release_slot(handle, victim);
+      else if (victim->shelf->frame != frame)
+         stb_unicode_evict_shelf(handle, victim->shelf);
+      else
+         stb_unicode_detach_slot(handle, victim);
+   }
+
+   slot               = handle->free_slots;
+   handle->free_slots = slot->next;
+   slot->next         = NULL;
+
+   return slot;
 }
 
 static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
@@ -118,75 +375,135 @@ static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
 {
    int glyph_index                      = 0;
    int x0                               = 0;
+   int y0                               = 0;
+   int x1                               = 0;
    int y1                               = 0;
    int advance_width                    = 0;
    int left_side_bearing                = 0;
+   unsigned width                       = 0;
+   unsigned height                      = 0;
    unsigned map_id                      = 0;
-   uint8_t *dst                         = NULL;
+   unsigned frame                       = 0;
    stb_unicode_atlas_slot_t* atlas_slot = NULL;
    stb_unicode_font_renderer_t *self    = (stb_unicode_font_renderer_t*)data;
 
    if(!self)
       return NULL;
 
-   map_id                               = charcode & 0xFF;
+   frame                                = stb_unicode_frame();
+   map_id                               = stb_unicode_hash(charcode);
    atlas_slot                           = self->uc_map[map_id];
 
    while(atlas_slot)
    {
       if(atlas_slot->charcode == charcode)
       {
-         atlas_slot->last_used = self->usage_counter++;
+         /* Try again to find room for it. */
+         if (atlas_slot->no_room && atlas_slot->frame != frame)
+         {
+            stb_unicode_release_slot(self, atlas_slot);
+            break;
+         }
+
+         atlas_slot->frame = frame;
+         if (atlas_slot->shelf)
+            atlas_slot->shelf->frame = frame;
+
+         if (atlas_slot != self->lru_head)
+         {
+            stb_unicode_lru_unlink(self, atlas_slot);
+            stb_unicode_lru_push_front(self, atlas_slot);
+         }
          return &atlas_slot->glyph;
       }
       atlas_slot = atlas_slot->next;
    }
 
-   atlas_slot             = font_renderer_stb_unicode_get_slot(self);
-   atlas_slot->charcode   = charcode;
-   atlas_slot->next       = self->uc_map[map_id];
-   self->uc_map[map_id] = atlas_slot;
-
    glyph_index              = stbtt_FindGlyphIndex(&self->info, charcode);
 
-   dst = (uint8_t*)self->atlas.buffer + atlas_slot->glyph.atlas_offset_x
-         + atlas_slot->glyph.atlas_offset_y * self->atlas.width;
-
    stbtt_GetGlyphHMetrics(&self->info, glyph_index, &advance_width, &left_side_bearing);
-   if (stbtt_GetGlyphBox(&self->info, glyph_index, &x0, NULL, NULL, &y1))
+
+   /* An empty glyph has no box and needs no atlas space. */
+   if (stbtt_GetGlyphBox(&self->info, glyph_index, NULL, NULL, NULL, NULL))
    {
-      stbtt_MakeGlyphBitmap(&self->info, dst, self->max_glyph_width, self->max_glyph_height,
-            self->atlas.width, self->scale_factor, self->scale_factor, glyph_index);
+      stbtt_GetGlyphBitmapBox(&self->info, glyph_index,
+            self->scale_factor, self->scale_factor, &x0, &y0, &x1, &y1);
+
+      width  = MIN(x1 - x0, self->max_glyph_width);
+      height = MIN(y1 - y0, self->max_glyph_height);
    }
-   else
+
+   atlas_slot             = font_renderer_stb_unicode_get_slot(self, frame);
+   if (!atlas_slot)
+      return NULL;
+
+   atlas_slot->charcode   = charcode;
+   atlas_slot->frame      = frame;
+   atlas_slot->no_room    = false;
+   atlas_slot->shelf      = NULL;
+
+   atlas_slot->glyph.atlas_offset_x = 0;
+   atlas_slot->glyph.atlas_offset_y = 0;
+
+   if (width && height)
    {
-      /* This means the glyph is empty. In this case, stbtt_MakeGlyphBitmap()
-       * fills the corresponding region of the atlas buffer with garbage,
-       * so just zero it */
-      unsigned x, y;
-      for (x = 0; x < self->max_glyph_width; x++)
-         for (y = 0; y < self->max_glyph_height; y++)
-            dst[x + (y * self->atlas.width)] = 0;
+      unsigned y;
+      uint8_t *dst               = NULL;
+      unsigned padded_width      = width  + STB_UNICODE_GLYPH_PAD;
+      unsigned padded_height     = height + STB_UNICODE_GLYPH_PAD;
+      stb_unicode_shelf_t *shelf = stb_unicode_alloc_rect(self,
+            padded_width, padded_height, frame);
+
+      if (shelf)
+      {
+         shelf->frame                     = frame;
+         atlas_slot->glyph.atlas_offset_x = shelf->x;
+         atlas_slot->glyph.atlas_offset_y = shelf->y;
+         atlas_slot->shelf                = shelf;
+         atlas_slot->shelf_next           = shelf->glyphs;
+         shelf->glyphs                    = atlas_slot;
+         shelf->x                        += padded_width;
+
+         dst = (uint8_t*)self->atlas.buffer + atlas_slot->glyph.atlas_offset_x
+            + atlas_slot->glyph.atlas_offset_y * self->atlas.width;
+
+         /* The space may have belonged to evicted glyphs. */
+         for (y = 0; y < padded_height; y++)
+            memset(dst + y * self->atlas.width, 0, padded_width);
+
+         stbtt_MakeGlyphBitmap(&self->info, dst, width, height,
+               self->atlas.width, self->scale_factor, self->scale_factor, glyph_index);
+
+         font_atlas_mark_dirty(&self->atlas,
+               atlas_slot->glyph.atlas_offset_x,
+               atlas_slot->glyph.atlas_offset_y,
+               padded_width, padded_height);
+      }
+      else
+      {
+         atlas_slot->no_room              = true;
+         width = height                   = 0;
+      }
    }
 
-   atlas_slot->glyph.width          = self->max_glyph_width;
-   atlas_slot->glyph.height         = self->max_glyph_height;
+   atlas_slot->glyph.width          = width;
+   atlas_slot->glyph.height         = height;
    atlas_slot->glyph.advance_x      = round_away_from_zero((float)advance_width * self->scale_factor);
    atlas_slot->glyph.advance_y      = 0;
-   atlas_slot->glyph.draw_offset_x  = round_away_from_zero((float)x0 * self->scale_factor);
-   atlas_slot->glyph.draw_offset_y  = round_away_from_zero((float)(-y1) * self->scale_factor);
+   atlas_slot->glyph.draw_offset_x  = x0;
+   atlas_slot->glyph.draw_offset_y  = y0;
 
-   self->atlas.dirty = true;
-   atlas_slot->last_used = self->usage_counter++;
-   return &atlas_slot->glyph;
+   atlas_slot->next       = self->uc_map[map_id];
+   self->uc_map[map_id]   = atlas_slot;
+   stb_unicode_lru_push_front(self, atlas_slot);
 
+   return &atlas_slot->glyph;
 }
 
 static bool font_renderer_stb_unicode_create_atlas(
       stb_unicode_font_renderer_t *self, float font_size)
 {
-   unsigned i, x, y;
-   stb_unicode_atlas_slot_t* slot = NULL;
+   unsigned i;
 
    self->max_glyph_width  = font_size < 0 ? -font_size : font_size;
    self->max_glyph_height = font_size < 0 ? -font_size : font_size;
@@ -200,16 +517,16 @@ static bool font_renderer_stb_unicode_create_atlas(
    if (!self->atlas.buffer)
       return false;
 
-   slot = self->atlas_slots;
+   for (i = 0; i < STB_UNICODE_MAX_GLYPHS; i++)
+   {
+      self->atlas_slots[i].next = self->free_slots;
+      self->free_slots          = &self->atlas_slots[i];
+   }
 
-   for (y = 0; y < STB_UNICODE_ATLAS_ROWS; y++)
+   for (i = 0; i < STB_UNICODE_MAX_SHELVES; i++)
    {
-      for (x = 0; x < STB_UNICODE_ATLAS_COLS; x++)
-      {
-         slot->glyph.atlas_offset_x = x * self->max_glyph_width;
-         slot->glyph.atlas_offset_y = y * self->max_glyph_height;
-         slot++;
-      }
+      self->shelf_pool[i].next = self->free_shelves;
+      self->free_shelves       = &self->shelf_pool[i];
    }
 
    for (i = 0; i < 256; i++)
@@ -221,6 +538,10 @@ static bool font_renderer_stb_unicode_create_atlas(
          font_renderer_stb_unicode_get_glyph(self, i);
    }
 
+   /* Drivers upload the whole atlas when they create it. */
+   font_atlas_clear_dirty(&self->atlas);
+   self->atlas.dirty = true;
+
    return true;
 }
 
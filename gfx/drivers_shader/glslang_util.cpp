@@ -30,6 +30,7 @@
 #endif
 
 #include "glslang_util.h"
+#include "slang_cache.h"
 #if defined(HAVE_GLSLANG)
 #include <glslang.hpp>
 #endif
@@ -382,9 +383,12 @@ bool glslang_parse_meta(const vector<string> &lines, glslang_meta *meta)
 #if defined(HAVE_GLSLANG)
 bool glslang_compile_shader(const char *shader_path, glslang_output *output)
 {
+   char key[SLANG_CACHE_KEY_SIZE];
    vector<string> lines;
-
-   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+   string vertex_source;
+   string fragment_source;
+   char cache_dir[PATH_MAX_LENGTH];
+   bool use_cache = false;
 
    if (!glslang_read_shader_file(shader_path, &lines, true))
       return false;
@@ -392,20 +396,44 @@ bool glslang_compile_shader(const char *shader_path, glslang_output *output)
    if (!glslang_parse_meta(lines, &output->meta))
       return false;
 
-   if (    !glslang::compile_spirv(build_stage_source(lines, "vertex"),
+   /* Includes are already expanded, so the stage sources
+    * cover everything the SPIR-V depends on. */
+   vertex_source   = build_stage_source(lines, "vertex");
+   fragment_source = build_stage_source(lines, "fragment");
+   use_cache       = slang_cache_dir(cache_dir, sizeof(cache_dir));
+
+   if (use_cache)
+   {
+      slang_cache_spirv_key(key, vertex_source, fragment_source);
+
+      if (slang_cache_load_spirv(cache_dir, key,
+               &output->vertex, &output->fragment))
+      {
+         RARCH_LOG("[slang]: Loaded cached shader \"%s\".\n", shader_path);
+         return true;
+      }
+   }
+
+   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+
+   if (    !glslang::compile_spirv(vertex_source,
             glslang::StageVertex, &output->vertex))
    {
       RARCH_ERR("Failed to compile vertex shader stage.\n");
       return false;
    }
 
-   if (    !glslang::compile_spirv(build_stage_source(lines, "fragment"),
+   if (    !glslang::compile_spirv(fragment_source,
             glslang::StageFragment, &output->fragment))
    {
       RARCH_ERR("Failed to compile fragment shader stage.\n");
       return false;
    }
 
+   if (use_cache && !slang_cache_save_spirv(cache_dir, key,
+            output->vertex, output->fragment))
+      RARCH_WARN("[slang]: Failed to write shader cache entry.\n");
+
    return true;
 }
 #else
@@ -0,0 +1,510 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2017 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include <compat/strl.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
+#include <retro_miscellaneous.h>
+#include <rhash.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "slang_cache.h"
+#include "slang_reflection.h"
+#include "slang_reflection.hpp"
+#include "../../configuration.h"
+#include "../../verbosity.h"
+
+using namespace std;
+
+#define SLANG_CACHE_MAGIC       "RASLANGC"
+#define SLANG_CACHE_MAGIC_SIZE  8
+#define SLANG_CACHE_HEADER_SIZE (SLANG_CACHE_MAGIC_SIZE + 16)
+
+/* Serialized sizes of slang_semantic_meta and
+ * slang_texture_semantic_meta */
+#define SLANG_CACHE_SEMANTIC_SIZE 24
+#define SLANG_CACHE_TEXTURE_SIZE  28
+
+enum slang_cache_entry_type
+{
+   SLANG_CACHE_ENTRY_SPIRV = 0,
+   SLANG_CACHE_ENTRY_REFLECTION
+};
+
+/* Cache files never leave the machine that wrote them,
+ * so the payload is stored in native byte order. */
+static void slang_cache_put_u32(vector<uint8_t> &buf, uint32_t v)
+{
+   size_t pos = buf.size();
+   buf.resize(pos + sizeof(v));
+   memcpy(buf.data() + pos, &v, sizeof(v));
+}
+
+static void slang_cache_put_u64(vector<uint8_t> &buf, uint64_t v)
+{
+   size_t pos = buf.size();
+   buf.resize(pos + sizeof(v));
+   memcpy(buf.data() + pos, &v, sizeof(v));
+}
+
+struct slang_cache_reader
+{
+   const uint8_t *ptr;
+   const uint8_t *end;
+};
+
+static bool slang_cache_get_u32(slang_cache_reader *r, uint32_t *v)
+{
+   if ((size_t)(r->end - r->ptr) < sizeof(*v))
+      return false;
+   memcpy(v, r->ptr, sizeof(*v));
+   r->ptr += sizeof(*v);
+   return true;
+}
+
+static bool slang_cache_get_u64(slang_cache_reader *r, uint64_t *v)
+{
+   if ((size_t)(r->end - r->ptr) < sizeof(*v))
+      return false;
+   memcpy(v, r->ptr, sizeof(*v));
+   r->ptr += sizeof(*v);
+   return true;
+}
+
+static void slang_cache_hash(char *key, const string &input)
+{
+   sha256_hash(key, (const uint8_t*)input.data(), input.size());
+}
+
+static void slang_cache_entry_path(char *s, size_t len,
+      const char *dir, const char *key, const char *ext)
+{
+   char name[SLANG_CACHE_KEY_SIZE + 8];
+
+   strlcpy(name, key, sizeof(name));
+   strlcat(name, ext, sizeof(name));
+   fill_pathname_join(s, dir, name, len);
+}
+
+static bool slang_cache_read_entry(const char *path,
+      enum slang_cache_entry_type type, vector<uint8_t> *payload)
+{
+   uint32_t version, entry_type, size, crc;
+   void *buf      = NULL;
+   int64_t len    = 0;
+   const uint8_t *data;
+   bool ret       = false;
+
+   if (!path_is_valid(path))
+      return false;
+
+   if (!filestream_read_file(path, &buf, &len))
+      return false;
+
+   data = (const uint8_t*)buf;
+
+   if (len < SLANG_CACHE_HEADER_SIZE ||
+         memcmp(data, SLANG_CACHE_MAGIC, SLANG_CACHE_MAGIC_SIZE))
+      goto end;
+
+   memcpy(&version,    data + SLANG_CACHE_MAGIC_SIZE +  0, 4);
+   memcpy(&entry_type, data + SLANG_CACHE_MAGIC_SIZE +  4, 4);
+   memcpy(&size,       data + SLANG_CACHE_MAGIC_SIZE +  8, 4);
+   memcpy(&crc,        data + SLANG_CACHE_MAGIC_SIZE + 12, 4);
+
+   if (     version    != SLANG_CACHE_VERSION
+         || entry_type != (uint32_t)type
+         || (uint64_t)len != SLANG_CACHE_HEADER_SIZE + (uint64_t)size)
+      goto end;
+
+   if (encoding_crc32(0, data + SLANG_CACHE_HEADER_SIZE, size) != crc)
+   {
+      RARCH_WARN("[slang]: Ignoring corrupt cache entry \"%s\".\n", path);
+      goto end;
+   }
+
+   payload->assign(data + SLANG_CACHE_HEADER_SIZE,
+         data + SLANG_CACHE_HEADER_SIZE + size);
+   ret = true;
+
+end:
+   free(buf);
+   return ret;
+}
+
+static bool slang_cache_write_entry(const char *path,
+      enum slang_cache_entry_type type, const vector<uint8_t> &payload)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+   vector<uint8_t> buf;
+   uint32_t crc = encoding_crc32(0, payload.data(), payload.size());
+
+   buf.reserve(SLANG_CACHE_HEADER_SIZE + payload.size());
+   buf.insert(buf.end(), (const uint8_t*)SLANG_CACHE_MAGIC,
+         (const uint8_t*)SLANG_CACHE_MAGIC + SLANG_CACHE_MAGIC_SIZE);
+   slang_cache_put_u32(buf, SLANG_CACHE_VERSION);
+   slang_cache_put_u32(buf, (uint32_t)type);
+   slang_cache_put_u32(buf, (uint32_t)payload.size());
+   slang_cache_put_u32(buf, crc);
+   buf.insert(buf.end(), payload.begin(), payload.end());
+
+   /* Write next to the entry and rename it into place, so
+    * a concurrent reader never sees a partial file. */
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (!filestream_write_file(tmp_path, buf.data(), buf.size()))
+      return false;
+
+   if (filestream_rename(tmp_path, path) != 0)
+   {
+      /* Entries are content-addressed, so one already
+       * written by another instance is identical. */
+      filestream_delete(tmp_path);
+      return path_is_valid(path);
+   }
+
+   return true;
+}
+
+bool slang_cache_dir(char *s, size_t len)
+{
+   settings_t *settings = config_get_ptr();
+
+   if (!settings || string_is_empty(settings->paths.directory_cache))
+      return false;
+
+   fill_pathname_join(s, settings->paths.directory_cache, "slang", len);
+
+   return path_is_directory(s) || path_mkdir(s);
+}
+
+void slang_cache_spirv_key(char *key,
+      const string &vertex_source,
+      const string &fragment_source)
+{
+   string input;
+   char header[64];
+
+   snprintf(header, sizeof(header), "spirv %u %u %u\n",
+         SLANG_CACHE_VERSION,
+         (unsigned)vertex_source.size(),
+         (unsigned)fragment_source.size());
+
+   input.reserve(strlen(header) + vertex_source.size()
+         + fragment_source.size()
+#ifdef PACKAGE_VERSION
+         + strlen(PACKAGE_VERSION)
+#endif
+         );
+   input += header;
+#ifdef PACKAGE_VERSION
+   /* The bundled glslang is only updated with releases. */
+   input += PACKAGE_VERSION;
+#endif
+   input += vertex_source;
+   input += fragment_source;
+
+   slang_cache_hash(key, input);
+}
+
+bool slang_cache_load_spirv(const char *dir, const char *key,
+      vector<uint32_t> *vertex,
+      vector<uint32_t> *fragment)
+{
+   char path[PATH_MAX_LENGTH];
+   vector<uint8_t> payload;
+   slang_cache_reader r;
+   uint32_t vertex_words, fragment_words;
+
+   slang_cache_entry_path(path, sizeof(path), dir, key, ".spv");
+
+   if (!slang_cache_read_entry(path, SLANG_CACHE_ENTRY_SPIRV, &payload))
+      return false;
+
+   r.ptr = payload.data();
+   r.end = payload.data() + payload.size();
+
+   if (     !slang_cache_get_u32(&r, &vertex_words)
+         || !slang_cache_get_u32(&r, &fragment_words))
+      return false;
+
+   if ((uint64_t)(r.end - r.ptr) !=
+         ((uint64_t)vertex_words + fragment_words) * sizeof(uint32_t))
+      return false;
+
+   vertex->resize(vertex_words);
+   fragment->resize(fragment_words);
+   memcpy(vertex->data(), r.ptr, vertex_words * sizeof(uint32_t));
+   memcpy(fragment->data(), r.ptr + vertex_words * sizeof(uint32_t),
+         fragment_words * sizeof(uint32_t));
+
+   return true;
+}
+
+bool slang_cache_save_spirv(const char *dir, const char *key,
+      const vector<uint32_t> &vertex,
+      const vector<uint32_t> &fragment)
+{
+   char path[PATH_MAX_LENGTH];
+   vector<uint8_t> payload;
+
+   payload.reserve(8 + (vertex.size() + fragment.size()) * sizeof(uint32_t));
+   slang_cache_put_u32(payload, (uint32_t)vertex.size());
+   slang_cache_put_u32(payload, (uint32_t)fragment.size());
+   payload.insert(payload.end(), (const uint8_t*)vertex.data(),
+         (const uint8_t*)(vertex.data() + vertex.size()));
+   payload.insert(payload.end(), (const uint8_t*)fragment.data(),
+         (const uint8_t*)(fragment.data() + fragment.size()));
+
+   slang_cache_entry_path(path, sizeof(path), dir, key, ".spv");
+
+   return slang_cache_write_entry(path, SLANG_CACHE_ENTRY_SPIRV, payload);
+}
+
+template <typename M>
+static void slang_cache_hash_map(string &input, const char *tag, const M *m)
+{
+   vector<string> lines;
+   char line[256];
+
+   input += tag;
+
+   if (!m)
+   {
+      input += " none\n";
+      return;
+   }
+
+   /* unordered_map iteration order is unspecified. */
+   for (auto &entry : *m)
+   {
+      snprintf(line, sizeof(line), "%s %d %u\n", entry.first.c_str(),
+            (int)entry.second.semantic, entry.second.index);
+      lines.push_back(line);
+   }
+
+   sort(begin(lines), end(lines));
+
+   input += '\n';
+   for (auto &l : lines)
+      input += l;
+}
+
+void slang_cache_reflection_key(char *key,
+      const vector<uint32_t> &vertex,
+      const vector<uint32_t> &fragment,
+      const slang_reflection &reflection)
+{
+   string input;
+   char header[64];
+
+   snprintf(header, sizeof(header), "reflection %u %u %u %u\n",
+         SLANG_CACHE_VERSION,
+         reflection.pass_number,
+         (unsigned)vertex.size(), (unsigned)fragment.size());
+
+   input += header;
+   input.append((const char*)vertex.data(), vertex.size() * sizeof(uint32_t));
+   input.append((const char*)fragment.data(), fragment.size() * sizeof(uint32_t));
+
+   slang_cache_hash_map(input, "textures", reflection.texture_semantic_map);
+   slang_cache_hash_map(input, "texture_uniforms",
+         reflection.texture_semantic_uniform_map);
+   slang_cache_hash_map(input, "semantics", reflection.semantic_map);
+
+   slang_cache_hash(key, input);
+}
+
+static void slang_cache_put_semantic(vector<uint8_t> &buf,
+      const slang_semantic_meta &meta)
+{
+   slang_cache_put_u64(buf, meta.ubo_offset);
+   slang_cache_put_u64(buf, meta.push_constant_offset);
+   slang_cache_put_u32(buf, meta.num_components);
+   slang_cache_put_u32(buf, (meta.uniform       ? 1 : 0)
+                          | (meta.push_constant ? 2 : 0));
+}
+
+static bool slang_cache_get_semantic(slang_cache_reader *r,
+      slang_semantic_meta *meta)
+{
+   uint64_t ubo_offset, push_constant_offset;
+   uint32_t num_components, flags;
+
+   if (     !slang_cache_get_u64(r, &ubo_offset)
+         || !slang_cache_get_u64(r, &push_constant_offset)
+         || !slang_cache_get_u32(r, &num_components)
+         || !slang_cache_get_u32(r, &flags))
+      return false;
+
+   meta->ubo_offset           = (size_t)ubo_offset;
+   meta->push_constant_offset = (size_t)push_constant_offset;
+   meta->num_components       = num_components;
+   meta->uniform              = (flags & 1) != 0;
+   meta->push_constant        = (flags & 2) != 0;
+   return true;
+}
+
+static void slang_cache_put_texture(vector<uint8_t> &buf,
+      const slang_texture_semantic_meta &meta)
+{
+   slang_cache_put_u64(buf, meta.ubo_offset);
+   slang_cache_put_u64(buf, meta.push_constant_offset);
+   slang_cache_put_u32(buf, meta.binding);
+   slang_cache_put_u32(buf, meta.stage_mask);
+   slang_cache_put_u32(buf, (meta.texture       ? 1 : 0)
+                          | (meta.uniform       ? 2 : 0)
+                          | (meta.push_constant ? 4 : 0));
+}
+
+static bool slang_cache_get_texture(slang_cache_reader *r,
+      slang_texture_semantic_meta *meta)
+{
+   uint64_t ubo_offset, push_constant_offset;
+   uint32_t binding, stage_mask, flags;
+
+   if (     !slang_cache_get_u64(r, &ubo_offset)
+         || !slang_cache_get_u64(r, &push_constant_offset)
+         || !slang_cache_get_u32(r, &binding)
+         || !slang_cache_get_u32(r, &stage_mask)
+         || !slang_cache_get_u32(r, &flags))
+      return false;
+
+   meta->ubo_offset           = (size_t)ubo_offset;
+   meta->push_constant_offset = (size_t)push_constant_offset;
+   meta->binding              = binding;
+   meta->stage_mask           = stage_mask;
+   meta->texture              = (flags & 1) != 0;
+   meta->uniform              = (flags & 2) != 0;
+   meta->push_constant        = (flags & 4) != 0;
+   return true;
+}
+
+bool slang_cache_load_reflection(const char *dir, const char *key,
+      slang_reflection *reflection)
+{
+   unsigned i, j;
+   char path[PATH_MAX_LENGTH];
+   vector<uint8_t> payload;
+   slang_cache_reader r;
+   uint64_t ubo_size, push_constant_size;
+   uint32_t ubo_binding, ubo_stage_mask, push_constant_stage_mask, count;
+   /* Only touch the caller's reflection once everything parsed. */
+   slang_reflection out;
+
+   slang_cache_entry_path(path, sizeof(path), dir, key, ".refl");
+
+   if (!slang_cache_read_entry(path, SLANG_CACHE_ENTRY_REFLECTION, &payload))
+      return false;
+
+   r.ptr = payload.data();
+   r.end = payload.data() + payload.size();
+
+   if (     !slang_cache_get_u64(&r, &ubo_size)
+         || !slang_cache_get_u64(&r, &push_constant_size)
+         || !slang_cache_get_u32(&r, &ubo_binding)
+         || !slang_cache_get_u32(&r, &ubo_stage_mask)
+         || !slang_cache_get_u32(&r, &push_constant_stage_mask))
+      return false;
+
+   for (i = 0; i < SLANG_NUM_TEXTURE_SEMANTICS; i++)
+   {
+      if (!slang_cache_get_u32(&r, &count) ||
+            (uint64_t)count * SLANG_CACHE_TEXTURE_SIZE
+            > (uint64_t)(r.end - r.ptr))
+         return false;
+
+      out.semantic_textures[i].resize(count);
+      for (j = 0; j < count; j++)
+         if (!slang_cache_get_texture(&r, &out.semantic_textures[i][j]))
+            return false;
+   }
+
+   for (i = 0; i < SLANG_NUM_SEMANTICS; i++)
+      if (!slang_cache_get_semantic(&r, &out.semantics[i]))
+         return false;
+
+   if (!slang_cache_get_u32(&r, &count) ||
+         (uint64_t)count * SLANG_CACHE_SEMANTIC_SIZE
+         > (uint64_t)(r.end - r.ptr))
+      return false;
+
+   out.semantic_float_parameters.resize(count);
+   for (j = 0; j < count; j++)
+      if (!slang_cache_get_semantic(&r, &out.semantic_float_parameters[j]))
+         return false;
+
+   if (r.ptr != r.end)
+      return false;
+
+   reflection->ubo_size                 = (size_t)ubo_size;
+   reflection->push_constant_size       = (size_t)push_constant_size;
+   reflection->ubo_binding              = ubo_binding;
+   reflection->ubo_stage_mask           = ubo_stage_mask;
+   reflection->push_constant_stage_mask = push_constant_stage_mask;
+
+   for (i = 0; i < SLANG_NUM_TEXTURE_SEMANTICS; i++)
+      reflection->semantic_textures[i].swap(out.semantic_textures[i]);
+   for (i = 0; i < SLANG_NUM_SEMANTICS; i++)
+      reflection->semantics[i] = out.semantics[i];
+   reflection->semantic_float_parameters.swap(out.semantic_float_parameters);
+
+   return true;
+}
+
+bool slang_cache_save_reflection(const char *dir, const char *key,
+      const slang_reflection &reflection)
+{
+   unsigned i;
+   char path[PATH_MAX_LENGTH];
+   vector<uint8_t> payload;
+
+   slang_cache_put_u64(payload, reflection.ubo_size);
+   slang_cache_put_u64(payload, reflection.push_constant_size);
+   slang_cache_put_u32(payload, reflection.ubo_binding);
+   slang_cache_put_u32(payload, reflection.ubo_stage_mask);
+   slang_cache_put_u32(payload, reflection.push_constant_stage_mask);
+
+   for (i = 0; i < SLANG_NUM_TEXTURE_SEMANTICS; i++)
+   {
+      slang_cache_put_u32(payload,
+            (uint32_t)reflection.semantic_textures[i].size());
+      for (auto &meta : reflection.semantic_textures[i])
+         slang_cache_put_texture(payload, meta);
+   }
+
+   for (i = 0; i < SLANG_NUM_SEMANTICS; i++)
+      slang_cache_put_semantic(payload, reflection.semantics[i]);
+
+   slang_cache_put_u32(payload,
+         (uint32_t)reflection.semantic_float_parameters.size());
+   for (auto &meta : reflection.semantic_float_parameters)
+      slang_cache_put_semantic(payload, meta);
+
+   slang_cache_entry_path(path, sizeof(path), dir, key, ".refl");
+
+   return slang_cache_write_entry(path, SLANG_CACHE_ENTRY_REFLECTION, payload);
+}
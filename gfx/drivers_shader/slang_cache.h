@@ -0,0 +1,94 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2017 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLANG_CACHE_H_
+#define SLANG_CACHE_H_
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+
+struct slang_reflection;
+
+/* Content-addressed cache of compiled slang passes.
+ *
+ * Entries are named after the SHA-256 of everything that
+ * determines their contents, so they never need to be
+ * invalidated; a changed shader, include or define simply
+ * hashes to a new entry.
+ *
+ *   <key>.spv   SPIR-V for both stages, keyed on the
+ *               preprocessed stage sources.
+ *   <key>.refl  Reflection results, keyed on the SPIR-V and
+ *               the semantic maps the reflection ran with.
+ *
+ * Every entry carries a CRC32 of its payload and is written
+ * to a temporary file first, so a torn or corrupt entry is
+ * treated as a miss.
+ *
+ * None of this touches the GPU; the functions taking a
+ * directory work on any path. */
+
+/* Bump when the compiler or the reflection code changes
+ * in a way that alters cached output. */
+#define SLANG_CACHE_VERSION   1
+#define SLANG_CACHE_KEY_SIZE  65
+
+/**
+ * slang_cache_dir:
+ * @s               : output for the directory
+ * @len             : size of @s
+ *
+ * Gets the directory holding the shader cache, created if
+ * needed. Filter chains may be built on the video thread,
+ * so the path is written to the caller's buffer.
+ *
+ * Returns: false if there is no cache directory configured.
+ **/
+bool slang_cache_dir(char *s, size_t len);
+
+void slang_cache_spirv_key(char *key,
+      const std::string &vertex_source,
+      const std::string &fragment_source);
+
+bool slang_cache_load_spirv(const char *dir, const char *key,
+      std::vector<uint32_t> *vertex,
+      std::vector<uint32_t> *fragment);
+
+bool slang_cache_save_spirv(const char *dir, const char *key,
+      const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment);
+
+/**
+ * slang_cache_reflection_key:
+ * @key             : output, SLANG_CACHE_KEY_SIZE bytes
+ * @vertex          : vertex SPIR-V
+ * @fragment        : fragment SPIR-V
+ * @reflection      : reflection inputs (pass number and
+ *                    semantic maps)
+ **/
+void slang_cache_reflection_key(char *key,
+      const std::vector<uint32_t> &vertex,
+      const std::vector<uint32_t> &fragment,
+      const slang_reflection &reflection);
+
+/* Fills in the reflection results, leaving its inputs alone. */
+bool slang_cache_load_reflection(const char *dir, const char *key,
+      slang_reflection *reflection);
+
+bool slang_cache_save_reflection(const char *dir, const char *key,
+      const slang_reflection &reflection);
+
+#endif
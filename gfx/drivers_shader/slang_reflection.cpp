@@ -16,9 +16,11 @@
 #include "spirv_cross.hpp"
 #include "slang_reflection.h"
 #include "slang_reflection.hpp"
+#include "slang_cache.h"
 #include <vector>
 #include <algorithm>
 #include <stdio.h>
+#include <retro_miscellaneous.h>
 #include "../../verbosity.h"
 
 using namespace std;
@@ -656,6 +658,17 @@ bool slang_reflect_spirv(const std::vector<uint32_t> &vertex,
       const std::vector<uint32_t> &fragment,
       slang_reflection *reflection)
 {
+   char key[SLANG_CACHE_KEY_SIZE];
+   char cache_dir[PATH_MAX_LENGTH];
+   bool use_cache = slang_cache_dir(cache_dir, sizeof(cache_dir));
+
+   if (use_cache)
+   {
+      slang_cache_reflection_key(key, vertex, fragment, *reflection);
+      if (slang_cache_load_reflection(cache_dir, key, reflection))
+         return true;
+   }
+
    try
    {
       Compiler vertex_compiler(vertex);
@@ -672,6 +685,9 @@ bool slang_reflect_spirv(const std::vector<uint32_t> &vertex,
          return false;
       }
 
+      if (use_cache)
+         slang_cache_save_reflection(cache_dir, key, *reflection);
+
       return true;
    }
    catch (const std::exception &e)
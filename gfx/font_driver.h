@@ -21,6 +21,7 @@
 
 #include <boolean.h>
 #include <retro_common_api.h>
+#include <retro_inline.h>
 
 #include "video_driver.h"
 
@@ -59,8 +60,54 @@ struct font_atlas
    unsigned width;
    unsigned height;
    bool dirty;
+
+   /* Region changed since the last upload, [x0, x1) x [y0, y1).
+    * Left empty by renderers that do not track it, in which
+    * case the whole atlas has to be uploaded. */
+   unsigned dirty_x0;
+   unsigned dirty_y0;
+   unsigned dirty_x1;
+   unsigned dirty_y1;
 };
 
+static INLINE void font_atlas_mark_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   if (atlas->dirty_x1 <= atlas->dirty_x0)
+   {
+      atlas->dirty_x0 = x;
+      atlas->dirty_y0 = y;
+      atlas->dirty_x1 = x + width;
+      atlas->dirty_y1 = y + height;
+   }
+   else
+   {
+      if (x < atlas->dirty_x0)
+         atlas->dirty_x0 = x;
+      if (y < atlas->dirty_y0)
+         atlas->dirty_y0 = y;
+      if (x + width > atlas->dirty_x1)
+         atlas->dirty_x1 = x + width;
+      if (y + height > atlas->dirty_y1)
+         atlas->dirty_y1 = y + height;
+   }
+
+   atlas->dirty = true;
+}
+
+static INLINE bool font_atlas_has_dirty_rect(const struct font_atlas *atlas)
+{
+   return atlas->dirty_x1 > atlas->dirty_x0
+      &&  atlas->dirty_y1 > atlas->dirty_y0;
+}
+
+static INLINE void font_atlas_clear_dirty(struct font_atlas *atlas)
+{
+   atlas->dirty    = false;
+   atlas->dirty_x0 = atlas->dirty_y0 = 0;
+   atlas->dirty_x1 = atlas->dirty_y1 = 0;
+}
+
 struct font_params
 {
    float x;
@@ -59,6 +59,7 @@
 
 #include "../frontend/frontend_driver.h"
 #include "../record/record_driver.h"
+#include "../performance_counters.h"
 #include "../config.def.h"
 #include "../configuration.h"
 #include "../driver.h"
@@ -166,6 +167,9 @@ static char video_driver_window_title[512]               = {0};
 static bool video_driver_window_title_update             = true;
 
 static retro_time_t video_driver_frame_time_samples[MEASURE_FRAME_TIME_SAMPLES_COUNT];
+#ifdef HAVE_THREADS
+static retro_time_t video_driver_thread_frame_time_samples[MEASURE_FRAME_TIME_SAMPLES_COUNT];
+#endif
 static uint64_t video_driver_frame_time_count            = 0;
 static uint64_t video_driver_frame_count                 = 0;
 
@@ -814,6 +818,23 @@ static void video_driver_monitor_compute_fps_statistics(void)
             " deviation, based on %u last samples).\n",
             avg_fps, 100.0 * stddev, samples);
    }
+
+#ifdef HAVE_THREADS
+   if (video_driver_is_threaded_internal())
+   {
+      video_thread_stats_t stats;
+
+      if (video_thread_get_stats(&stats))
+         RARCH_LOG("[Video]: Threaded frame pacing: %u dropped, %u duplicated"
+               " out of %u frames. Queue latency: %u usec average,"
+               " %u usec max.\n",
+               (unsigned)stats.frames_dropped,
+               (unsigned)stats.frames_duplicated,
+               (unsigned)stats.frames_pushed,
+               (unsigned)stats.latency_avg,
+               (unsigned)stats.latency_max);
+   }
+#endif
 }
 
 static void video_driver_pixel_converter_free(void)
@@ -1299,11 +1320,13 @@ void video_monitor_set_refresh_rate(float hz)
  * Gets the monitor FPS statistics based on the current
  * runtime.
  *
+ * With threaded video, the intervals between frames presented
+ * by the video thread are measured instead.
+ *
  * Returns: true (1) on success.
  * false (0) if:
- * a) threaded video mode is enabled
- * b) less than 2 frame time samples.
- * c) FPS monitor enable is off.
+ * a) less than 2 frame time samples.
+ * b) FPS monitor enable is off.
  **/
 bool video_monitor_fps_statistics(double *refresh_rate,
       double *deviation, unsigned *sample_points)
@@ -1313,14 +1336,20 @@ bool video_monitor_fps_statistics(double *refresh_rate,
    retro_time_t avg       = 0;
    retro_time_t accum_var = 0;
    unsigned samples       = 0;
+   const retro_time_t *frame_time_samples = video_driver_frame_time_samples;
 
 #ifdef HAVE_THREADS
    if (video_driver_is_threaded_internal())
-      return false;
+   {
+      samples            = video_thread_get_frame_time_samples(
+            video_driver_thread_frame_time_samples,
+            MEASURE_FRAME_TIME_SAMPLES_COUNT);
+      frame_time_samples = video_driver_thread_frame_time_samples;
+   }
+   else
 #endif
-
-   samples = MIN(MEASURE_FRAME_TIME_SAMPLES_COUNT,
-         (unsigned)video_driver_frame_time_count);
+      samples = MIN(MEASURE_FRAME_TIME_SAMPLES_COUNT,
+            (unsigned)video_driver_frame_time_count);
 
    if (samples < 2)
       return false;
@@ -1328,7 +1357,7 @@ bool video_monitor_fps_statistics(double *refresh_rate,
    /* Measure statistics on frame time (microsecs), *not* FPS. */
    for (i = 0; i < samples; i++)
    {
-      accum += video_driver_frame_time_samples[i];
+      accum += frame_time_samples[i];
 #if 0
       RARCH_LOG("[Video]: Interval #%u: %d usec / frame.\n",
             i, (int)frame_time_samples[i]);
@@ -1340,7 +1369,7 @@ bool video_monitor_fps_statistics(double *refresh_rate,
    /* Drop first measurement. It is likely to be bad. */
    for (i = 0; i < samples; i++)
    {
-      retro_time_t diff = video_driver_frame_time_samples[i] - avg;
+      retro_time_t diff = frame_time_samples[i] - avg;
       accum_var         += diff * diff;
    }
 
@@ -2381,6 +2410,8 @@ void video_driver_frame(const void *data, unsigned width,
    if (!video_driver_active)
       return;
 
+   PERF_TRACE_BEGIN("video_driver_frame");
+
    if (video_driver_scaler_ptr && data &&
          (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_0RGB1555) &&
          (data != RETRO_HW_FRAME_BUFFER_VALID))
@@ -2412,6 +2443,7 @@ void video_driver_frame(const void *data, unsigned width,
          (MEASURE_FRAME_TIME_SAMPLES_COUNT - 1);
       frame_time                                   = new_time - fps_time;
       video_driver_frame_time_samples[write_index] = frame_time;
+      perf_metrics_record(PERF_METRIC_FRAME_TIME, (uint32_t)frame_time);
       fps_time                                     = new_time;
 
       if (video_driver_frame_count == 1)
@@ -2595,6 +2627,8 @@ void video_driver_frame(const void *data, unsigned width,
          video_driver_frame_count,
          (unsigned)pitch, video_driver_msg, &video_info);
 
+   perf_metrics_frame_submitted();
+
    video_driver_frame_count++;
 
    /* Display the FPS, with a higher priority. */
@@ -2627,6 +2661,8 @@ void video_driver_frame(const void *data, unsigned width,
       video_driver_crt_switching_active = false;
 
    /* trigger set resolution*/
+
+   PERF_TRACE_END("video_driver_frame");
 }
 
 void crt_switch_driver_reinit(void)
@@ -2905,6 +2941,11 @@ void video_driver_get_status(uint64_t *frame_count, bool * is_alive,
    *is_focused  = video_driver_cb_has_focus();
 }
 
+uint64_t video_driver_get_frame_count(void)
+{
+   return video_driver_frame_count;
+}
+
 /**
  * find_video_context_driver_driver_index:
  * @ident                      : Identifier of resampler driver to find.
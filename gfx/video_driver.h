@@ -1024,11 +1024,13 @@ void video_monitor_set_refresh_rate(float hz);
  * Gets the monitor FPS statistics based on the current
  * runtime.
  *
+ * With threaded video, the intervals between frames presented
+ * by the video thread are measured instead.
+ *
  * Returns: true (1) on success.
  * false (0) if:
- * a) threaded video mode is enabled
- * b) less than 2 frame time samples.
- * c) FPS monitor enable is off.
+ * a) less than 2 frame time samples.
+ * b) FPS monitor enable is off.
  **/
 bool video_monitor_fps_statistics(double *refresh_rate,
       double *deviation, unsigned *sample_points);
@@ -1110,6 +1112,8 @@ void video_driver_set_threaded(bool val);
 void video_driver_get_status(uint64_t *frame_count, bool * is_alive,
       bool *is_focused);
 
+uint64_t video_driver_get_frame_count(void);
+
 /**
  * video_context_driver_init_first:
  * @data                    : Input data.
@@ -15,6 +15,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <file/file_path.h>
 #include <file/config_file_userdata.h>
@@ -43,44 +44,164 @@ struct rarch_soft_plug
    const struct softfilter_implementation *impl;
 };
 
+/* Filters are asked for this many row tiles per worker thread,
+ * so that a slow band of the image does not hold up the frame. */
+#define SOFTFILTER_TILES_PER_THREAD 4
+
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
 
-struct filter_thread_data
+/* One set of worker threads is shared by every softfilter instance.
+ * Each frame, the workers and the calling thread pull work packets
+ * from a shared counter until none are left. */
+struct softfilter_pool
 {
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
+   sthread_t **threads;
+   unsigned num_threads;
+   unsigned refcount;
+
    slock_t *lock;
+   scond_t *work_cond;
+   scond_t *done_cond;
+
    void *userdata;
+   const struct softfilter_work_packet *packets;
+   unsigned num_packets;
+   unsigned next_packet;
+   unsigned pending;
+   unsigned generation;
    bool die;
-   bool done;
 };
 
-static void filter_thread_loop(void *data)
+static struct softfilter_pool softfilter_pool;
+
+/* Must be called with the pool lock held. Returns with it held. */
+static void softfilter_pool_run_packets(struct softfilter_pool *pool)
 {
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
+   while (pool->next_packet < pool->num_packets)
+   {
+      const struct softfilter_work_packet *packet =
+         &pool->packets[pool->next_packet++];
+
+      slock_unlock(pool->lock);
+      if (packet->work)
+         packet->work(pool->userdata, packet->thread_data);
+      slock_lock(pool->lock);
+
+      if (--pool->pending == 0)
+         scond_signal(pool->done_cond);
+   }
+}
+
+static void softfilter_pool_loop(void *data)
+{
+   struct softfilter_pool *pool = (struct softfilter_pool*)data;
+   unsigned generation          = 0;
+
+   slock_lock(pool->lock);
 
    for (;;)
    {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
+      while (!pool->die && pool->generation == generation)
+         scond_wait(pool->work_cond, pool->lock);
+
+      if (pool->die)
          break;
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
+      generation = pool->generation;
+      softfilter_pool_run_packets(pool);
+   }
+
+   slock_unlock(pool->lock);
+}
+
+static void softfilter_pool_release(void)
+{
+   unsigned i;
+   struct softfilter_pool *pool = &softfilter_pool;
 
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
+   if (!pool->refcount || --pool->refcount)
+      return;
+
+   if (pool->threads)
+   {
+      slock_lock(pool->lock);
+      pool->die = true;
+      scond_broadcast(pool->work_cond);
+      slock_unlock(pool->lock);
+
+      for (i = 0; i < pool->num_threads; i++)
+      {
+         if (pool->threads[i])
+            sthread_join(pool->threads[i]);
+      }
+      free(pool->threads);
    }
+
+   if (pool->lock)
+      slock_free(pool->lock);
+   if (pool->work_cond)
+      scond_free(pool->work_cond);
+   if (pool->done_cond)
+      scond_free(pool->done_cond);
+
+   memset(pool, 0, sizeof(*pool));
+}
+
+/* The pool is sized by the first filter that needs it
+ * and lives until the last filter using it is freed. */
+static bool softfilter_pool_acquire(unsigned num_threads)
+{
+   unsigned i;
+   struct softfilter_pool *pool = &softfilter_pool;
+
+   if (pool->refcount++)
+      return true;
+
+   pool->lock      = slock_new();
+   pool->work_cond = scond_new();
+   pool->done_cond = scond_new();
+   pool->threads   = (sthread_t**)calloc(num_threads, sizeof(*pool->threads));
+
+   if (!pool->lock || !pool->work_cond || !pool->done_cond || !pool->threads)
+      goto error;
+
+   for (i = 0; i < num_threads; i++)
+   {
+      pool->threads[i] = sthread_create(softfilter_pool_loop, pool);
+      if (!pool->threads[i])
+         goto error;
+      pool->num_threads++;
+   }
+
+   return true;
+
+error:
+   softfilter_pool_release();
+   return false;
+}
+
+static void softfilter_pool_run(void *userdata,
+      const struct softfilter_work_packet *packets, unsigned num_packets)
+{
+   struct softfilter_pool *pool = &softfilter_pool;
+
+   slock_lock(pool->lock);
+
+   pool->userdata    = userdata;
+   pool->packets     = packets;
+   pool->num_packets = num_packets;
+   pool->next_packet = 0;
+   pool->pending     = num_packets;
+   pool->generation++;
+   scond_broadcast(pool->work_cond);
+
+   softfilter_pool_run_packets(pool);
+
+   while (pool->pending)
+      scond_wait(pool->done_cond, pool->lock);
+
+   slock_unlock(pool->lock);
 }
 #endif
 
@@ -98,10 +219,10 @@ struct rarch_softfilter
    enum retro_pixel_format pix_fmt, out_pix_fmt;
 
    struct softfilter_work_packet *packets;
-   unsigned threads;
+   unsigned num_packets;
 
 #ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
+   bool pool_acquired;
 #endif
 };
 
@@ -134,12 +255,10 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       softfilter_simd_mask_t cpu_features,
       unsigned threads)
 {
-   unsigned input_fmts, input_fmt, output_fmts, i = 0;
+   unsigned input_fmts, input_fmt, output_fmts;
    struct config_file_userdata userdata;
    char key[64], name[64];
 
-   (void)i;
-
    key[0] = name[0] = '\0';
 
    snprintf(key, sizeof(key), "filter");
@@ -207,10 +326,16 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = cpu_features_get_core_amount();
+   if (!threads)
+      threads = 1;
+
+   /* Filters treat the thread count as the number of work packets
+    * they may split a frame into; the pool decides who runs them. */
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads :
-         cpu_features_get_core_amount(), cpu_features,
+         threads * SOFTFILTER_TILES_PER_THREAD, cpu_features,
          &userdata);
    if (!filt->impl_data)
    {
@@ -218,18 +343,18 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       return false;
    }
 
-   threads = filt->impl->query_num_threads(filt->impl_data);
-   if (!threads)
+   filt->num_packets = filt->impl->query_num_threads(filt->impl_data);
+   if (!filt->num_packets)
    {
       RARCH_ERR("Invalid number of threads.\n");
       return false;
    }
 
-   filt->threads = threads;
-   RARCH_LOG("Using %u threads for softfilter.\n", threads);
+   RARCH_LOG("Using %u threads and %u work packets for softfilter.\n",
+         filt->num_packets > 1 ? threads : 1, filt->num_packets);
 
    filt->packets = (struct softfilter_work_packet*)
-      calloc(threads, sizeof(*filt->packets));
+      calloc(filt->num_packets, sizeof(*filt->packets));
    if (!filt->packets)
    {
       RARCH_ERR("Failed to allocate softfilter packets.\n");
@@ -237,26 +362,12 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    }
 
 #ifdef HAVE_THREADS
-   filt->thread_data = (struct filter_thread_data*)
-      calloc(threads, sizeof(*filt->thread_data));
-   if (!filt->thread_data)
-      return false;
-
-   for (i = 0; i < threads; i++)
+   /* The calling thread works through packets too. */
+   if (filt->num_packets > 1 && threads > 1)
    {
-      filt->thread_data[i].userdata = filt->impl_data;
-      filt->thread_data[i].done = true;
-
-      filt->thread_data[i].lock = slock_new();
-      if (!filt->thread_data[i].lock)
-         return false;
-      filt->thread_data[i].cond = scond_new();
-      if (!filt->thread_data[i].cond)
-         return false;
-      filt->thread_data[i].thread = sthread_create(
-            filter_thread_loop, &filt->thread_data[i]);
-      if (!filt->thread_data[i].thread)
+      if (!softfilter_pool_acquire(threads - 1))
          return false;
+      filt->pool_acquired = true;
    }
 #endif
 
@@ -474,19 +585,8 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
 #endif
 
 #ifdef HAVE_THREADS
-   for (i = 0; i < filt->threads; i++)
-   {
-      if (!filt->thread_data[i].thread)
-         continue;
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].die = true;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
-      sthread_join(filt->thread_data[i].thread);
-      slock_free(filt->thread_data[i].lock);
-      scond_free(filt->thread_data[i].cond);
-   }
-   free(filt->thread_data);
+   if (filt->pool_acquired)
+      softfilter_pool_release();
 #endif
    free(filt);
 }
@@ -528,32 +628,13 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
             output, output_stride, input, width, height, input_stride);
 
 #ifdef HAVE_THREADS
-   /* Fire off workers */
-   for (i = 0; i < filt->threads; i++)
+   if (filt->pool_acquired)
    {
-#if 0
-      RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-      filt->thread_data[i].packet = &filt->packets[i];
-      slock_lock(filt->thread_data[i].lock);
-      filt->thread_data[i].done = false;
-      scond_signal(filt->thread_data[i].cond);
-      slock_unlock(filt->thread_data[i].lock);
+      softfilter_pool_run(filt->impl_data, filt->packets, filt->num_packets);
+      return;
    }
-
-   /* Wait for workers */
-   for (i = 0; i < filt->threads; i++)
-   {
-#if 0
-      RARCH_LOG("Waiting for filter thread %u ...\n", i);
 #endif
-      slock_lock(filt->thread_data[i].lock);
-      while (!filt->thread_data[i].done)
-         scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-      slock_unlock(filt->thread_data[i].lock);
-   }
-#else
-   for (i = 0; i < filt->threads; i++)
+
+   for (i = 0; i < filt->num_packets; i++)
       filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
-#endif
 }
@@ -38,6 +38,13 @@
 #include <string.h>
 #include <math.h>
 
+/* The AVX2 kernel is compiled per function and only used
+ * when the frontend reports AVX2 in the SIMD mask. */
+#if !defined(MSB_FIRST) && defined(__SSE2__) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define TWOXBR_AVX2
+#include <immintrin.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation twoxbr_get_implementation
 #define softfilter_thread_data twoxbr_softfilter_thread_data
@@ -64,6 +71,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   int avx2;
    uint16_t RGBtoYUV[65536];
    uint16_t tbl_5_to_8[32];
    uint16_t tbl_6_to_8[64];
@@ -225,15 +233,15 @@ static void *twoxbr_generic_create(const struct softfilter_config *config,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
    if (!filt)
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+   filt->avx2    = (simd & SOFTFILTER_SIMD_AVX2) != 0;
    if (!filt->workers)
    {
       free(filt);
@@ -534,11 +542,348 @@ int eq8(uint32_t A, uint32_t B,
          out += 2
 #endif
 
+#ifdef TWOXBR_AVX2
+/* Branch-free form of FILTRO_RGB8888 for a vector of 8 pixels.
+ * The blends use the same wrapping 32-bit arithmetic as the C
+ * macros and df8/eq8 give the same truncated y, u and v, so the
+ * output is bit-identical to the C version. */
+__attribute__((target("avx2")))
+static __m128i twoxbr_avx2_trunc(__m256d x)
+{
+   return _mm256_cvttpd_epi32(_mm256_andnot_pd(_mm256_set1_pd(-0.0), x));
+}
+
+/* y, u and v exactly as df8 computes them: in double precision,
+ * in the same operation order, truncated with cvttpd. */
+__attribute__((target("avx2")))
+static void twoxbr_avx2_yuv_double(__m256i r, __m256i g, __m256i b,
+      __m256i *yv, __m256i *uv, __m256i *vv)
+{
+   unsigned h;
+   __m128i y[2], u[2], v[2];
+
+   for (h = 0; h < 2; h++)
+   {
+      const __m256d rd = _mm256_cvtepi32_pd(h
+            ? _mm256_extracti128_si256(r, 1) : _mm256_castsi256_si128(r));
+      const __m256d gd = _mm256_cvtepi32_pd(h
+            ? _mm256_extracti128_si256(g, 1) : _mm256_castsi256_si128(g));
+      const __m256d bd = _mm256_cvtepi32_pd(h
+            ? _mm256_extracti128_si256(b, 1) : _mm256_castsi256_si128(b));
+
+      y[h] = twoxbr_avx2_trunc(_mm256_add_pd(_mm256_add_pd(
+                  _mm256_mul_pd(_mm256_set1_pd(0.299), rd),
+                  _mm256_mul_pd(_mm256_set1_pd(0.587), gd)),
+               _mm256_mul_pd(_mm256_set1_pd(0.114), bd)));
+      u[h] = twoxbr_avx2_trunc(_mm256_add_pd(_mm256_sub_pd(
+                  _mm256_mul_pd(_mm256_set1_pd(-0.169), rd),
+                  _mm256_mul_pd(_mm256_set1_pd(0.331), gd)),
+               _mm256_mul_pd(_mm256_set1_pd(0.500), bd)));
+      v[h] = twoxbr_avx2_trunc(_mm256_sub_pd(_mm256_sub_pd(
+                  _mm256_mul_pd(_mm256_set1_pd(0.500), rd),
+                  _mm256_mul_pd(_mm256_set1_pd(0.419), gd)),
+               _mm256_mul_pd(_mm256_set1_pd(0.081), bd)));
+   }
+
+   *yv = _mm256_inserti128_si256(_mm256_castsi128_si256(y[0]), y[1], 1);
+   *uv = _mm256_inserti128_si256(_mm256_castsi128_si256(u[0]), u[1], 1);
+   *vv = _mm256_inserti128_si256(_mm256_castsi128_si256(v[0]), v[1], 1);
+}
+
+/* |x| / 1000 for |x| < 2^24; also flags nonzero exact multiples. */
+__attribute__((target("avx2")))
+static __m256i twoxbr_avx2_div1000(__m256i x, __m256i *tie)
+{
+   const __m256i ax = _mm256_abs_epi32(x);
+   const __m256i q  = _mm256_cvttps_epi32(_mm256_div_ps(
+            _mm256_cvtepi32_ps(ax), _mm256_set1_ps(1000.0f)));
+   *tie = _mm256_or_si256(*tie, _mm256_andnot_si256(
+            _mm256_cmpeq_epi32(ax, _mm256_setzero_si256()),
+            _mm256_cmpeq_epi32(ax,
+               _mm256_mullo_epi32(q, _mm256_set1_epi32(1000)))));
+   return q;
+}
+
+/* Returns df8(A, B) per lane and, if ne is set, stores !eq8(A, B).
+ *
+ * y, u and v are weighted sums of the channel differences with
+ * weights in thousandths, so they are computed exactly in integers.
+ * The doubles in df8 only differ from that when the exact sum is
+ * a nonzero whole number, where rounding can land just below it;
+ * those vectors are redone in double precision. */
+__attribute__((target("avx2")))
+static __m256i twoxbr_avx2_df(__m256i A, __m256i B, __m256i *ne)
+{
+   __m256i y, u, v;
+   __m256i tie      = _mm256_setzero_si256();
+   const __m256i ff = _mm256_set1_epi32(0xFF);
+   const __m256i r  = _mm256_abs_epi32(_mm256_sub_epi32(
+            _mm256_and_si256(A, ff), _mm256_and_si256(B, ff)));
+   const __m256i g  = _mm256_abs_epi32(_mm256_sub_epi32(
+            _mm256_and_si256(_mm256_srli_epi32(A, 8), ff),
+            _mm256_and_si256(_mm256_srli_epi32(B, 8), ff)));
+   const __m256i b  = _mm256_abs_epi32(_mm256_sub_epi32(
+            _mm256_and_si256(_mm256_srli_epi32(A, 16), ff),
+            _mm256_and_si256(_mm256_srli_epi32(B, 16), ff)));
+
+   y = twoxbr_avx2_div1000(_mm256_add_epi32(_mm256_add_epi32(
+               _mm256_mullo_epi32(r, _mm256_set1_epi32(299)),
+               _mm256_mullo_epi32(g, _mm256_set1_epi32(587))),
+            _mm256_mullo_epi32(b, _mm256_set1_epi32(114))), &tie);
+   u = twoxbr_avx2_div1000(_mm256_sub_epi32(
+            _mm256_mullo_epi32(b, _mm256_set1_epi32(500)),
+            _mm256_add_epi32(
+               _mm256_mullo_epi32(r, _mm256_set1_epi32(169)),
+               _mm256_mullo_epi32(g, _mm256_set1_epi32(331)))), &tie);
+   v = twoxbr_avx2_div1000(_mm256_sub_epi32(
+            _mm256_mullo_epi32(r, _mm256_set1_epi32(500)),
+            _mm256_add_epi32(
+               _mm256_mullo_epi32(g, _mm256_set1_epi32(419)),
+               _mm256_mullo_epi32(b, _mm256_set1_epi32(81)))), &tie);
+
+   if (!_mm256_testz_si256(tie, tie))
+      twoxbr_avx2_yuv_double(r, g, b, &y, &u, &v);
+
+   if (ne)
+      *ne = _mm256_or_si256(_mm256_or_si256(
+               _mm256_cmpgt_epi32(y, _mm256_set1_epi32(48)),
+               _mm256_cmpgt_epi32(u, _mm256_set1_epi32(7))),
+            _mm256_cmpgt_epi32(v, _mm256_set1_epi32(6)));
+
+   return _mm256_add_epi32(_mm256_add_epi32(
+            _mm256_mullo_epi32(y, _mm256_set1_epi32(48)),
+            _mm256_mullo_epi32(u, _mm256_set1_epi32(7))),
+         _mm256_mullo_epi32(v, _mm256_set1_epi32(6)));
+}
+
+/* ALPHA_BLEND_8888_*_W; mul is 1 for the shift-only weights. */
+__attribute__((target("avx2")))
+static __m256i twoxbr_avx2_blend(__m256i dst, __m256i src,
+      int mul, int shift)
+{
+   unsigned c;
+   __m256i res       = _mm256_setzero_si256();
+   const __m128i cnt = _mm_cvtsi32_si128(shift);
+
+   for (c = 0; c < 3; c++)
+   {
+      const __m256i mask = _mm256_set1_epi32(0xFF << (8 * c));
+      const __m256i d    = _mm256_and_si256(dst, mask);
+      __m256i diff       = _mm256_sub_epi32(_mm256_and_si256(src, mask), d);
+      if (mul != 1)
+         diff = _mm256_mullo_epi32(diff, _mm256_set1_epi32(mul));
+      res  = _mm256_or_si256(res, _mm256_and_si256(mask,
+               _mm256_add_epi32(d, _mm256_srl_epi32(diff, cnt))));
+   }
+
+   return _mm256_add_epi32(res, _mm256_set1_epi32((int)ALPHA_MASK8888));
+}
+
+/* ALPHA_BLEND_128_W */
+__attribute__((target("avx2")))
+static __m256i twoxbr_avx2_blend128(__m256i dst, __m256i src)
+{
+   const __m256i lbmask = _mm256_set1_epi32((int)PG_LBMASK8888);
+   return _mm256_add_epi32(
+         _mm256_srli_epi32(_mm256_and_si256(src, lbmask), 1),
+         _mm256_srli_epi32(_mm256_and_si256(dst, lbmask), 1));
+}
+
+__attribute__((target("avx2")))
+static void twoxbr_avx2_filtro(__m256i *E, int N1, int N2, int N3,
+      __m256i PE, __m256i _PI, __m256i PH, __m256i PF,
+      __m256i PG, __m256i PC, __m256i PD, __m256i PB,
+      __m256i F4, __m256i I4, __m256i H5, __m256i I5)
+{
+   __m256i e, i, cond, blend, px, ke, ki, cl, cu, clu;
+   __m256i lu, left, up, dia, b64;
+   __m256i ne_fb, ne_fc, ne_hd, ne_hg, ne_ei;
+   __m256i ne_ff4, ne_fi4, ne_hh5, ne_hi5, ne_eg, ne_ec;
+   const __m256i ones = _mm256_set1_epi32(-1);
+   const __m256i ex   = _mm256_xor_si256(_mm256_or_si256(
+            _mm256_cmpeq_epi32(PE, PH), _mm256_cmpeq_epi32(PE, PF)), ones);
+
+   /* Flat areas skip the whole pass, as in the C version. */
+   if (_mm256_testz_si256(ex, ex))
+      return;
+
+   e = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(
+                  twoxbr_avx2_df(PE, PC, &ne_ec),
+                  twoxbr_avx2_df(PE, PG, &ne_eg)),
+               twoxbr_avx2_df(_PI, H5, NULL)),
+            twoxbr_avx2_df(_PI, F4, NULL)),
+         _mm256_slli_epi32(twoxbr_avx2_df(PH, PF, NULL), 2));
+   i = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(
+                  twoxbr_avx2_df(PH, PD, &ne_hd),
+                  twoxbr_avx2_df(PH, I5, &ne_hi5)),
+               twoxbr_avx2_df(PF, I4, &ne_fi4)),
+            twoxbr_avx2_df(PF, PB, &ne_fb)),
+         _mm256_slli_epi32(twoxbr_avx2_df(PE, _PI, &ne_ei), 2));
+   twoxbr_avx2_df(PF, PC, &ne_fc);
+   twoxbr_avx2_df(PH, PG, &ne_hg);
+   twoxbr_avx2_df(PF, F4, &ne_ff4);
+   twoxbr_avx2_df(PH, H5, &ne_hh5);
+
+   cond = _mm256_or_si256(_mm256_or_si256(
+            _mm256_and_si256(ne_fb, ne_fc),
+            _mm256_and_si256(ne_hd, ne_hg)),
+         _mm256_andnot_si256(ne_ei, _mm256_or_si256(
+               _mm256_and_si256(ne_ff4, ne_fi4),
+               _mm256_and_si256(ne_hh5, ne_hi5))));
+   cond = _mm256_or_si256(cond, _mm256_xor_si256(
+            _mm256_and_si256(ne_eg, ne_ec), ones));
+   cond = _mm256_and_si256(_mm256_and_si256(cond, ex),
+         _mm256_cmpgt_epi32(i, e));
+   /* The 'else if (e <= i)' case. */
+   blend = _mm256_andnot_si256(cond,
+         _mm256_andnot_si256(_mm256_cmpgt_epi32(e, i), ex));
+
+   if (_mm256_testz_si256(_mm256_or_si256(cond, blend), ones))
+      return;
+
+   px  = _mm256_blendv_epi8(PH, PF, _mm256_xor_si256(_mm256_cmpgt_epi32(
+               twoxbr_avx2_df(PE, PF, NULL), twoxbr_avx2_df(PE, PH, NULL)), ones));
+   ke = twoxbr_avx2_df(PF, PG, NULL);
+   ki = twoxbr_avx2_df(PH, PC, NULL);
+
+   /* cl: ((ke<<1) <= ki) && ex3, cu: (ke >= (ki<<1)) && ex2 */
+   cl  = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_slli_epi32(ke, 1), ki),
+         _mm256_xor_si256(_mm256_or_si256(
+               _mm256_cmpeq_epi32(PE, PG), _mm256_cmpeq_epi32(PD, PG)), ones));
+   cu  = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_slli_epi32(ki, 1), ke),
+         _mm256_xor_si256(_mm256_or_si256(
+               _mm256_cmpeq_epi32(PE, PC), _mm256_cmpeq_epi32(PB, PC)), ones));
+   clu = _mm256_and_si256(cl, cu);
+
+   lu   = _mm256_and_si256(cond, clu);
+   left = _mm256_andnot_si256(clu, _mm256_and_si256(cond, cl));
+   up   = _mm256_andnot_si256(cl, _mm256_and_si256(cond, cu));
+   dia  = _mm256_or_si256(blend,
+         _mm256_andnot_si256(_mm256_or_si256(cl, cu), cond));
+
+   b64   = twoxbr_avx2_blend(E[N2], px, 1, 2);
+   E[N1] = _mm256_blendv_epi8(E[N1], twoxbr_avx2_blend(E[N1], px, 1, 2), up);
+   E[N1] = _mm256_blendv_epi8(E[N1], b64, lu);
+   E[N2] = _mm256_blendv_epi8(E[N2], b64, _mm256_or_si256(lu, left));
+   E[N3] = _mm256_blendv_epi8(
+         _mm256_blendv_epi8(
+            _mm256_blendv_epi8(E[N3], twoxbr_avx2_blend128(E[N3], px), dia),
+            twoxbr_avx2_blend(E[N3], px, 192, 8), _mm256_or_si256(left, up)),
+         twoxbr_avx2_blend(E[N3], px, 224, 8), lu);
+}
+
+#define FILTRO_RGB8888_AVX2(Z, PE, _PI, PH, PF, PG, PC, PD, PB, PA, G5, C4, G0, D0, C1, B1, F4, I4, H5, I5, A0, A1, N0, N1, N2, N3, pg_red_mask, pg_green_mask, pg_blue_mask) \
+     twoxbr_avx2_filtro(E, N1, N2, N3, PE, _PI, PH, PF, PG, PC, PD, PB, F4, I4, H5, I5)
+
+#define twoxbr_avx2_load(ptr) _mm256_loadu_si256((const __m256i*)(ptr))
+
+#define twoxbr_avx2_store(ptr, A, B) \
+   lo = _mm256_unpacklo_epi32(A, B); \
+   hi = _mm256_unpackhi_epi32(A, B); \
+   _mm256_storeu_si256((__m256i*)(ptr), _mm256_permute2x128_si256(lo, hi, 0x20)); \
+   _mm256_storeu_si256((__m256i*)(ptr) + 1, _mm256_permute2x128_si256(lo, hi, 0x31))
+
+/* A pass costs the vector kernel about as much as a few pixels
+ * cost the C path, which skips pixels without an edge. Only take
+ * blocks whose passes have at least this many edge pixels on
+ * average. */
+#ifndef TWOXBR_AVX2_MIN_LANES
+#define TWOXBR_AVX2_MIN_LANES 3
+#endif
+
+/* Checking a block that then goes to C is pure overhead, which
+ * made sparse-edge pixel art slower with the kernel than without.
+ * Rows are alike from one to the next, so a row where less than
+ * 1/TWOXBR_AVX2_MIN_SHARE of the pixels went through the kernel
+ * sends the next TWOXBR_AVX2_SKIP_ROWS rows straight to C. */
+#ifndef TWOXBR_AVX2_MIN_SHARE
+#define TWOXBR_AVX2_MIN_SHARE 2
+#endif
+#ifndef TWOXBR_AVX2_SKIP_ROWS
+#define TWOXBR_AVX2_SKIP_ROWS 8
+#endif
+
+__attribute__((target("avx2")))
+static int twoxbr_avx2_worth(__m256i PE, __m256i PB,
+      __m256i PD, __m256i PF, __m256i PH)
+{
+   const __m256i eb = _mm256_cmpeq_epi32(PE, PB);
+   const __m256i ed = _mm256_cmpeq_epi32(PE, PD);
+   const __m256i ef = _mm256_cmpeq_epi32(PE, PF);
+   const __m256i eh = _mm256_cmpeq_epi32(PE, PH);
+   /* The 'ex' test of each of the four passes; bits set when equal. */
+   const int m0     = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(eh, ef)));
+   const int m1     = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(ef, eb)));
+   const int m2     = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(eb, ed)));
+   const int m3     = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(ed, eh)));
+   const int passes = (m0 != 0xFF) + (m1 != 0xFF) + (m2 != 0xFF) + (m3 != 0xFF);
+   const int lanes  = 32 - __builtin_popcount(m0) - __builtin_popcount(m1)
+      - __builtin_popcount(m2) - __builtin_popcount(m3);
+
+   return passes && lanes >= passes * TWOXBR_AVX2_MIN_LANES;
+}
+
+/* Returns the number of pixels done. It stops early at a block
+ * the C path does faster; the caller runs a block of that and
+ * calls it again. */
+__attribute__((target("avx2")))
+static unsigned twoxbr_row_xrgb8888_avx2(const uint32_t *in, uint32_t *out,
+      unsigned prevline, unsigned prevline2,
+      unsigned nextline, unsigned nextline2,
+      unsigned dst_stride, unsigned width)
+{
+   unsigned x;
+
+   for (x = 0; x + 8 <= width; x += 8, in += 8, out += 16)
+   {
+      __m256i E[4], lo, hi;
+      const __m256i A1  = twoxbr_avx2_load(in - prevline2 - 1);
+      const __m256i B1  = twoxbr_avx2_load(in - prevline2);
+      const __m256i C1  = twoxbr_avx2_load(in - prevline2 + 1);
+      const __m256i A0  = twoxbr_avx2_load(in - prevline - 2);
+      const __m256i PA  = twoxbr_avx2_load(in - prevline - 1);
+      const __m256i PB  = twoxbr_avx2_load(in - prevline);
+      const __m256i PC  = twoxbr_avx2_load(in - prevline + 1);
+      const __m256i C4  = twoxbr_avx2_load(in - prevline + 2);
+      const __m256i D0  = twoxbr_avx2_load(in - 2);
+      const __m256i PD  = twoxbr_avx2_load(in - 1);
+      const __m256i PE  = twoxbr_avx2_load(in);
+      const __m256i PF  = twoxbr_avx2_load(in + 1);
+      const __m256i F4  = twoxbr_avx2_load(in + 2);
+      const __m256i G0  = twoxbr_avx2_load(in + nextline - 2);
+      const __m256i PG  = twoxbr_avx2_load(in + nextline - 1);
+      const __m256i PH  = twoxbr_avx2_load(in + nextline);
+      const __m256i _PI = twoxbr_avx2_load(in + nextline + 1);
+      const __m256i I4  = twoxbr_avx2_load(in + nextline + 2);
+      const __m256i G5  = twoxbr_avx2_load(in + nextline2 - 1);
+      const __m256i H5  = twoxbr_avx2_load(in + nextline2);
+      const __m256i I5  = twoxbr_avx2_load(in + nextline2 + 1);
+
+      if (!twoxbr_avx2_worth(PE, PB, PD, PF, PH))
+         break;
+
+      E[0] = E[1] = E[2] = E[3] = PE;
+      FILTRO_RGB8888_AVX2(Z, PE, _PI, PH, PF, PG, PC, PD, PB, PA, G5, C4, G0, D0, C1, B1, F4, I4, H5, I5, A0, A1, 0, 1, 2, 3, pg_red_mask, pg_green_mask, pg_blue_mask);
+      FILTRO_RGB8888_AVX2(Z, PE, PC, PF, PB, _PI, PA, PH, PD, PG, I4, A1, I5, H5, A0, D0, B1, C1, F4, C4, G5, G0, 2, 0, 3, 1, pg_red_mask, pg_green_mask, pg_blue_mask);
+      FILTRO_RGB8888_AVX2(Z, PE, PA, PB, PD, PC, PG, PF, PH, _PI, C1, G0, C4, F4, G5, H5, D0, A0, B1, A1, I4, I5, 3, 2, 1, 0, pg_red_mask, pg_green_mask, pg_blue_mask);
+      FILTRO_RGB8888_AVX2(Z, PE, PG, PD, PH, PA, _PI, PB, PF, PC, A0, I5, A1, B1, I4, F4, H5, G5, D0, G0, C1, C4, 1, 3, 0, 2, pg_red_mask, pg_green_mask, pg_blue_mask);
+
+      twoxbr_avx2_store(out, E[0], E[1]);
+      twoxbr_avx2_store(out + dst_stride, E[2], E[3]);
+   }
+
+   return x;
+}
+#endif
+
 static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
       int first, int last, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned nextline, finish;
+   unsigned finish;
+#ifdef TWOXBR_AVX2
+   unsigned skip_rows        = 0;
+#endif
    uint32_t pg_red_mask      = RED_MASK8888;
    uint32_t pg_green_mask    = GREEN_MASK8888;
    uint32_t pg_blue_mask     = BLUE_MASK8888;
@@ -546,54 +891,87 @@ static void twoxbr_generic_xrgb8888(void *data, unsigned width, unsigned height,
    uint32_t pg_alpha_mask    = ALPHA_MASK8888;
    struct filter_data *filt = (struct filter_data*)data;
 
-   (void)filt;
-
-   nextline = (last) ? 0 : src_stride;
-
    for (; height; height--)
    {
+      /* Clamp the taps to the frame. first and last count
+       * the frame rows above and below this packet. */
+      unsigned below     = height - 1 + last;
+      unsigned prevline  = first     ? src_stride     : 0;
+      unsigned prevline2 = first > 1 ? 2 * src_stride : prevline;
+      unsigned nextline  = below     ? src_stride     : 0;
+      unsigned nextline2 = below > 1 ? 2 * src_stride : nextline;
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
+#ifdef TWOXBR_AVX2
+      unsigned vector = 0;
+      int use_avx2    = filt->avx2 && !skip_rows;
 
-      for (finish = width; finish; finish -= 1)
-      {
-         uint32_t E[4];
-         uint32_t ex, e, i, ke, ki, ex2, ex3, px;
-         uint32_t A1 = *(in - nextline - nextline - 1);
-         uint32_t B1 = *(in - nextline - nextline);
-         uint32_t C1 = *(in - nextline - nextline + 1);
-         uint32_t A0 = *(in - nextline - 2);
-         uint32_t PA = *(in - nextline - 1);
-         uint32_t PB = *(in - nextline);
-         uint32_t PC = *(in - nextline + 1);
-         uint32_t C4 = *(in - nextline + 2);
-         uint32_t D0 = *(in - 2);
-         uint32_t PD = *(in - 1);
-         uint32_t PE = *(in);
-         uint32_t PF = *(in + 1);
-         uint32_t F4 = *(in + 2);
-         uint32_t G0 = *(in + nextline - 2);
-         uint32_t PG = *(in + nextline - 1);
-         uint32_t PH = *(in + nextline);
-         uint32_t _PI = *(in + nextline + 1);
-         uint32_t I4 = *(in + nextline + 2);
-         uint32_t G5 = *(in + nextline + nextline - 1);
-         uint32_t H5 = *(in + nextline + nextline);
-         uint32_t I5 = *(in + nextline + nextline + 1);
+      if (skip_rows)
+         skip_rows--;
+#endif
 
-         /*
-          * Map of the pixels:          A1 B1 C1
-          *                          A0 PA PB PC C4
-          *                          D0 PD PE PF F4
-          *                          G0 PG PH _PI I4
-          *                             G5 H5 I5
-          */
+      for (finish = width; finish; )
+      {
+         unsigned count = finish;
+#ifdef TWOXBR_AVX2
+         if (use_avx2)
+         {
+            unsigned done = twoxbr_row_xrgb8888_avx2(in, out,
+                  prevline, prevline2, nextline, nextline2, dst_stride, finish);
+            in     += done;
+            out    += 2 * done;
+            finish -= done;
+            vector += done;
+            count   = finish < 8 ? finish : 8;
+         }
+#endif
 
-         twoxbr_function(FILTRO_RGB8888, filt);
+         for (; count; count--, finish--)
+         {
+            uint32_t E[4];
+            uint32_t ex, e, i, ke, ki, ex2, ex3, px;
+            uint32_t A1 = *(in - prevline2 - 1);
+            uint32_t B1 = *(in - prevline2);
+            uint32_t C1 = *(in - prevline2 + 1);
+            uint32_t A0 = *(in - prevline - 2);
+            uint32_t PA = *(in - prevline - 1);
+            uint32_t PB = *(in - prevline);
+            uint32_t PC = *(in - prevline + 1);
+            uint32_t C4 = *(in - prevline + 2);
+            uint32_t D0 = *(in - 2);
+            uint32_t PD = *(in - 1);
+            uint32_t PE = *(in);
+            uint32_t PF = *(in + 1);
+            uint32_t F4 = *(in + 2);
+            uint32_t G0 = *(in + nextline - 2);
+            uint32_t PG = *(in + nextline - 1);
+            uint32_t PH = *(in + nextline);
+            uint32_t _PI = *(in + nextline + 1);
+            uint32_t I4 = *(in + nextline + 2);
+            uint32_t G5 = *(in + nextline2 - 1);
+            uint32_t H5 = *(in + nextline2);
+            uint32_t I5 = *(in + nextline2 + 1);
+
+            /*
+             * Map of the pixels:          A1 B1 C1
+             *                          A0 PA PB PC C4
+             *                          D0 PD PE PF F4
+             *                          G0 PG PH _PI I4
+             *                             G5 H5 I5
+             */
+
+            twoxbr_function(FILTRO_RGB8888, filt);
+         }
       }
 
+#ifdef TWOXBR_AVX2
+      if (use_avx2 && vector * TWOXBR_AVX2_MIN_SHARE < width)
+         skip_rows = TWOXBR_AVX2_SKIP_ROWS;
+#endif
+
       src += src_stride;
       dst += 2 * dst_stride;
+      first++;
    }
 }
 
@@ -607,10 +985,16 @@ static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
    uint16_t pg_green_mask   = GREEN_MASK565;
    uint16_t pg_blue_mask    = BLUE_MASK565;
    uint16_t pg_lbmask       = PG_LBMASK565;
-   unsigned nextline        = (last) ? 0 : src_stride;
 
    for (; height; height--)
    {
+      /* Clamp the taps to the frame. first and last count
+       * the frame rows above and below this packet. */
+      unsigned below     = height - 1 + last;
+      unsigned prevline  = first     ? src_stride     : 0;
+      unsigned prevline2 = first > 1 ? 2 * src_stride : prevline;
+      unsigned nextline  = below     ? src_stride     : 0;
+      unsigned nextline2 = below > 1 ? 2 * src_stride : nextline;
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
 
@@ -618,14 +1002,14 @@ static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
       {
          uint16_t E[4];
          uint16_t ex, e, i, ke, ki, ex2, ex3, px;
-         uint16_t A1 = *(in - nextline - nextline - 1);
-         uint16_t B1 = *(in - nextline - nextline);
-         uint16_t C1 = *(in - nextline - nextline + 1);
-         uint16_t A0 = *(in - nextline - 2);
-         uint16_t PA = *(in - nextline - 1);
-         uint16_t PB = *(in - nextline);
-         uint16_t PC = *(in - nextline + 1);
-         uint16_t C4 = *(in - nextline + 2);
+         uint16_t A1 = *(in - prevline2 - 1);
+         uint16_t B1 = *(in - prevline2);
+         uint16_t C1 = *(in - prevline2 + 1);
+         uint16_t A0 = *(in - prevline - 2);
+         uint16_t PA = *(in - prevline - 1);
+         uint16_t PB = *(in - prevline);
+         uint16_t PC = *(in - prevline + 1);
+         uint16_t C4 = *(in - prevline + 2);
          uint16_t D0 = *(in - 2);
          uint16_t PD = *(in - 1);
          uint16_t PE = *(in);
@@ -636,9 +1020,9 @@ static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
          uint16_t PH = *(in + nextline);
          uint16_t _PI = *(in + nextline + 1);
          uint16_t I4 = *(in + nextline + 2);
-         uint16_t G5 = *(in + nextline + nextline - 1);
-         uint16_t H5 = *(in + nextline + nextline);
-         uint16_t I5 = *(in + nextline + nextline + 1);
+         uint16_t G5 = *(in + nextline2 - 1);
+         uint16_t H5 = *(in + nextline2);
+         uint16_t I5 = *(in + nextline2 + 1);
 
          /*
           * Map of the pixels:          A1 B1 C1
@@ -653,6 +1037,7 @@ static void twoxbr_generic_rgb565(void *data, unsigned width, unsigned height,
 
       src += src_stride;
       dst += 2 * dst_stride;
+      first++;
    }
 }
 
@@ -716,7 +1101,7 @@ static void twoxbr_generic_packets(void *data,
       /* Workers need to know if they can access
        * pixels outside their given buffer. */
       thr->first = y_start;
-      thr->last = y_end == height;
+      thr->last = height - y_end;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = twoxbr_work_cb_rgb565;
@@ -76,7 +76,7 @@ static void *twoxsai_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -118,12 +118,12 @@ static void twoxsai_generic_destroy(void *data)
 
 #define twoxsai_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)));
 
-#define twoxsai_declare_variables(typename_t, in, nextline) \
+#define twoxsai_declare_variables(typename_t, in, prevline, nextline, nextline2) \
          typename_t product, product1, product2; \
-         typename_t colorI = *(in - nextline - 1); \
-         typename_t colorE = *(in - nextline + 0); \
-         typename_t colorF = *(in - nextline + 1); \
-         typename_t colorJ = *(in - nextline + 2); \
+         typename_t colorI = *(in - prevline - 1); \
+         typename_t colorE = *(in - prevline + 0); \
+         typename_t colorF = *(in - prevline + 1); \
+         typename_t colorJ = *(in - prevline + 2); \
          typename_t colorG = *(in - 1); \
          typename_t colorA = *(in + 0); \
          typename_t colorB = *(in + 1); \
@@ -132,9 +132,9 @@ static void twoxsai_generic_destroy(void *data)
          typename_t colorC = *(in + nextline + 0); \
          typename_t colorD = *(in + nextline + 1); \
          typename_t colorL = *(in + nextline + 2); \
-         typename_t colorM = *(in + nextline + nextline - 1); \
-         typename_t colorN = *(in + nextline + nextline + 0); \
-         typename_t colorO = *(in + nextline + nextline + 1);
+         typename_t colorM = *(in + nextline2 - 1); \
+         typename_t colorN = *(in + nextline2 + 0); \
+         typename_t colorO = *(in + nextline2 + 1);
 
 #ifndef twoxsai_function
 #define twoxsai_function(result_cb, interpolate_cb, interpolate2_cb) \
@@ -229,16 +229,21 @@ static void twoxsai_generic_xrgb8888(unsigned width, unsigned height,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
    for (; height; height--)
    {
+      /* Clamp the taps to the frame. first and last count
+       * the frame rows above and below this packet. */
+      unsigned below     = height - 1 + last;
+      unsigned prevline  = first     ? src_stride     : 0;
+      unsigned nextline  = below     ? src_stride     : 0;
+      unsigned nextline2 = below > 1 ? 2 * src_stride : nextline;
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
 
       for (finish = width; finish; finish -= 1)
       {
-         twoxsai_declare_variables(uint32_t, in, nextline);
+         twoxsai_declare_variables(uint32_t, in, prevline, nextline, nextline2);
 
          /*
           * Map of the pixels:           I|E F|J
@@ -253,6 +258,7 @@ static void twoxsai_generic_xrgb8888(unsigned width, unsigned height,
 
       src += src_stride;
       dst += 2 * dst_stride;
+      first++;
    }
 }
 
@@ -261,16 +267,21 @@ static void twoxsai_generic_rgb565(unsigned width, unsigned height,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
    for (; height; height--)
    {
+      /* Clamp the taps to the frame. first and last count
+       * the frame rows above and below this packet. */
+      unsigned below     = height - 1 + last;
+      unsigned prevline  = first     ? src_stride     : 0;
+      unsigned nextline  = below     ? src_stride     : 0;
+      unsigned nextline2 = below > 1 ? 2 * src_stride : nextline;
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
 
       for (finish = width; finish; finish -= 1)
       {
-         twoxsai_declare_variables(uint16_t, in, nextline);
+         twoxsai_declare_variables(uint16_t, in, prevline, nextline, nextline2);
 
          /*
           * Map of the pixels:           I|E F|J
@@ -285,6 +296,7 @@ static void twoxsai_generic_rgb565(unsigned width, unsigned height,
 
       src += src_stride;
       dst += 2 * dst_stride;
+      first++;
    }
 }
 
@@ -348,7 +360,7 @@ static void twoxsai_generic_packets(void *data,
        * outside their given buffer.
        */
       thr->first = y_start;
-      thr->last = y_end == height;
+      thr->last = height - y_end;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = twoxsai_work_cb_rgb565;
@@ -157,7 +157,12 @@ typedef void (*softfilter_get_work_packets_t)(void *data,
 /* Returns the number of worker threads the filter will use.
  * This can differ from the value passed to create() instead the filter
  * cannot be parallelized, etc. The number of threads must be less-or-equal
- * compared to the value passed to create(). */
+ * compared to the value passed to create().
+ *
+ * Each "thread" is really one work packet. The frontend may pass a
+ * larger value to create() than it has cores and run the packets on
+ * a smaller pool in any order, so packets must not depend on each
+ * other. Splitting the frame into row tiles is the expected use. */
 typedef unsigned (*softfilter_query_num_threads_t)(void *data);
 
 struct softfilter_implementation
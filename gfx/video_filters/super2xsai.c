@@ -19,6 +19,13 @@
 #include "softfilter.h"
 #include <stdlib.h>
 
+/* The AVX2 kernels are compiled per function and only used
+ * when the frontend reports AVX2 in the SIMD mask. */
+#if defined(__SSE2__) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SUPERTWOXSAI_AVX2
+#include <immintrin.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation supertwoxsai_get_implementation
 #define softfilter_thread_data supertwoxsai_softfilter_thread_data
@@ -45,6 +52,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   int avx2;
 };
 
 static unsigned supertwoxsai_generic_input_fmts(void)
@@ -72,13 +80,15 @@ static void *supertwoxsai_generic_create(const struct softfilter_config *config,
    if (!filt)
       return NULL;
 
-   (void)simd;
    (void)config;
    (void)userdata;
 
    filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+#ifdef SUPERTWOXSAI_AVX2
+   filt->avx2    = (simd & SOFTFILTER_SIMD_AVX2) != 0;
+#endif
 
    if (!filt->workers)
    {
@@ -117,12 +127,12 @@ static void supertwoxsai_generic_destroy(void *data)
 #define supertwoxsai_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)))
 
 #ifndef supertwoxsai_declare_variables
-#define supertwoxsai_declare_variables(typename_t, in, nextline) \
+#define supertwoxsai_declare_variables(typename_t, in, prevline, nextline, nextline2) \
          typename_t product1a, product1b, product2a, product2b; \
-         const typename_t colorB0 = *(in - nextline - 1); \
-         const typename_t colorB1 = *(in - nextline + 0); \
-         const typename_t colorB2 = *(in - nextline + 1); \
-         const typename_t colorB3 = *(in - nextline + 2); \
+         const typename_t colorB0 = *(in - prevline - 1); \
+         const typename_t colorB1 = *(in - prevline + 0); \
+         const typename_t colorB2 = *(in - prevline + 1); \
+         const typename_t colorB3 = *(in - prevline + 2); \
          const typename_t color4  = *(in - 1); \
          const typename_t color5  = *(in + 0); \
          const typename_t color6  = *(in + 1); \
@@ -131,10 +141,10 @@ static void supertwoxsai_generic_destroy(void *data)
          const typename_t color2  = *(in + nextline + 0); \
          const typename_t color3  = *(in + nextline + 1); \
          const typename_t colorS1 = *(in + nextline + 2); \
-         const typename_t colorA0 = *(in + nextline + nextline - 1); \
-         const typename_t colorA1 = *(in + nextline + nextline + 0); \
-         const typename_t colorA2 = *(in + nextline + nextline + 1); \
-         const typename_t colorA3 = *(in + nextline + nextline + 2)
+         const typename_t colorA0 = *(in + nextline2 - 1); \
+         const typename_t colorA1 = *(in + nextline2 + 0); \
+         const typename_t colorA2 = *(in + nextline2 + 1); \
+         const typename_t colorA3 = *(in + nextline2 + 2)
 #endif
 
 #ifndef supertwoxsai_function
@@ -200,21 +210,183 @@ static void supertwoxsai_generic_destroy(void *data)
          out += 2
 #endif
 
+#ifdef SUPERTWOXSAI_AVX2
+/* Branch-free form of supertwoxsai_function for a vector of pixels.
+ * Every case is computed and the right one is picked with blends,
+ * so the output is bit-identical to the C version. 'bits' is the
+ * pixel size, 32 for XRGB8888 and 16 for RGB565. */
+#define supertwoxsai_avx2_load(ptr) _mm256_loadu_si256((const __m256i*)(ptr))
+#define supertwoxsai_avx2_eq(bits, A, B) _mm256_cmpeq_epi##bits(A, B)
+#define supertwoxsai_avx2_ne(bits, A, B) _mm256_xor_si256(_mm256_cmpeq_epi##bits(A, B), ones)
+#define supertwoxsai_avx2_and(A, B) _mm256_and_si256(A, B)
+#define supertwoxsai_avx2_sel(A, B, mask) _mm256_blendv_epi8(A, B, mask)
+
+#define supertwoxsai_avx2_interpolate(bits, A, B) \
+   _mm256_add_epi##bits(_mm256_add_epi##bits( \
+      _mm256_srli_epi##bits(_mm256_and_si256(A, lbmask), 1), \
+      _mm256_srli_epi##bits(_mm256_and_si256(B, lbmask), 1)), \
+      _mm256_and_si256(_mm256_and_si256(A, B), lsbmask))
+
+/* interpolate2(A, A, A, B); x * 3 is done as (x << 1) + x. */
+#define supertwoxsai_avx2_triple(bits, X) _mm256_add_epi##bits(_mm256_slli_epi##bits(X, 1), X)
+
+#define supertwoxsai_avx2_interpolate3(bits, A, B) \
+   _mm256_add_epi##bits(_mm256_add_epi##bits( \
+      supertwoxsai_avx2_triple(bits, _mm256_srli_epi##bits(_mm256_and_si256(A, qmask), 2)), \
+      _mm256_srli_epi##bits(_mm256_and_si256(B, qmask), 2)), \
+      _mm256_and_si256(_mm256_srli_epi##bits(_mm256_add_epi##bits( \
+         supertwoxsai_avx2_triple(bits, _mm256_and_si256(A, qlsbmask)), \
+         _mm256_and_si256(B, qlsbmask)), 2), qlsbmask))
+
+/* Minus supertwoxsai_result(A, B, C, D), from all-ones compare masks. */
+#define supertwoxsai_avx2_result(bits, A, B, C, D) \
+   _mm256_sub_epi##bits( \
+      _mm256_xor_si256(_mm256_and_si256(supertwoxsai_avx2_eq(bits, A, C), supertwoxsai_avx2_eq(bits, A, D)), ones), \
+      _mm256_xor_si256(_mm256_and_si256(supertwoxsai_avx2_eq(bits, B, C), supertwoxsai_avx2_eq(bits, B, D)), ones))
+
+#define supertwoxsai_avx2_store(bits, ptr, A, B) \
+   lo = _mm256_unpacklo_epi##bits(A, B); \
+   hi = _mm256_unpackhi_epi##bits(A, B); \
+   _mm256_storeu_si256((__m256i*)(ptr), _mm256_permute2x128_si256(lo, hi, 0x20)); \
+   _mm256_storeu_si256((__m256i*)(ptr) + 1, _mm256_permute2x128_si256(lo, hi, 0x31))
+
+#define supertwoxsai_avx2_row(typename_t, bits, lb, lsb, q, qlsb) \
+   unsigned x; \
+   const unsigned step    = 32 / sizeof(typename_t); \
+   const __m256i lbmask   = _mm256_set1_epi##bits(lb); \
+   const __m256i lsbmask  = _mm256_set1_epi##bits(lsb); \
+   const __m256i qmask    = _mm256_set1_epi##bits(q); \
+   const __m256i qlsbmask = _mm256_set1_epi##bits(qlsb); \
+   const __m256i ones     = _mm256_set1_epi32(-1); \
+   const __m256i zero     = _mm256_setzero_si256(); \
+   for (x = 0; x + step <= width; x += step, in += step, out += 2 * step) \
+   { \
+      __m256i lo, hi, r, p1a, p1b, p2a, p2b, b, cond; \
+      const __m256i colorB0 = supertwoxsai_avx2_load(in - prevline - 1); \
+      const __m256i colorB1 = supertwoxsai_avx2_load(in - prevline + 0); \
+      const __m256i colorB2 = supertwoxsai_avx2_load(in - prevline + 1); \
+      const __m256i colorB3 = supertwoxsai_avx2_load(in - prevline + 2); \
+      const __m256i color4  = supertwoxsai_avx2_load(in - 1); \
+      const __m256i color5  = supertwoxsai_avx2_load(in + 0); \
+      const __m256i color6  = supertwoxsai_avx2_load(in + 1); \
+      const __m256i colorS2 = supertwoxsai_avx2_load(in + 2); \
+      const __m256i color1  = supertwoxsai_avx2_load(in + nextline - 1); \
+      const __m256i color2  = supertwoxsai_avx2_load(in + nextline + 0); \
+      const __m256i color3  = supertwoxsai_avx2_load(in + nextline + 1); \
+      const __m256i colorS1 = supertwoxsai_avx2_load(in + nextline + 2); \
+      const __m256i colorA0 = supertwoxsai_avx2_load(in + nextline2 - 1); \
+      const __m256i colorA1 = supertwoxsai_avx2_load(in + nextline2 + 0); \
+      const __m256i colorA2 = supertwoxsai_avx2_load(in + nextline2 + 1); \
+      const __m256i colorA3 = supertwoxsai_avx2_load(in + nextline2 + 2); \
+      const __m256i eq26    = supertwoxsai_avx2_eq(bits, color2, color6); \
+      const __m256i eq53    = supertwoxsai_avx2_eq(bits, color5, color3); \
+      const __m256i eq63    = supertwoxsai_avx2_eq(bits, color6, color3); \
+      const __m256i eq52    = supertwoxsai_avx2_eq(bits, color5, color2); \
+      const __m256i i56     = supertwoxsai_avx2_interpolate(bits, color5, color6); \
+      const __m256i i25     = supertwoxsai_avx2_interpolate(bits, color2, color5); \
+      /* Neither diagonal matches. */ \
+      p2b  = supertwoxsai_avx2_interpolate(bits, color2, color3); \
+      cond = supertwoxsai_avx2_and(supertwoxsai_avx2_and(eq52, supertwoxsai_avx2_eq(bits, color2, colorA2)), \
+               supertwoxsai_avx2_and(supertwoxsai_avx2_ne(bits, colorA1, color3), supertwoxsai_avx2_ne(bits, color2, colorA3))); \
+      p2b  = supertwoxsai_avx2_sel(p2b, supertwoxsai_avx2_interpolate3(bits, color2, color3), cond); \
+      cond = supertwoxsai_avx2_and(supertwoxsai_avx2_and(eq63, supertwoxsai_avx2_eq(bits, color3, colorA1)), \
+               supertwoxsai_avx2_and(supertwoxsai_avx2_ne(bits, color2, colorA2), supertwoxsai_avx2_ne(bits, color3, colorA0))); \
+      p2b  = supertwoxsai_avx2_sel(p2b, supertwoxsai_avx2_interpolate3(bits, color3, color2), cond); \
+      p1b  = i56; \
+      cond = supertwoxsai_avx2_and(supertwoxsai_avx2_and(eq52, supertwoxsai_avx2_eq(bits, color5, colorB2)), \
+               supertwoxsai_avx2_and(supertwoxsai_avx2_ne(bits, colorB1, color6), supertwoxsai_avx2_ne(bits, color5, colorB3))); \
+      p1b  = supertwoxsai_avx2_sel(p1b, supertwoxsai_avx2_interpolate3(bits, color5, color6), cond); \
+      cond = supertwoxsai_avx2_and(supertwoxsai_avx2_and(eq63, supertwoxsai_avx2_eq(bits, color6, colorB1)), \
+               supertwoxsai_avx2_and(supertwoxsai_avx2_ne(bits, color5, colorB2), supertwoxsai_avx2_ne(bits, color6, colorB0))); \
+      p1b  = supertwoxsai_avx2_sel(p1b, supertwoxsai_avx2_interpolate3(bits, color6, color5), cond); \
+      /* Both diagonals match; vote on the neighbourhood. */ \
+      r    = _mm256_add_epi##bits(_mm256_add_epi##bits( \
+               supertwoxsai_avx2_result(bits, color6, color5, color1, colorA1), \
+               supertwoxsai_avx2_result(bits, color6, color5, color4, colorB1)), \
+             _mm256_add_epi##bits( \
+               supertwoxsai_avx2_result(bits, color6, color5, colorA2, colorS1), \
+               supertwoxsai_avx2_result(bits, color6, color5, colorB2, colorS2))); \
+      b    = supertwoxsai_avx2_sel(i56, color6, _mm256_cmpgt_epi##bits(zero, r)); \
+      b    = supertwoxsai_avx2_sel(b, color5, _mm256_cmpgt_epi##bits(r, zero)); \
+      cond = supertwoxsai_avx2_and(eq26, eq53); \
+      p2b  = supertwoxsai_avx2_sel(p2b, b, cond); \
+      p1b  = supertwoxsai_avx2_sel(p1b, b, cond); \
+      /* One diagonal matches. */ \
+      cond = _mm256_andnot_si256(eq26, eq53); \
+      p2b  = supertwoxsai_avx2_sel(p2b, color5, cond); \
+      p1b  = supertwoxsai_avx2_sel(p1b, color5, cond); \
+      cond = _mm256_andnot_si256(eq53, eq26); \
+      p2b  = supertwoxsai_avx2_sel(p2b, color2, cond); \
+      p1b  = supertwoxsai_avx2_sel(p1b, color2, cond); \
+      cond = _mm256_or_si256( \
+               supertwoxsai_avx2_and(supertwoxsai_avx2_and(_mm256_andnot_si256(eq26, eq53), supertwoxsai_avx2_eq(bits, color4, color5)), \
+                  supertwoxsai_avx2_ne(bits, color5, colorA2)), \
+               supertwoxsai_avx2_and(supertwoxsai_avx2_and(supertwoxsai_avx2_eq(bits, color5, color1), supertwoxsai_avx2_eq(bits, color6, color5)), \
+                  supertwoxsai_avx2_and(supertwoxsai_avx2_ne(bits, color4, color2), supertwoxsai_avx2_ne(bits, color5, colorA0)))); \
+      p2a  = supertwoxsai_avx2_sel(color2, i25, cond); \
+      cond = _mm256_or_si256( \
+               supertwoxsai_avx2_and(supertwoxsai_avx2_and(_mm256_andnot_si256(eq53, eq26), supertwoxsai_avx2_eq(bits, color1, color2)), \
+                  supertwoxsai_avx2_ne(bits, color2, colorB2)), \
+               supertwoxsai_avx2_and(supertwoxsai_avx2_and(supertwoxsai_avx2_eq(bits, color4, color2), supertwoxsai_avx2_eq(bits, color3, color2)), \
+                  supertwoxsai_avx2_and(supertwoxsai_avx2_ne(bits, color1, color5), supertwoxsai_avx2_ne(bits, color2, colorB0)))); \
+      p1a  = supertwoxsai_avx2_sel(color5, i25, cond); \
+      supertwoxsai_avx2_store(bits, out, p1a, p1b); \
+      supertwoxsai_avx2_store(bits, out + dst_stride, p2a, p2b); \
+   } \
+   return x
+
+/* Both return the number of pixels done; the caller finishes the row. */
+__attribute__((target("avx2")))
+static unsigned supertwoxsai_row_xrgb8888_avx2(const uint32_t *in, uint32_t *out,
+      unsigned prevline, unsigned nextline, unsigned nextline2,
+      unsigned dst_stride, unsigned width)
+{
+   supertwoxsai_avx2_row(uint32_t, 32, (int)0xFEFEFEFE, 0x01010101,
+         (int)0xFCFCFCFC, 0x03030303);
+}
+
+__attribute__((target("avx2")))
+static unsigned supertwoxsai_row_rgb565_avx2(const uint16_t *in, uint16_t *out,
+      unsigned prevline, unsigned nextline, unsigned nextline2,
+      unsigned dst_stride, unsigned width)
+{
+   supertwoxsai_avx2_row(uint16_t, 16, (short)0xF7DE, 0x0821,
+         (short)0xE79C, 0x1863);
+}
+#endif
+
 static void supertwoxsai_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+      int first, int last, int avx2, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
    for (; height; height--)
    {
+      /* Clamp the taps to the frame. first and last count
+       * the frame rows above and below this packet. */
+      unsigned below     = height - 1 + last;
+      unsigned prevline  = first     ? src_stride     : 0;
+      unsigned nextline  = below     ? src_stride     : 0;
+      unsigned nextline2 = below > 1 ? 2 * src_stride : nextline;
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
 
-      for (finish = width; finish; finish -= 1)
+      finish = width;
+#ifdef SUPERTWOXSAI_AVX2
+      if (avx2)
       {
-         supertwoxsai_declare_variables(uint32_t, in, nextline);
+         unsigned done = supertwoxsai_row_xrgb8888_avx2(in, out,
+               prevline, nextline, nextline2, dst_stride, width);
+         in     += done;
+         out    += 2 * done;
+         finish -= done;
+      }
+#endif
+
+      for (; finish; finish -= 1)
+      {
+         supertwoxsai_declare_variables(uint32_t, in, prevline, nextline, nextline2);
 
          //---------------------------    B1 B2
          //                             4  5  6 S2
@@ -227,24 +399,42 @@ static void supertwoxsai_generic_xrgb8888(unsigned width, unsigned height,
 
       src += src_stride;
       dst += 2 * dst_stride;
+      first++;
    }
 }
 
 static void supertwoxsai_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+      int first, int last, int avx2, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
    for (; height; height--)
    {
+      /* Clamp the taps to the frame. first and last count
+       * the frame rows above and below this packet. */
+      unsigned below     = height - 1 + last;
+      unsigned prevline  = first     ? src_stride     : 0;
+      unsigned nextline  = below     ? src_stride     : 0;
+      unsigned nextline2 = below > 1 ? 2 * src_stride : nextline;
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
 
-      for (finish = width; finish; finish -= 1)
+      finish = width;
+#ifdef SUPERTWOXSAI_AVX2
+      if (avx2)
+      {
+         unsigned done = supertwoxsai_row_rgb565_avx2(in, out,
+               prevline, nextline, nextline2, dst_stride, width);
+         in     += done;
+         out    += 2 * done;
+         finish -= done;
+      }
+#endif
+
+      for (; finish; finish -= 1)
       {
-         supertwoxsai_declare_variables(uint16_t, in, nextline);
+         supertwoxsai_declare_variables(uint16_t, in, prevline, nextline, nextline2);
 
          //---------------------------    B1 B2
          //                             4  5  6 S2
@@ -257,11 +447,13 @@ static void supertwoxsai_generic_rgb565(unsigned width, unsigned height,
 
       src += src_stride;
       dst += 2 * dst_stride;
+      first++;
    }
 }
 
 static void supertwoxsai_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint16_t *input = (uint16_t*)thr->in_data;
    uint16_t *output = (uint16_t*)thr->out_data;
@@ -269,7 +461,7 @@ static void supertwoxsai_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    supertwoxsai_generic_rgb565(width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->last, filt->avx2, input,
         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
         output,
         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -277,6 +469,7 @@ static void supertwoxsai_work_cb_rgb565(void *data, void *thread_data)
 
 static void supertwoxsai_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint32_t *input = (uint32_t*)thr->in_data;
    uint32_t *output = (uint32_t*)thr->out_data;
@@ -284,7 +477,7 @@ static void supertwoxsai_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned height = thr->height;
 
    supertwoxsai_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->last, filt->avx2, input,
             (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
             output,
             (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -313,7 +506,7 @@ static void supertwoxsai_generic_packets(void *data,
 
       // Workers need to know if they can access pixels outside their given buffer.
       thr->first = y_start;
-      thr->last = y_end == height;
+      thr->last = height - y_end;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = supertwoxsai_work_cb_rgb565;
@@ -19,6 +19,13 @@
 #include "softfilter.h"
 #include <stdlib.h>
 
+/* The AVX2 kernels are compiled per function and only used
+ * when the frontend reports AVX2 in the SIMD mask. */
+#if defined(__SSE2__) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SUPEREAGLE_AVX2
+#include <immintrin.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation supereagle_get_implementation
 #define softfilter_thread_data supereagle_softfilter_thread_data
@@ -45,6 +52,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   int avx2;
 };
 
 static unsigned supereagle_generic_input_fmts(void)
@@ -75,8 +83,11 @@ static void *supereagle_generic_create(const struct softfilter_config *config,
    if (!filt)
       return NULL;
    filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
+#ifdef SUPEREAGLE_AVX2
+   filt->avx2    = (simd & SOFTFILTER_SIMD_AVX2) != 0;
+#endif
    if (!filt->workers)
    {
       free(filt);
@@ -113,10 +124,10 @@ static void supereagle_generic_destroy(void *data)
 
 #define supereagle_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)));
 
-#define supereagle_declare_variables(typename_t, in, nextline) \
+#define supereagle_declare_variables(typename_t, in, prevline, nextline, nextline2) \
          typename_t product1a, product1b, product2a, product2b; \
-         const typename_t colorB1 = *(in - nextline + 0); \
-         const typename_t colorB2 = *(in - nextline + 1); \
+         const typename_t colorB1 = *(in - prevline + 0); \
+         const typename_t colorB2 = *(in - prevline + 1); \
          const typename_t color4  = *(in - 1); \
          const typename_t color5  = *(in + 0); \
          const typename_t color6  = *(in + 1); \
@@ -125,8 +136,8 @@ static void supereagle_generic_destroy(void *data)
          const typename_t color2  = *(in + nextline + 0); \
          const typename_t color3  = *(in + nextline + 1); \
          const typename_t colorS1 = *(in + nextline + 2); \
-         const typename_t colorA1 = *(in + nextline + nextline + 0); \
-         const typename_t colorA2 = *(in + nextline + nextline + 1)
+         const typename_t colorA1 = *(in + nextline2 + 0); \
+         const typename_t colorA2 = *(in + nextline2 + 1)
 
 #ifndef supereagle_function
 #define supereagle_function(result_cb, interpolate_cb, interpolate2_cb) \
@@ -214,56 +225,228 @@ static void supereagle_generic_destroy(void *data)
          out += 2
 #endif
 
+#ifdef SUPEREAGLE_AVX2
+/* Branch-free form of supereagle_function for a vector of pixels.
+ * Every case is computed and the right one is picked with blends,
+ * so the output is bit-identical to the C version. 'bits' is the
+ * pixel size, 32 for XRGB8888 and 16 for RGB565. */
+#define supereagle_avx2_load(ptr) _mm256_loadu_si256((const __m256i*)(ptr))
+#define supereagle_avx2_eq(bits, A, B) _mm256_cmpeq_epi##bits(A, B)
+#define supereagle_avx2_sel(bits, A, B, mask) _mm256_blendv_epi8(A, B, mask)
+
+#define supereagle_avx2_interpolate(bits, A, B) \
+   _mm256_add_epi##bits(_mm256_add_epi##bits( \
+      _mm256_srli_epi##bits(_mm256_and_si256(A, lbmask), 1), \
+      _mm256_srli_epi##bits(_mm256_and_si256(B, lbmask), 1)), \
+      _mm256_and_si256(_mm256_and_si256(A, B), lsbmask))
+
+#define supereagle_avx2_interpolate2(bits, A, B, C, D) \
+   _mm256_add_epi##bits(_mm256_add_epi##bits(_mm256_add_epi##bits(_mm256_add_epi##bits( \
+      _mm256_srli_epi##bits(_mm256_and_si256(A, qmask), 2), \
+      _mm256_srli_epi##bits(_mm256_and_si256(B, qmask), 2)), \
+      _mm256_srli_epi##bits(_mm256_and_si256(C, qmask), 2)), \
+      _mm256_srli_epi##bits(_mm256_and_si256(D, qmask), 2)), \
+      _mm256_and_si256(_mm256_srli_epi##bits(_mm256_add_epi##bits(_mm256_add_epi##bits(_mm256_add_epi##bits( \
+         _mm256_and_si256(A, qlsbmask), _mm256_and_si256(B, qlsbmask)), \
+         _mm256_and_si256(C, qlsbmask)), _mm256_and_si256(D, qlsbmask)), 2), qlsbmask))
+
+/* Minus supereagle_result(A, B, C, D), from all-ones compare masks. */
+#define supereagle_avx2_result(bits, A, B, C, D) \
+   _mm256_sub_epi##bits( \
+      _mm256_xor_si256(_mm256_and_si256(supereagle_avx2_eq(bits, A, C), supereagle_avx2_eq(bits, A, D)), ones), \
+      _mm256_xor_si256(_mm256_and_si256(supereagle_avx2_eq(bits, B, C), supereagle_avx2_eq(bits, B, D)), ones))
+
+#define supereagle_avx2_store(bits, ptr, A, B) \
+   lo = _mm256_unpacklo_epi##bits(A, B); \
+   hi = _mm256_unpackhi_epi##bits(A, B); \
+   _mm256_storeu_si256((__m256i*)(ptr), _mm256_permute2x128_si256(lo, hi, 0x20)); \
+   _mm256_storeu_si256((__m256i*)(ptr) + 1, _mm256_permute2x128_si256(lo, hi, 0x31))
+
+#define supereagle_avx2_row(typename_t, bits, lb, lsb, q, qlsb) \
+   unsigned x; \
+   const unsigned step    = 32 / sizeof(typename_t); \
+   const __m256i lbmask   = _mm256_set1_epi##bits(lb); \
+   const __m256i lsbmask  = _mm256_set1_epi##bits(lsb); \
+   const __m256i qmask    = _mm256_set1_epi##bits(q); \
+   const __m256i qlsbmask = _mm256_set1_epi##bits(qlsb); \
+   const __m256i ones     = _mm256_set1_epi32(-1); \
+   const __m256i zero     = _mm256_setzero_si256(); \
+   for (x = 0; x + step <= width; x += step, in += step, out += 2 * step) \
+   { \
+      __m256i lo, hi, c1c2, p1a, p1b, p2a, p2b, b1, b2, b3, r, r_pos, r_neg; \
+      const __m256i colorB1 = supereagle_avx2_load(in - prevline + 0); \
+      const __m256i colorB2 = supereagle_avx2_load(in - prevline + 1); \
+      const __m256i color4  = supereagle_avx2_load(in - 1); \
+      const __m256i color5  = supereagle_avx2_load(in + 0); \
+      const __m256i color6  = supereagle_avx2_load(in + 1); \
+      const __m256i colorS2 = supereagle_avx2_load(in + 2); \
+      const __m256i color1  = supereagle_avx2_load(in + nextline - 1); \
+      const __m256i color2  = supereagle_avx2_load(in + nextline + 0); \
+      const __m256i color3  = supereagle_avx2_load(in + nextline + 1); \
+      const __m256i colorS1 = supereagle_avx2_load(in + nextline + 2); \
+      const __m256i colorA1 = supereagle_avx2_load(in + nextline2 + 0); \
+      const __m256i colorA2 = supereagle_avx2_load(in + nextline2 + 1); \
+      const __m256i eq26    = supereagle_avx2_eq(bits, color2, color6); \
+      const __m256i eq53    = supereagle_avx2_eq(bits, color5, color3); \
+      const __m256i case1   = _mm256_andnot_si256(eq53, eq26); \
+      const __m256i case2   = _mm256_andnot_si256(eq26, eq53); \
+      const __m256i case3   = _mm256_and_si256(eq26, eq53); \
+      const __m256i i23     = supereagle_avx2_interpolate(bits, color2, color3); \
+      const __m256i i56     = supereagle_avx2_interpolate(bits, color5, color6); \
+      c1c2 = supereagle_avx2_interpolate(bits, color2, color6); \
+      p1a  = supereagle_avx2_interpolate2(bits, color5, color5, color5, c1c2); \
+      p2b  = supereagle_avx2_interpolate2(bits, color3, color3, color3, c1c2); \
+      c1c2 = supereagle_avx2_interpolate(bits, color5, color3); \
+      p1b  = supereagle_avx2_interpolate2(bits, color6, color6, color6, c1c2); \
+      p2a  = supereagle_avx2_interpolate2(bits, color2, color2, color2, c1c2); \
+      r     = _mm256_add_epi##bits(_mm256_add_epi##bits( \
+               supereagle_avx2_result(bits, color6, color5, color1, colorA1), \
+               supereagle_avx2_result(bits, color6, color5, color4, colorB1)), \
+            _mm256_add_epi##bits( \
+               supereagle_avx2_result(bits, color6, color5, colorA2, colorS1), \
+               supereagle_avx2_result(bits, color6, color5, colorB2, colorS2))); \
+      r_pos = _mm256_cmpgt_epi##bits(zero, r); \
+      r_neg = _mm256_cmpgt_epi##bits(r, zero); \
+      b1   = supereagle_avx2_sel(bits, i56, \
+               supereagle_avx2_interpolate(bits, color2, supereagle_avx2_interpolate(bits, color2, color5)), \
+               _mm256_or_si256(supereagle_avx2_eq(bits, color1, color2), supereagle_avx2_eq(bits, color6, colorB2))); \
+      b2   = color5; \
+      b3   = supereagle_avx2_sel(bits, color5, i56, r_pos); \
+      p1a  = supereagle_avx2_sel(bits, p1a, b3, case3); \
+      p1a  = supereagle_avx2_sel(bits, p1a, b2, case2); \
+      p1a  = supereagle_avx2_sel(bits, p1a, b1, case1); \
+      b1   = supereagle_avx2_sel(bits, i23, \
+               supereagle_avx2_interpolate(bits, color2, i23), \
+               _mm256_or_si256(supereagle_avx2_eq(bits, color6, colorS2), supereagle_avx2_eq(bits, color2, colorA1))); \
+      p2b  = supereagle_avx2_sel(bits, p2b, b3, case3); \
+      p2b  = supereagle_avx2_sel(bits, p2b, b2, case2); \
+      p2b  = supereagle_avx2_sel(bits, p2b, b1, case1); \
+      b1   = color2; \
+      b2   = supereagle_avx2_sel(bits, i56, \
+               supereagle_avx2_interpolate(bits, color5, i56), \
+               _mm256_or_si256(supereagle_avx2_eq(bits, colorB1, color5), supereagle_avx2_eq(bits, color3, colorS1))); \
+      b3   = supereagle_avx2_sel(bits, color2, i56, r_neg); \
+      p1b  = supereagle_avx2_sel(bits, p1b, b3, case3); \
+      p1b  = supereagle_avx2_sel(bits, p1b, b2, case2); \
+      p1b  = supereagle_avx2_sel(bits, p1b, b1, case1); \
+      b2   = supereagle_avx2_sel(bits, i23, \
+               supereagle_avx2_interpolate(bits, color5, supereagle_avx2_interpolate(bits, color5, color2)), \
+               _mm256_or_si256(supereagle_avx2_eq(bits, color3, colorA2), supereagle_avx2_eq(bits, color4, color5))); \
+      p2a  = supereagle_avx2_sel(bits, p2a, b3, case3); \
+      p2a  = supereagle_avx2_sel(bits, p2a, b2, case2); \
+      p2a  = supereagle_avx2_sel(bits, p2a, b1, case1); \
+      supereagle_avx2_store(bits, out, p1a, p1b); \
+      supereagle_avx2_store(bits, out + dst_stride, p2a, p2b); \
+   } \
+   return x
+
+/* Both return the number of pixels done; the caller finishes the row. */
+__attribute__((target("avx2")))
+static unsigned supereagle_row_xrgb8888_avx2(const uint32_t *in, uint32_t *out,
+      unsigned prevline, unsigned nextline, unsigned nextline2,
+      unsigned dst_stride, unsigned width)
+{
+   supereagle_avx2_row(uint32_t, 32, (int)0xFEFEFEFE, 0x01010101,
+         (int)0xFCFCFCFC, 0x03030303);
+}
+
+__attribute__((target("avx2")))
+static unsigned supereagle_row_rgb565_avx2(const uint16_t *in, uint16_t *out,
+      unsigned prevline, unsigned nextline, unsigned nextline2,
+      unsigned dst_stride, unsigned width)
+{
+   supereagle_avx2_row(uint16_t, 16, (short)0xF7DE, 0x0821,
+         (short)0xE79C, 0x1863);
+}
+#endif
+
 static void supereagle_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+      int first, int last, int avx2, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
    for (; height; height--)
    {
+      /* Clamp the taps to the frame. first and last count
+       * the frame rows above and below this packet. */
+      unsigned below     = height - 1 + last;
+      unsigned prevline  = first     ? src_stride     : 0;
+      unsigned nextline  = below     ? src_stride     : 0;
+      unsigned nextline2 = below > 1 ? 2 * src_stride : nextline;
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
 
-      for (finish = width; finish; finish -= 1)
+      finish = width;
+#ifdef SUPEREAGLE_AVX2
+      if (avx2)
       {
-         supereagle_declare_variables(uint32_t, in, nextline);
+         unsigned done = supereagle_row_xrgb8888_avx2(in, out,
+               prevline, nextline, nextline2, dst_stride, width);
+         in     += done;
+         out    += 2 * done;
+         finish -= done;
+      }
+#endif
+
+      for (; finish; finish -= 1)
+      {
+         supereagle_declare_variables(uint32_t, in, prevline, nextline, nextline2);
 
          supereagle_function(supereagle_result, supereagle_interpolate_xrgb8888, supereagle_interpolate2_xrgb8888);
       }
 
       src += src_stride;
       dst += 2 * dst_stride;
+      first++;
    }
 }
 
 static void supereagle_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+      int first, int last, int avx2, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
    for (; height; height--)
    {
+      /* Clamp the taps to the frame. first and last count
+       * the frame rows above and below this packet. */
+      unsigned below     = height - 1 + last;
+      unsigned prevline  = first     ? src_stride     : 0;
+      unsigned nextline  = below     ? src_stride     : 0;
+      unsigned nextline2 = below > 1 ? 2 * src_stride : nextline;
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
 
-      for (finish = width; finish; finish -= 1)
+      finish = width;
+#ifdef SUPEREAGLE_AVX2
+      if (avx2)
+      {
+         unsigned done = supereagle_row_rgb565_avx2(in, out,
+               prevline, nextline, nextline2, dst_stride, width);
+         in     += done;
+         out    += 2 * done;
+         finish -= done;
+      }
+#endif
+
+      for (; finish; finish -= 1)
       {
-         supereagle_declare_variables(uint16_t, in, nextline);
+         supereagle_declare_variables(uint16_t, in, prevline, nextline, nextline2);
 
          supereagle_function(supereagle_result, supereagle_interpolate_rgb565, supereagle_interpolate2_rgb565);
       }
 
       src += src_stride;
       dst += 2 * dst_stride;
+      first++;
    }
 }
 
 static void supereagle_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint16_t *input = (uint16_t*)thr->in_data;
    uint16_t *output = (uint16_t*)thr->out_data;
@@ -271,7 +454,7 @@ static void supereagle_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    supereagle_generic_rgb565(width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->last, filt->avx2, input,
             (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
             output,
             (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -279,6 +462,7 @@ static void supereagle_work_cb_rgb565(void *data, void *thread_data)
 
 static void supereagle_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint32_t *input = (uint32_t*)thr->in_data;
    uint32_t *output = (uint32_t*)thr->out_data;
@@ -286,7 +470,7 @@ static void supereagle_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned height = thr->height;
 
    supereagle_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
+         thr->first, thr->last, filt->avx2, input,
         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
         output,
         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -315,7 +499,7 @@ static void supereagle_generic_packets(void *data,
 
       /* Workers need to know if they can access pixels outside their given buffer. */
       thr->first = y_start;
-      thr->last = y_end == height;
+      thr->last = height - y_end;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = supereagle_work_cb_rgb565;
@@ -22,6 +22,7 @@
 #include <features/features_cpu.h>
 #include <rthreads/rthreads.h>
 #include <string/stdstring.h>
+#include <retro_atomic.h>
 
 #include "video_thread_wrapper.h"
 #include "font_driver.h"
@@ -60,6 +61,27 @@ enum thread_cmd
    CMD_DUMMY = INT_MAX
 };
 
+/* Frames are triple-buffered between the main thread
+ * and the video thread */
+#define VIDEO_THREAD_FRAME_SLOTS        3
+#define VIDEO_THREAD_SLOT_FRESH         4
+#define VIDEO_THREAD_SLOT_MASK          3
+#define VIDEO_THREAD_FRAME_TIME_SAMPLES 1024
+
+typedef struct thread_frame_slot
+{
+   uint8_t *buffer;
+   /* buffer, or NULL when the core duped the frame */
+   const void *data;
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   uint64_t count;
+   uint64_t seq;
+   retro_time_t pushed;
+   char msg[255];
+} thread_frame_slot_t;
+
 struct thread_packet
 {
    enum thread_cmd type;
@@ -185,8 +207,20 @@ struct thread_video
    bool is_idle;
 
    retro_time_t last_time;
-   unsigned hit_count;
-   unsigned miss_count;
+
+   /* Frame pacing statistics, guarded by lock */
+   struct
+   {
+      uint64_t pushed;
+      uint64_t dropped;
+      uint64_t duplicated;
+      uint64_t latency_count;
+      retro_time_t latency_sum;
+      retro_time_t latency_max;
+      retro_time_t last_present;
+      retro_time_t samples[VIDEO_THREAD_FRAME_TIME_SAMPLES];
+      unsigned sample_count;
+   } stats;
 
    float *alpha_mod;
    unsigned alpha_mods;
@@ -204,14 +238,22 @@ struct thread_video
    struct
    {
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      bool updated;
+#ifndef RETRO_ATOMIC_LOCK_FREE
+      slock_t *middle_lock;
+#endif
+      thread_frame_slot_t slots[VIDEO_THREAD_FRAME_SLOTS];
+      size_t slot_size;
+      /* The main thread fills 'back' and the video thread renders
+       * 'front'. Finished frames are handed over by swapping 'back'
+       * with 'middle', which has VIDEO_THREAD_SLOT_FRESH set until
+       * the video thread swaps it for its 'front'. */
+      retro_atomic_int_t middle;
+      unsigned back;
+      unsigned front;
+      uint64_t published;
+      /* Sequence number of the last frame rendered, guarded by lock */
+      uint64_t presented;
       bool within_thread;
-      uint64_t count;
-      char msg[255];
    } frame;
 
    video_driver_t video_thread;
@@ -229,6 +271,33 @@ static void *video_thread_init_never_call(const video_info_t *video,
    return NULL;
 }
 
+static int video_thread_middle_load(thread_video_t *thr)
+{
+#ifdef RETRO_ATOMIC_LOCK_FREE
+   return retro_atomic_int_load(&thr->frame.middle);
+#else
+   int middle;
+   slock_lock(thr->frame.middle_lock);
+   middle = thr->frame.middle;
+   slock_unlock(thr->frame.middle_lock);
+   return middle;
+#endif
+}
+
+static int video_thread_middle_exchange(thread_video_t *thr, int value)
+{
+#ifdef RETRO_ATOMIC_LOCK_FREE
+   return retro_atomic_int_exchange(&thr->frame.middle, value);
+#else
+   int middle;
+   slock_lock(thr->frame.middle_lock);
+   middle             = thr->frame.middle;
+   thr->frame.middle  = value;
+   slock_unlock(thr->frame.middle_lock);
+   return middle;
+#endif
+}
+
 /* thread -> user */
 static void video_thread_reply(thread_video_t *thr, const thread_packet_t *pkt)
 {
@@ -564,10 +633,9 @@ static void video_thread_loop(void *data)
       bool updated = false;
 
       slock_lock(thr->lock);
-      while (thr->send_cmd == CMD_VIDEO_NONE && !thr->frame.updated)
+      while (thr->send_cmd == CMD_VIDEO_NONE &&
+            !(video_thread_middle_load(thr) & VIDEO_THREAD_SLOT_FRESH))
          scond_wait(thr->cond_thread, thr->lock);
-      if (thr->frame.updated)
-         updated = true;
 
       /* To avoid race condition where send_cmd is updated
        * right after the switch is checked. */
@@ -578,6 +646,15 @@ static void video_thread_loop(void *data)
       if (video_thread_handle_packet(thr, &pkt))
          return;
 
+      /* Take the newest finished frame, handing the
+       * one just rendered back to the main thread */
+      if (video_thread_middle_load(thr) & VIDEO_THREAD_SLOT_FRESH)
+      {
+         thr->frame.front = video_thread_middle_exchange(thr,
+               (int)thr->frame.front) & VIDEO_THREAD_SLOT_MASK;
+         updated          = true;
+      }
+
       if (updated)
       {
          struct video_viewport vp;
@@ -585,6 +662,9 @@ static void video_thread_loop(void *data)
          bool               alive = false;
          bool               focus = false;
          bool        has_windowed = true;
+         const thread_frame_slot_t *slot = &thr->frame.slots[thr->frame.front];
+         retro_time_t        time = cpu_features_get_time_usec();
+         retro_time_t     latency = time - slot->pushed;
 
          vp.x                     = 0;
          vp.y                     = 0;
@@ -603,14 +683,16 @@ static void video_thread_loop(void *data)
             video_driver_build_info(&video_info);
 
             ret = thr->driver->frame(thr->driver_data,
-                  thr->frame.buffer, thr->frame.width, thr->frame.height,
-                  thr->frame.count,
-                  thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL,
+                  slot->data, slot->width, slot->height,
+                  slot->count,
+                  slot->pitch, *slot->msg ? slot->msg : NULL,
                   &video_info);
          }
 
          slock_unlock(thr->frame.lock);
 
+         time = cpu_features_get_time_usec();
+
          if (thr->driver && thr->driver->alive)
             alive = ret && thr->driver->alive(thr->driver_data);
 
@@ -624,11 +706,22 @@ static void video_thread_loop(void *data)
             thr->driver->viewport_info(thr->driver_data, &vp);
 
          slock_lock(thr->lock);
-         thr->alive         = alive;
-         thr->focus         = focus;
-         thr->has_windowed  = has_windowed;
-         thr->frame.updated = false;
-         thr->vp            = vp;
+         thr->alive           = alive;
+         thr->focus           = focus;
+         thr->has_windowed    = has_windowed;
+         thr->frame.presented = slot->seq;
+         thr->vp              = vp;
+
+         thr->stats.latency_sum += latency;
+         thr->stats.latency_count++;
+         if (latency > thr->stats.latency_max)
+            thr->stats.latency_max = latency;
+         if (thr->stats.last_present)
+            thr->stats.samples[thr->stats.sample_count++ &
+               (VIDEO_THREAD_FRAME_TIME_SAMPLES - 1)] =
+               time - thr->stats.last_present;
+         thr->stats.last_present = time;
+
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
       }
@@ -695,7 +788,9 @@ static bool video_thread_frame(void *data, const void *frame_,
       unsigned width, unsigned height, uint64_t frame_count,
       unsigned pitch, const char *msg, video_frame_info_t *video_info)
 {
+   int middle;
    unsigned copy_stride;
+   thread_frame_slot_t *slot           = NULL;
    const uint8_t *src                  = NULL;
    uint8_t *dst                        = NULL;
    thread_video_t *thr                 = (thread_video_t*)data;
@@ -715,20 +810,20 @@ static bool video_thread_frame(void *data, const void *frame_,
    copy_stride = width * (thr->info.rgb32
          ? sizeof(uint32_t) : sizeof(uint16_t));
 
-   src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
-
-   slock_lock(thr->lock);
+   slot = &thr->frame.slots[thr->frame.back];
+   src  = (const uint8_t*)frame_;
+   dst  = slot->buffer;
 
    if (!thr->nonblock)
    {
-
       retro_time_t target_frame_time = (retro_time_t)
          roundf(1000000 / video_info->refresh_rate);
       retro_time_t target = thr->last_time + target_frame_time;
 
+      slock_lock(thr->lock);
+
       /* Ideally, use absolute time, but that is only a good idea on POSIX. */
-      while (thr->frame.updated)
+      while (thr->frame.presented != thr->frame.published)
       {
          retro_time_t current = cpu_features_get_time_usec();
          retro_time_t delta   = target - current;
@@ -739,11 +834,16 @@ static bool video_thread_frame(void *data, const void *frame_,
          if (!scond_wait_timeout(thr->cond_cmd, thr->lock, delta))
             break;
       }
+
+      slock_unlock(thr->lock);
    }
 
-   /* Drop frame if updated flag is still set, as thread is
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   /* The back slot belongs to this thread, so it is filled
+    * without holding any lock. A core that rendered into it
+    * through get_current_software_framebuffer needs no copy. */
+   if (src == dst)
+      slot->pitch = pitch;
+   else
    {
       if (src)
       {
@@ -751,31 +851,43 @@ static bool video_thread_frame(void *data, const void *frame_,
          for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
             memcpy(dst, src, copy_stride);
       }
+      slot->pitch = copy_stride;
+   }
+
+   slot->data   = frame_ ? slot->buffer : NULL;
+   slot->width  = width;
+   slot->height = height;
+   slot->count  = frame_count;
+   slot->seq    = ++thr->frame.published;
+   slot->pushed = cpu_features_get_time_usec();
 
-      thr->frame.updated = true;
-      thr->frame.width  = width;
-      thr->frame.height = height;
-      thr->frame.count  = frame_count;
-      thr->frame.pitch  = copy_stride;
+   if (msg)
+      strlcpy(slot->msg, msg, sizeof(slot->msg));
+   else
+      *slot->msg = '\0';
+
+   middle = video_thread_middle_exchange(thr,
+         (int)thr->frame.back | VIDEO_THREAD_SLOT_FRESH);
+   thr->frame.back = middle & VIDEO_THREAD_SLOT_MASK;
 
-      if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
-      else
-         *thr->frame.msg = '\0';
+   slock_lock(thr->lock);
 
-      scond_signal(thr->cond_thread);
+   thr->stats.pushed++;
+   /* Replaced a frame the video thread never picked up */
+   if (middle & VIDEO_THREAD_SLOT_FRESH)
+      thr->stats.dropped++;
+   if (!frame_)
+      thr->stats.duplicated++;
+
+   scond_signal(thr->cond_thread);
 
 #if defined(HAVE_MENU)
-      if (thr->texture.enable)
-      {
-         while (thr->frame.updated)
-            scond_wait(thr->cond_cmd, thr->lock);
-      }
-#endif
-      thr->hit_count++;
+   if (thr->texture.enable)
+   {
+      while (thr->frame.presented != thr->frame.published)
+         scond_wait(thr->cond_cmd, thr->lock);
    }
-   else
-      thr->miss_count++;
+#endif
 
    slock_unlock(thr->lock);
 
@@ -794,12 +906,16 @@ static bool video_thread_init(thread_video_t *thr,
       const video_info_t info,
       const input_driver_t **input, void **input_data)
 {
+   unsigned i;
    size_t max_size;
    thread_packet_t pkt = {CMD_INIT};
 
    thr->lock                 = slock_new();
    thr->alpha_lock           = slock_new();
    thr->frame.lock           = slock_new();
+#ifndef RETRO_ATOMIC_LOCK_FREE
+   thr->frame.middle_lock    = slock_new();
+#endif
    thr->cond_cmd             = scond_new();
    thr->cond_thread          = scond_new();
    thr->input                = input;
@@ -813,12 +929,21 @@ static bool video_thread_init(thread_video_t *thr,
    max_size                  = info.input_scale * RARCH_SCALE_BASE;
    max_size                 *= max_size;
    max_size                 *= info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
-   thr->frame.buffer         = (uint8_t*)malloc(max_size);
+   thr->frame.slot_size      = max_size;
 
-   if (!thr->frame.buffer)
-      return false;
+   for (i = 0; i < VIDEO_THREAD_FRAME_SLOTS; i++)
+   {
+      thr->frame.slots[i].buffer = (uint8_t*)malloc(max_size);
+
+      if (!thr->frame.slots[i].buffer)
+         return false;
+
+      memset(thr->frame.slots[i].buffer, 0x80, max_size);
+   }
 
-   memset(thr->frame.buffer, 0x80, max_size);
+   thr->frame.back           = 0;
+   thr->frame.middle         = 1;
+   thr->frame.front          = 2;
 
    thr->last_time            = cpu_features_get_time_usec();
    thr->thread               = sthread_create(video_thread_loop, thr);
@@ -915,6 +1040,7 @@ static bool video_thread_read_viewport(void *data, uint8_t *buffer, bool is_idle
 
 static void video_thread_free(void *data)
 {
+   unsigned i;
    thread_video_t *thr = (thread_video_t*)data;
    thread_packet_t pkt = { CMD_FREE };
 
@@ -928,8 +1054,12 @@ static void video_thread_free(void *data)
 #if defined(HAVE_MENU)
    free(thr->texture.frame);
 #endif
-   free(thr->frame.buffer);
+   for (i = 0; i < VIDEO_THREAD_FRAME_SLOTS; i++)
+      free(thr->frame.slots[i].buffer);
    slock_free(thr->frame.lock);
+#ifndef RETRO_ATOMIC_LOCK_FREE
+   slock_free(thr->frame.middle_lock);
+#endif
    slock_free(thr->lock);
    scond_free(thr->cond_cmd);
    scond_free(thr->cond_thread);
@@ -937,8 +1067,13 @@ static void video_thread_free(void *data)
    free(thr->alpha_mod);
    slock_free(thr->alpha_lock);
 
-   RARCH_LOG("Threaded video stats: Frames pushed: %u, Frames dropped: %u.\n",
-         thr->hit_count, thr->miss_count);
+   RARCH_LOG("Threaded video stats: Frames pushed: %u, Frames dropped: %u,"
+         " Frames duplicated: %u, Average queue latency: %u usec.\n",
+         (unsigned)thr->stats.pushed, (unsigned)thr->stats.dropped,
+         (unsigned)thr->stats.duplicated,
+         thr->stats.latency_count
+         ? (unsigned)(thr->stats.latency_sum / thr->stats.latency_count)
+         : 0);
 
    free(thr);
 }
@@ -1231,6 +1366,44 @@ static struct video_shader *thread_get_current_shader(void *data)
    return thr->poke->get_current_shader(thr->driver_data);
 }
 
+/* Lets the core render straight into the back slot,
+ * video_thread_frame() then hands it over without a copy. */
+static bool thread_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   enum retro_pixel_format format = video_driver_get_pixel_format();
+   thread_video_t *thr            = (thread_video_t*)data;
+   unsigned bpp                   = 0;
+
+   if (!thr || !framebuffer)
+      return false;
+
+   /* 0RGB1555 is converted before it reaches the wrapper */
+   if (thr->info.rgb32)
+   {
+      if (format != RETRO_PIXEL_FORMAT_XRGB8888)
+         return false;
+      bpp = sizeof(uint32_t);
+   }
+   else
+   {
+      if (format != RETRO_PIXEL_FORMAT_RGB565)
+         return false;
+      bpp = sizeof(uint16_t);
+   }
+
+   if ((size_t)framebuffer->width * framebuffer->height * bpp
+         > thr->frame.slot_size)
+      return false;
+
+   framebuffer->data         = thr->frame.slots[thr->frame.back].buffer;
+   framebuffer->pitch        = framebuffer->width * bpp;
+   framebuffer->format       = format;
+   framebuffer->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+
+   return true;
+}
+
 static uint32_t thread_get_flags(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
@@ -1261,7 +1434,7 @@ static const video_poke_interface_t thread_poke = {
    NULL,
 
    thread_get_current_shader,
-   NULL,                      /* get_current_software_framebuffer */
+   thread_get_current_software_framebuffer,
    NULL                       /* get_hw_render_interface */
 };
 
@@ -1408,6 +1581,51 @@ const char *video_thread_get_ident(void)
    return thr->driver->ident;
 }
 
+bool video_thread_get_stats(video_thread_stats_t *stats)
+{
+   thread_video_t *thr = (thread_video_t*)video_driver_get_ptr(true);
+
+   if (!thr || !stats)
+      return false;
+
+   slock_lock(thr->lock);
+   stats->frames_pushed     = thr->stats.pushed;
+   stats->frames_dropped    = thr->stats.dropped;
+   stats->frames_duplicated = thr->stats.duplicated;
+   stats->latency_avg       = thr->stats.latency_count
+      ? thr->stats.latency_sum / (retro_time_t)thr->stats.latency_count
+      : 0;
+   stats->latency_max       = thr->stats.latency_max;
+   slock_unlock(thr->lock);
+
+   return true;
+}
+
+unsigned video_thread_get_frame_time_samples(retro_time_t *samples,
+      unsigned max_samples)
+{
+   unsigned i, count;
+   thread_video_t *thr = (thread_video_t*)video_driver_get_ptr(true);
+
+   if (!thr || !samples)
+      return 0;
+
+   slock_lock(thr->lock);
+
+   count = thr->stats.sample_count;
+   if (count > VIDEO_THREAD_FRAME_TIME_SAMPLES)
+      count = VIDEO_THREAD_FRAME_TIME_SAMPLES;
+   if (count > max_samples)
+      count = max_samples;
+
+   for (i = 0; i < count; i++)
+      samples[i] = thr->stats.samples[i];
+
+   slock_unlock(thr->lock);
+
+   return count;
+}
+
 static void video_thread_send_and_wait(thread_video_t *thr,
       thread_packet_t *pkt)
 {
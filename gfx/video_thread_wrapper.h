@@ -38,6 +38,18 @@ typedef struct thread_packet thread_packet_t;
 
 typedef struct thread_video thread_video_t;
 
+typedef struct video_thread_stats
+{
+   uint64_t frames_pushed;
+   /* Replaced before the video thread picked them up */
+   uint64_t frames_dropped;
+   /* Pushed by the core as dupes (NULL frame) */
+   uint64_t frames_duplicated;
+   /* Time from push until the video thread starts rendering */
+   retro_time_t latency_avg;
+   retro_time_t latency_max;
+} video_thread_stats_t;
+
 /**
  * video_init_thread:
  * @out_driver                : Output video driver
@@ -73,6 +85,25 @@ void *video_thread_get_ptr(const video_driver_t **drv);
 
 const char *video_thread_get_ident(void);
 
+/**
+ * video_thread_get_stats:
+ * @stats                     : Output frame pacing statistics.
+ *
+ * Returns: true (1) if the threaded wrapper is active.
+ **/
+bool video_thread_get_stats(video_thread_stats_t *stats);
+
+/**
+ * video_thread_get_frame_time_samples:
+ * @samples                   : Output intervals between presented
+ *                              frames, in microseconds.
+ * @max_samples               : Capacity of @samples.
+ *
+ * Returns: number of samples written.
+ **/
+unsigned video_thread_get_frame_time_samples(retro_time_t *samples,
+      unsigned max_samples);
+
 bool video_thread_font_init(
       const void **font_driver,
       void **font_handle,
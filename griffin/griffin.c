@@ -935,6 +935,7 @@ FILE
 #include "../file_path_str.c"
 #include "../libretro-common/lists/dir_list.c"
 #include "../libretro-common/lists/string_list.c"
+#include "../libretro-common/lists/string_map.c"
 #include "../libretro-common/lists/file_list.c"
 #include "../setting_list.c"
 #include "../libretro-common/file/retro_dirent.c"
@@ -968,6 +969,7 @@ CONFIGURATION
 STATE MANAGER
 ============================================================ */
 #include "../managers/state_manager.c"
+#include "../managers/savestate_file.c"
 
 /*============================================================
 FRONTEND
@@ -1239,6 +1241,7 @@ MENU
 #include "../menu/menu_displaylist.c"
 #include "../menu/menu_animation.c"
 #include "../menu/menu_thumbnail_path.c"
+#include "../menu/menu_thumbnail_cache.c"
 
 #include "../menu/drivers/null.c"
 #include "../menu/drivers/menu_generic.c"
@@ -62,6 +62,7 @@
 #include "../retroarch.h"
 #include "../movie.h"
 #include "../list_special.h"
+#include "../performance_counters.h"
 #include "../verbosity.h"
 #include "../tasks/tasks_internal.h"
 #include "../command.h"
@@ -412,6 +413,10 @@ static unsigned osk_last_codepoint_len            = 0;
 static input_keyboard_press_t g_keyboard_press_cb;
 
 static turbo_buttons_t input_driver_turbo_btns;
+
+/* Joypad and analog stick state of each port, built from the driver
+ * state on the first query after input_poll, see input_state. */
+static input_snapshot_t input_driver_snapshot[MAX_USERS];
 #ifdef HAVE_COMMAND
 static command_t *input_driver_command            = NULL;
 #endif
@@ -595,7 +600,10 @@ void input_poll(void)
    settings_t *settings           = config_get_ptr();
    uint8_t max_users              = (uint8_t)input_driver_max_users;
 
+   PERF_TRACE_BEGIN("input_poll");
+
    current_input->poll(current_input_data);
+   perf_metrics_input_polled();
 
    input_driver_turbo_btns.count++;
 
@@ -603,7 +611,11 @@ void input_poll(void)
       input_driver_turbo_btns.frame_enable[i] = 0;
 
    if (input_driver_block_libretro_input)
+   {
+      memset(input_driver_snapshot, 0, sizeof(input_driver_snapshot));
+      PERF_TRACE_END("input_poll");
       return;
+   }
 
    for (i = 0; i < max_users; i++)
    {
@@ -641,22 +653,22 @@ void input_poll(void)
    if (input_driver_remote)
       input_remote_poll(input_driver_remote, max_users);
 #endif
+
+   /* Only now is every source of input up to date; anything
+    * that read input_state() above must not leak into the frame */
+   memset(input_driver_snapshot, 0, sizeof(input_driver_snapshot));
+
+   PERF_TRACE_END("input_poll");
 }
 
 /**
- * input_state:
- * @port                 : user number.
- * @device               : device identifier of user.
- * @idx                  : index value of user.
- * @id                   : identifier of key pressed by user.
+ * input_state_raw:
  *
- * Input state callback function.
- *
- * Returns: Non-zero if the given key (identified by @id)
- * was pressed by the user (assigned to @port).
+ * Queries the driver, overlay, network gamepad and mapper for the
+ * given input. Turbo and BSV movies are handled by the callers.
  **/
-int16_t input_state(unsigned port, unsigned device,
-      unsigned idx, unsigned id)
+static int16_t input_state_raw(settings_t *settings, unsigned port,
+      unsigned device, unsigned idx, unsigned id)
 {
    int16_t res         = 0;
 #ifdef HAVE_OVERLAY
@@ -667,108 +679,204 @@ int16_t input_state(unsigned port, unsigned device,
       is in action for that button*/
    bool reset_state  = false;
 
-   device &= RETRO_DEVICE_MASK;
-
-   if (bsv_movie_is_playback_on())
+   if (settings->bools.input_remap_binds_enable)
    {
-      int16_t bsv_result;
-      if (bsv_movie_get_input(&bsv_result))
-         return bsv_result;
-
-      bsv_movie_ctl(BSV_MOVIE_CTL_SET_END, NULL);
-   }
-
-   if (     !input_driver_flushing_input
-         && !input_driver_block_libretro_input)
-   {
-      settings_t *settings = config_get_ptr();
-
-      if (settings->bools.input_remap_binds_enable)
+      switch (device)
       {
-         switch (device)
-         {
-            case RETRO_DEVICE_JOYPAD:
-               if (id != settings->uints.input_remap_ids[port][id])
+         case RETRO_DEVICE_JOYPAD:
+            if (id != settings->uints.input_remap_ids[port][id])
+               reset_state = true;
+            break;
+         case RETRO_DEVICE_ANALOG:
+            if (idx < 2 && id < 2)
+            {
+               unsigned offset = RARCH_FIRST_CUSTOM_BIND + (idx * 4) + (id * 2);
+               if (settings->uints.input_remap_ids[port][offset]   != offset)
                   reset_state = true;
-               break;
-            case RETRO_DEVICE_ANALOG:
-               if (idx < 2 && id < 2)
-               {
-                  unsigned offset = RARCH_FIRST_CUSTOM_BIND + (idx * 4) + (id * 2);
-                  if (settings->uints.input_remap_ids[port][offset]   != offset)
-                     reset_state = true;
-                  if (settings->uints.input_remap_ids[port][offset+1] != (offset+1))
-                     reset_state = true;
-               }
-               break;
-         }
+               if (settings->uints.input_remap_ids[port][offset+1] != (offset+1))
+                  reset_state = true;
+            }
+            break;
       }
+   }
 
 #ifdef HAVE_OVERLAY
-      if (overlay_ptr)
-         input_state_overlay(overlay_ptr,
-               &res_overlay, port, device, idx, id);
+   if (overlay_ptr)
+      input_state_overlay(overlay_ptr,
+            &res_overlay, port, device, idx, id);
 #endif
 
 #ifdef HAVE_NETWORKGAMEPAD
-      if (input_driver_remote)
-         input_remote_state(&res, port, device, idx, id);
+   if (input_driver_remote)
+      input_remote_state(&res, port, device, idx, id);
 #endif
 
-      if (((id < RARCH_FIRST_META_KEY) || (device == RETRO_DEVICE_KEYBOARD)))
+   if (((id < RARCH_FIRST_META_KEY) || (device == RETRO_DEVICE_KEYBOARD)))
+   {
+      bool bind_valid = libretro_input_binds[port] && libretro_input_binds[port][id].valid;
+
+      if (bind_valid || device == RETRO_DEVICE_KEYBOARD)
       {
-         bool bind_valid = libretro_input_binds[port] && libretro_input_binds[port][id].valid;
+         rarch_joypad_info_t joypad_info;
+         joypad_info.axis_threshold = input_driver_axis_threshold;
+         joypad_info.joy_idx        = settings->uints.input_joypad_map[port];
+         joypad_info.auto_binds     = input_autoconf_binds[joypad_info.joy_idx];
 
-         if (bind_valid || device == RETRO_DEVICE_KEYBOARD)
+         if (!reset_state)
          {
-            rarch_joypad_info_t joypad_info;
-            joypad_info.axis_threshold = input_driver_axis_threshold;
-            joypad_info.joy_idx        = settings->uints.input_joypad_map[port];
-            joypad_info.auto_binds     = input_autoconf_binds[joypad_info.joy_idx];
-
-            if (!reset_state)
-            {
-               res = current_input->input_state(
-                     current_input_data, joypad_info, libretro_input_binds, port, device, idx, id);
+            res = current_input->input_state(
+                  current_input_data, joypad_info, libretro_input_binds, port, device, idx, id);
 
 #ifdef HAVE_OVERLAY
-               if (input_overlay_is_alive(overlay_ptr) && port == 0)
-                  res |= res_overlay;
+            if (input_overlay_is_alive(overlay_ptr) && port == 0)
+               res |= res_overlay;
 #endif
-            }
-            else
-               res = 0;
          }
+         else
+            res = 0;
       }
+   }
 
-      if (settings->bools.input_remap_binds_enable && input_driver_mapper)
-         input_mapper_state(input_driver_mapper,
-               &res, port, device, idx, id);
+   if (settings->bools.input_remap_binds_enable && input_driver_mapper)
+      input_mapper_state(input_driver_mapper,
+            &res, port, device, idx, id);
 
-      /* Don't allow turbo for D-pad. */
-      if (device == RETRO_DEVICE_JOYPAD && (id < RETRO_DEVICE_ID_JOYPAD_UP ||
-               id > RETRO_DEVICE_ID_JOYPAD_RIGHT))
+   return res;
+}
+
+/**
+ * input_state_turbo:
+ *
+ * Applies the turbo button to the state of a joypad button.
+ **/
+static int16_t input_state_turbo(settings_t *settings, unsigned port,
+      unsigned id, int16_t res)
+{
+   /* Don't allow turbo for D-pad. */
+   if (id >= RETRO_DEVICE_ID_JOYPAD_UP && id <= RETRO_DEVICE_ID_JOYPAD_RIGHT)
+      return res;
+
+   /*
+    * Apply turbo button if activated.
+    *
+    * If turbo button is held, all buttons pressed except
+    * for D-pad will go into a turbo mode. Until the button is
+    * released again, the input state will be modulated by a
+    * periodic pulse defined by the configured duty cycle.
+    */
+   if (res && input_driver_turbo_btns.frame_enable[port])
+      input_driver_turbo_btns.enable[port] |= (1 << id);
+   else if (!res)
+      input_driver_turbo_btns.enable[port] &= ~(1 << id);
+
+   if (input_driver_turbo_btns.enable[port] & (1 << id))
+   {
+      /* if turbo button is enabled for this key ID */
+      res = res && ((input_driver_turbo_btns.count
+               % settings->uints.input_turbo_period)
+            < settings->uints.input_turbo_duty_cycle);
+   }
+
+   return res;
+}
+
+/**
+ * input_driver_get_snapshot:
+ * @port                 : user number.
+ * @device               : RETRO_DEVICE_JOYPAD or RETRO_DEVICE_ANALOG.
+ *
+ * Returns the joypad buttons, with turbo applied, or the analog
+ * sticks of @port as of the last input_poll, building them on
+ * first use. The snapshot has no padding, so it can be hashed or
+ * compared as a whole.
+ *
+ * Returns: NULL if @port is out of range.
+ **/
+const input_snapshot_t *input_driver_get_snapshot(unsigned port,
+      unsigned device)
+{
+   input_snapshot_t *snapshot = NULL;
+   settings_t *settings       = NULL;
+   unsigned i;
+
+   if (port >= MAX_USERS)
+      return NULL;
+
+   snapshot = &input_driver_snapshot[port];
+   settings = config_get_ptr();
+
+   if (device == RETRO_DEVICE_JOYPAD && !snapshot->buttons_valid)
+   {
+      snapshot->buttons = 0;
+      for (i = 0; i <= RETRO_DEVICE_ID_JOYPAD_R3; i++)
       {
-         /*
-          * Apply turbo button if activated.
-          *
-          * If turbo button is held, all buttons pressed except
-          * for D-pad will go into a turbo mode. Until the button is
-          * released again, the input state will be modulated by a
-          * periodic pulse defined by the configured duty cycle.
-          */
-         if (res && input_driver_turbo_btns.frame_enable[port])
-            input_driver_turbo_btns.enable[port] |= (1 << id);
-         else if (!res)
-            input_driver_turbo_btns.enable[port] &= ~(1 << id);
-
-         if (input_driver_turbo_btns.enable[port] & (1 << id))
-         {
-            /* if turbo button is enabled for this key ID */
-            res = res && ((input_driver_turbo_btns.count
-                     % settings->uints.input_turbo_period)
-                  < settings->uints.input_turbo_duty_cycle);
-         }
+         int16_t res = input_state_turbo(settings, port, i,
+               input_state_raw(settings, port,
+                  RETRO_DEVICE_JOYPAD, 0, i));
+         if (res)
+            snapshot->buttons |= 1 << i;
+      }
+      snapshot->buttons_valid = 1;
+   }
+   else if (device == RETRO_DEVICE_ANALOG && !snapshot->analog_valid)
+   {
+      for (i = 0; i < 4; i++)
+         snapshot->analog[i] = input_state_raw(settings, port,
+               RETRO_DEVICE_ANALOG, i >> 1, i & 1);
+      snapshot->analog_valid = 1;
+   }
+
+   return snapshot;
+}
+
+/**
+ * input_state:
+ * @port                 : user number.
+ * @device               : device identifier of user.
+ * @idx                  : index value of user.
+ * @id                   : identifier of key pressed by user.
+ *
+ * Input state callback function.
+ *
+ * Joypad buttons and analog sticks are answered from the per-port
+ * snapshot, everything else queries the drivers.
+ *
+ * Returns: Non-zero if the given key (identified by @id)
+ * was pressed by the user (assigned to @port).
+ **/
+int16_t input_state(unsigned port, unsigned device,
+      unsigned idx, unsigned id)
+{
+   int16_t res         = 0;
+
+   device &= RETRO_DEVICE_MASK;
+
+   if (bsv_movie_is_playback_on())
+   {
+      int16_t bsv_result;
+      if (bsv_movie_get_input(&bsv_result))
+         return bsv_result;
+
+      bsv_movie_ctl(BSV_MOVIE_CTL_SET_END, NULL);
+   }
+
+   if (     !input_driver_flushing_input
+         && !input_driver_block_libretro_input)
+   {
+      if (port < MAX_USERS && device == RETRO_DEVICE_JOYPAD
+            && id <= RETRO_DEVICE_ID_JOYPAD_R3)
+         res = (input_driver_get_snapshot(port, device)->buttons >> id) & 1;
+      else if (port < MAX_USERS && device == RETRO_DEVICE_ANALOG
+            && idx < 2 && id < 2)
+         res = input_driver_get_snapshot(port, device)->analog[idx * 2 + id];
+      else
+      {
+         settings_t *settings = config_get_ptr();
+
+         res = input_state_raw(settings, port, device, idx, id);
+
+         if (device == RETRO_DEVICE_JOYPAD && id < 16)
+            res = input_state_turbo(settings, port, id, res);
       }
    }
 
@@ -778,6 +886,24 @@ int16_t input_state(unsigned port, unsigned device,
    return res;
 }
 
+/**
+ * input_state_uncached:
+ *
+ * Same as input_state(), but bypasses the snapshot, turbo and
+ * BSV movies. For frontend code that looks at the input while
+ * it is being polled, such as the overlay.
+ **/
+int16_t input_state_uncached(unsigned port, unsigned device,
+      unsigned idx, unsigned id)
+{
+   if (     input_driver_flushing_input
+         || input_driver_block_libretro_input)
+      return 0;
+
+   return input_state_raw(config_get_ptr(), port,
+         device & RETRO_DEVICE_MASK, idx, id);
+}
+
 /**
  * state_tracker_update_input:
  *
@@ -294,6 +294,16 @@ float input_sensor_get_input(unsigned port, unsigned id);
    } \
 }
 
+/* Input of one port for the current frame, with remapping and
+ * turbo applied. */
+typedef struct input_snapshot
+{
+   uint16_t buttons;       /* RETRO_DEVICE_ID_JOYPAD_* bitmask */
+   uint8_t buttons_valid;
+   uint8_t analog_valid;
+   int16_t analog[4];      /* left x, left y, right x, right y */
+} input_snapshot_t;
+
 /**
  * input_poll:
  *
@@ -301,6 +311,9 @@ float input_sensor_get_input(unsigned port, unsigned id);
  **/
 void input_poll(void);
 
+const input_snapshot_t *input_driver_get_snapshot(unsigned port,
+      unsigned device);
+
 /**
  * input_state:
  * @port                 : user number.
@@ -316,6 +329,9 @@ void input_poll(void);
 int16_t input_state(unsigned port, unsigned device,
       unsigned idx, unsigned id);
 
+int16_t input_state_uncached(unsigned port, unsigned device,
+      unsigned idx, unsigned id);
+
 void input_keys_pressed(void *data, input_bits_t* new_state);
 
 #ifdef HAVE_MENU
@@ -105,7 +105,7 @@ static bool input_overlay_add_inputs_inner(overlay_desc_t *desc,
                   if (bank_mask & 1)
                   {
                      /* Light up the button if pressed */
-                     if (!input_state(port, RETRO_DEVICE_JOYPAD, 0, id))
+                     if (!input_state_uncached(port, RETRO_DEVICE_JOYPAD, 0, id))
                      {
                         /* We need ALL of the inputs to be active,
                          * abort. */
@@ -131,9 +131,9 @@ static bool input_overlay_add_inputs_inner(overlay_desc_t *desc,
             unsigned int index = (desc->type == OVERLAY_TYPE_ANALOG_RIGHT) ?
                RETRO_DEVICE_INDEX_ANALOG_RIGHT : RETRO_DEVICE_INDEX_ANALOG_LEFT;
 
-            float analog_x     = input_state(port, RETRO_DEVICE_ANALOG,
+            float analog_x     = input_state_uncached(port, RETRO_DEVICE_ANALOG,
                   index, RETRO_DEVICE_ID_ANALOG_X);
-            float analog_y     = input_state(port, RETRO_DEVICE_ANALOG,
+            float analog_y     = input_state_uncached(port, RETRO_DEVICE_ANALOG,
                   index, RETRO_DEVICE_ID_ANALOG_Y);
             float dx           = (analog_x/0x8000)*(desc->range_x/2);
             float dy           = (analog_y/0x8000)*(desc->range_y/2);
@@ -150,7 +150,7 @@ static bool input_overlay_add_inputs_inner(overlay_desc_t *desc,
          break;
 
       case OVERLAY_TYPE_KEYBOARD:
-         if (input_state(port, RETRO_DEVICE_KEYBOARD, 0, desc->retro_key_idx))
+         if (input_state_uncached(port, RETRO_DEVICE_KEYBOARD, 0, desc->retro_key_idx))
          {
             desc->updated  = true;
             return true;
@@ -1125,6 +1125,8 @@ MSG_HASH(MENU_ENUM_LABEL_TAKE_SCREENSHOT,
       "take_screenshot")
 MSG_HASH(MENU_ENUM_LABEL_THREADED_DATA_RUNLOOP_ENABLE,
       "threaded_data_runloop_enable")
+MSG_HASH(MENU_ENUM_LABEL_TASK_QUEUE_WORKERS,
+      "task_queue_workers")
 MSG_HASH(MENU_ENUM_LABEL_THUMBNAILS,
       "thumbnails")
 MSG_HASH(MENU_ENUM_LABEL_LEFT_THUMBNAILS,
@@ -2966,6 +2966,10 @@ MSG_HASH(
     MENU_ENUM_LABEL_VALUE_THREADED_DATA_RUNLOOP_ENABLE,
     "Threaded tasks"
     )
+MSG_HASH(
+    MENU_ENUM_LABEL_VALUE_TASK_QUEUE_WORKERS,
+    "Task worker threads"
+    )
 MSG_HASH(
     MENU_ENUM_LABEL_VALUE_THUMBNAILS,
     "Thumbnails"
@@ -6003,6 +6007,10 @@ MSG_HASH(
     MENU_ENUM_SUBLABEL_THREADED_DATA_RUNLOOP_ENABLE,
     "Perform tasks on a separate thread."
     )
+MSG_HASH(
+    MENU_ENUM_SUBLABEL_TASK_QUEUE_WORKERS,
+    "Number of threads that run tasks concurrently. Takes effect after a restart."
+    )
 MSG_HASH(
     MENU_ENUM_SUBLABEL_PLAYLIST_ENTRY_REMOVE,
     "Allow the user to remove entries from playlists."
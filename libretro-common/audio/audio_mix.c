@@ -28,16 +28,47 @@
 #include <altivec.h>
 #endif
 
+#if (defined(__ARM_NEON__) || defined(__aarch64__)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define AUDIO_MIX_NEON
+#include <arm_neon.h>
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <boolean.h>
 #include <memalign.h>
 #include <retro_miscellaneous.h>
 #include <audio/audio_mix.h>
+#include <features/features_cpu.h>
 #include <streams/file_stream.h>
 #include <audio/conversion/float_to_s16.h>
 #include <audio/conversion/s16_to_float.h>
 
+/* The AVX2 kernels are compiled per function, so the baseline
+ * build flags stay untouched. They only run once
+ * audio_mix_init_simd() has found support for them on this CPU. */
+#if defined(__SSE2__) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define AUDIO_MIX_X86_DISPATCH
+#define AUDIO_MIX_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+
+static bool audio_mix_avx2_enabled = false;
+#endif
+
+/**
+ * audio_mix_init_simd:
+ *
+ * Enables the AVX2 variants of the mixing functions when
+ * the CPU supports them. Safe to call more than once.
+ **/
+void audio_mix_init_simd(void)
+{
+#ifdef AUDIO_MIX_X86_DISPATCH
+   audio_mix_avx2_enabled = (cpu_features_get() & RETRO_SIMD_AVX2) != 0;
+#endif
+}
+
 void audio_mix_volume_C(float *out, const float *in, float vol, size_t samples)
 {
    size_t i;
@@ -75,6 +106,152 @@ void audio_mix_volume_SSE2(float *out, const float *in, float vol, size_t sample
 }
 #endif
 
+#ifdef AUDIO_MIX_X86_DISPATCH
+/* Multiply and add are kept separate rather than fused, so the
+ * result matches the SSE2 and C paths bit for bit. */
+AUDIO_MIX_TARGET("avx2")
+static size_t audio_mix_volume_AVX2(float *out,
+      const float *in, float vol, size_t samples)
+{
+   size_t i;
+   __m256 volume = _mm256_set1_ps(vol);
+
+   for (i = 0; i + 32 <= samples; i += 32)
+   {
+      __m256 a0 = _mm256_mul_ps(volume, _mm256_loadu_ps(in + i +  0));
+      __m256 a1 = _mm256_mul_ps(volume, _mm256_loadu_ps(in + i +  8));
+      __m256 a2 = _mm256_mul_ps(volume, _mm256_loadu_ps(in + i + 16));
+      __m256 a3 = _mm256_mul_ps(volume, _mm256_loadu_ps(in + i + 24));
+
+      _mm256_storeu_ps(out + i +  0, _mm256_add_ps(_mm256_loadu_ps(out + i +  0), a0));
+      _mm256_storeu_ps(out + i +  8, _mm256_add_ps(_mm256_loadu_ps(out + i +  8), a1));
+      _mm256_storeu_ps(out + i + 16, _mm256_add_ps(_mm256_loadu_ps(out + i + 16), a2));
+      _mm256_storeu_ps(out + i + 24, _mm256_add_ps(_mm256_loadu_ps(out + i + 24), a3));
+   }
+
+   for (; i + 8 <= samples; i += 8)
+      _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i),
+               _mm256_mul_ps(volume, _mm256_loadu_ps(in + i))));
+
+   return i;
+}
+
+AUDIO_MIX_TARGET("avx2")
+static size_t audio_mix_clamp_AVX2(float *buf, size_t samples)
+{
+   size_t i;
+   __m256 lo = _mm256_set1_ps(-1.0f);
+   __m256 hi = _mm256_set1_ps( 1.0f);
+
+   for (i = 0; i + 8 <= samples; i += 8)
+      _mm256_storeu_ps(buf + i, _mm256_min_ps(hi,
+               _mm256_max_ps(lo, _mm256_loadu_ps(buf + i))));
+
+   return i;
+}
+#endif
+
+#ifdef AUDIO_MIX_NEON
+static size_t audio_mix_volume_NEON(float *out,
+      const float *in, float vol, size_t samples)
+{
+   size_t i;
+
+   for (i = 0; i + 16 <= samples; i += 16)
+   {
+      float32x4_t a0 = vld1q_f32(in + i +  0);
+      float32x4_t a1 = vld1q_f32(in + i +  4);
+      float32x4_t a2 = vld1q_f32(in + i +  8);
+      float32x4_t a3 = vld1q_f32(in + i + 12);
+
+      vst1q_f32(out + i +  0, vaddq_f32(vld1q_f32(out + i +  0), vmulq_n_f32(a0, vol)));
+      vst1q_f32(out + i +  4, vaddq_f32(vld1q_f32(out + i +  4), vmulq_n_f32(a1, vol)));
+      vst1q_f32(out + i +  8, vaddq_f32(vld1q_f32(out + i +  8), vmulq_n_f32(a2, vol)));
+      vst1q_f32(out + i + 12, vaddq_f32(vld1q_f32(out + i + 12), vmulq_n_f32(a3, vol)));
+   }
+
+   return i;
+}
+
+static size_t audio_mix_clamp_NEON(float *buf, size_t samples)
+{
+   size_t i;
+   float32x4_t lo = vdupq_n_f32(-1.0f);
+   float32x4_t hi = vdupq_n_f32( 1.0f);
+
+   for (i = 0; i + 4 <= samples; i += 4)
+      vst1q_f32(buf + i, vminq_f32(hi, vmaxq_f32(lo, vld1q_f32(buf + i))));
+
+   return i;
+}
+#endif
+
+/**
+ * audio_mix_volume:
+ * @out              : buffer to mix into
+ * @in               : samples to add
+ * @vol              : gain applied to @in
+ * @samples          : number of samples
+ *
+ * Adds @in scaled by @vol to @out, using the widest
+ * vector unit available.
+ **/
+void audio_mix_volume(float *out, const float *in, float vol, size_t samples)
+{
+   size_t i = 0;
+
+#if defined(AUDIO_MIX_X86_DISPATCH)
+   if (audio_mix_avx2_enabled)
+      i = audio_mix_volume_AVX2(out, in, vol, samples);
+#elif defined(AUDIO_MIX_NEON)
+   i = audio_mix_volume_NEON(out, in, vol, samples);
+#endif
+
+#ifdef __SSE2__
+   audio_mix_volume_SSE2(out + i, in + i, vol, samples - i);
+#else
+   audio_mix_volume_C(out + i, in + i, vol, samples - i);
+#endif
+}
+
+/**
+ * audio_mix_clamp:
+ * @buf              : samples to clamp
+ * @samples          : number of samples
+ *
+ * Clamps mixed samples to the [-1.0, 1.0] range.
+ **/
+void audio_mix_clamp(float *buf, size_t samples)
+{
+   size_t i = 0;
+
+#if defined(AUDIO_MIX_X86_DISPATCH)
+   if (audio_mix_avx2_enabled)
+      i = audio_mix_clamp_AVX2(buf, samples);
+#elif defined(AUDIO_MIX_NEON)
+   i = audio_mix_clamp_NEON(buf, samples);
+#endif
+
+#ifdef __SSE2__
+   {
+      __m128 lo = _mm_set1_ps(-1.0f);
+      __m128 hi = _mm_set1_ps( 1.0f);
+
+      for (; i + 4 <= samples; i += 4)
+         _mm_storeu_ps(buf + i, _mm_min_ps(hi,
+                  _mm_max_ps(lo, _mm_loadu_ps(buf + i))));
+   }
+#endif
+
+   for (; i < samples; i++)
+   {
+      if (buf[i] < -1.0f)
+         buf[i] = -1.0f;
+      else if (buf[i] > 1.0f)
+         buf[i] = 1.0f;
+   }
+}
+
 void audio_mix_free_chunk(audio_chunk_t *chunk)
 {
    if (!chunk)
@@ -21,6 +21,7 @@
  */
 
 #include <audio/audio_mixer.h>
+#include <audio/audio_mix.h>
 #include <audio/audio_resampler.h>
 
 #include <formats/rwav.h>
@@ -306,6 +307,8 @@ void audio_mixer_init(unsigned rate)
 
    s_rate = rate;
 
+   audio_mix_init_simd();
+
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
       s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
 }
@@ -853,7 +856,6 @@ static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
    unsigned buf_free                = (unsigned)(num_frames * 2);
    const audio_mixer_sound_t* sound = voice->sound;
    unsigned pcm_available           = sound->types.wav.frames
@@ -864,8 +866,9 @@ static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
 again:
    if (pcm_available < buf_free)
    {
-      for (i = pcm_available; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, pcm_available);
+      buffer += pcm_available;
+      pcm    += pcm_available;
 
       if (voice->repeat)
       {
@@ -886,8 +889,9 @@ again:
    }
    else
    {
-      for (i = buf_free; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, buf_free);
+      buffer += buf_free;
+      pcm    += buf_free;
 
       voice->types.wav.position += buf_free;
    }
@@ -898,7 +902,6 @@ static void audio_mixer_mix_ogg(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
    struct resampler_data info = { 0 };
    float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
    unsigned buf_free                = (unsigned)(num_frames * 2);
@@ -952,17 +955,18 @@ again:
 
    if (voice->types.ogg.samples < buf_free)
    {
-      for (i = voice->types.ogg.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, voice->types.ogg.samples);
+      buffer += voice->types.ogg.samples;
+      pcm    += voice->types.ogg.samples;
 
       buf_free -= voice->types.ogg.samples;
       goto again;
    }
    else
    {
-      int i;
-      for (i = buf_free; i != 0; --i )
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, buf_free);
+      buffer += buf_free;
+      pcm    += buf_free;
 
       voice->types.ogg.position += buf_free;
       voice->types.ogg.samples  -= buf_free;
@@ -1050,7 +1054,6 @@ static void audio_mixer_mix_flac(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
    struct resampler_data info = { 0 };
    float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
    unsigned buf_free                = (unsigned)(num_frames * 2);
@@ -1101,17 +1104,18 @@ again:
 
    if (voice->types.flac.samples < buf_free)
    {
-      for (i = voice->types.flac.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, voice->types.flac.samples);
+      buffer += voice->types.flac.samples;
+      pcm    += voice->types.flac.samples;
 
       buf_free -= voice->types.flac.samples;
       goto again;
    }
    else
    {
-      int i;
-      for (i = buf_free; i != 0; --i )
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, buf_free);
+      buffer += buf_free;
+      pcm    += buf_free;
 
       voice->types.flac.position += buf_free;
       voice->types.flac.samples  -= buf_free;
@@ -1124,7 +1128,6 @@ static void audio_mixer_mix_mp3(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
    struct resampler_data info = { 0 };
    float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
    unsigned buf_free                = (unsigned)(num_frames * 2);
@@ -1174,17 +1177,18 @@ again:
 
    if (voice->types.mp3.samples < buf_free)
    {
-      for (i = voice->types.mp3.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, voice->types.mp3.samples);
+      buffer += voice->types.mp3.samples;
+      pcm    += voice->types.mp3.samples;
 
       buf_free -= voice->types.mp3.samples;
       goto again;
    }
    else
    {
-      int i;
-      for (i = buf_free; i != 0; --i )
-         *buffer++ += *pcm++ * volume;
+      audio_mix_volume(buffer, pcm, volume, buf_free);
+      buffer += buf_free;
+      pcm    += buf_free;
 
       voice->types.mp3.position += buf_free;
       voice->types.mp3.samples  -= buf_free;
@@ -1195,8 +1199,6 @@ again:
 void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bool override)
 {
    unsigned i;
-   size_t j                   = 0;
-   float* sample              = NULL;
    audio_mixer_voice_t* voice = s_voices;
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
@@ -1233,13 +1235,7 @@ void audio_mixer_mix(float* buffer, size_t num_frames, float volume_override, bo
       }
    }
 
-   for (j = 0, sample = buffer; j < num_frames; j++, sample++)
-   {
-      if (*sample < -1.0f)
-         *sample = -1.0f;
-      else if (*sample > 1.0f)
-         *sample = 1.0f;
-   }
+   audio_mix_clamp(buffer, num_frames * 2);
 }
 
 float audio_mixer_voice_get_volume(audio_mixer_voice_t *voice)
@@ -68,6 +68,7 @@ enum sinc_window
 typedef struct rarch_sinc_resampler
 {
    unsigned enable_avx;
+   unsigned enable_fma;
    unsigned phase_bits;
    unsigned subphase_bits;
    unsigned subphase_mask;
@@ -94,6 +95,28 @@ typedef struct rarch_sinc_resampler
 #endif
 #endif
 
+/* The FMA kernel is compiled per function, so the baseline build
+ * flags stay untouched. It is only selected when the CPU reports
+ * AVX2, and every AVX2 part also implements FMA3. */
+#if defined(__SSE2__) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SINC_X86_DISPATCH
+#define SINC_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#endif
+
+/* Unlike the assembly kernel, the intrinsics kernel also handles
+ * the Kaiser (interpolated) tables and builds for AArch64. */
+#if (defined(__ARM_NEON__) || defined(__aarch64__)) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define SINC_NEON_INTRINSICS
+#include <arm_neon.h>
+
+#if defined(__ARM_FEATURE_FMA)
+#define SINC_NEON_MLA(acc, a, b) vfmaq_f32(acc, a, b)
+#else
+#define SINC_NEON_MLA(acc, a, b) vmlaq_f32(acc, a, b)
+#endif
+#endif
+
 #ifdef WANT_NEON
 /* Assumes that taps >= 8, and that taps is a multiple of 8. */
 void process_sinc_neon_asm(float *out, const float *left,
@@ -249,6 +272,217 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 }
 #endif
 
+#ifdef SINC_X86_DISPATCH
+SINC_TARGET("avx2,fma")
+static void resampler_sinc_process_fma(void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+         resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+         resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      while (resamp->time < phases)
+      {
+         unsigned i;
+         __m128 res_l, res_r;
+         __m256 sum_l             = _mm256_setzero_ps();
+         __m256 sum_r             = _mm256_setzero_ps();
+         __m256 sum_l2            = _mm256_setzero_ps();
+         __m256 sum_r2            = _mm256_setzero_ps();
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         unsigned phase           = resamp->time >> resamp->subphase_bits;
+
+         if (resamp->window_type == SINC_WINDOW_KAISER)
+         {
+            const float *phase_table = resamp->phase_table + phase * taps * 2;
+            const float *delta_table = phase_table + taps;
+            __m256 delta             = _mm256_set1_ps((float)
+                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+
+            /* Two accumulators per channel hide the FMA latency. */
+            for (i = 0; i + 16 <= taps; i += 16)
+            {
+               __m256 sinc  = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i),
+                     delta, _mm256_load_ps(phase_table + i));
+               __m256 sinc2 = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i + 8),
+                     delta, _mm256_load_ps(phase_table + i + 8));
+
+               sum_l  = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i),     sinc,  sum_l);
+               sum_r  = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i),     sinc,  sum_r);
+               sum_l2 = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i + 8), sinc2, sum_l2);
+               sum_r2 = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i + 8), sinc2, sum_r2);
+            }
+
+            if (i < taps)
+            {
+               __m256 sinc  = _mm256_fmadd_ps(_mm256_load_ps(delta_table + i),
+                     delta, _mm256_load_ps(phase_table + i));
+
+               sum_l  = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r  = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+            }
+         }
+         else
+         {
+            const float *phase_table = resamp->phase_table + phase * taps;
+
+            for (i = 0; i < taps; i += 8)
+            {
+               __m256 sinc  = _mm256_load_ps(phase_table + i);
+
+               sum_l  = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r  = _mm256_fmadd_ps(_mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+            }
+         }
+
+         sum_l     = _mm256_add_ps(sum_l, sum_l2);
+         sum_r     = _mm256_add_ps(sum_r, sum_r2);
+
+         /* Fold both halves, then hadd { l, l, r, r } down to { L, R, L, R }. */
+         res_l     = _mm_add_ps(_mm256_castps256_ps128(sum_l),
+               _mm256_extractf128_ps(sum_l, 1));
+         res_r     = _mm_add_ps(_mm256_castps256_ps128(sum_r),
+               _mm256_extractf128_ps(sum_r, 1));
+         res_l     = _mm_hadd_ps(res_l, res_r);
+         res_l     = _mm_hadd_ps(res_l, res_l);
+
+         _mm_storel_pi((__m64*)output, res_l);
+
+         output += 2;
+         out_frames++;
+         resamp->time += ratio;
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
+#ifdef SINC_NEON_INTRINSICS
+/* Assumes that taps is a multiple of 8. */
+static void resampler_sinc_process_neon_intrinsics(void *re_,
+      struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+         resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+         resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      while (resamp->time < phases)
+      {
+         unsigned i;
+         float32x2_t res_l, res_r;
+         float32x4_t sum_l        = vdupq_n_f32(0.0f);
+         float32x4_t sum_r        = vdupq_n_f32(0.0f);
+         float32x4_t sum_l2       = vdupq_n_f32(0.0f);
+         float32x4_t sum_r2       = vdupq_n_f32(0.0f);
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         unsigned phase           = resamp->time >> resamp->subphase_bits;
+
+         if (resamp->window_type == SINC_WINDOW_KAISER)
+         {
+            const float *phase_table = resamp->phase_table + phase * taps * 2;
+            const float *delta_table = phase_table + taps;
+            float32x4_t delta        = vdupq_n_f32((float)
+                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+
+            for (i = 0; i < taps; i += 8)
+            {
+               float32x4_t sinc  = SINC_NEON_MLA(vld1q_f32(phase_table + i),
+                     vld1q_f32(delta_table + i), delta);
+               float32x4_t sinc2 = SINC_NEON_MLA(vld1q_f32(phase_table + i + 4),
+                     vld1q_f32(delta_table + i + 4), delta);
+
+               sum_l  = SINC_NEON_MLA(sum_l,  vld1q_f32(buffer_l + i),     sinc);
+               sum_r  = SINC_NEON_MLA(sum_r,  vld1q_f32(buffer_r + i),     sinc);
+               sum_l2 = SINC_NEON_MLA(sum_l2, vld1q_f32(buffer_l + i + 4), sinc2);
+               sum_r2 = SINC_NEON_MLA(sum_r2, vld1q_f32(buffer_r + i + 4), sinc2);
+            }
+         }
+         else
+         {
+            const float *phase_table = resamp->phase_table + phase * taps;
+
+            for (i = 0; i < taps; i += 8)
+            {
+               float32x4_t sinc  = vld1q_f32(phase_table + i);
+               float32x4_t sinc2 = vld1q_f32(phase_table + i + 4);
+
+               sum_l  = SINC_NEON_MLA(sum_l,  vld1q_f32(buffer_l + i),     sinc);
+               sum_r  = SINC_NEON_MLA(sum_r,  vld1q_f32(buffer_r + i),     sinc);
+               sum_l2 = SINC_NEON_MLA(sum_l2, vld1q_f32(buffer_l + i + 4), sinc2);
+               sum_r2 = SINC_NEON_MLA(sum_r2, vld1q_f32(buffer_r + i + 4), sinc2);
+            }
+         }
+
+         sum_l = vaddq_f32(sum_l, sum_l2);
+         sum_r = vaddq_f32(sum_r, sum_r2);
+         res_l = vadd_f32(vget_low_f32(sum_l), vget_high_f32(sum_l));
+         res_r = vadd_f32(vget_low_f32(sum_r), vget_high_f32(sum_r));
+
+         /* { l0 + l1, r0 + r1 } */
+         vst1_f32(output, vpadd_f32(res_l, res_r));
+
+         output += 2;
+         out_frames++;
+         resamp->time += ratio;
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
 #if defined(__SSE__)
 static void resampler_sinc_process_sse(void *re_, struct resampler_data *data)
 {
@@ -639,14 +873,23 @@ static void *resampler_sinc_new(const struct resampler_config *config,
       re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
    }
 
+#ifdef SINC_X86_DISPATCH
+   /* The Lanczos qualities have too few taps for 8-wide FMA
+    * to pay off over SSE. */
+   if (mask & RESAMPLER_SIMD_AVX2 && re->window_type == SINC_WINDOW_KAISER)
+      re->enable_fma = 1;
+#endif
+
    /* Be SIMD-friendly. */
+   if (re->enable_fma)
+      re->taps     = (re->taps + 7) & ~7;
 #if defined(__AVX__)
-   if (re->enable_avx)
-      re->taps  = (re->taps + 7) & ~7;
-   else
+   else if (re->enable_avx)
+      re->taps     = (re->taps + 7) & ~7;
 #endif
+   else
    {
-#if defined(WANT_NEON)
+#if defined(WANT_NEON) || defined(SINC_NEON_INTRINSICS)
       re->taps     = (re->taps + 7) & ~7;
 #else
       re->taps     = (re->taps + 3) & ~3;
@@ -684,24 +927,36 @@ static void *resampler_sinc_new(const struct resampler_config *config,
 
    sinc_resampler.process = resampler_sinc_process_c;
 
-   if (mask & RESAMPLER_SIMD_AVX && re->enable_avx)
+   if (re->enable_fma)
    {
+#ifdef SINC_X86_DISPATCH
+      sinc_resampler.process = resampler_sinc_process_fma;
+#endif
+   }
 #if defined(__AVX__)
+   else if (mask & RESAMPLER_SIMD_AVX && re->enable_avx)
       sinc_resampler.process = resampler_sinc_process_avx;
 #endif
-   }
    else if (mask & RESAMPLER_SIMD_SSE)
    {
 #if defined(__SSE__)
       sinc_resampler.process = resampler_sinc_process_sse;
 #endif
    }
-   else if (mask & RESAMPLER_SIMD_NEON && re->window_type != SINC_WINDOW_KAISER)
-   {
 #if defined(WANT_NEON)
+   else if (mask & RESAMPLER_SIMD_NEON && re->window_type != SINC_WINDOW_KAISER)
       sinc_resampler.process = resampler_sinc_process_neon;
 #endif
+#if defined(SINC_NEON_INTRINSICS)
+   else
+   {
+      /* Advanced SIMD is mandatory on AArch64. */
+#if !defined(__aarch64__)
+      if (mask & RESAMPLER_SIMD_NEON)
+#endif
+         sinc_resampler.process = resampler_sinc_process_neon_intrinsics;
    }
+#endif
 
    return re;
 
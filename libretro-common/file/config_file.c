@@ -46,17 +46,24 @@
 #include <file/config_file.h>
 #include <file/file_path.h>
 #include <lists/string_list.h>
+#include <rhash.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 
 #define MAX_INCLUDE_DEPTH 16
 
+/* Initial number of slots in the key index, must be a power of two. */
+#define CONFIG_INDEX_MIN_SIZE 64
+
 struct config_entry_list
 {
    /* If we got this from an #include,
     * do not allow overwrite. */
    bool readonly;
 
+   /* djb2 hash of key */
+   uint32_t hash;
+
    char *key;
    char *value;
    struct config_entry_list *next;
@@ -71,6 +78,128 @@ struct config_include_list
 static config_file_t *config_file_new_internal(
       const char *path, unsigned depth, config_file_cb_t *cb);
 
+/* Returns the index slot holding key, or the empty slot
+ * where it would be inserted. */
+static size_t config_index_slot(const config_file_t *conf,
+      const char *key, uint32_t hash)
+{
+   size_t mask = conf->index_size - 1;
+   size_t i    = hash & mask;
+
+   while (conf->index[i])
+   {
+      const struct config_entry_list *entry = conf->index[i];
+
+      if (entry->hash == hash && string_is_equal(entry->key, key))
+         break;
+
+      i = (i + 1) & mask;
+   }
+
+   return i;
+}
+
+static bool config_index_resize(config_file_t *conf, size_t size)
+{
+   size_t i;
+   struct config_entry_list **old_index = conf->index;
+   size_t old_size                      = conf->index_size;
+   struct config_entry_list **index     = (struct config_entry_list**)
+      calloc(size, sizeof(*index));
+
+   if (!index)
+      return false;
+
+   conf->index      = index;
+   conf->index_size = size;
+
+   for (i = 0; i < old_size; i++)
+   {
+      struct config_entry_list *entry = old_index[i];
+      if (entry)
+         conf->index[config_index_slot(conf, entry->key, entry->hash)] = entry;
+   }
+
+   free(old_index);
+   return true;
+}
+
+/* Indexes entry unless an entry with the same key is already
+ * indexed, since lookups return the first entry in the list. */
+static void config_index_add(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   size_t i;
+
+   if (!entry->key)
+      return;
+
+   entry->hash = djb2_calculate(entry->key);
+
+   /* Keep the load factor under 3/4 */
+   if ((conf->index_count + 1) * 4 > conf->index_size * 3)
+   {
+      size_t size = conf->index_size
+         ? conf->index_size * 2 : CONFIG_INDEX_MIN_SIZE;
+      if (!config_index_resize(conf, size))
+         return;
+   }
+
+   i = config_index_slot(conf, entry->key, entry->hash);
+
+   if (conf->index[i])
+      return;
+
+   conf->index[i] = entry;
+   conf->index_count++;
+}
+
+/* Removes slot i, shifting back the entries of its probe sequence. */
+static void config_index_remove_slot(config_file_t *conf, size_t i)
+{
+   size_t mask = conf->index_size - 1;
+   size_t j    = i;
+
+   conf->index[i] = NULL;
+   conf->index_count--;
+
+   for (;;)
+   {
+      size_t home;
+      struct config_entry_list *entry = NULL;
+
+      j     = (j + 1) & mask;
+      entry = conf->index[j];
+
+      if (!entry)
+         break;
+
+      home = entry->hash & mask;
+
+      /* Move entry into the hole if the hole lies between
+       * its home slot and its current slot (cyclically). */
+      if ((j > i && (home <= i || home > j)) ||
+          (j < i && (home <= i && home > j)))
+      {
+         conf->index[i] = entry;
+         conf->index[j] = NULL;
+         i              = j;
+      }
+   }
+}
+
+static void config_index_rebuild(config_file_t *conf)
+{
+   struct config_entry_list *entry = NULL;
+
+   if (conf->index)
+      memset(conf->index, 0, conf->index_size * sizeof(*conf->index));
+   conf->index_count = 0;
+
+   for (entry = conf->entries; entry; entry = entry->next)
+      config_index_add(conf, entry);
+}
+
 static int config_sort_compare_func(struct config_entry_list *a,
       struct config_entry_list *b)
 {
@@ -254,6 +383,9 @@ static void add_child_list(config_file_t *parent, config_file_t *child)
       parent->entries   = child->entries;
    }
 
+   for (list = child->entries; list; list = list->next)
+      config_index_add(parent, list);
+
    child->entries = NULL;
 
    /* Rebase tail. */
@@ -413,6 +545,9 @@ static config_file_t *config_file_new_internal(
    conf->includes                 = NULL;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false ;
+   conf->index                    = NULL;
+   conf->index_size               = 0;
+   conf->index_count              = 0;
 
    if (!path || !*path)
       return conf;
@@ -469,6 +604,8 @@ static config_file_t *config_file_new_internal(
 
          conf->tail = list;
 
+         config_index_add(conf, list);
+
          if (cb != NULL && list->key != NULL && list->value != NULL)
             cb->config_file_new_entry_cb(list->key, list->value) ;
       }
@@ -527,6 +664,7 @@ void config_file_free(config_file_t *conf)
 
    if (conf->path)
       free(conf->path);
+   free(conf->index);
    free(conf);
 }
 
@@ -538,9 +676,14 @@ bool config_append_file(config_file_t *conf, const char *path)
 
    if (new_conf->tail)
    {
+      if (!conf->entries)
+         conf->tail        = new_conf->tail;
       new_conf->tail->next = conf->entries;
       conf->entries        = new_conf->entries; /* Pilfer. */
       new_conf->entries    = NULL;
+
+      /* Prepended entries take priority */
+      config_index_rebuild(conf);
    }
 
    config_file_free(new_conf);
@@ -555,9 +698,6 @@ config_file_t *config_file_new_from_string(const char *from_string)
    if (!conf)
       return NULL;
 
-   if (!from_string)
-      return conf;
-
    conf->path                     = NULL;
    conf->entries                  = NULL;
    conf->tail                     = NULL;
@@ -565,6 +705,12 @@ config_file_t *config_file_new_from_string(const char *from_string)
    conf->includes                 = NULL;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false ;
+   conf->index                    = NULL;
+   conf->index_size               = 0;
+   conf->index_count              = 0;
+
+   if (!from_string)
+      return conf;
 
    lines = string_split(from_string, "\n");
    if (!lines)
@@ -597,6 +743,8 @@ config_file_t *config_file_new_from_string(const char *from_string)
                conf->entries = list;
 
             conf->tail = list;
+
+            config_index_add(conf, list);
          }
       }
 
@@ -619,28 +767,17 @@ config_file_t *config_file_new(const char *path)
 }
 
 static struct config_entry_list *config_get_entry(const config_file_t *conf,
-      const char *key, struct config_entry_list **prev)
+      const char *key)
 {
-   struct config_entry_list *entry    = NULL;
-   struct config_entry_list *previous = prev ? *prev : NULL;
-
-   for (entry = conf->entries; entry; entry = entry->next)
-   {
-      if (string_is_equal(key, entry->key))
-         return entry;
-
-      previous = entry;
-   }
-
-   if (prev)
-      *prev = previous;
+   if (!conf->index || !key)
+      return NULL;
 
-   return NULL;
+   return conf->index[config_index_slot(conf, key, djb2_calculate(key))];
 }
 
 bool config_get_double(config_file_t *conf, const char *key, double *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -653,7 +790,7 @@ bool config_get_double(config_file_t *conf, const char *key, double *in)
 
 bool config_get_float(config_file_t *conf, const char *key, float *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -666,7 +803,7 @@ bool config_get_float(config_file_t *conf, const char *key, float *in)
 
 bool config_get_int(config_file_t *conf, const char *key, int *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -685,7 +822,7 @@ bool config_get_int(config_file_t *conf, const char *key, int *in)
 
 bool config_get_size_t(config_file_t *conf, const char *key, size_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -704,7 +841,7 @@ bool config_get_size_t(config_file_t *conf, const char *key, size_t *in)
 #if defined(__STDC_VERSION__) && __STDC_VERSION__>=199901L
 bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -723,7 +860,7 @@ bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 
 bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -742,7 +879,7 @@ bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -761,7 +898,7 @@ bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_char(config_file_t *conf, const char *key, char *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -777,7 +914,7 @@ bool config_get_char(config_file_t *conf, const char *key, char *in)
 
 bool config_get_string(config_file_t *conf, const char *key, char **str)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -798,7 +935,7 @@ bool config_get_config_path(config_file_t *conf, char *s, size_t len)
 bool config_get_array(config_file_t *conf, const char *key,
       char *buf, size_t size)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       return strlcpy(buf, entry->value, size) < size;
@@ -812,7 +949,7 @@ bool config_get_path(config_file_t *conf, const char *key,
    if (config_get_array(conf, key, buf, size))
       return true;
 #else
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -825,7 +962,7 @@ bool config_get_path(config_file_t *conf, const char *key,
 
 bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -846,8 +983,8 @@ bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *last  = (conf->guaranteed_no_duplicates && conf->last) ? conf->last : conf->entries;
-   struct config_entry_list *entry = conf->guaranteed_no_duplicates?NULL:config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = conf->guaranteed_no_duplicates
+      ? NULL : config_get_entry(conf, key);
 
    if (entry && !entry->readonly)
    {
@@ -868,27 +1005,47 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
    entry->value     = strdup(val);
    entry->next      = NULL;
 
-   if (last)
-      last->next    = entry;
+   if (conf->tail)
+      conf->tail->next = entry;
    else
-      conf->entries = entry;
+      conf->entries    = entry;
 
-   conf->last = entry ;
+   conf->tail = entry;
+   conf->last = entry;
 
+   config_index_add(conf, entry);
 }
 
 void config_unset(config_file_t *conf, const char *key)
 {
-   struct config_entry_list *last  = conf->entries;
-   struct config_entry_list *entry = config_get_entry(conf, key, &last);
+   size_t i;
+   struct config_entry_list *entry = NULL;
+   struct config_entry_list *next  = NULL;
+
+   if (!conf->index)
+      return;
+
+   i     = config_index_slot(conf, key, djb2_calculate(key));
+   entry = conf->index[i];
 
    if (!entry)
       return;
 
-   entry->key   = NULL;
-   entry->value = NULL;
+   /* A later duplicate of the key becomes visible */
+   for (next = entry->next; next; next = next->next)
+      if (next->key && next->hash == entry->hash
+            && string_is_equal(next->key, key))
+         break;
+
+   if (next)
+      conf->index[i] = next;
+   else
+      config_index_remove_slot(conf, i);
+
    free(entry->key);
    free(entry->value);
+   entry->key   = NULL;
+   entry->value = NULL;
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -1030,6 +1187,11 @@ void config_file_dump_orbis(config_file_t *conf, int fd)
 
    list = merge_sort_linked_list((struct config_entry_list*)conf->entries, config_sort_compare_func);
    conf->entries = list;
+   config_index_rebuild(conf);
+
+   conf->tail = list;
+   while (conf->tail && conf->tail->next)
+      conf->tail = conf->tail->next;
 
    while (list)
    {
@@ -1056,7 +1218,17 @@ void config_file_dump(config_file_t *conf, FILE *file, bool sort)
    }
 
    if (sort)
+   {
       list = merge_sort_linked_list((struct config_entry_list*)conf->entries, config_sort_compare_func);
+
+      /* Sorting can reorder duplicate keys */
+      conf->entries = list;
+      config_index_rebuild(conf);
+
+      conf->tail = list;
+      while (conf->tail && conf->tail->next)
+         conf->tail = conf->tail->next;
+   }
    else
       list = (struct config_entry_list*)conf->entries;
 
@@ -1072,16 +1244,7 @@ void config_file_dump(config_file_t *conf, FILE *file, bool sort)
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   struct config_entry_list *list = conf->entries;
-
-   while (list)
-   {
-      if (string_is_equal(entry, list->key))
-         return true;
-      list = list->next;
-   }
-
-   return false;
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf,
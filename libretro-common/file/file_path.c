@@ -196,6 +196,60 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+/**
+ * path_get_stamp:
+ * @path               : path
+ * @size               : receives the size of the file
+ * @mtime              : receives the modification time of the file
+ *
+ * Gets the size and modification time of a regular file,
+ * e.g. to tell whether data derived from it is still current.
+ * Unlike path_get_size(), sizes above 2 GB are supported.
+ *
+ * Returns: true (1) if the stamp could be determined, otherwise
+ * false (0), including on platforms without modification times.
+ */
+bool path_get_stamp(const char *path, int64_t *size, int64_t *mtime)
+{
+#if defined(_WIN32) && !defined(LEGACY_WIN32)
+   struct _stat64 buf;
+   int ret            = -1;
+   wchar_t *path_wide = NULL;
+
+   if (!path || !*path)
+      return false;
+
+   path_wide = utf8_to_utf16_string_alloc(path);
+
+   if (!path_wide)
+      return false;
+
+   ret = _wstat64(path_wide, &buf);
+   free(path_wide);
+
+   if (ret != 0 || (buf.st_mode & _S_IFDIR))
+      return false;
+
+   *size  = (int64_t)buf.st_size;
+   *mtime = (int64_t)buf.st_mtime;
+   return true;
+#elif defined(_WIN32) || defined(VITA) || defined(PSP) || defined(PS2) || defined(ORBIS) || defined(__CELLOS_LV2__)
+   return false;
+#else
+   struct stat buf;
+
+   if (!path || !*path)
+      return false;
+
+   if (stat(path, &buf) != 0 || S_ISDIR(buf.st_mode))
+      return false;
+
+   *size  = (int64_t)buf.st_size;
+   *mtime = (int64_t)buf.st_mtime;
+   return true;
+#endif
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
@@ -62,6 +62,10 @@
 #include <retro_inline.h>
 #include <streams/file_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #define TRUE 1
 #define FALSE 0
 
@@ -190,6 +194,32 @@ struct _metadata_entry
 	UINT8					flags;			/* flag bits */
 };
 
+/* LRU cache of decompressed hunks, optionally filled ahead
+   of the reader by a prefetch thread */
+typedef struct _hunk_cache hunk_cache;
+struct _hunk_cache
+{
+	UINT32					count;			/* number of cached hunks */
+	UINT32 *				hunknum;		/* hunk held by each slot, ~0 if empty */
+	UINT32 *				stamp;			/* last use of each slot */
+	UINT32					clock;			/* current use stamp */
+	UINT8 *					data;			/* count * hunkbytes of hunk data */
+
+#ifdef HAVE_THREADS
+	slock_t *				lock;			/* protects the slots and the prefetch window */
+	slock_t *				decode_lock;	/* serializes access to the file and codecs */
+	scond_t *				cond;			/* signals a new prefetch window */
+	sthread_t *				thread;			/* prefetch thread, or NULL */
+	UINT8 *					prefetch_buf;	/* decompression target of the prefetch thread */
+	UINT32					prefetch;		/* number of hunks to read ahead */
+	UINT32					prefetch_next;	/* next hunk to prefetch */
+	UINT32					prefetch_end;	/* end of the prefetch window */
+	UINT32					demand;			/* demand reads waiting for or holding decode_lock */
+	UINT32					last_read;		/* hunk of the previous demand read */
+	int						quit;			/* asks the prefetch thread to exit */
+#endif
+};
+
 /* internal representation of an open CHD file */
 struct _chd_file
 {
@@ -229,6 +259,8 @@ struct _chd_file
 	UINT32					maxhunk;		/* maximum hunk accessed */
 #endif
    UINT8 *              file_cache; /* cache of underlying file */
+
+	hunk_cache *			hunkcache;		/* LRU cache of decompressed hunks, or NULL */
 };
 
 /***************************************************************************
@@ -251,6 +283,7 @@ static chd_error header_read(chd_file *chd, chd_header *header);
 static chd_error hunk_read_into_cache(chd_file *chd, UINT32 hunknum);
 #endif
 static chd_error hunk_read_into_memory(chd_file *chd, UINT32 hunknum, UINT8 *dest);
+static void hunk_cache_free(chd_file *chd);
 
 /* internal map access */
 static chd_error map_read(chd_file *chd);
@@ -1012,6 +1045,9 @@ void chd_close(chd_file *chd)
 	if (chd == NULL || chd->cookie != COOKIE_VALUE)
 		return;
 
+	/* stop prefetching before the codecs go away */
+	hunk_cache_free(chd);
+
 	/* deinit the codec */
 	if (chd->header.version < 5)
 	{
@@ -1156,6 +1192,322 @@ const chd_header *chd_get_header(chd_file *chd)
 	return &chd->header;
 }
 
+/***************************************************************************
+    DECOMPRESSED HUNK CACHE
+***************************************************************************/
+
+/*-------------------------------------------------
+    hunk_cache_find - return the slot holding
+    the given hunk, or -1; the cache lock must
+    be held
+-------------------------------------------------*/
+
+static int hunk_cache_find(hunk_cache *cache, UINT32 hunknum)
+{
+	UINT32 i;
+
+	for (i = 0; i < cache->count; i++)
+		if (cache->hunknum[i] == hunknum)
+			return (int)i;
+
+	return -1;
+}
+
+/*-------------------------------------------------
+    hunk_cache_lookup - copy a hunk out of the
+    cache if present
+-------------------------------------------------*/
+
+static int hunk_cache_lookup(chd_file *chd, UINT32 hunknum, UINT8 *dest)
+{
+	hunk_cache *cache = chd->hunkcache;
+	int slot;
+
+#ifdef HAVE_THREADS
+	slock_lock(cache->lock);
+#endif
+
+	slot = hunk_cache_find(cache, hunknum);
+	if (slot >= 0)
+	{
+		cache->stamp[slot] = ++cache->clock;
+		memcpy(dest, cache->data + (size_t)slot * chd->header.hunkbytes,
+				chd->header.hunkbytes);
+	}
+
+#ifdef HAVE_THREADS
+	slock_unlock(cache->lock);
+#endif
+
+	return slot >= 0;
+}
+
+/*-------------------------------------------------
+    hunk_cache_insert - store a decompressed hunk
+    in the least recently used slot
+-------------------------------------------------*/
+
+static void hunk_cache_insert(chd_file *chd, UINT32 hunknum, const UINT8 *src)
+{
+	hunk_cache *cache = chd->hunkcache;
+	UINT32 i;
+	int slot;
+
+#ifdef HAVE_THREADS
+	slock_lock(cache->lock);
+#endif
+
+	slot = hunk_cache_find(cache, hunknum);
+	if (slot < 0)
+	{
+		slot = 0;
+		for (i = 1; i < cache->count; i++)
+			if (cache->stamp[i] < cache->stamp[slot])
+				slot = (int)i;
+
+		cache->hunknum[slot] = hunknum;
+		memcpy(cache->data + (size_t)slot * chd->header.hunkbytes, src,
+				chd->header.hunkbytes);
+	}
+	cache->stamp[slot] = ++cache->clock;
+
+#ifdef HAVE_THREADS
+	slock_unlock(cache->lock);
+#endif
+}
+
+/*-------------------------------------------------
+    hunk_cache_demand - count a demand read in or
+    out; the prefetch thread starts no new decode
+    while one is pending
+-------------------------------------------------*/
+
+static void hunk_cache_demand(chd_file *chd, int begin)
+{
+#ifdef HAVE_THREADS
+	hunk_cache *cache = chd->hunkcache;
+
+	if (cache->thread == NULL)
+		return;
+
+	slock_lock(cache->lock);
+	if (begin)
+		cache->demand++;
+	else if (--cache->demand == 0 && cache->prefetch_next < cache->prefetch_end)
+		scond_signal(cache->cond);
+	slock_unlock(cache->lock);
+#else
+	(void)chd;
+	(void)begin;
+#endif
+}
+
+/*-------------------------------------------------
+    hunk_cache_prefetch - move the prefetch window
+    after the given hunk if the reader is going
+    through the file in order, stop it otherwise
+-------------------------------------------------*/
+
+static void hunk_cache_prefetch(chd_file *chd, UINT32 hunknum)
+{
+#ifdef HAVE_THREADS
+	hunk_cache *cache = chd->hunkcache;
+
+	if (cache->thread == NULL)
+		return;
+
+	slock_lock(cache->lock);
+	if (hunknum == cache->last_read || hunknum == cache->last_read + 1)
+	{
+		cache->prefetch_next = hunknum + 1;
+		cache->prefetch_end  = MIN(hunknum + 1 + cache->prefetch, chd->header.totalhunks);
+		scond_signal(cache->cond);
+	}
+	else
+		cache->prefetch_end  = cache->prefetch_next;
+	cache->last_read = hunknum;
+	slock_unlock(cache->lock);
+#else
+	(void)chd;
+	(void)hunknum;
+#endif
+}
+
+#ifdef HAVE_THREADS
+/*-------------------------------------------------
+    hunk_cache_thread - decompress the hunks of
+    the prefetch window that aren't cached yet
+-------------------------------------------------*/
+
+static void hunk_cache_thread(void *data)
+{
+	chd_file *chd     = (chd_file *)data;
+	hunk_cache *cache = chd->hunkcache;
+
+	slock_lock(cache->lock);
+
+	for (;;)
+	{
+		UINT32 hunknum;
+		int cached;
+		chd_error err = CHDERR_NONE;
+
+		while (!cache->quit && (cache->demand > 0
+					|| cache->prefetch_next >= cache->prefetch_end))
+			scond_wait(cache->cond, cache->lock);
+
+		if (cache->quit)
+			break;
+
+		hunknum = cache->prefetch_next++;
+		cached  = hunk_cache_find(cache, hunknum) >= 0;
+		slock_unlock(cache->lock);
+
+		if (!cached)
+		{
+			int yield;
+
+			slock_lock(cache->decode_lock);
+
+			/* a demand read that arrived meanwhile goes first;
+			   put the hunk back unless the window moved on */
+			slock_lock(cache->lock);
+			yield  = cache->demand > 0;
+			cached = hunk_cache_find(cache, hunknum) >= 0;
+			if (yield && cache->prefetch_next == hunknum + 1)
+				cache->prefetch_next = hunknum;
+			slock_unlock(cache->lock);
+
+			if (yield)
+			{
+				slock_unlock(cache->decode_lock);
+				slock_lock(cache->lock);
+				continue;
+			}
+
+			if (!cached)
+				err = hunk_read_into_memory(chd, hunknum, cache->prefetch_buf);
+
+			slock_unlock(cache->decode_lock);
+
+			if (!cached && err == CHDERR_NONE)
+				hunk_cache_insert(chd, hunknum, cache->prefetch_buf);
+		}
+
+		slock_lock(cache->lock);
+	}
+
+	slock_unlock(cache->lock);
+}
+#endif
+
+/*-------------------------------------------------
+    hunk_cache_free - stop prefetching and free
+    the hunk cache
+-------------------------------------------------*/
+
+static void hunk_cache_free(chd_file *chd)
+{
+	hunk_cache *cache = chd->hunkcache;
+
+	if (cache == NULL)
+		return;
+
+#ifdef HAVE_THREADS
+	if (cache->thread != NULL)
+	{
+		slock_lock(cache->lock);
+		cache->quit = 1;
+		scond_signal(cache->cond);
+		slock_unlock(cache->lock);
+
+		sthread_join(cache->thread);
+	}
+	if (cache->cond != NULL)
+		scond_free(cache->cond);
+	if (cache->decode_lock != NULL)
+		slock_free(cache->decode_lock);
+	if (cache->lock != NULL)
+		slock_free(cache->lock);
+	free(cache->prefetch_buf);
+#endif
+
+	free(cache->hunknum);
+	free(cache->stamp);
+	free(cache->data);
+	free(cache);
+
+	chd->hunkcache = NULL;
+}
+
+/*-------------------------------------------------
+    chd_set_hunk_cache - set up an LRU cache of
+    decompressed hunks and optional read-ahead
+-------------------------------------------------*/
+
+chd_error chd_set_hunk_cache(chd_file *chd, UINT32 hunks, UINT32 prefetch)
+{
+	hunk_cache *cache;
+	UINT32 i;
+
+	/* punt if NULL or invalid */
+	if (chd == NULL || chd->cookie != COOKIE_VALUE)
+		return CHDERR_INVALID_PARAMETER;
+
+	hunk_cache_free(chd);
+
+	if (hunks == 0)
+		return CHDERR_NONE;
+
+	/* prefetched hunks must not evict the one being read */
+	if (prefetch >= hunks)
+		prefetch = hunks - 1;
+
+	cache = (hunk_cache *)calloc(1, sizeof(*cache));
+	if (cache == NULL)
+		return CHDERR_OUT_OF_MEMORY;
+	chd->hunkcache = cache;
+
+	cache->count   = hunks;
+	cache->hunknum = (UINT32 *)malloc(hunks * sizeof(*cache->hunknum));
+	cache->stamp   = (UINT32 *)calloc(hunks, sizeof(*cache->stamp));
+	cache->data    = (UINT8 *)malloc((size_t)hunks * chd->header.hunkbytes);
+	if (cache->hunknum == NULL || cache->stamp == NULL || cache->data == NULL)
+		goto cleanup;
+
+	for (i = 0; i < hunks; i++)
+		cache->hunknum[i] = ~0;
+
+#ifdef HAVE_THREADS
+	cache->lock        = slock_new();
+	cache->decode_lock = slock_new();
+	if (cache->lock == NULL || cache->decode_lock == NULL)
+		goto cleanup;
+
+	if (prefetch > 0)
+	{
+		cache->prefetch     = prefetch;
+		cache->last_read    = ~0;
+		cache->prefetch_buf = (UINT8 *)malloc(chd->header.hunkbytes);
+		cache->cond         = scond_new();
+		if (cache->prefetch_buf == NULL || cache->cond == NULL)
+			goto cleanup;
+
+		cache->thread = sthread_create(hunk_cache_thread, chd);
+		if (cache->thread == NULL)
+			goto cleanup;
+	}
+#else
+	(void)prefetch;
+#endif
+
+	return CHDERR_NONE;
+
+cleanup:
+	hunk_cache_free(chd);
+	return CHDERR_OUT_OF_MEMORY;
+}
+
 /***************************************************************************
     CORE DATA READ/WRITE
 ***************************************************************************/
@@ -1167,12 +1519,50 @@ const chd_header *chd_get_header(chd_file *chd)
 
 chd_error chd_read(chd_file *chd, UINT32 hunknum, void *buffer)
 {
+	chd_error err;
+
 	/* punt if NULL or invalid */
 	if (chd == NULL || chd->cookie != COOKIE_VALUE)
 		return CHDERR_INVALID_PARAMETER;
 
 	/* perform the read */
-	return hunk_read_into_memory(chd, hunknum, (UINT8 *)buffer);
+	if (chd->hunkcache == NULL)
+		return hunk_read_into_memory(chd, hunknum, (UINT8 *)buffer);
+
+	if (hunk_cache_lookup(chd, hunknum, (UINT8 *)buffer))
+	{
+		hunk_cache_prefetch(chd, hunknum);
+		return CHDERR_NONE;
+	}
+
+#ifdef HAVE_THREADS
+	/* at most the one prefetch decode already running
+	   is ahead of us */
+	hunk_cache_demand(chd, 1);
+	slock_lock(chd->hunkcache->decode_lock);
+
+	/* the prefetch thread may have beaten us to it */
+	if (hunk_cache_lookup(chd, hunknum, (UINT8 *)buffer))
+	{
+		slock_unlock(chd->hunkcache->decode_lock);
+		hunk_cache_demand(chd, 0);
+		hunk_cache_prefetch(chd, hunknum);
+		return CHDERR_NONE;
+	}
+#endif
+
+	err = hunk_read_into_memory(chd, hunknum, (UINT8 *)buffer);
+
+#ifdef HAVE_THREADS
+	slock_unlock(chd->hunkcache->decode_lock);
+	hunk_cache_demand(chd, 0);
+#endif
+
+	if (err == CHDERR_NONE)
+		hunk_cache_insert(chd, hunknum, (const UINT8 *)buffer);
+
+	hunk_cache_prefetch(chd, hunknum);
+	return err;
 }
 
 /***************************************************************************
@@ -25,12 +25,15 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <boolean.h>
 #include <retro_inline.h>
+#include <features/features_cpu.h>
 
 #include <gfx/scaler/pixconv.h>
 
 #ifdef SCALER_NO_SIMD
 #undef __SSE2__
+#undef __ARM_NEON__
 #endif
 
 #if defined(__SSE2__)
@@ -39,6 +42,137 @@
 #include <mmintrin.h>
 #endif
 
+#if defined(__ARM_NEON__) && !defined(DONT_WANT_ARM_OPTIMIZATIONS)
+#define PIXCONV_NEON
+#include <arm_neon.h>
+#endif
+
+/* SSSE3 and AVX2 kernels are compiled per function, so the
+ * baseline build flags stay untouched. They only run once
+ * conv_init_simd() has found support for them on this CPU. */
+#if defined(__SSE2__) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define PIXCONV_X86_DISPATCH
+#define PIXCONV_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+
+static bool conv_ssse3_enabled = false;
+static bool conv_avx2_enabled  = false;
+#endif
+
+/**
+ * conv_init_simd:
+ *
+ * Enables the SSSE3/AVX2 variants of the converters when
+ * the CPU supports them. Safe to call more than once.
+ **/
+void conv_init_simd(void)
+{
+#ifdef PIXCONV_X86_DISPATCH
+   uint64_t cpu       = cpu_features_get();
+
+   conv_ssse3_enabled = (cpu & RETRO_SIMD_SSSE3) != 0;
+   conv_avx2_enabled  = (cpu & RETRO_SIMD_AVX2)  != 0;
+#endif
+}
+
+#ifdef PIXCONV_X86_DISPATCH
+/* Expands 16 5/6-bit channel values (already scaled to 8 bits
+ * by the mulhi tricks below) into 16 ARGB8888 pixels. The
+ * unpacks work per 128-bit lane, so the halves are put back
+ * in order before storing. */
+PIXCONV_TARGET("avx2")
+static INLINE void store_argb8888_avx2(uint32_t *out,
+      __m256i b, __m256i g, __m256i r, __m256i a)
+{
+   __m256i lo = _mm256_or_si256(_mm256_unpacklo_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpacklo_epi8(r, a), 2));
+   __m256i hi = _mm256_or_si256(_mm256_unpackhi_epi8(b, g),
+         _mm256_slli_si256(_mm256_unpackhi_epi8(r, a), 2));
+
+   _mm256_storeu_si256((__m256i*)(out + 0),
+         _mm256_permute2x128_si256(lo, hi, 0x20));
+   _mm256_storeu_si256((__m256i*)(out + 8),
+         _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+/* Packs 16 32-bit values that fit in 16 bits into
+ * 16 consecutive uint16_t. */
+PIXCONV_TARGET("avx2")
+static INLINE void store_pack16_avx2(uint16_t *out,
+      __m256i lo, __m256i hi)
+{
+   /* Sign-extend so the saturating pack keeps all 16 bits. */
+   lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+   hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+   _mm256_storeu_si256((__m256i*)out, _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+#endif
+
+/* Runs a wider kernel over the leading columns it handles
+ * and leaves the remaining columns of every row to the
+ * generic loops that follow. */
+#define PIXCONV_DISPATCH(enabled, kernel, out_step, in_step) \
+   do \
+   { \
+      if (enabled) \
+      { \
+         int done = kernel(output, input, width, height, \
+               out_stride, in_stride); \
+         output  += done * (out_step); \
+         input   += done * (in_step); \
+         width   -= done; \
+      } \
+   } while (0)
+
+#if defined(__SSE2__)
+static INLINE __m128i pack16_sse2(__m128i lo, __m128i hi)
+{
+   lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+   hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+   return _mm_packs_epi32(lo, hi);
+}
+
+/* Swaps the first and third byte of every 32-bit pixel. */
+static INLINE __m128i swap_rb_sse2(__m128i in)
+{
+   const __m128i mask_ag = _mm_set1_epi32((int)0xff00ff00u);
+   __m128i ag            = _mm_and_si128(in, mask_ag);
+   __m128i rb            = _mm_andnot_si128(mask_ag, in);
+   rb                    = _mm_or_si128(_mm_slli_epi32(rb, 16),
+         _mm_srli_epi32(rb, 16));
+   return _mm_or_si128(ag, rb);
+}
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_rgb565_0rgb1555_avx2(uint16_t *output,
+      const uint16_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width         = width & ~15;
+   const __m256i hi_mask = _mm256_set1_epi16(0x7fe0);
+   const __m256i lo_mask = _mm256_set1_epi16(0x1f);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i hi = _mm256_and_si256(_mm256_srli_epi16(in, 1), hi_mask);
+         __m256i lo = _mm256_and_si256(in, lo_mask);
+         _mm256_storeu_si256((__m256i*)(output + w), _mm256_or_si256(hi, lo));
+      }
+   }
+
+   return max_width;
+}
+#endif
+
 void conv_rgb565_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -48,9 +182,20 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
    uint16_t *output = (uint16_t*)output_;
 
 #if defined(__SSE2__)
-   int max_width           = width - 7;
+   int max_width;
    const __m128i hi_mask   = _mm_set1_epi16(0x7fe0);
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
+#elif defined(PIXCONV_NEON)
+   int max_width;
+   const uint16x8_t hi_mask = vdupq_n_u16(0x7fe0);
+   const uint16x8_t lo_mask = vdupq_n_u16(0x1f);
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_rgb565_0rgb1555_avx2, 1, 1);
+#endif
+#if defined(__SSE2__) || defined(PIXCONV_NEON)
+   max_width               = width - 7;
 #endif
 
    for (h = 0; h < height;
@@ -61,10 +206,18 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
       for (; w < max_width; w += 8)
       {
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i hi = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
+         __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 1), hi_mask);
          __m128i lo = _mm_and_si128(in, lo_mask);
          _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t hi = vandq_u16(vshrq_n_u16(in, 1), hi_mask);
+         uint16x8_t lo = vandq_u16(in, lo_mask);
+         vst1q_u16(output + w, vorrq_u16(hi, lo));
+      }
 #endif
 
       for (; w < width; w++)
@@ -77,6 +230,38 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_0rgb1555_rgb565_avx2(uint16_t *output,
+      const uint16_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width           = width & ~15;
+   const __m256i hi_mask   = _mm256_set1_epi16(
+         (int16_t)((0x1f << 11) | (0x1f << 6)));
+   const __m256i lo_mask   = _mm256_set1_epi16(0x1f);
+   const __m256i glow_mask = _mm256_set1_epi16(1 << 5);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i rg   = _mm256_and_si256(_mm256_slli_epi16(in, 1), hi_mask);
+         __m256i b    = _mm256_and_si256(in, lo_mask);
+         __m256i glow = _mm256_and_si256(_mm256_srli_epi16(in, 4), glow_mask);
+         _mm256_storeu_si256((__m256i*)(output + w),
+               _mm256_or_si256(rg, _mm256_or_si256(b, glow)));
+      }
+   }
+
+   return max_width;
+}
+#endif
+
 void conv_0rgb1555_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -86,12 +271,25 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
    uint16_t *output        = (uint16_t*)output_;
 
 #if defined(__SSE2__)
-   int max_width           = width - 7;
+   int max_width;
 
    const __m128i hi_mask   = _mm_set1_epi16(
          (int16_t)((0x1f << 11) | (0x1f << 6)));
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
    const __m128i glow_mask = _mm_set1_epi16(1 << 5);
+#elif defined(PIXCONV_NEON)
+   int max_width;
+
+   const uint16x8_t hi_mask   = vdupq_n_u16((0x1f << 11) | (0x1f << 6));
+   const uint16x8_t lo_mask   = vdupq_n_u16(0x1f);
+   const uint16x8_t glow_mask = vdupq_n_u16(1 << 5);
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_0rgb1555_rgb565_avx2, 1, 1);
+#endif
+#if defined(__SSE2__) || defined(PIXCONV_NEON)
+   max_width               = width - 7;
 #endif
 
    for (h = 0; h < height;
@@ -108,6 +306,15 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w),
                _mm_or_si128(rg, _mm_or_si128(b, glow)));
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t rg   = vandq_u16(vshlq_n_u16(in, 1), hi_mask);
+         uint16x8_t b    = vandq_u16(in, lo_mask);
+         uint16x8_t glow = vandq_u16(vshrq_n_u16(in, 4), glow_mask);
+         vst1q_u16(output + w, vorrq_u16(rg, vorrq_u16(b, glow)));
+      }
 #endif
 
       for (; w < width; w++)
@@ -121,6 +328,43 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_0rgb1555_argb8888_avx2(uint32_t *output,
+      const uint16_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width             = width & ~15;
+   const __m256i pix_mask_r  = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_gb = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul15_mid   = _mm256_set1_epi16(0x4200);
+   const __m256i mul15_hi    = _mm256_set1_epi16(0x0210);
+   const __m256i a           = _mm256_set1_epi16(0x00ff);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i r = _mm256_and_si256(in, pix_mask_r);
+         __m256i g = _mm256_and_si256(in, pix_mask_gb);
+         __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_gb);
+
+         r         = _mm256_mulhi_epi16(r, mul15_hi);
+         g         = _mm256_mulhi_epi16(g, mul15_mid);
+         b         = _mm256_mulhi_epi16(b, mul15_mid);
+
+         store_argb8888_avx2(output + w, b, g, r, a);
+      }
+   }
+
+   return max_width;
+}
+#endif
+
 void conv_0rgb1555_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -136,7 +380,17 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
    const __m128i mul15_hi    = _mm_set1_epi16(0x0210);
    const __m128i a           = _mm_set1_epi16(0x00ff);
 
-   int max_width = width - 7;
+   int max_width;
+#elif defined(PIXCONV_NEON)
+   const uint16x8_t mask5 = vdupq_n_u16(0x1f);
+   int max_width;
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_0rgb1555_argb8888_avx2, 1, 1);
+#endif
+#if defined(__SSE2__) || defined(PIXCONV_NEON)
+   max_width = width - 7;
 #endif
 
    for (h = 0; h < height;
@@ -171,6 +425,22 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint8x8_t r = vmovn_u16(vandq_u16(vshrq_n_u16(in, 10), mask5));
+         uint8x8_t g = vmovn_u16(vandq_u16(vshrq_n_u16(in,  5), mask5));
+         uint8x8_t b = vmovn_u16(vandq_u16(in, mask5));
+
+         res.val[0]  = vorr_u8(vshl_n_u8(b, 3), vshr_n_u8(b, 2));
+         res.val[1]  = vorr_u8(vshl_n_u8(g, 3), vshr_n_u8(g, 2));
+         res.val[2]  = vorr_u8(vshl_n_u8(r, 3), vshr_n_u8(r, 2));
+         res.val[3]  = vdup_n_u8(0xff);
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -188,6 +458,85 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+/* Shared by the ARGB8888 and ABGR8888 outputs, which only
+ * differ in the order the red and blue channels are stored. */
+PIXCONV_TARGET("avx2")
+static INLINE int conv_rgb565_8888_avx2(uint32_t *output,
+      const uint16_t *input, int width, int height,
+      int out_stride, int in_stride, bool swap_rb)
+{
+   int h;
+   int max_width            = width & ~15;
+   const __m256i pix_mask_r = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_g = _mm256_set1_epi16(0x3f <<  5);
+   const __m256i pix_mask_b = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul16_r    = _mm256_set1_epi16(0x0210);
+   const __m256i mul16_g    = _mm256_set1_epi16(0x2080);
+   const __m256i mul16_b    = _mm256_set1_epi16(0x4200);
+   const __m256i a          = _mm256_set1_epi16(0x00ff);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i r = _mm256_and_si256(_mm256_srli_epi16(in, 1), pix_mask_r);
+         __m256i g = _mm256_and_si256(in, pix_mask_g);
+         __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_b);
+
+         r         = _mm256_mulhi_epi16(r, mul16_r);
+         g         = _mm256_mulhi_epi16(g, mul16_g);
+         b         = _mm256_mulhi_epi16(b, mul16_b);
+
+         if (swap_rb)
+            store_argb8888_avx2(output + w, r, g, b, a);
+         else
+            store_argb8888_avx2(output + w, b, g, r, a);
+      }
+   }
+
+   return max_width;
+}
+
+PIXCONV_TARGET("avx2")
+static int conv_rgb565_argb8888_avx2(uint32_t *output,
+      const uint16_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   return conv_rgb565_8888_avx2(output, input, width, height,
+         out_stride, in_stride, false);
+}
+
+PIXCONV_TARGET("avx2")
+static int conv_rgb565_abgr8888_avx2(uint32_t *output,
+      const uint16_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   return conv_rgb565_8888_avx2(output, input, width, height,
+         out_stride, in_stride, true);
+}
+#endif
+
+#ifdef PIXCONV_NEON
+static INLINE uint8x8x4_t conv_rgb565_8888_neon(uint16x8_t in)
+{
+   uint8x8x4_t res;
+   uint8x8_t r = vmovn_u16(vshrq_n_u16(in, 11));
+   uint8x8_t g = vmovn_u16(vandq_u16(vshrq_n_u16(in, 5), vdupq_n_u16(0x3f)));
+   uint8x8_t b = vmovn_u16(vandq_u16(in, vdupq_n_u16(0x1f)));
+
+   res.val[0]  = vorr_u8(vshl_n_u8(b, 3), vshr_n_u8(b, 2));
+   res.val[1]  = vorr_u8(vshl_n_u8(g, 2), vshr_n_u8(g, 4));
+   res.val[2]  = vorr_u8(vshl_n_u8(r, 3), vshr_n_u8(r, 2));
+   res.val[3]  = vdup_n_u8(0xff);
+
+   return res;
+}
+#endif
+
 void conv_rgb565_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -205,6 +554,8 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
    const __m128i mul16_b    = _mm_set1_epi16(0x4200);
    const __m128i a          = _mm_set1_epi16(0x00ff);
 
+   int max_width;
+#elif defined(PIXCONV_NEON)
    int max_width            = width - 7;
 #elif defined(__MMX__)
    const __m64 pix_mask_r = _mm_set1_pi16(0x1f << 10);
@@ -218,6 +569,13 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
    int max_width            = width - 3;
 #endif
 
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_rgb565_argb8888_avx2, 1, 1);
+#endif
+#if defined(__SSE2__)
+   max_width                = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
@@ -249,6 +607,10 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+         vst4_u8((uint8_t*)(output + w),
+               conv_rgb565_8888_neon(vld1q_u16(input + w)));
 #elif defined(__MMX__)
       for (; w < max_width; w += 4)
       {
@@ -302,7 +664,7 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
    int h;
    const uint16_t *input    = (const uint16_t*)input_;
    uint32_t *output         = (uint32_t*)output_;
- #if defined(__SSE2__)
+#if defined(__SSE2__)
    const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
    const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
@@ -310,9 +672,17 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
    const __m128i mul16_g    = _mm_set1_epi16(0x2080);
    const __m128i mul16_b    = _mm_set1_epi16(0x4200);
    const __m128i a          = _mm_set1_epi16(0x00ff);
-    int max_width            = width - 7;
+   int max_width;
+#elif defined(PIXCONV_NEON)
+   int max_width            = width - 7;
 #endif
-    for (h = 0; h < height;
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_rgb565_abgr8888_avx2, 1, 1);
+#endif
+#if defined(__SSE2__)
+   max_width                = width - 7;
+#endif
+   for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
@@ -320,7 +690,7 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
       for (; w < max_width; w += 8)
       {
          __m128i res_lo, res_hi;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+         __m128i res_lo_rg, res_hi_rg, res_lo_ba, res_hi_ba;
          const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
          __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
          __m128i        g = _mm_and_si128(in, pix_mask_g);
@@ -328,19 +698,28 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
          r                = _mm_mulhi_epi16(r, mul16_r);
          g                = _mm_mulhi_epi16(g, mul16_g);
          b                = _mm_mulhi_epi16(b, mul16_b);
-         res_lo_bg        = _mm_unpacklo_epi8(b, g);
-         res_hi_bg        = _mm_unpackhi_epi8(b, g);
-         res_lo_ra        = _mm_unpacklo_epi8(r, a);
-         res_hi_ra        = _mm_unpackhi_epi8(r, a);
-         res_lo           = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi           = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
+         res_lo_rg        = _mm_unpacklo_epi8(r, g);
+         res_hi_rg        = _mm_unpackhi_epi8(r, g);
+         res_lo_ba        = _mm_unpacklo_epi8(b, a);
+         res_hi_ba        = _mm_unpackhi_epi8(b, a);
+         res_lo           = _mm_or_si128(res_lo_rg,
+               _mm_slli_si128(res_lo_ba, 2));
+         res_hi           = _mm_or_si128(res_hi_rg,
+               _mm_slli_si128(res_hi_ba, 2));
          _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
          _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t res = conv_rgb565_8888_neon(vld1q_u16(input + w));
+         uint8x8_t     r = res.val[2];
+         res.val[2]      = res.val[0];
+         res.val[0]      = r;
+         vst4_u8((uint8_t*)(output + w), res);
+      }
 #endif
-       for (; w < width; w++)
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 11) & 0x1f;
@@ -354,34 +733,164 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_argb8888_rgba4444_avx2(uint16_t *output,
+      const uint32_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width        = width & ~15;
+   const __m256i mask_r = _mm256_set1_epi32(0xf000);
+   const __m256i mask_g = _mm256_set1_epi32(0x0f00);
+   const __m256i mask_b = _mm256_set1_epi32(0x00f0);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         __m256i res[2];
+         int i;
+
+         for (i = 0; i < 2; i++)
+         {
+            const __m256i in = _mm256_loadu_si256(
+                  (const __m256i*)(input + w + i * 8));
+            __m256i r = _mm256_and_si256(_mm256_srli_epi32(in, 8), mask_r);
+            __m256i g = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask_g);
+            __m256i b = _mm256_and_si256(in, mask_b);
+            __m256i a = _mm256_srli_epi32(in, 28);
+            res[i]    = _mm256_or_si256(_mm256_or_si256(r, g),
+                  _mm256_or_si256(b, a));
+         }
+
+         store_pack16_avx2(output + w, res[0], res[1]);
+      }
+   }
+
+   return max_width;
+}
+#endif
+
 void conv_argb8888_rgba4444(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi32(0xf000);
+   const __m128i mask_g  = _mm_set1_epi32(0x0f00);
+   const __m128i mask_b  = _mm_set1_epi32(0x00f0);
+   int max_width;
+#elif defined(PIXCONV_NEON)
+   const uint8x8_t mask  = vdup_n_u8(0xf0);
+   int max_width         = width - 7;
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_argb8888_rgba4444_avx2, 1, 1);
+#endif
+#if defined(__SSE2__)
+   max_width             = width - 7;
+#endif
+
    for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+         h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i res[2];
+         int i;
+
+         for (i = 0; i < 2; i++)
+         {
+            const __m128i in = _mm_loadu_si128(
+                  (const __m128i*)(input + w + i * 4));
+            __m128i r = _mm_and_si128(_mm_srli_epi32(in, 8), mask_r);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(in, 4), mask_g);
+            __m128i b = _mm_and_si128(in, mask_b);
+            __m128i a = _mm_srli_epi32(in, 28);
+            res[i]    = _mm_or_si128(_mm_or_si128(r, g),
+                  _mm_or_si128(b, a));
+         }
+
+         _mm_storeu_si128((__m128i*)(output + w),
+               pack16_sse2(res[0], res[1]));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t in = vld4_u8((const uint8_t*)(input + w));
+         uint16x8_t r   = vshll_n_u8(vand_u8(in.val[2], mask), 8);
+         uint16x8_t g   = vshll_n_u8(vand_u8(in.val[1], mask), 4);
+         uint16x8_t b   = vmovl_u8(vand_u8(in.val[0], mask));
+         uint16x8_t a   = vmovl_u8(vshr_n_u8(in.val[3], 4));
+         vst1q_u16(output + w, vorrq_u16(vorrq_u16(r, g), vorrq_u16(b, a)));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
-         uint32_t r   = (col >> 16) & 0xf;
-         uint32_t g   = (col >>  8) & 0xf;
-         uint32_t b   = (col) & 0xf;
-         uint32_t a   = (col >>  24) & 0xf;
-         r            = (r >> 4) | r;
-         g            = (g >> 4) | g;
-         b            = (b >> 4) | b;
-         a            = (a >> 4) | a;
+         uint32_t r   = (col >> 20) & 0xf;
+         uint32_t g   = (col >> 12) & 0xf;
+         uint32_t b   = (col >>  4) & 0xf;
+         uint32_t a   = (col >> 28) & 0xf;
 
          output[w]    = (r << 12) | (g << 8) | (b << 4) | a;
       }
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_rgba4444_argb8888_avx2(uint32_t *output,
+      const uint16_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width         = width & ~15;
+   const __m256i mask_lo = _mm256_set1_epi16(0x000f);
+   const __m256i mask_hi = _mm256_set1_epi16(0x0f00);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         __m256i lo, hi;
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i bg = _mm256_or_si256(
+               _mm256_and_si256(_mm256_srli_epi16(in, 4), mask_lo),
+               _mm256_and_si256(in, mask_hi));
+         __m256i ra = _mm256_or_si256(_mm256_srli_epi16(in, 12),
+               _mm256_and_si256(_mm256_slli_epi16(in, 8), mask_hi));
+
+         bg         = _mm256_or_si256(bg, _mm256_slli_epi16(bg, 4));
+         ra         = _mm256_or_si256(ra, _mm256_slli_epi16(ra, 4));
+
+         lo         = _mm256_unpacklo_epi16(bg, ra);
+         hi         = _mm256_unpackhi_epi16(bg, ra);
+
+         _mm256_storeu_si256((__m256i*)(output + w + 0),
+               _mm256_permute2x128_si256(lo, hi, 0x20));
+         _mm256_storeu_si256((__m256i*)(output + w + 8),
+               _mm256_permute2x128_si256(lo, hi, 0x31));
+      }
+   }
+
+   return max_width;
+}
+#endif
+
 void conv_rgba4444_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -390,7 +899,16 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
    const uint16_t *input = (const uint16_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
-#if defined(__MMX__)
+#if defined(__SSE2__)
+   const __m128i mask_lo = _mm_set1_epi16(0x000f);
+   const __m128i mask_hi = _mm_set1_epi16(0x0f00);
+
+   int max_width;
+#elif defined(PIXCONV_NEON)
+   const uint16x8_t mask = vdupq_n_u16(0xf);
+
+   int max_width         = width - 7;
+#elif defined(__MMX__)
    const __m64 pix_mask_r = _mm_set1_pi16(0xf << 10);
    const __m64 pix_mask_g = _mm_set1_pi16(0xf << 8);
    const __m64 pix_mask_b = _mm_set1_pi16(0xf << 8);
@@ -402,11 +920,55 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
    int max_width            = width - 3;
 #endif
 
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_rgba4444_argb8888_avx2, 1, 1);
+#endif
+#if defined(__SSE2__)
+   max_width             = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
       int w = 0;
-#if defined(__MMX__)
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         /* B and G nibbles in the low and high byte of each
+          * lane, then R and A, each widened to 8 bits. */
+         __m128i bg = _mm_or_si128(
+               _mm_and_si128(_mm_srli_epi16(in, 4), mask_lo),
+               _mm_and_si128(in, mask_hi));
+         __m128i ra = _mm_or_si128(_mm_srli_epi16(in, 12),
+               _mm_and_si128(_mm_slli_epi16(in, 8), mask_hi));
+
+         bg         = _mm_or_si128(bg, _mm_slli_epi16(bg, 4));
+         ra         = _mm_or_si128(ra, _mm_slli_epi16(ra, 4));
+
+         _mm_storeu_si128((__m128i*)(output + w + 0),
+               _mm_unpacklo_epi16(bg, ra));
+         _mm_storeu_si128((__m128i*)(output + w + 4),
+               _mm_unpackhi_epi16(bg, ra));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint8x8_t r = vmovn_u16(vshrq_n_u16(in, 12));
+         uint8x8_t g = vmovn_u16(vandq_u16(vshrq_n_u16(in, 8), mask));
+         uint8x8_t b = vmovn_u16(vandq_u16(vshrq_n_u16(in, 4), mask));
+         uint8x8_t a = vmovn_u16(vandq_u16(in, mask));
+
+         res.val[0]  = vorr_u8(vshl_n_u8(b, 4), b);
+         res.val[1]  = vorr_u8(vshl_n_u8(g, 4), g);
+         res.val[2]  = vorr_u8(vshl_n_u8(r, 4), r);
+         res.val[3]  = vorr_u8(vshl_n_u8(a, 4), a);
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
+#elif defined(__MMX__)
       for (; w < max_width; w += 4)
       {
          __m64 res_lo, res_hi;
@@ -454,18 +1016,90 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_rgba4444_rgb565_avx2(uint16_t *output,
+      const uint16_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width        = width & ~15;
+   const __m256i mask_r = _mm256_set1_epi16((int16_t)0xf000);
+   const __m256i mask_g = _mm256_set1_epi16(0x0780);
+   const __m256i mask_b = _mm256_set1_epi16(0x001e);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 1)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+         __m256i r = _mm256_and_si256(in, mask_r);
+         __m256i g = _mm256_and_si256(_mm256_srli_epi16(in, 1), mask_g);
+         __m256i b = _mm256_and_si256(_mm256_srli_epi16(in, 3), mask_b);
+         _mm256_storeu_si256((__m256i*)(output + w),
+               _mm256_or_si256(r, _mm256_or_si256(g, b)));
+      }
+   }
+
+   return max_width;
+}
+#endif
+
 void conv_rgba4444_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint16_t *input = (const uint16_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi16((int16_t)0xf000);
+   const __m128i mask_g  = _mm_set1_epi16(0x0780);
+   const __m128i mask_b  = _mm_set1_epi16(0x001e);
+   int max_width;
+#elif defined(PIXCONV_NEON)
+   const uint16x8_t mask_r = vdupq_n_u16(0xf000);
+   const uint16x8_t mask_g = vdupq_n_u16(0x0780);
+   const uint16x8_t mask_b = vdupq_n_u16(0x001e);
+   int max_width           = width - 7;
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_rgba4444_rgb565_avx2, 1, 1);
+#endif
+#if defined(__SSE2__)
+   max_width             = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+         __m128i r = _mm_and_si128(in, mask_r);
+         __m128i g = _mm_and_si128(_mm_srli_epi16(in, 1), mask_g);
+         __m128i b = _mm_and_si128(_mm_srli_epi16(in, 3), mask_b);
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_or_si128(r, _mm_or_si128(g, b)));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint16x8_t r = vandq_u16(in, mask_r);
+         uint16x8_t g = vandq_u16(vshrq_n_u16(in, 1), mask_g);
+         uint16x8_t b = vandq_u16(vshrq_n_u16(in, 3), mask_b);
+         vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 12) & 0xf;
@@ -522,6 +1156,18 @@ static INLINE void store_bgr24_sse2(void *output, __m128i a,
          _mm_or_si128(c0, _mm_or_si128(c1, _mm_or_si128(c2,
                   _mm_or_si128(c3, _mm_or_si128(c4, c5))))));
 }
+
+/* Stores 16 BGR24 pixels held in the low 12 bytes of a to d. */
+static INLINE void store_bgr24_packed_sse2(uint8_t *out,
+      __m128i a, __m128i b, __m128i c, __m128i d)
+{
+   _mm_storeu_si128((__m128i*)(out +  0),
+         _mm_or_si128(a, _mm_slli_si128(b, 12)));
+   _mm_storeu_si128((__m128i*)(out + 16),
+         _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+   _mm_storeu_si128((__m128i*)(out + 32),
+         _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+}
 #endif
 
 void conv_0rgb1555_bgr24(void *output_, const void *input_,
@@ -540,6 +1186,10 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
    const __m128i a           = _mm_set1_epi16(0x00ff);
 
    int max_width             = width - 15;
+#elif defined(PIXCONV_NEON)
+   const uint16x8_t mask5    = vdupq_n_u16(0x1f);
+
+   int max_width             = width - 7;
 #endif
 
    for (h = 0; h < height;
@@ -591,6 +1241,21 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
          /* Non-POT pixel sizes for the loss */
          store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8, out += 24)
+      {
+         uint8x8x3_t res;
+         const uint16x8_t in = vld1q_u16(input + w);
+         uint8x8_t r = vmovn_u16(vandq_u16(vshrq_n_u16(in, 10), mask5));
+         uint8x8_t g = vmovn_u16(vandq_u16(vshrq_n_u16(in,  5), mask5));
+         uint8x8_t b = vmovn_u16(vandq_u16(in, mask5));
+
+         res.val[0]  = vorr_u8(vshl_n_u8(b, 3), vshr_n_u8(b, 2));
+         res.val[1]  = vorr_u8(vshl_n_u8(g, 3), vshr_n_u8(g, 2));
+         res.val[2]  = vorr_u8(vshl_n_u8(r, 3), vshr_n_u8(r, 2));
+
+         vst3_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -628,6 +1293,8 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    const __m128i a          = _mm_set1_epi16(0x00ff);
 
    int max_width            = width - 15;
+#elif defined(PIXCONV_NEON)
+   int max_width            = width - 7;
 #endif
 
    for (h = 0; h < height; h++, output += out_stride, input += in_stride >> 1)
@@ -676,6 +1343,18 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
 
          store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8, out += 24)
+      {
+         uint8x8x3_t res;
+         uint8x8x4_t px = conv_rgb565_8888_neon(vld1q_u16(input + w));
+
+         res.val[0]     = px.val[0];
+         res.val[1]     = px.val[1];
+         res.val[2]     = px.val[2];
+
+         vst3_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -695,19 +1374,88 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    }
 }
 
+
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("ssse3")
+static int conv_bgr24_argb8888_ssse3(uint32_t *output,
+      const uint8_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width       = width & ~15;
+   const __m128i shuf  = _mm_setr_epi8(
+         0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+   const __m128i alpha = _mm_set1_epi32((int)0xff000000u);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride)
+   {
+      const uint8_t *inp = input;
+      int w;
+      for (w = 0; w < max_width; w += 16, inp += 48)
+      {
+         __m128i in0 = _mm_loadu_si128((const __m128i*)(inp +  0));
+         __m128i in1 = _mm_loadu_si128((const __m128i*)(inp + 16));
+         __m128i in2 = _mm_loadu_si128((const __m128i*)(inp + 32));
+
+         /* Line up every group of 4 pixels (12 bytes)
+          * at the start of a register. */
+         __m128i p0  = in0;
+         __m128i p1  = _mm_alignr_epi8(in1, in0, 12);
+         __m128i p2  = _mm_alignr_epi8(in2, in1,  8);
+         __m128i p3  = _mm_srli_si128(in2, 4);
+
+         _mm_storeu_si128((__m128i*)(output + w +  0),
+               _mm_or_si128(_mm_shuffle_epi8(p0, shuf), alpha));
+         _mm_storeu_si128((__m128i*)(output + w +  4),
+               _mm_or_si128(_mm_shuffle_epi8(p1, shuf), alpha));
+         _mm_storeu_si128((__m128i*)(output + w +  8),
+               _mm_or_si128(_mm_shuffle_epi8(p2, shuf), alpha));
+         _mm_storeu_si128((__m128i*)(output + w + 12),
+               _mm_or_si128(_mm_shuffle_epi8(p3, shuf), alpha));
+      }
+   }
+
+   return max_width;
+}
+#endif
+
 void conv_bgr24_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint8_t *input = (const uint8_t*)input_;
    uint32_t *output     = (uint32_t*)output_;
+#if defined(PIXCONV_NEON)
+   int max_width        = width - 7;
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_ssse3_enabled, conv_bgr24_argb8888_ssse3, 1, 3);
+#endif
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride)
    {
       const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      int w              = 0;
+#if defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8, inp += 24)
+      {
+         uint8x8x4_t res;
+         uint8x8x3_t in = vld3_u8(inp);
+
+         res.val[0]     = in.val[0];
+         res.val[1]     = in.val[1];
+         res.val[2]     = in.val[2];
+         res.val[3]     = vdup_n_u8(0xff);
+
+         vst4_u8((uint8_t*)(output + w), res);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t b = *inp++;
          uint32_t g = *inp++;
@@ -717,18 +1465,104 @@ void conv_bgr24_argb8888(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_argb8888_0rgb1555_avx2(uint16_t *output,
+      const uint32_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width        = width & ~15;
+   const __m256i mask_r = _mm256_set1_epi32(0x7c00);
+   const __m256i mask_g = _mm256_set1_epi32(0x03e0);
+   const __m256i mask_b = _mm256_set1_epi32(0x001f);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         __m256i res[2];
+         int i;
+
+         for (i = 0; i < 2; i++)
+         {
+            const __m256i in = _mm256_loadu_si256(
+                  (const __m256i*)(input + w + i * 8));
+            __m256i r = _mm256_and_si256(_mm256_srli_epi32(in, 9), mask_r);
+            __m256i g = _mm256_and_si256(_mm256_srli_epi32(in, 6), mask_g);
+            __m256i b = _mm256_and_si256(_mm256_srli_epi32(in, 3), mask_b);
+            res[i]    = _mm256_or_si256(r, _mm256_or_si256(g, b));
+         }
+
+         store_pack16_avx2(output + w, res[0], res[1]);
+      }
+   }
+
+   return max_width;
+}
+#endif
+
 void conv_argb8888_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
 
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi32(0x7c00);
+   const __m128i mask_g  = _mm_set1_epi32(0x03e0);
+   const __m128i mask_b  = _mm_set1_epi32(0x001f);
+   int max_width;
+#elif defined(PIXCONV_NEON)
+   int max_width         = width - 7;
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_argb8888_0rgb1555_avx2, 1, 1);
+#endif
+#if defined(__SSE2__)
+   max_width             = width - 7;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i res[2];
+         int i;
+
+         for (i = 0; i < 2; i++)
+         {
+            const __m128i in = _mm_loadu_si128(
+                  (const __m128i*)(input + w + i * 4));
+            __m128i r = _mm_and_si128(_mm_srli_epi32(in, 9), mask_r);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(in, 6), mask_g);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(in, 3), mask_b);
+            res[i]    = _mm_or_si128(r, _mm_or_si128(g, b));
+         }
+
+         _mm_storeu_si128((__m128i*)(output + w),
+               pack16_sse2(res[0], res[1]));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t in = vld4_u8((const uint8_t*)(input + w));
+         uint16x8_t r   = vshll_n_u8(vshr_n_u8(in.val[2], 3), 10);
+         uint16x8_t g   = vshll_n_u8(vshr_n_u8(in.val[1], 3), 5);
+         uint16x8_t b   = vmovl_u8(vshr_n_u8(in.val[0], 3));
+         vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint16_t r   = (col >> 19) & 0x1f;
@@ -739,6 +1573,167 @@ void conv_argb8888_0rgb1555(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_argb8888_rgb565_avx2(uint16_t *output,
+      const uint32_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width        = width & ~15;
+   const __m256i mask_r = _mm256_set1_epi32(0xf800);
+   const __m256i mask_g = _mm256_set1_epi32(0x07e0);
+   const __m256i mask_b = _mm256_set1_epi32(0x001f);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         __m256i res[2];
+         int i;
+
+         for (i = 0; i < 2; i++)
+         {
+            const __m256i in = _mm256_loadu_si256(
+                  (const __m256i*)(input + w + i * 8));
+            __m256i r = _mm256_and_si256(_mm256_srli_epi32(in, 8), mask_r);
+            __m256i g = _mm256_and_si256(_mm256_srli_epi32(in, 5), mask_g);
+            __m256i b = _mm256_and_si256(_mm256_srli_epi32(in, 3), mask_b);
+            res[i]    = _mm256_or_si256(r, _mm256_or_si256(g, b));
+         }
+
+         store_pack16_avx2(output + w, res[0], res[1]);
+      }
+   }
+
+   return max_width;
+}
+#endif
+
+void conv_argb8888_rgb565(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+#if defined(__SSE2__)
+   const __m128i mask_r  = _mm_set1_epi32(0xf800);
+   const __m128i mask_g  = _mm_set1_epi32(0x07e0);
+   const __m128i mask_b  = _mm_set1_epi32(0x001f);
+   int max_width;
+#elif defined(PIXCONV_NEON)
+   int max_width         = width - 7;
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_argb8888_rgb565_avx2, 1, 1);
+#endif
+#if defined(__SSE2__)
+   max_width             = width - 7;
+#endif
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 8)
+      {
+         __m128i res[2];
+         int i;
+
+         for (i = 0; i < 2; i++)
+         {
+            const __m128i in = _mm_loadu_si128(
+                  (const __m128i*)(input + w + i * 4));
+            __m128i r = _mm_and_si128(_mm_srli_epi32(in, 8), mask_r);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(in, 5), mask_g);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(in, 3), mask_b);
+            res[i]    = _mm_or_si128(r, _mm_or_si128(g, b));
+         }
+
+         _mm_storeu_si128((__m128i*)(output + w),
+               pack16_sse2(res[0], res[1]));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 8)
+      {
+         uint8x8x4_t in = vld4_u8((const uint8_t*)(input + w));
+         uint16x8_t r   = vshll_n_u8(vand_u8(in.val[2], vdup_n_u8(0xf8)), 8);
+         uint16x8_t g   = vshll_n_u8(vand_u8(in.val[1], vdup_n_u8(0xfc)), 3);
+         uint16x8_t b   = vmovl_u8(vshr_n_u8(in.val[0], 3));
+         vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+      }
+#endif
+
+      for (; w < width; w++)
+      {
+         uint32_t col = input[w];
+         uint16_t r   = (col >> 19) & 0x1f;
+         uint16_t g   = (col >> 10) & 0x3f;
+         uint16_t b   = (col >>  3) & 0x1f;
+         output[w]    = (r << 11) | (g << 5) | (b << 0);
+      }
+   }
+}
+
+#ifdef PIXCONV_X86_DISPATCH
+/* pshufb does the byte gather that store_bgr24_sse2()
+ * needs a dozen masks and shifts for. */
+PIXCONV_TARGET("ssse3")
+static INLINE int conv_8888_bgr24_ssse3(uint8_t *output,
+      const uint32_t *input, int width, int height,
+      int out_stride, int in_stride, __m128i shuf)
+{
+   int h;
+   int max_width = width & ~15;
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 2)
+   {
+      uint8_t *out = output;
+      int        w;
+      for (w = 0; w < max_width; w += 16, out += 48)
+      {
+         __m128i l0 = _mm_loadu_si128((const __m128i*)(input + w +  0));
+         __m128i l1 = _mm_loadu_si128((const __m128i*)(input + w +  4));
+         __m128i l2 = _mm_loadu_si128((const __m128i*)(input + w +  8));
+         __m128i l3 = _mm_loadu_si128((const __m128i*)(input + w + 12));
+
+         store_bgr24_packed_sse2(out,
+               _mm_shuffle_epi8(l0, shuf), _mm_shuffle_epi8(l1, shuf),
+               _mm_shuffle_epi8(l2, shuf), _mm_shuffle_epi8(l3, shuf));
+      }
+   }
+
+   return max_width;
+}
+
+PIXCONV_TARGET("ssse3")
+static int conv_argb8888_bgr24_ssse3(uint8_t *output,
+      const uint32_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   return conv_8888_bgr24_ssse3(output, input, width, height,
+         out_stride, in_stride, _mm_setr_epi8(
+            0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1));
+}
+
+PIXCONV_TARGET("ssse3")
+static int conv_abgr8888_bgr24_ssse3(uint8_t *output,
+      const uint32_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   return conv_8888_bgr24_ssse3(output, input, width, height,
+         out_stride, in_stride, _mm_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+#endif
+
 void conv_argb8888_bgr24(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -748,9 +1743,18 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
    uint8_t *output       = (uint8_t*)output_;
 
 #if defined(__SSE2__)
+   int max_width;
+#elif defined(PIXCONV_NEON)
    int max_width = width - 15;
 #endif
 
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_ssse3_enabled, conv_argb8888_bgr24_ssse3, 3, 1);
+#endif
+#if defined(__SSE2__)
+   max_width = width - 15;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride, input += in_stride >> 2)
    {
@@ -763,12 +1767,20 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
          __m128i l1 = _mm_loadu_si128((const __m128i*)(input + w +  4));
          __m128i l2 = _mm_loadu_si128((const __m128i*)(input + w +  8));
          __m128i l3 = _mm_loadu_si128((const __m128i*)(input + w + 12));
-         l0 = _mm_shuffle_epi32(l0, _MM_SHUFFLE(3, 0, 1, 2));
-         l1 = _mm_shuffle_epi32(l1, _MM_SHUFFLE(3, 0, 1, 2));
-         l2 = _mm_shuffle_epi32(l2, _MM_SHUFFLE(3, 0, 1, 2));
-         l3 = _mm_shuffle_epi32(l3, _MM_SHUFFLE(3, 0, 1, 2));
          store_bgr24_sse2(out, l0, l1, l2, l3);
       }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 16, out += 48)
+      {
+         uint8x16x3_t res;
+         uint8x16x4_t in = vld4q_u8((const uint8_t*)(input + w));
+
+         res.val[0]      = in.val[0];
+         res.val[1]      = in.val[1];
+         res.val[2]      = in.val[2];
+
+         vst3q_u8(out, res);
+      }
 #endif
 
       for (; w < width; w++)
@@ -790,9 +1802,18 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
    uint8_t *output       = (uint8_t*)output_;
 
 #if defined(__SSE2__)
+   int max_width;
+#elif defined(PIXCONV_NEON)
    int max_width = width - 15;
 #endif
 
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_ssse3_enabled, conv_abgr8888_bgr24_ssse3, 3, 1);
+#endif
+#if defined(__SSE2__)
+   max_width = width - 15;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride, input += in_stride >> 2)
    {
@@ -802,10 +1823,22 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
       for (; w < max_width; w += 16, out += 48)
       {
          store_bgr24_sse2(out,
-               _mm_loadu_si128((const __m128i*)(input + w +  0)),
-               _mm_loadu_si128((const __m128i*)(input + w +  4)),
-               _mm_loadu_si128((const __m128i*)(input + w +  8)),
-               _mm_loadu_si128((const __m128i*)(input + w + 12)));
+               swap_rb_sse2(_mm_loadu_si128((const __m128i*)(input + w +  0))),
+               swap_rb_sse2(_mm_loadu_si128((const __m128i*)(input + w +  4))),
+               swap_rb_sse2(_mm_loadu_si128((const __m128i*)(input + w +  8))),
+               swap_rb_sse2(_mm_loadu_si128((const __m128i*)(input + w + 12))));
+      }
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 16, out += 48)
+      {
+         uint8x16x3_t res;
+         uint8x16x4_t in = vld4q_u8((const uint8_t*)(input + w));
+
+         res.val[0]      = in.val[2];
+         res.val[1]      = in.val[1];
+         res.val[2]      = in.val[0];
+
+         vst3q_u8(out, res);
       }
 #endif
 
@@ -819,19 +1852,78 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_argb8888_abgr8888_avx2(uint32_t *output,
+      const uint32_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width      = width & ~15;
+   const __m256i shuf = _mm256_setr_epi8(
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 2)
+   {
+      int w;
+      for (w = 0; w < max_width; w += 16)
+      {
+         __m256i l0 = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+         __m256i l1 = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+         _mm256_storeu_si256((__m256i*)(output + w + 0),
+               _mm256_shuffle_epi8(l0, shuf));
+         _mm256_storeu_si256((__m256i*)(output + w + 8),
+               _mm256_shuffle_epi8(l1, shuf));
+      }
+   }
+
+   return max_width;
+}
+#endif
 
 void conv_argb8888_abgr8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
 
+#if defined(__SSE2__)
+   int max_width;
+#elif defined(PIXCONV_NEON)
+   int max_width         = width - 15;
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_argb8888_abgr8888_avx2, 1, 1);
+#endif
+#if defined(__SSE2__)
+   max_width             = width - 3;
+#endif
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = 0;
+#if defined(__SSE2__)
+      for (; w < max_width; w += 4)
+         _mm_storeu_si128((__m128i*)(output + w), swap_rb_sse2(
+                  _mm_loadu_si128((const __m128i*)(input + w))));
+#elif defined(PIXCONV_NEON)
+      for (; w < max_width; w += 16)
+      {
+         uint8x16x4_t px = vld4q_u8((const uint8_t*)(input + w));
+         uint8x16_t    b = px.val[0];
+         px.val[0]       = px.val[2];
+         px.val[2]       = b;
+         vst4q_u8((uint8_t*)(output + w), px);
+      }
+#endif
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          output[w]    = ((col << 16) & 0xff0000) |
@@ -848,6 +1940,118 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
 #define YUV_MAT_V_R (90)
 #define YUV_MAT_V_G (-46)
 
+#ifdef PIXCONV_X86_DISPATCH
+PIXCONV_TARGET("avx2")
+static int conv_yuyv_argb8888_avx2(uint32_t *output,
+      const uint8_t *input, int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   int max_width               = width & ~31;
+   const __m256i mask_y        = _mm256_set1_epi16(0xffu);
+   const __m256i mask_u        = _mm256_set1_epi32(0xffu << 8);
+   const __m256i mask_v        = _mm256_set1_epi32((int)(0xffu << 24));
+   const __m256i chroma_offset = _mm256_set1_epi16(128);
+   const __m256i round_offset  = _mm256_set1_epi16(YUV_OFFSET);
+
+   const __m256i yuv_mul       = _mm256_set1_epi16(YUV_MAT_Y);
+   const __m256i u_g_mul       = _mm256_set1_epi16(YUV_MAT_U_G);
+   const __m256i u_b_mul       = _mm256_set1_epi16(YUV_MAT_U_B);
+   const __m256i v_r_mul       = _mm256_set1_epi16(YUV_MAT_V_R);
+   const __m256i v_g_mul       = _mm256_set1_epi16(YUV_MAT_V_G);
+   const __m256i a             = _mm256_set1_epi16(-1);
+
+   for (h = 0; h < height; h++, output += out_stride >> 2, input += in_stride)
+   {
+      const uint8_t *src = input;
+      uint32_t      *dst = output;
+      int              w;
+
+      /* Each loop processes 32 pixels, as two independent
+       * 16 pixel halves of the SSE2 loop, one per 128-bit lane. */
+      for (w = 0; w < max_width; w += 32, src += 64, dst += 32)
+      {
+         __m256i u, v, u0_g, u1_g, u0_b, u1_b, v0_r, v1_r, v0_g, v1_g,
+                 r0, g0, b0, r1, g1, b1;
+         __m256i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+         __m256i res0, res1, res2, res3;
+         __m256i l0   = _mm256_loadu_si256((const __m256i*)(src +  0));
+         __m256i l1   = _mm256_loadu_si256((const __m256i*)(src + 32));
+         __m256i yuv0 = _mm256_permute2x128_si256(l0, l1, 0x20);
+         __m256i yuv1 = _mm256_permute2x128_si256(l0, l1, 0x31);
+
+         __m256i _y0  = _mm256_and_si256(yuv0, mask_y);
+         __m256i u0   = _mm256_and_si256(yuv0, mask_u);
+         __m256i v0   = _mm256_and_si256(yuv0, mask_v);
+         __m256i _y1  = _mm256_and_si256(yuv1, mask_y);
+         __m256i u1   = _mm256_and_si256(yuv1, mask_u);
+         __m256i v1   = _mm256_and_si256(yuv1, mask_v);
+
+         u0   = _mm256_srli_si256(u0, 1);
+         v0   = _mm256_srli_si256(v0, 3);
+         u1   = _mm256_srli_si256(u1, 1);
+         v1   = _mm256_srli_si256(v1, 3);
+         u    = _mm256_sub_epi16(_mm256_packs_epi32(u0, u1), chroma_offset);
+         v    = _mm256_sub_epi16(_mm256_packs_epi32(v0, v1), chroma_offset);
+
+         u0   = _mm256_unpacklo_epi16(u, u);
+         u1   = _mm256_unpackhi_epi16(u, u);
+         v0   = _mm256_unpacklo_epi16(v, v);
+         v1   = _mm256_unpackhi_epi16(v, v);
+
+         _y0  = _mm256_mullo_epi16(_y0, yuv_mul);
+         _y1  = _mm256_mullo_epi16(_y1, yuv_mul);
+         u0_g = _mm256_mullo_epi16(u0, u_g_mul);
+         u1_g = _mm256_mullo_epi16(u1, u_g_mul);
+         u0_b = _mm256_mullo_epi16(u0, u_b_mul);
+         u1_b = _mm256_mullo_epi16(u1, u_b_mul);
+         v0_r = _mm256_mullo_epi16(v0, v_r_mul);
+         v1_r = _mm256_mullo_epi16(v1, v_r_mul);
+         v0_g = _mm256_mullo_epi16(v0, v_g_mul);
+         v1_g = _mm256_mullo_epi16(v1, v_g_mul);
+
+         r0   = _mm256_srai_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y0, v0_r), round_offset), YUV_SHIFT);
+         g0   = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y0, v0_g), u0_g), round_offset), YUV_SHIFT);
+         b0   = _mm256_srai_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y0, u0_b), round_offset), YUV_SHIFT);
+         r1   = _mm256_srai_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y1, v1_r), round_offset), YUV_SHIFT);
+         g1   = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y1, v1_g), u1_g), round_offset), YUV_SHIFT);
+         b1   = _mm256_srai_epi16(_mm256_adds_epi16(
+                  _mm256_adds_epi16(_y1, u1_b), round_offset), YUV_SHIFT);
+
+         r0   = _mm256_packus_epi16(r0, r1);
+         g0   = _mm256_packus_epi16(g0, g1);
+         b0   = _mm256_packus_epi16(b0, b1);
+
+         res_lo_bg = _mm256_unpacklo_epi8(b0, g0);
+         res_hi_bg = _mm256_unpackhi_epi8(b0, g0);
+         res_lo_ra = _mm256_unpacklo_epi8(r0, a);
+         res_hi_ra = _mm256_unpackhi_epi8(r0, a);
+         res0      = _mm256_unpacklo_epi16(res_lo_bg, res_lo_ra);
+         res1      = _mm256_unpackhi_epi16(res_lo_bg, res_lo_ra);
+         res2      = _mm256_unpacklo_epi16(res_hi_bg, res_hi_ra);
+         res3      = _mm256_unpackhi_epi16(res_hi_bg, res_hi_ra);
+
+         /* Lane 0 holds pixels 0-15, lane 1 pixels 16-31. */
+         _mm256_storeu_si256((__m256i*)(dst +  0),
+               _mm256_permute2x128_si256(res0, res1, 0x20));
+         _mm256_storeu_si256((__m256i*)(dst +  8),
+               _mm256_permute2x128_si256(res2, res3, 0x20));
+         _mm256_storeu_si256((__m256i*)(dst + 16),
+               _mm256_permute2x128_si256(res0, res1, 0x31));
+         _mm256_storeu_si256((__m256i*)(dst + 24),
+               _mm256_permute2x128_si256(res2, res3, 0x31));
+      }
+   }
+
+   return max_width;
+}
+#endif
+
 void conv_yuyv_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
@@ -870,6 +2074,13 @@ void conv_yuyv_argb8888(void *output_, const void *input_,
    const __m128i v_g_mul       = _mm_set1_epi16(YUV_MAT_V_G);
    const __m128i a             = _mm_cmpeq_epi16(
          _mm_setzero_si128(), _mm_setzero_si128());
+#elif defined(PIXCONV_NEON)
+   const int16x8_t chroma_offset = vdupq_n_s16(128);
+   const int16x8_t round_offset  = vdupq_n_s16(YUV_OFFSET);
+#endif
+
+#ifdef PIXCONV_X86_DISPATCH
+   PIXCONV_DISPATCH(conv_avx2_enabled, conv_yuyv_argb8888_avx2, 1, 2);
 #endif
 
    for (h = 0; h < height; h++, output += out_stride >> 2, input += in_stride)
@@ -961,6 +2172,44 @@ void conv_yuyv_argb8888(void *output_, const void *input_,
          _mm_storeu_si128((__m128i*)(dst +  8), res2);
          _mm_storeu_si128((__m128i*)(dst + 12), res3);
       }
+#elif defined(PIXCONV_NEON)
+      /* Each loop processes 16 pixels. The sums stay within
+       * 16 bits, so only the final narrowing has to saturate. */
+      for (; w + 16 <= width; w += 16, src += 32, dst += 16)
+      {
+         uint8x8x4_t res;
+         uint8x8x2_t r, g, b;
+         uint8x8x4_t yuv = vld4_u8(src); /* [Y0, U, Y1, V] x 8 */
+         int16x8_t   u   = vsubq_s16(vreinterpretq_s16_u16(
+                  vmovl_u8(yuv.val[1])), chroma_offset);
+         int16x8_t   v   = vsubq_s16(vreinterpretq_s16_u16(
+                  vmovl_u8(yuv.val[3])), chroma_offset);
+         int16x8_t  _y0  = vreinterpretq_s16_u16(vshll_n_u8(yuv.val[0], 6));
+         int16x8_t  _y1  = vreinterpretq_s16_u16(vshll_n_u8(yuv.val[2], 6));
+
+         int16x8_t  cr   = vmlaq_n_s16(round_offset, v, YUV_MAT_V_R);
+         int16x8_t  cg   = vmlaq_n_s16(vmlaq_n_s16(round_offset,
+                  u, YUV_MAT_U_G), v, YUV_MAT_V_G);
+         int16x8_t  cb   = vmlaq_n_s16(round_offset, u, YUV_MAT_U_B);
+
+         /* Even and odd pixels, zipped back into order. */
+         r = vzip_u8(vqshrun_n_s16(vaddq_s16(_y0, cr), YUV_SHIFT),
+               vqshrun_n_s16(vaddq_s16(_y1, cr), YUV_SHIFT));
+         g = vzip_u8(vqshrun_n_s16(vaddq_s16(_y0, cg), YUV_SHIFT),
+               vqshrun_n_s16(vaddq_s16(_y1, cg), YUV_SHIFT));
+         b = vzip_u8(vqshrun_n_s16(vaddq_s16(_y0, cb), YUV_SHIFT),
+               vqshrun_n_s16(vaddq_s16(_y1, cb), YUV_SHIFT));
+
+         res.val[3] = vdup_n_u8(0xff);
+         res.val[0] = b.val[0];
+         res.val[1] = g.val[0];
+         res.val[2] = r.val[0];
+         vst4_u8((uint8_t*)(dst + 0), res);
+         res.val[0] = b.val[1];
+         res.val[1] = g.val[1];
+         res.val[2] = r.val[1];
+         vst4_u8((uint8_t*)(dst + 8), res);
+      }
 #endif
 
       /* Finish off the rest (if any) in C. */
@@ -77,6 +77,7 @@ static bool allocate_frames(struct scaler_ctx *ctx)
 bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 {
    scaler_ctx_gen_reset(ctx);
+   conv_init_simd();
 
    ctx->scaler_special = NULL;
    ctx->unscaled       = false;
@@ -148,6 +149,9 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
                   case SCALER_FMT_0RGB1555:
                      ctx->direct_pixconv = conv_argb8888_0rgb1555;
                      break;
+                  case SCALER_FMT_RGB565:
+                     ctx->direct_pixconv = conv_argb8888_rgb565;
+                     break;
                   case SCALER_FMT_BGR24:
                      ctx->direct_pixconv = conv_argb8888_bgr24;
                      break;
@@ -245,6 +249,10 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
             ctx->out_pixconv = conv_argb8888_0rgb1555;
             break;
 
+         case SCALER_FMT_RGB565:
+            ctx->out_pixconv = conv_argb8888_rgb565;
+            break;
+
          case SCALER_FMT_BGR24:
             ctx->out_pixconv = conv_argb8888_bgr24;
             break;
@@ -56,16 +56,41 @@ typedef struct
 } audio_chunk_t;
 
 #if defined(__SSE2__)
-#define audio_mix_volume           audio_mix_volume_SSE2
-
 void audio_mix_volume_SSE2(float *out,
       const float *in, float vol, size_t samples);
-#else
-#define audio_mix_volume           audio_mix_volume_C
 #endif
 
 void audio_mix_volume_C(float *dst, const float *src, float vol, size_t samples);
 
+/**
+ * audio_mix_init_simd:
+ *
+ * Enables the AVX2 variants of the mixing functions when
+ * the CPU supports them. Safe to call more than once.
+ **/
+void audio_mix_init_simd(void);
+
+/**
+ * audio_mix_volume:
+ * @out              : buffer to mix into
+ * @in               : samples to add
+ * @vol              : gain applied to @in
+ * @samples          : number of samples
+ *
+ * Adds @in scaled by @vol to @out, using the widest
+ * vector unit available.
+ **/
+void audio_mix_volume(float *out, const float *in, float vol, size_t samples);
+
+/**
+ * audio_mix_clamp:
+ * @buf              : samples to clamp
+ * @samples          : number of samples
+ *
+ * Clamps mixed samples to the [-1.0, 1.0] range.
+ **/
+void audio_mix_clamp(float *buf, size_t samples);
+
 void audio_mix_free_chunk(audio_chunk_t *chunk);
 
 audio_chunk_t* audio_mix_load_wav_file(const char *path, int sample_rate);
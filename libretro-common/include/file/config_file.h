@@ -61,6 +61,13 @@ struct config_file
    bool guaranteed_no_duplicates;
 
    struct config_include_list *includes;
+
+   /* Open addressing hash table pointing to the first
+    * entry of the list for each key. Kept in sync with
+    * the list, which stays authoritative for ordering. */
+   struct config_entry_list **index;
+   size_t index_size;
+   size_t index_count;
 };
 
 typedef struct config_file config_file_t;
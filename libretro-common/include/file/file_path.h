@@ -498,6 +498,18 @@ bool path_is_valid(const char *path);
 
 int32_t path_get_size(const char *path);
 
+/**
+ * path_get_stamp:
+ * @path               : path
+ * @size               : receives the size of the file
+ * @mtime              : receives the modification time of the file
+ *
+ * Gets the size and modification time of a regular file.
+ *
+ * Returns: true (1) if the stamp could be determined, otherwise false (0).
+ */
+bool path_get_stamp(const char *path, int64_t *size, int64_t *mtime);
+
 RETRO_END_DECLS
 
 #endif
@@ -29,6 +29,11 @@
 
 RETRO_BEGIN_DECLS
 
+/* Picks the widest SIMD variant of every converter the CPU
+ * supports. Converters fall back to SSE2/NEON/C until this
+ * has been called. */
+void conv_init_simd(void);
+
 void conv_0rgb1555_argb8888(void *output, const void *input,
       int width, int height,
       int out_stride, int in_stride);
@@ -346,6 +346,11 @@ chd_error chd_open(const char *filename, int mode, chd_file *parent, chd_file **
 /* precache underlying file */
 chd_error chd_precache(chd_file *chd);
 
+/* keep up to 'hunks' decompressed hunks in an LRU cache, and
+   decompress the 'prefetch' hunks following each read in the
+   background (needs HAVE_THREADS); 0 hunks disables the cache */
+chd_error chd_set_hunk_cache(chd_file *chd, UINT32 hunks, UINT32 prefetch);
+
 /* close a CHD file */
 void chd_close(chd_file *chd);
 
@@ -0,0 +1,88 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (string_map.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_STRING_MAP_H
+#define __LIBRETRO_SDK_STRING_MAP_H
+
+#include <retro_common_api.h>
+
+#include <boolean.h>
+#include <stdint.h>
+#include <stddef.h>
+
+RETRO_BEGIN_DECLS
+
+struct string_map_slot
+{
+   const char *key;
+   uint32_t hash;
+   size_t value;
+};
+
+/* Open addressing hash map from strings to size_t
+ * values (typically indices into an array owned by
+ * the caller). Keys are borrowed, not copied.
+ * A zero-initialized map is a valid empty map. */
+struct string_map
+{
+   struct string_map_slot *slots;
+   size_t capacity;
+   size_t count;
+};
+
+/**
+ * string_map_insert:
+ * @map              : pointer to string map
+ * @key              : key, must outlive the map
+ * @value            : value to associate with @key
+ *
+ * Inserts @key, or replaces the value of an existing
+ * @key.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+bool string_map_insert(struct string_map *map,
+      const char *key, size_t value);
+
+/**
+ * string_map_find:
+ * @map              : pointer to string map
+ * @key              : key to look up
+ * @value            : if not NULL, receives the value of @key
+ *
+ * Returns: true (1) if @key is in the map, otherwise false (0).
+ **/
+bool string_map_find(const struct string_map *map,
+      const char *key, size_t *value);
+
+/**
+ * string_map_free:
+ * @map              : pointer to string map
+ *
+ * Frees the slots and leaves an empty map behind.
+ * The keys are not touched.
+ **/
+void string_map_free(struct string_map *map);
+
+RETRO_END_DECLS
+
+#endif
@@ -42,6 +42,20 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+enum task_priority
+{
+   /* Default class: generic file and network IO
+    * (downloads, savestates, decompression...). */
+   TASK_PRIORITY_IO = 0,
+   /* Menu-facing work the user is actively waiting
+    * for (thumbnails...). Always scheduled first. */
+   TASK_PRIORITY_INTERACTIVE,
+   /* Bulk work (database scans...). Only scheduled
+    * when nothing else is runnable. */
+   TASK_PRIORITY_BACKGROUND,
+   TASK_PRIORITY_COUNT
+};
+
 typedef struct retro_task retro_task_t;
 typedef void (*retro_task_callback_t)(retro_task_t *task,
       void *task_data,
@@ -58,6 +72,8 @@ typedef void (*retro_task_queue_msg_t)(retro_task_t *task,
 
 typedef bool (*retro_task_retriever_t)(retro_task_t *task, void *data);
 
+typedef void (*retro_task_trace_t)(retro_task_t *task, bool begin);
+
 typedef bool (*retro_task_condition_fn_t)(void *data);
 
 typedef struct
@@ -111,6 +127,9 @@ struct retro_task
 
    enum task_type type;
 
+   /* scheduling class, set before pushing the task */
+   enum task_priority priority;
+
    /* task identifier */
    uint32_t ident;
 
@@ -118,10 +137,33 @@ struct retro_task
     * (e.g. associate a sticky notification to a task) */
    void *frontend_userdata;
 
-   /* don't touch this. */
+   /* don't touch these. */
+   int64_t when_queued;
    retro_task_t *next;
 };
 
+typedef struct task_queue_stats
+{
+   /* number of worker threads, 0 when not threaded */
+   unsigned workers;
+
+   /* tasks currently inside their handler */
+   unsigned running;
+
+   /* runnable tasks waiting for their next handler call */
+   unsigned queued[TASK_PRIORITY_COUNT];
+
+   /* handler calls since the task system was first initialized */
+   uint64_t dispatched[TASK_PRIORITY_COUNT];
+
+   /* time spent queued before each handler call */
+   uint64_t latency_avg_usec[TASK_PRIORITY_COUNT];
+   uint64_t latency_max_usec[TASK_PRIORITY_COUNT];
+
+   /* tasks a worker took from another worker's deque */
+   uint64_t steals;
+} task_queue_stats_t;
+
 typedef struct task_finder_data
 {
    retro_task_finder_t func;
@@ -187,6 +229,24 @@ void task_queue_unset_threaded(void);
 
 bool task_queue_is_threaded(void);
 
+/* Sets the number of worker threads used by
+ * the threaded implementation.
+ * Takes effect the next time the task system
+ * is initialized. 0 is treated as 1.
+ * With more than one worker, handlers of
+ * different tasks run at the same time and
+ * must not share state without locking. */
+void task_queue_set_workers(unsigned workers);
+
+/* Fills stats with the current queue depth
+ * and per-priority dispatch latency. */
+void task_queue_get_stats(task_queue_stats_t *stats);
+
+/* Sets a function called right before and right after
+ * every task handler call, on the thread running it.
+ * Used for tracing; NULL removes it. */
+void task_queue_set_trace_hook(retro_task_trace_t hook);
+
 /**
  * Calls func for every running task
  * until it returns true.
@@ -0,0 +1,237 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (retro_atomic.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_ATOMIC_H
+#define __LIBRETRO_SDK_ATOMIC_H
+
+#include <stddef.h>
+
+#include <retro_inline.h>
+
+/* Minimal atomic integer operations for lock-free hand-offs
+ * between two threads. Loads have acquire semantics, stores
+ * have release semantics and exchanges are full barriers.
+ *
+ * retro_atomic_size_t is an unsigned counter as wide as size_t
+ * (64 bits on 64-bit targets) that wraps around on overflow.
+ * The fences order plain accesses around them, e.g. the data
+ * of a seqlock.
+ *
+ * RETRO_ATOMIC_LOCK_FREE is only defined when the compiler
+ * provides them; callers must fall back to a lock otherwise. */
+
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define RETRO_ATOMIC_LOCK_FREE 1
+
+typedef volatile int retro_atomic_int_t;
+
+static INLINE int retro_atomic_int_load(retro_atomic_int_t *p)
+{
+   return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static INLINE void retro_atomic_int_store(retro_atomic_int_t *p, int v)
+{
+   __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static INLINE int retro_atomic_int_exchange(retro_atomic_int_t *p, int v)
+{
+   return __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL);
+}
+
+static INLINE int retro_atomic_int_fetch_add(retro_atomic_int_t *p, int v)
+{
+   return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL);
+}
+
+typedef volatile size_t retro_atomic_size_t;
+
+static INLINE size_t retro_atomic_size_load(retro_atomic_size_t *p)
+{
+   return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static INLINE void retro_atomic_size_store(retro_atomic_size_t *p, size_t v)
+{
+   __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static INLINE size_t retro_atomic_size_fetch_add(retro_atomic_size_t *p, size_t v)
+{
+   return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL);
+}
+
+static INLINE void retro_atomic_fence_acquire(void)
+{
+   __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+static INLINE void retro_atomic_fence_release(void)
+{
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+#elif defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+#define RETRO_ATOMIC_LOCK_FREE 1
+
+typedef volatile int retro_atomic_int_t;
+
+static INLINE int retro_atomic_int_load(retro_atomic_int_t *p)
+{
+   int v = *p;
+   __sync_synchronize();
+   return v;
+}
+
+static INLINE void retro_atomic_int_store(retro_atomic_int_t *p, int v)
+{
+   __sync_synchronize();
+   *p = v;
+}
+
+static INLINE int retro_atomic_int_exchange(retro_atomic_int_t *p, int v)
+{
+   /* __sync_lock_test_and_set is only an acquire barrier */
+   __sync_synchronize();
+   return __sync_lock_test_and_set(p, v);
+}
+
+static INLINE int retro_atomic_int_fetch_add(retro_atomic_int_t *p, int v)
+{
+   return __sync_fetch_and_add(p, v);
+}
+
+typedef volatile size_t retro_atomic_size_t;
+
+static INLINE size_t retro_atomic_size_load(retro_atomic_size_t *p)
+{
+   size_t v = *p;
+   __sync_synchronize();
+   return v;
+}
+
+static INLINE void retro_atomic_size_store(retro_atomic_size_t *p, size_t v)
+{
+   __sync_synchronize();
+   *p = v;
+}
+
+static INLINE size_t retro_atomic_size_fetch_add(retro_atomic_size_t *p, size_t v)
+{
+   return __sync_fetch_and_add(p, v);
+}
+
+static INLINE void retro_atomic_fence_acquire(void)
+{
+   __sync_synchronize();
+}
+
+static INLINE void retro_atomic_fence_release(void)
+{
+   __sync_synchronize();
+}
+#elif defined(_MSC_VER) && _MSC_VER >= 1400
+#define RETRO_ATOMIC_LOCK_FREE 1
+
+#include <intrin.h>
+
+#pragma intrinsic(_InterlockedExchange, _InterlockedCompareExchange, _InterlockedExchangeAdd)
+
+typedef volatile long retro_atomic_int_t;
+
+/* Interlocked operations are full barriers on every target,
+ * unlike plain volatile accesses on ARM */
+static INLINE int retro_atomic_int_load(retro_atomic_int_t *p)
+{
+   return (int)_InterlockedCompareExchange(p, 0, 0);
+}
+
+static INLINE void retro_atomic_int_store(retro_atomic_int_t *p, int v)
+{
+   _InterlockedExchange(p, v);
+}
+
+static INLINE int retro_atomic_int_exchange(retro_atomic_int_t *p, int v)
+{
+   return (int)_InterlockedExchange(p, v);
+}
+
+static INLINE int retro_atomic_int_fetch_add(retro_atomic_int_t *p, int v)
+{
+   return (int)_InterlockedExchangeAdd(p, v);
+}
+
+#ifdef _WIN64
+#pragma intrinsic(_InterlockedExchange64, _InterlockedCompareExchange64, _InterlockedExchangeAdd64)
+
+typedef volatile __int64 retro_atomic_size_t;
+
+static INLINE size_t retro_atomic_size_load(retro_atomic_size_t *p)
+{
+   return (size_t)_InterlockedCompareExchange64(p, 0, 0);
+}
+
+static INLINE void retro_atomic_size_store(retro_atomic_size_t *p, size_t v)
+{
+   _InterlockedExchange64(p, (__int64)v);
+}
+
+static INLINE size_t retro_atomic_size_fetch_add(retro_atomic_size_t *p, size_t v)
+{
+   return (size_t)_InterlockedExchangeAdd64(p, (__int64)v);
+}
+#else
+typedef volatile long retro_atomic_size_t;
+
+static INLINE size_t retro_atomic_size_load(retro_atomic_size_t *p)
+{
+   return (size_t)(unsigned long)_InterlockedCompareExchange(p, 0, 0);
+}
+
+static INLINE void retro_atomic_size_store(retro_atomic_size_t *p, size_t v)
+{
+   _InterlockedExchange(p, (long)v);
+}
+
+static INLINE size_t retro_atomic_size_fetch_add(retro_atomic_size_t *p, size_t v)
+{
+   return (size_t)(unsigned long)_InterlockedExchangeAdd(p, (long)v);
+}
+#endif
+
+static INLINE void retro_atomic_fence_acquire(void)
+{
+   long fence = 0;
+   _InterlockedExchange(&fence, 0);
+}
+
+static INLINE void retro_atomic_fence_release(void)
+{
+   long fence = 0;
+   _InterlockedExchange(&fence, 0);
+}
+#else
+typedef volatile int retro_atomic_int_t;
+typedef volatile size_t retro_atomic_size_t;
+#endif
+
+#endif
@@ -103,6 +103,15 @@ void sthread_join(sthread_t *thread);
  */
 bool sthread_isself(sthread_t *thread);
 
+/**
+ * sthread_get_current_thread_id:
+ *
+ * Returns: an identifier for the calling thread, unique
+ * among running threads. Also valid for threads that were
+ * not created through sthread_create.
+ */
+uintptr_t sthread_get_current_thread_id(void);
+
 /**
  * slock_new:
  *
@@ -102,6 +102,18 @@ int filestream_rename(const char *old_path, const char *new_path);
 
 const char *filestream_get_path(RFILE *stream);
 
+/**
+ * filestream_get_mapped:
+ * @stream             : file opened for reading with
+ *                       RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS
+ * @size               : receives the size of the mapping
+ *
+ * Returns: read-only pointer to the whole memory-mapped file,
+ * valid until the stream is closed, or NULL if the file is not
+ * memory-mapped.
+ **/
+const void *filestream_get_mapped(RFILE *stream, int64_t *size);
+
 bool filestream_exists(const char *path);
 
 char *filestream_getline(RFILE *stream);
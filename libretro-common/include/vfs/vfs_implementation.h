@@ -74,6 +74,8 @@ int retro_vfs_file_rename_impl(const char *old_path, const char *new_path);
 
 const char *retro_vfs_file_get_path_impl(libretro_vfs_implementation_file *stream);
 
+const void *retro_vfs_file_get_mapped_impl(libretro_vfs_implementation_file *stream, uint64_t *size);
+
 int retro_vfs_stat_impl(const char *path, int32_t *size);
 
 int retro_vfs_mkdir_impl(const char *dir);
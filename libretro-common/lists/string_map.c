@@ -0,0 +1,136 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (string_map.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include <lists/string_map.h>
+#include <rhash.h>
+#include <string/stdstring.h>
+
+/* Number of slots of a map's first allocation,
+ * must be a power of two. */
+#define STRING_MAP_MIN_CAPACITY 64
+
+static bool string_map_resize(struct string_map *map, size_t capacity)
+{
+   size_t i;
+   struct string_map_slot *old_slots = map->slots;
+   size_t old_capacity               = map->capacity;
+   struct string_map_slot *slots     = (struct string_map_slot*)
+      calloc(capacity, sizeof(*slots));
+
+   if (!slots)
+      return false;
+
+   map->slots    = slots;
+   map->capacity = capacity;
+
+   for (i = 0; i < old_capacity; i++)
+   {
+      size_t pos;
+
+      if (!old_slots[i].key)
+         continue;
+
+      pos = old_slots[i].hash & (capacity - 1);
+      while (slots[pos].key)
+         pos = (pos + 1) & (capacity - 1);
+      slots[pos] = old_slots[i];
+   }
+
+   free(old_slots);
+   return true;
+}
+
+bool string_map_insert(struct string_map *map,
+      const char *key, size_t value)
+{
+   size_t pos;
+   uint32_t hash;
+
+   if (!map || !key)
+      return false;
+
+   /* Keep the load factor at or below one half */
+   if ((map->count + 1) * 2 > map->capacity)
+      if (!string_map_resize(map, map->capacity
+               ? map->capacity * 2 : STRING_MAP_MIN_CAPACITY))
+         return false;
+
+   hash = djb2_calculate(key);
+   pos  = hash & (map->capacity - 1);
+
+   while (map->slots[pos].key)
+   {
+      if (     map->slots[pos].hash == hash
+            && string_is_equal(map->slots[pos].key, key))
+      {
+         map->slots[pos].value = value;
+         return true;
+      }
+      pos = (pos + 1) & (map->capacity - 1);
+   }
+
+   map->slots[pos].key   = key;
+   map->slots[pos].hash  = hash;
+   map->slots[pos].value = value;
+   map->count++;
+   return true;
+}
+
+bool string_map_find(const struct string_map *map,
+      const char *key, size_t *value)
+{
+   size_t pos;
+   uint32_t hash;
+
+   if (!map || !map->count || !key)
+      return false;
+
+   hash = djb2_calculate(key);
+   pos  = hash & (map->capacity - 1);
+
+   while (map->slots[pos].key)
+   {
+      if (     map->slots[pos].hash == hash
+            && string_is_equal(map->slots[pos].key, key))
+      {
+         if (value)
+            *value = map->slots[pos].value;
+         return true;
+      }
+      pos = (pos + 1) & (map->capacity - 1);
+   }
+
+   return false;
+}
+
+void string_map_free(struct string_map *map)
+{
+   if (!map)
+      return;
+
+   free(map->slots);
+   map->slots    = NULL;
+   map->capacity = 0;
+   map->count    = 0;
+}
@@ -23,13 +23,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include <queues/task_queue.h>
+#include <features/features_cpu.h>
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
 #define SLOCK_LOCK(x) slock_lock(x)
 #define SLOCK_UNLOCK(x) slock_unlock(x)
+
+/* only created by the threaded implementation */
+static slock_t *stats_lock      = NULL;
 #else
 #define SLOCK_LOCK(x)
 #define SLOCK_UNLOCK(x)
@@ -53,6 +58,22 @@ struct retro_task_impl
    void (*retrieve)(task_retriever_data_t *data);
    void (*init)(void);
    void (*deinit)(void);
+   void (*stats)(task_queue_stats_t *stats);
+};
+
+struct task_queue_counters
+{
+   uint64_t dispatched[TASK_PRIORITY_COUNT];
+   uint64_t latency_total[TASK_PRIORITY_COUNT];
+   uint64_t latency_max[TASK_PRIORITY_COUNT];
+   uint64_t steals;
+};
+
+/* Order in which the priority classes are scheduled */
+static const enum task_priority task_priority_order[TASK_PRIORITY_COUNT] = {
+   TASK_PRIORITY_INTERACTIVE,
+   TASK_PRIORITY_IO,
+   TASK_PRIORITY_BACKGROUND
 };
 
 static retro_task_queue_msg_t msg_push_bak;
@@ -63,6 +84,10 @@ static struct retro_task_impl *impl_current = NULL;
 static bool task_threaded_enable            = false;
 
 static uint32_t task_count                  = 0;
+static unsigned task_workers_wanted         = 1;
+static retro_task_trace_t task_trace_hook    = NULL;
+
+static struct task_queue_counters task_counters;
 
 static void task_queue_msg_push(retro_task_t *task,
       unsigned prio, unsigned duration,
@@ -107,6 +132,36 @@ static void task_queue_push_progress(retro_task_t *task)
    }
 }
 
+static void task_queue_mark_queued(retro_task_t *task)
+{
+   task->when_queued = cpu_features_get_time_usec();
+}
+
+static void task_queue_run_handler(retro_task_t *task)
+{
+   retro_task_trace_t hook = task_trace_hook;
+
+   if (hook)
+      hook(task, true);
+   task->handler(task);
+   if (hook)
+      hook(task, false);
+}
+
+static void task_queue_mark_dispatched(retro_task_t *task)
+{
+   uint64_t latency = (uint64_t)
+      (cpu_features_get_time_usec() - task->when_queued);
+   unsigned prio    = task->priority;
+
+   SLOCK_LOCK(stats_lock);
+   task_counters.dispatched[prio]++;
+   task_counters.latency_total[prio] += latency;
+   if (latency > task_counters.latency_max[prio])
+      task_counters.latency_max[prio] = latency;
+   SLOCK_UNLOCK(stats_lock);
+}
+
 static void task_queue_put(task_queue_t *queue, retro_task_t *task)
 {
    task->next = NULL;
@@ -157,6 +212,7 @@ static void retro_task_internal_gather(void)
 
 static void retro_task_regular_push_running(retro_task_t *task)
 {
+   task_queue_mark_queued(task);
    task_queue_put(&tasks_running, task);
 }
 
@@ -168,27 +224,31 @@ static void retro_task_regular_cancel(void *task)
 
 static void retro_task_regular_gather(void)
 {
-   retro_task_t *task  = NULL;
-   retro_task_t *queue = NULL;
-   retro_task_t *next  = NULL;
+   unsigned i;
+   retro_task_t *task = NULL;
+   task_queue_t queues[TASK_PRIORITY_COUNT];
+
+   memset(queues, 0, sizeof(queues));
 
    while ((task = task_queue_get(&tasks_running)) != NULL)
-   {
-      task->next = queue;
-      queue = task;
-   }
+      task_queue_put(&queues[task->priority], task);
 
-   for (task = queue; task; task = next)
+   for (i = 0; i < TASK_PRIORITY_COUNT; i++)
    {
-      next = task->next;
-      task->handler(task);
+      task_queue_t *queue = &queues[task_priority_order[i]];
 
-      task_queue_push_progress(task);
+      while ((task = task_queue_get(queue)) != NULL)
+      {
+         task_queue_mark_dispatched(task);
+         task_queue_run_handler(task);
 
-      if (task->finished)
-         task_queue_put(&tasks_finished, task);
-      else
-         retro_task_regular_push_running(task);
+         task_queue_push_progress(task);
+
+         if (task->finished)
+            task_queue_put(&tasks_finished, task);
+         else
+            retro_task_regular_push_running(task);
+      }
    }
 
    retro_task_internal_gather();
@@ -273,6 +333,14 @@ static void retro_task_regular_retrieve(task_retriever_data_t *data)
    }
 }
 
+static void retro_task_regular_stats(task_queue_stats_t *stats)
+{
+   retro_task_t *task = tasks_running.front;
+
+   for (; task; task = task->next)
+      stats->queued[task->priority]++;
+}
+
 static struct retro_task_impl impl_regular = {
    NULL,
    retro_task_regular_push_running,
@@ -283,64 +351,201 @@ static struct retro_task_impl impl_regular = {
    retro_task_regular_find,
    retro_task_regular_retrieve,
    retro_task_regular_init,
-   retro_task_regular_deinit
+   retro_task_regular_deinit,
+   retro_task_regular_stats
 };
 
 #ifdef HAVE_THREADS
+/* Circular buffer of tasks.
+ * The owning worker pops from the front,
+ * idle workers steal from the back. */
+typedef struct
+{
+   retro_task_t **tasks;
+   size_t head;
+   size_t count;
+   size_t capacity;
+} task_deque_t;
+
+typedef struct
+{
+   slock_t *lock;
+   sthread_t *thread;
+   task_deque_t deques[TASK_PRIORITY_COUNT];
+   unsigned id;
+} task_worker_t;
+
 static slock_t *running_lock    = NULL;
 static slock_t *finished_lock   = NULL;
 static slock_t *property_lock   = NULL;
 static slock_t *queue_lock      = NULL;
+static slock_t *worker_lock     = NULL;
 static scond_t *worker_cond     = NULL;
-static sthread_t *worker_thread = NULL;
-static bool worker_continue     = true; /* use running_lock when touching it */
+static task_worker_t *workers   = NULL;
+static unsigned workers_count   = 0;
+static unsigned worker_next     = 0;
+/* use worker_lock when touching these */
+static unsigned worker_pending  = 0;
+static unsigned worker_running  = 0;
+static bool worker_continue     = true;
+
+static bool task_deque_push_back(task_deque_t *dq, retro_task_t *task)
+{
+   if (dq->count == dq->capacity)
+   {
+      size_t i;
+      size_t capacity      = dq->capacity ? dq->capacity * 2 : 16;
+      retro_task_t **tasks = (retro_task_t**)
+         malloc(capacity * sizeof(*tasks));
+
+      if (!tasks)
+         return false;
+
+      for (i = 0; i < dq->count; i++)
+         tasks[i] = dq->tasks[(dq->head + i) % dq->capacity];
+
+      free(dq->tasks);
+      dq->tasks    = tasks;
+      dq->head     = 0;
+      dq->capacity = capacity;
+   }
+
+   dq->tasks[(dq->head + dq->count) % dq->capacity] = task;
+   dq->count++;
+
+   return true;
+}
+
+static retro_task_t *task_deque_pop_front(task_deque_t *dq)
+{
+   retro_task_t *task = NULL;
+
+   if (dq->count == 0)
+      return NULL;
+
+   task     = dq->tasks[dq->head];
+   dq->head = (dq->head + 1) % dq->capacity;
+   dq->count--;
+
+   return task;
+}
+
+static retro_task_t *task_deque_pop_back(task_deque_t *dq)
+{
+   if (dq->count == 0)
+      return NULL;
+
+   dq->count--;
+
+   return dq->tasks[(dq->head + dq->count) % dq->capacity];
+}
+
+/* Makes a task runnable on the given worker. */
+static void task_worker_schedule(task_worker_t *worker, retro_task_t *task)
+{
+   task_queue_mark_queued(task);
+
+   slock_lock(worker->lock);
+   task_deque_push_back(&worker->deques[task->priority], task);
+   slock_unlock(worker->lock);
+
+   slock_lock(worker_lock);
+   worker_pending++;
+   scond_signal(worker_cond);
+   slock_unlock(worker_lock);
+}
+
+/* Takes the most urgent runnable task, preferring
+ * the worker's own deque and stealing from other
+ * workers before settling for a lower priority class. */
+static retro_task_t *task_worker_take(task_worker_t *worker)
+{
+   unsigned i, j;
+
+   for (i = 0; i < TASK_PRIORITY_COUNT; i++)
+   {
+      enum task_priority prio = task_priority_order[i];
+      retro_task_t *task      = NULL;
+
+      slock_lock(worker->lock);
+      task = task_deque_pop_front(&worker->deques[prio]);
+      slock_unlock(worker->lock);
+
+      if (task)
+         return task;
+
+      for (j = 1; j < workers_count; j++)
+      {
+         task_worker_t *victim = &workers[(worker->id + j) % workers_count];
+
+         slock_lock(victim->lock);
+         task = task_deque_pop_back(&victim->deques[prio]);
+         slock_unlock(victim->lock);
+
+         if (task)
+         {
+            slock_lock(stats_lock);
+            task_counters.steals++;
+            slock_unlock(stats_lock);
+            return task;
+         }
+      }
+   }
+
+   return NULL;
+}
 
 static void task_queue_remove(task_queue_t *queue, retro_task_t *task)
 {
-   retro_task_t     *t = NULL;
-   retro_task_t *front = NULL;
+   retro_task_t *t = NULL;
 
    slock_lock(queue_lock);
-   front = queue->front;
-   slock_unlock(queue_lock);
 
    /* Remove first element if needed */
-   if (task == front)
+   if (task == queue->front)
    {
-      slock_lock(queue_lock);
       queue->front = task->next;
-      slock_unlock(queue_lock);
       task->next   = NULL;
+      slock_unlock(queue_lock);
 
       return;
    }
 
    /* Parse queue */
-   t = front;
+   t = queue->front;
 
    while (t && t->next)
    {
-      /* Remove task and update queue */
+      /* Remove task and update queue. With several workers
+       * tasks can finish in any order, so keep back valid */
       if (t->next == task)
       {
          t->next    = task->next;
          task->next = NULL;
+         if (queue->back == task)
+            queue->back = t;
          break;
       }
 
       /* Update iterator */
       t = t->next;
    }
+
+   slock_unlock(queue_lock);
 }
 
 static void retro_task_threaded_push_running(retro_task_t *task)
 {
+   unsigned next;
+
    slock_lock(running_lock);
    slock_lock(queue_lock);
    task_queue_put(&tasks_running, task);
-   scond_signal(worker_cond);
    slock_unlock(queue_lock);
+   next = worker_next++ % workers_count;
    slock_unlock(running_lock);
+
+   task_worker_schedule(&workers[next], task);
 }
 
 static void retro_task_threaded_cancel(void *task)
@@ -437,47 +642,62 @@ static void retro_task_threaded_retrieve(task_retriever_data_t *data)
 
 static void threaded_worker(void *userdata)
 {
-   (void)userdata;
+   task_worker_t *worker = (task_worker_t*)userdata;
 
    for (;;)
    {
       retro_task_t *task  = NULL;
       bool finished = false;
 
-      if (!worker_continue)
-         break; /* should we keep running until all tasks finished? */
+      slock_lock(worker_lock);
 
-      slock_lock(running_lock);
+      while (worker_continue && worker_pending == 0)
+         scond_wait(worker_cond, worker_lock);
 
-      /* Get first task to run */
-      task = tasks_running.front;
-      if (task == NULL)
+      if (!worker_continue)
       {
-         scond_wait(worker_cond, running_lock);
-         slock_unlock(running_lock);
-         continue;
+         /* should we keep running until all tasks finished? */
+         slock_unlock(worker_lock);
+         break;
       }
 
-      slock_unlock(running_lock);
+      /* Reserve one of the pending tasks. Only reserving
+       * workers pop from the deques, so there is always
+       * one left for us even if it gets stolen under our feet
+       * and we have to look again. */
+      worker_pending--;
+      worker_running++;
+      slock_unlock(worker_lock);
+
+      do
+      {
+         task = task_worker_take(worker);
+      } while (!task);
 
-      task->handler(task);
+      task_queue_mark_dispatched(task);
+      task_queue_run_handler(task);
 
       slock_lock(property_lock);
       finished = task->finished;
       slock_unlock(property_lock);
 
-      slock_lock(running_lock);
-      task_queue_remove(&tasks_running, task);
-      slock_unlock(running_lock);
+      slock_lock(worker_lock);
+      worker_running--;
+      slock_unlock(worker_lock);
 
       /* Update queue */
       if (!finished)
       {
-         /* Re-add task to running queue */
-         retro_task_threaded_push_running(task);
+         /* Keep the task on this worker, others will
+          * steal it if they run out of work */
+         task_worker_schedule(worker, task);
       }
       else
       {
+         slock_lock(running_lock);
+         task_queue_remove(&tasks_running, task);
+         slock_unlock(running_lock);
+
          /* Add task to finished queue */
          slock_lock(finished_lock);
          task_queue_put(&tasks_finished, task);
@@ -488,40 +708,95 @@ static void threaded_worker(void *userdata)
 
 static void retro_task_threaded_init(void)
 {
-   running_lock  = slock_new();
-   finished_lock = slock_new();
-   property_lock = slock_new();
-   queue_lock    = slock_new();
-   worker_cond   = scond_new();
+   unsigned i;
+   retro_task_t *task = NULL;
+
+   running_lock   = slock_new();
+   finished_lock  = slock_new();
+   property_lock  = slock_new();
+   queue_lock     = slock_new();
+   worker_lock    = slock_new();
+   stats_lock     = slock_new();
+   worker_cond    = scond_new();
+
+   workers_count  = task_workers_wanted ? task_workers_wanted : 1;
+   workers        = (task_worker_t*)calloc(workers_count, sizeof(*workers));
+
+   for (i = 0; i < workers_count; i++)
+   {
+      workers[i].lock = slock_new();
+      workers[i].id   = i;
+   }
 
-   slock_lock(running_lock);
    worker_continue = true;
-   slock_unlock(running_lock);
+   worker_pending  = 0;
+   worker_running  = 0;
+   worker_next     = 0;
+
+   /* Tasks left on hold by a previous deinit */
+   for (task = tasks_running.front; task; task = task->next)
+      task_worker_schedule(&workers[worker_next++ % workers_count], task);
 
-   worker_thread = sthread_create(threaded_worker, NULL);
+   for (i = 0; i < workers_count; i++)
+      workers[i].thread = sthread_create(threaded_worker, &workers[i]);
 }
 
 static void retro_task_threaded_deinit(void)
 {
-   slock_lock(running_lock);
+   unsigned i, j;
+
+   slock_lock(worker_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
-   slock_unlock(running_lock);
+   scond_broadcast(worker_cond);
+   slock_unlock(worker_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < workers_count; i++)
+      sthread_join(workers[i].thread);
+
+   for (i = 0; i < workers_count; i++)
+   {
+      for (j = 0; j < TASK_PRIORITY_COUNT; j++)
+         free(workers[i].deques[j].tasks);
+      slock_free(workers[i].lock);
+   }
+   free(workers);
 
    scond_free(worker_cond);
    slock_free(running_lock);
    slock_free(finished_lock);
    slock_free(property_lock);
    slock_free(queue_lock);
+   slock_free(worker_lock);
+   slock_free(stats_lock);
 
-   worker_thread = NULL;
+   workers       = NULL;
+   workers_count = 0;
    worker_cond   = NULL;
    running_lock  = NULL;
    finished_lock = NULL;
    property_lock = NULL;
-   queue_lock = NULL;
+   queue_lock    = NULL;
+   worker_lock   = NULL;
+   stats_lock    = NULL;
+}
+
+static void retro_task_threaded_stats(task_queue_stats_t *stats)
+{
+   unsigned i, j;
+
+   stats->workers = workers_count;
+
+   for (i = 0; i < workers_count; i++)
+   {
+      slock_lock(workers[i].lock);
+      for (j = 0; j < TASK_PRIORITY_COUNT; j++)
+         stats->queued[j] += (unsigned)workers[i].deques[j].count;
+      slock_unlock(workers[i].lock);
+   }
+
+   slock_lock(worker_lock);
+   stats->running = worker_running;
+   slock_unlock(worker_lock);
 }
 
 static struct retro_task_impl impl_threaded = {
@@ -534,7 +809,8 @@ static struct retro_task_impl impl_threaded = {
    retro_task_threaded_find,
    retro_task_threaded_retrieve,
    retro_task_threaded_init,
-   retro_task_threaded_deinit
+   retro_task_threaded_deinit,
+   retro_task_threaded_stats
 };
 #endif
 
@@ -582,6 +858,40 @@ bool task_queue_is_threaded(void)
    return task_threaded_enable;
 }
 
+void task_queue_set_workers(unsigned workers)
+{
+   task_workers_wanted = workers ? workers : 1;
+}
+
+void task_queue_set_trace_hook(retro_task_trace_t hook)
+{
+   task_trace_hook = hook;
+}
+
+void task_queue_get_stats(task_queue_stats_t *stats)
+{
+   unsigned i;
+
+   memset(stats, 0, sizeof(*stats));
+
+   if (!impl_current)
+      return;
+
+   impl_current->stats(stats);
+
+   SLOCK_LOCK(stats_lock);
+   for (i = 0; i < TASK_PRIORITY_COUNT; i++)
+   {
+      if (task_counters.dispatched[i])
+         stats->latency_avg_usec[i] = task_counters.latency_total[i]
+            / task_counters.dispatched[i];
+      stats->dispatched[i]       = task_counters.dispatched[i];
+      stats->latency_max_usec[i] = task_counters.latency_max[i];
+   }
+   stats->steals = task_counters.steals;
+   SLOCK_UNLOCK(stats_lock);
+}
+
 bool task_queue_find(task_finder_data_t *find_data)
 {
    if (!impl_current->find(find_data->func, find_data->userdata))
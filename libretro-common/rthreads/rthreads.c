@@ -317,6 +317,15 @@ bool sthread_isself(sthread_t *thread)
 #endif
 }
 
+uintptr_t sthread_get_current_thread_id(void)
+{
+#ifdef USE_WIN32_THREADS
+   return (uintptr_t)GetCurrentThreadId();
+#else
+   return (uintptr_t)pthread_self();
+#endif
+}
+
 /**
  * slock_new:
  *
@@ -0,0 +1,208 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (audio_pipeline_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Runs the frontend's audio flush pipeline (s16 to float, resample,
+ * mix one voice, clamp, float to s16) over blocks of a core's audio
+ * for every sinc resampler quality, and reports the cost of each
+ * stage per stereo frame.
+ *
+ * Usage: audio_pipeline_bench [block frames] [iterations] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include <features/features_cpu.h>
+#include <audio/audio_mix.h>
+#include <audio/audio_resampler.h>
+#include <audio/conversion/float_to_s16.h>
+#include <audio/conversion/s16_to_float.h>
+
+#define IN_RATE  32040.0
+#define OUT_RATE 48000.0
+
+struct bench_buffers
+{
+   int16_t *in;
+   float *in_float;
+   float *out_float;
+   float *voice;
+   int16_t *out;
+};
+
+static const char *quality_names[] = {
+   "dontcare", "lowest", "lower", "normal", "higher", "highest"
+};
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+enum bench_stage
+{
+   BENCH_STAGE_TO_FLOAT = 0,
+   BENCH_STAGE_RESAMPLE,
+   BENCH_STAGE_MIX,
+   BENCH_STAGE_TO_S16,
+   BENCH_STAGE_COUNT
+};
+
+/* One flush of 'frames' input frames, adding the time spent
+ * in each stage to 'elapsed'. */
+static void bench_flush(const retro_resampler_t *backend, void *re,
+      struct bench_buffers *buf, size_t frames, double *elapsed)
+{
+   struct resampler_data src_data;
+   double t0, t1, t2, t3, t4;
+
+   t0 = bench_time();
+   convert_s16_to_float(buf->in_float, buf->in, frames * 2, 1.0f);
+
+   t1 = bench_time();
+   src_data.data_in       = buf->in_float;
+   src_data.input_frames  = frames;
+   src_data.data_out      = buf->out_float;
+   src_data.output_frames = 0;
+   src_data.ratio         = OUT_RATE / IN_RATE;
+
+   backend->process(re, &src_data);
+
+   t2 = bench_time();
+   audio_mix_volume(buf->out_float, buf->voice, 0.5f,
+         src_data.output_frames * 2);
+   audio_mix_clamp(buf->out_float, src_data.output_frames * 2);
+
+   t3 = bench_time();
+   convert_float_to_s16(buf->out, buf->out_float,
+         src_data.output_frames * 2);
+   t4 = bench_time();
+
+   elapsed[BENCH_STAGE_TO_FLOAT] += t1 - t0;
+   elapsed[BENCH_STAGE_RESAMPLE] += t2 - t1;
+   elapsed[BENCH_STAGE_MIX]      += t3 - t2;
+   elapsed[BENCH_STAGE_TO_S16]   += t4 - t3;
+}
+
+/* Fills 'ns' with nanoseconds per input stereo frame for each
+ * stage. Returns false if the resampler could not be created. */
+static bool bench_run(enum resampler_quality quality,
+      struct bench_buffers *buf, size_t frames, unsigned iterations,
+      double *ns)
+{
+   unsigned i;
+   double elapsed[BENCH_STAGE_COUNT] = {0};
+   void *re                          = NULL;
+   const retro_resampler_t *backend  = NULL;
+
+   if (!retro_resampler_realloc(&re, &backend, "sinc", quality,
+            OUT_RATE / IN_RATE))
+      return false;
+
+   /* Warm up the caches and fill the filter history. */
+   bench_flush(backend, re, buf, frames, elapsed);
+   memset(elapsed, 0, sizeof(elapsed));
+
+   for (i = 0; i < iterations; i++)
+      bench_flush(backend, re, buf, frames, elapsed);
+
+   backend->free(re);
+
+   for (i = 0; i < BENCH_STAGE_COUNT; i++)
+      ns[i] = elapsed[i] * 1e9 / ((double)frames * iterations);
+
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned q;
+   size_t i;
+   char cpu_str[256];
+   struct bench_buffers buf;
+   size_t frames       = argc > 1 ? (size_t)strtoul(argv[1], NULL, 0) : 2048;
+   unsigned iterations = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 0) : 500;
+   size_t out_samples  = (size_t)(frames * 2 * (OUT_RATE / IN_RATE)) + 64;
+
+   if (!frames)
+      return 1;
+
+   buf.in        = (int16_t*)malloc(frames * 2 * sizeof(int16_t));
+   buf.in_float  = (float*)malloc(frames * 2 * sizeof(float));
+   buf.out_float = (float*)malloc(out_samples * sizeof(float));
+   buf.voice     = (float*)malloc(out_samples * sizeof(float));
+   buf.out       = (int16_t*)malloc(out_samples * sizeof(int16_t));
+
+   if (!buf.in || !buf.in_float || !buf.out_float || !buf.voice || !buf.out)
+   {
+      puts("[ERROR]: could not allocate buffers");
+      return 1;
+   }
+
+   for (i = 0; i < frames; i++)
+   {
+      buf.in[i * 2 + 0] = (int16_t)(sin(i * 0.05) * 20000.0);
+      buf.in[i * 2 + 1] = (int16_t)(sin(i * 0.07) * 20000.0);
+   }
+   for (i = 0; i < out_samples; i++)
+      buf.voice[i] = (float)sin(i * 0.011);
+
+   convert_s16_to_float_init_simd();
+   convert_float_to_s16_init_simd();
+   audio_mix_init_simd();
+
+   cpu_features_get_model_name(cpu_str, sizeof(cpu_str));
+   printf("CPU: %s\n", cpu_str);
+   printf("%.0f Hz -> %.0f Hz, %u blocks of %u frames, ns per frame\n\n",
+         IN_RATE, OUT_RATE, iterations, (unsigned)frames);
+   printf("%-10s %9s %9s %9s %9s %9s\n", "quality",
+         "to float", "resample", "mix", "to s16", "total");
+
+   for (q = RESAMPLER_QUALITY_LOWEST; q <= RESAMPLER_QUALITY_HIGHEST; q++)
+   {
+      double ns[BENCH_STAGE_COUNT];
+
+      if (!bench_run((enum resampler_quality)q, &buf,
+               frames, iterations, ns))
+         continue;
+
+      printf("%-10s %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+            quality_names[q],
+            ns[BENCH_STAGE_TO_FLOAT], ns[BENCH_STAGE_RESAMPLE],
+            ns[BENCH_STAGE_MIX], ns[BENCH_STAGE_TO_S16],
+            ns[BENCH_STAGE_TO_FLOAT] + ns[BENCH_STAGE_RESAMPLE]
+            + ns[BENCH_STAGE_MIX] + ns[BENCH_STAGE_TO_S16]);
+   }
+
+   free(buf.in);
+   free(buf.in_float);
+   free(buf.out_float);
+   free(buf.voice);
+   free(buf.out);
+
+   return 0;
+}
@@ -0,0 +1,190 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (sinc_resampler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Measures every sinc kernel this CPU can run at every quality
+ * level, with the ratio drifting each block the way dynamic rate
+ * control moves it, and reports the share of one core needed to
+ * resample 44.1 kHz to 48 kHz in real time, plus the largest
+ * deviation from the C kernel.
+ *
+ * Usage: sinc_resampler_bench [seconds of audio] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <features/features_cpu.h>
+#include <audio/audio_resampler.h>
+
+#define IN_RATE      44100.0
+#define OUT_RATE     48000.0
+#define BLOCK_FRAMES 735
+#define MAX_DRIFT    0.005
+
+/* Masks accumulate like the ones the frontend passes, so each row
+ * shows what a CPU with that instruction set would run. */
+struct bench_kernel
+{
+   const char *name;
+   resampler_simd_mask_t mask;
+};
+
+static const struct bench_kernel kernels[] = {
+   { "C",    0 },
+   { "SSE",  RESAMPLER_SIMD_SSE },
+   { "AVX",  RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_AVX },
+   { "AVX2", RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_AVX | RESAMPLER_SIMD_AVX2 },
+   { "NEON", RESAMPLER_SIMD_NEON },
+};
+
+static const char *quality_names[] = {
+   "dontcare", "lowest", "lower", "normal", "higher", "highest"
+};
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Resamples 'blocks' blocks of 'in' into 'out'.
+ * Returns the number of output frames. */
+static size_t bench_resample(enum resampler_quality quality,
+      resampler_simd_mask_t mask, const float *in, float *out,
+      unsigned blocks, double *seconds)
+{
+   unsigned i;
+   double start;
+   size_t out_frames = 0;
+   void *re          = sinc_resampler.init(NULL,
+         OUT_RATE / IN_RATE, quality, mask);
+
+   if (!re)
+      return 0;
+
+   start = bench_time();
+
+   for (i = 0; i < blocks; i++)
+   {
+      struct resampler_data src_data;
+
+      src_data.data_in       = in + (size_t)i * BLOCK_FRAMES * 2;
+      src_data.input_frames  = BLOCK_FRAMES;
+      src_data.data_out      = out + out_frames * 2;
+      src_data.output_frames = 0;
+      src_data.ratio         = (OUT_RATE / IN_RATE) *
+         (1.0 + MAX_DRIFT * sin(i * 0.1));
+
+      sinc_resampler.process(re, &src_data);
+      out_frames += src_data.output_frames;
+   }
+
+   *seconds = bench_time() - start;
+
+   sinc_resampler.free(re);
+   return out_frames;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned q, k;
+   size_t i, out_max;
+   char cpu_str[256];
+   float *in, *out, *ref;
+   unsigned seconds           = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 0) : 10;
+   unsigned blocks            = (unsigned)(seconds * IN_RATE / BLOCK_FRAMES);
+   resampler_simd_mask_t cpu  = (resampler_simd_mask_t)cpu_features_get();
+
+   if (!blocks)
+      return 1;
+
+   out_max = (size_t)((double)blocks * BLOCK_FRAMES
+         * (OUT_RATE / IN_RATE) * (1.0 + MAX_DRIFT)) + 64;
+   in      = (float*)malloc((size_t)blocks * BLOCK_FRAMES * 2 * sizeof(float));
+   out     = (float*)malloc(out_max * 2 * sizeof(float));
+   ref     = (float*)malloc(out_max * 2 * sizeof(float));
+
+   if (!in || !out || !ref)
+   {
+      puts("[ERROR]: could not allocate buffers");
+      return 1;
+   }
+
+   for (i = 0; i < (size_t)blocks * BLOCK_FRAMES; i++)
+   {
+      in[i * 2 + 0] = (float)(0.5 * sin(i * 0.031) + 0.25 * sin(i * 0.77));
+      in[i * 2 + 1] = (float)(0.5 * sin(i * 0.047) + 0.25 * sin(i * 1.31));
+   }
+
+   cpu_features_get_model_name(cpu_str, sizeof(cpu_str));
+   printf("CPU: %s\n", cpu_str);
+   printf("%u s of %.0f Hz -> %.0f Hz, ratio drifting by +/-%.1f%%\n\n",
+         seconds, IN_RATE, OUT_RATE, MAX_DRIFT * 100.0);
+   printf("%-9s %-5s %12s %10s %12s\n",
+         "quality", "isa", "ns/out fr", "core %", "max err");
+
+   for (q = RESAMPLER_QUALITY_LOWEST; q <= RESAMPLER_QUALITY_HIGHEST; q++)
+   {
+      double secs;
+      size_t ref_frames = bench_resample((enum resampler_quality)q,
+            0, in, ref, blocks, &secs);
+
+      for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+      {
+         size_t frames;
+         float max_err = 0.0f;
+
+         if ((kernels[k].mask & cpu) != kernels[k].mask)
+            continue;
+
+         frames = bench_resample((enum resampler_quality)q,
+               kernels[k].mask, in, out, blocks, &secs);
+
+         if (frames != ref_frames)
+         {
+            printf("[ERROR]: %s produced %u frames, expected %u\n",
+                  kernels[k].name, (unsigned)frames, (unsigned)ref_frames);
+            return 1;
+         }
+
+         for (i = 0; i < frames * 2; i++)
+         {
+            float err = fabsf(out[i] - ref[i]);
+            if (err > max_err)
+               max_err = err;
+         }
+
+         printf("%-9s %-5s %12.1f %9.3f%% %12.2e\n",
+               quality_names[q], kernels[k].name,
+               secs * 1e9 / frames, secs * 100.0 / seconds, max_err);
+      }
+   }
+
+   free(in);
+   free(out);
+   free(ref);
+
+   return 0;
+}
@@ -0,0 +1,133 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (config_file_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Loads a retroarch.cfg sized config plus a core and a game
+ * override the way configuration.c does, then queries and
+ * updates every key.
+ *
+ * Usage: config_file_bench [keys] [iterations] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <file/config_file.h>
+
+#define BASE_CFG "bench_base.cfg"
+#define CORE_CFG "bench_core.cfg"
+#define GAME_CFG "bench_game.cfg"
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void write_cfg(const char *path, unsigned keys,
+      unsigned step, const char *value)
+{
+   unsigned i;
+   FILE *file = fopen(path, "w");
+
+   if (!file)
+      return;
+
+   for (i = 0; i < keys; i += step)
+      fprintf(file, "setting_number_%u = \"%s_%u\"\n", i, value, i);
+
+   fclose(file);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, j;
+   char key[64];
+   char buf[64];
+   double start, elapsed;
+   unsigned keys       = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 0) : 1000;
+   unsigned iterations = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 0) : 100;
+   unsigned errors     = 0;
+
+   write_cfg(BASE_CFG, keys, 1, "base");
+   write_cfg(CORE_CFG, keys, 10, "core");
+   write_cfg(GAME_CFG, keys, 20, "game");
+
+   start = bench_time();
+
+   for (j = 0; j < iterations; j++)
+   {
+      config_file_t *conf = config_file_new(BASE_CFG);
+
+      if (!conf)
+      {
+         puts("[ERROR]: could not load " BASE_CFG);
+         return 1;
+      }
+
+      config_append_file(conf, CORE_CFG);
+      config_append_file(conf, GAME_CFG);
+
+      /* config_load() reads every setting, including
+       * plenty that are not in the file. */
+      for (i = 0; i < keys * 2; i++)
+      {
+         snprintf(key, sizeof(key), "setting_number_%u", i);
+
+         if (!config_get_array(conf, key, buf, sizeof(buf)))
+         {
+            if (i < keys)
+               errors++;
+            continue;
+         }
+
+         if (  (i % 20 == 0 && strncmp(buf, "game_", 5)) ||
+               (i % 20 != 0 && i % 10 == 0 && strncmp(buf, "core_", 5)) ||
+               (i % 10 != 0 && strncmp(buf, "base_", 5)))
+            errors++;
+      }
+
+      /* config_save_file() writes every setting back. */
+      for (i = 0; i < keys; i++)
+      {
+         snprintf(key, sizeof(key), "setting_number_%u", i);
+         config_set_int(conf, key, i);
+      }
+
+      config_file_free(conf);
+   }
+
+   elapsed = bench_time() - start;
+
+   remove(BASE_CFG);
+   remove(CORE_CFG);
+   remove(GAME_CFG);
+
+   if (errors)
+      printf("[ERROR]: %u wrong lookups\n", errors);
+
+   printf("%u keys, %u iterations: %.3f ms per load + overrides + %u gets + %u sets\n",
+         keys, iterations, elapsed * 1000.0 / iterations, keys * 2, keys);
+
+   return errors ? 1 : 0;
+}
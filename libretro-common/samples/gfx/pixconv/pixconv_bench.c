@@ -0,0 +1,167 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (pixconv_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Runs every pixel converter over a frame, first with the
+ * baseline SSE2/NEON/C paths and then after conv_init_simd(),
+ * and reports the throughput of both. The two outputs are
+ * compared as well, so a wrong wide kernel shows up here.
+ *
+ * Usage: pixconv_bench [width] [height] [iterations] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <features/features_cpu.h>
+#include <gfx/scaler/pixconv.h>
+
+typedef void (*pixconv_func_t)(void *output, const void *input,
+      int width, int height, int out_stride, int in_stride);
+
+struct pixconv_bench
+{
+   const char *name;
+   pixconv_func_t func;
+   unsigned in_bpp;
+   unsigned out_bpp;
+};
+
+static const struct pixconv_bench converters[] = {
+   { "0rgb1555_argb8888", conv_0rgb1555_argb8888, 2, 4 },
+   { "0rgb1555_rgb565",   conv_0rgb1555_rgb565,   2, 2 },
+   { "0rgb1555_bgr24",    conv_0rgb1555_bgr24,    2, 3 },
+   { "rgb565_0rgb1555",   conv_rgb565_0rgb1555,   2, 2 },
+   { "rgb565_argb8888",   conv_rgb565_argb8888,   2, 4 },
+   { "rgb565_abgr8888",   conv_rgb565_abgr8888,   2, 4 },
+   { "rgb565_bgr24",      conv_rgb565_bgr24,      2, 3 },
+   { "rgba4444_argb8888", conv_rgba4444_argb8888, 2, 4 },
+   { "rgba4444_rgb565",   conv_rgba4444_rgb565,   2, 2 },
+   { "bgr24_argb8888",    conv_bgr24_argb8888,    3, 4 },
+   { "argb8888_0rgb1555", conv_argb8888_0rgb1555, 4, 2 },
+   { "argb8888_rgb565",   conv_argb8888_rgb565,   4, 2 },
+   { "argb8888_rgba4444", conv_argb8888_rgba4444, 4, 2 },
+   { "argb8888_bgr24",    conv_argb8888_bgr24,    4, 3 },
+   { "argb8888_abgr8888", conv_argb8888_abgr8888, 4, 4 },
+   { "abgr8888_bgr24",    conv_abgr8888_bgr24,    4, 3 },
+   { "yuyv_argb8888",     conv_yuyv_argb8888,     2, 4 },
+};
+
+#define NUM_CONVERTERS (sizeof(converters) / sizeof(converters[0]))
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Returns the throughput in gigapixels per second. */
+static double bench_run(const struct pixconv_bench *conv,
+      uint8_t *output, const uint8_t *input,
+      unsigned width, unsigned height, unsigned iterations)
+{
+   unsigned i;
+   double start, elapsed;
+   int out_stride = width * conv->out_bpp;
+   int in_stride  = width * conv->in_bpp;
+
+   /* Warm up the caches and the branch predictors. */
+   conv->func(output, input, width, height, out_stride, in_stride);
+
+   start = bench_time();
+   for (i = 0; i < iterations; i++)
+      conv->func(output, input, width, height, out_stride, in_stride);
+   elapsed = bench_time() - start;
+
+   return (double)width * height * iterations / elapsed / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   char cpu_str[256];
+   double baseline[NUM_CONVERTERS];
+   uint8_t *reference[NUM_CONVERTERS];
+   unsigned width      = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 0) : 640;
+   unsigned height     = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 0) : 480;
+   unsigned iterations = argc > 3 ? (unsigned)strtoul(argv[3], NULL, 0) : 1000;
+   size_t frame_size   = (size_t)width * height * 4;
+   uint8_t *input      = (uint8_t*)malloc(frame_size);
+   uint8_t *output     = (uint8_t*)malloc(frame_size);
+   unsigned errors     = 0;
+
+   if (!input || !output || width < 2)
+   {
+      puts("[ERROR]: could not allocate frames");
+      return 1;
+   }
+
+   /* YUYV needs an even width. */
+   width &= ~1u;
+
+   srand(0);
+   for (i = 0; i < frame_size; i++)
+      input[i] = (uint8_t)rand();
+
+   cpu_features_get_model_name(cpu_str, sizeof(cpu_str));
+   printf("CPU: %s\n", cpu_str);
+   printf("%ux%u, %u iterations\n\n", width, height, iterations);
+
+   for (i = 0; i < NUM_CONVERTERS; i++)
+   {
+      baseline[i]  = bench_run(&converters[i], output, input,
+            width, height, iterations);
+      reference[i] = (uint8_t*)malloc(frame_size);
+      if (reference[i])
+         memcpy(reference[i], output, frame_size);
+   }
+
+   conv_init_simd();
+
+   printf("%-20s %10s %10s %8s\n", "converter", "base", "dispatch", "speedup");
+
+   for (i = 0; i < NUM_CONVERTERS; i++)
+   {
+      size_t size    = (size_t)width * height * converters[i].out_bpp;
+      double gpix    = bench_run(&converters[i], output, input,
+            width, height, iterations);
+      const char *ok = "";
+
+      if (reference[i] && memcmp(reference[i], output, size))
+      {
+         ok = "  [MISMATCH]";
+         errors++;
+      }
+
+      printf("%-20s %6.3f Gp/s %6.3f Gp/s %7.2fx%s\n",
+            converters[i].name, baseline[i], gpix, gpix / baseline[i], ok);
+
+      free(reference[i]);
+   }
+
+   free(input);
+   free(output);
+
+   return errors ? 1 : 0;
+}
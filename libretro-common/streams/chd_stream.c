@@ -28,12 +28,26 @@
 
 #include <streams/chd_stream.h>
 #include <retro_endianness.h>
+#include <retro_miscellaneous.h>
 #include <libchdr/chd.h>
 
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+/* Bytes of decompressed hunks kept around by libchdr. Readers
+ * seeking back and forth across a track boundary or re-reading
+ * the TOC area would decompress the same hunks over and over.
+ * 512 KB is 26 hunks of a v5 CD image (8 frames per hunk). */
+#ifndef HUNK_CACHE_BYTES
+#define HUNK_CACHE_BYTES (512 * 1024)
+#endif
+/* Bytes decompressed ahead of the reader on a separate thread;
+ * 128 KB is about 0.4 seconds of a 2x CD drive. */
+#ifndef HUNK_PREFETCH_BYTES
+#define HUNK_PREFETCH_BYTES (128 * 1024)
+#endif
+
 struct chdstream
 {
    chd_file *chd;
@@ -214,11 +228,17 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    if (!chdstream_find_track(chd, track, &meta))
       goto error;
 
+   hd = chd_get_header(chd);
+
+   /* At least two hunks, so one can be read ahead */
+   chd_set_hunk_cache(chd,
+         MAX(HUNK_CACHE_BYTES / hd->hunkbytes, 2),
+         MAX(HUNK_PREFETCH_BYTES / hd->hunkbytes, 1));
+
    stream = (chdstream_t*)calloc(1, sizeof(*stream));
    if (!stream)
       goto error;
 
-   hd              = chd_get_header(chd);
    stream->hunkmem = (uint8_t*)malloc(hd->hunkbytes);
    if (!stream->hunkmem)
       goto error;
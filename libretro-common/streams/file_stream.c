@@ -404,6 +404,24 @@ const char *filestream_get_path(RFILE *stream)
    return retro_vfs_file_get_path_impl((libretro_vfs_implementation_file*)stream->hfile);
 }
 
+const void *filestream_get_mapped(RFILE *stream, int64_t *size)
+{
+   uint64_t mapsize = 0;
+   const void *data = NULL;
+
+   /* A frontend VFS interface has no way to expose a mapping */
+   if (!stream || filestream_open_cb != NULL)
+      return NULL;
+
+   data = retro_vfs_file_get_mapped_impl(
+         (libretro_vfs_implementation_file*)stream->hfile, &mapsize);
+
+   if (data && size)
+      *size = (int64_t)mapsize;
+
+   return data;
+}
+
 int64_t filestream_write(RFILE *stream, const void *s, int64_t len)
 {
    int64_t output;
@@ -444,18 +444,23 @@ libretro_vfs_implementation_file *retro_vfs_file_open_impl(const char *path, uns
       {
          stream->mappos  = 0;
          stream->mapped  = NULL;
-         stream->mapsize = retro_vfs_file_seek_internal(stream, 0, SEEK_END);
+         /* The unbuffered seek path returns 0 rather than
+          * the new offset, so ask lseek() for the size */
+         stream->mapsize = (uint64_t)lseek(stream->fd, 0, SEEK_END);
 
          if (stream->mapsize == (uint64_t)-1)
             goto error;
 
-         retro_vfs_file_seek_internal(stream, 0, SEEK_SET);
+         lseek(stream->fd, 0, SEEK_SET);
 
          stream->mapped = (uint8_t*)mmap((void*)0,
                stream->mapsize, PROT_READ,  MAP_SHARED, stream->fd, 0);
 
          if (stream->mapped == MAP_FAILED)
+         {
+            stream->mapped = NULL;
             stream->hints &= ~RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS;
+         }
       }
 #endif
    }
@@ -573,10 +578,12 @@ int64_t retro_vfs_file_tell_impl(libretro_vfs_implementation_file *stream)
    if (stream->mapped && stream->hints & RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS)
       return stream->mappos;
 #endif
-   if (lseek(stream->fd, 0, SEEK_CUR) < 0)
-      return -1;
-
-   return 0;
+   {
+      off_t pos = lseek(stream->fd, 0, SEEK_CUR);
+      if (pos < 0)
+         return -1;
+      return pos;
+   }
 }
 
 int64_t retro_vfs_file_seek_impl(libretro_vfs_implementation_file *stream,
@@ -796,6 +803,22 @@ const char *retro_vfs_file_get_path_impl(libretro_vfs_implementation_file *strea
    return stream->orig_path;
 }
 
+const void *retro_vfs_file_get_mapped_impl(
+      libretro_vfs_implementation_file *stream, uint64_t *size)
+{
+#ifdef HAVE_MMAP
+   if (     stream
+         && stream->hints & RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS
+         && stream->mapped)
+   {
+      if (size)
+         *size = stream->mapsize;
+      return stream->mapped;
+   }
+#endif
+   return NULL;
+}
+
 int retro_vfs_stat_impl(const char *path, int32_t *size)
 {
    bool is_dir, is_character_special;
@@ -595,6 +595,11 @@ const char *retro_vfs_file_get_path_impl(libretro_vfs_implementation_file *strea
 	return stream->orig_path;
 }
 
+const void *retro_vfs_file_get_mapped_impl(libretro_vfs_implementation_file *stream, uint64_t *size)
+{
+	return NULL;
+}
+
 int retro_vfs_stat_impl(const char *path, int32_t *size)
 {
 	wchar_t *path_wide = NULL;
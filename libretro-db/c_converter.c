@@ -832,6 +832,25 @@ int main(int argc, char** argv)
 
    filestream_close(rdb_file);
 
+   /* Field indexes used by the menu's browse queries */
+   {
+      unsigned i;
+      static const char *index_fields[] = {
+         "developer", "publisher", "releaseyear", "genre"
+      };
+      libretrodb_t *db = libretrodb_new();
+
+      if (db && libretrodb_open(rdb_path, db) == 0)
+      {
+         for (i = 0; i < sizeof(index_fields) / sizeof(index_fields[0]); i++)
+            libretrodb_create_index(db, index_fields[i], index_fields[i]);
+         libretrodb_close(db);
+      }
+
+      if (db)
+         libretrodb_free(db);
+   }
+
    dat_converter_list_free(dat_parser_list);
 
    while (dat_count--)
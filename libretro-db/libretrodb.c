@@ -32,6 +32,7 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 
+#include <boolean.h>
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
@@ -48,7 +49,7 @@
 
 struct node_iter_ctx
 {
-	libretrodb_t *db;
+	RFILE *fd;
 	libretrodb_index_t *idx;
 };
 
@@ -59,6 +60,11 @@ struct libretrodb
 	uint64_t count;
 	uint64_t first_index_offset;
    char *path;
+   /* Whole file, either memory-mapped by the VFS layer
+    * or read into 'owned_data' */
+   const uint8_t *data;
+   uint8_t *owned_data;
+   uint64_t size;
 };
 
 struct libretrodb_index
@@ -66,6 +72,11 @@ struct libretrodb_index
 	char name[50];
 	uint64_t key_size;
 	uint64_t next;
+   /* Field indexes only, 'field' is empty for unique indexes */
+   char field[50];
+   uint64_t count;
+   int numeric;
+   int multi;
 };
 
 typedef struct libretrodb_metadata
@@ -86,6 +97,14 @@ struct libretrodb_cursor
 	int eof;
 	libretrodb_query_t *query;
 	libretrodb_t *db;
+   size_t pos;
+   struct rmsgpack_dom_arena arena;
+   /* Set when the query is answered from a field index */
+   const libretrodb_query_plan_t *plan;
+   /* Records in the planned key range, in database order */
+   uint64_t *plan_offsets;
+   size_t plan_count;
+   size_t plan_pos;
 };
 
 static struct rmsgpack_dom_value sentinal;
@@ -173,8 +192,7 @@ int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider,
    if ((rv = rmsgpack_dom_write(fd, &sentinal)) < 0)
       goto clean;
 
-   header.metadata_offset = swap_if_little64(filestream_seek(
-            fd, 0, RETRO_VFS_SEEK_POSITION_CURRENT));
+   header.metadata_offset = swap_if_little64(filestream_tell(fd));
    md.count = item_count;
    libretrodb_write_metadata(fd, &md);
    filestream_seek(fd, root, RETRO_VFS_SEEK_POSITION_START);
@@ -184,24 +202,29 @@ clean:
    return rv;
 }
 
-static int libretrodb_read_index_header(RFILE *fd, libretrodb_index_t *idx)
-{
-   uint64_t name_len = 50;
-   return rmsgpack_dom_read_into(fd,
-         "name", idx->name, &name_len,
-         "key_size", &idx->key_size,
-         "next", &idx->next, NULL);
-}
-
 static void libretrodb_write_index_header(RFILE *fd, libretrodb_index_t *idx)
 {
-   rmsgpack_write_map_header(fd, 3);
+   bool is_field = !string_is_empty(idx->field);
+
+   rmsgpack_write_map_header(fd, is_field ? 7 : 3);
    rmsgpack_write_string(fd, "name", strlen("name"));
    rmsgpack_write_string(fd, idx->name, (uint32_t)strlen(idx->name));
    rmsgpack_write_string(fd, "key_size", (uint32_t)strlen("key_size"));
    rmsgpack_write_uint(fd, idx->key_size);
    rmsgpack_write_string(fd, "next", strlen("next"));
    rmsgpack_write_uint(fd, idx->next);
+
+   if (!is_field)
+      return;
+
+   rmsgpack_write_string(fd, "field", strlen("field"));
+   rmsgpack_write_string(fd, idx->field, (uint32_t)strlen(idx->field));
+   rmsgpack_write_string(fd, "count", strlen("count"));
+   rmsgpack_write_uint(fd, idx->count);
+   rmsgpack_write_string(fd, "numeric", strlen("numeric"));
+   rmsgpack_write_bool(fd, idx->numeric);
+   rmsgpack_write_string(fd, "multi", strlen("multi"));
+   rmsgpack_write_bool(fd, idx->multi);
 }
 
 void libretrodb_close(libretrodb_t *db)
@@ -210,8 +233,54 @@ void libretrodb_close(libretrodb_t *db)
       filestream_close(db->fd);
    if (!string_is_empty(db->path))
       free(db->path);
-   db->path = NULL;
-   db->fd   = NULL;
+   if (db->owned_data)
+      free(db->owned_data);
+   db->path       = NULL;
+   db->fd         = NULL;
+   db->data       = NULL;
+   db->owned_data = NULL;
+   db->size       = 0;
+}
+
+/* Makes the whole file available in memory, preferably through
+ * the VFS mapping so nothing gets copied. */
+static int libretrodb_load_data(libretrodb_t *db, RFILE *fd)
+{
+   int64_t size       = 0;
+   const void *mapped = filestream_get_mapped(fd, &size);
+   int64_t pos        = filestream_tell(fd);
+
+   if (mapped)
+   {
+      db->data = (const uint8_t*)mapped;
+      db->size = (uint64_t)size;
+      return 0;
+   }
+
+   size = filestream_get_size(fd);
+
+   if (size <= 0)
+      return -EINVAL;
+
+   db->owned_data = (uint8_t*)malloc((size_t)size);
+
+   if (!db->owned_data)
+      return -ENOMEM;
+
+   filestream_seek(fd, 0, RETRO_VFS_SEEK_POSITION_START);
+
+   if (filestream_read(fd, db->owned_data, size) != size)
+   {
+      free(db->owned_data);
+      db->owned_data = NULL;
+      return -EINVAL;
+   }
+
+   filestream_seek(fd, pos, RETRO_VFS_SEEK_POSITION_START);
+
+   db->data = db->owned_data;
+   db->size = (uint64_t)size;
+   return 0;
 }
 
 int libretrodb_open(const char *path, libretrodb_t *db)
@@ -221,7 +290,7 @@ int libretrodb_open(const char *path, libretrodb_t *db)
    int rv    = 0;
    RFILE *fd = filestream_open(path,
          RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+         RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS);
 
    if (!fd)
       return -errno;
@@ -238,7 +307,8 @@ int libretrodb_open(const char *path, libretrodb_t *db)
       goto error;
    }
 
-   if (strncmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)) != 0)
+   if (memcmp(header.magic_number, MAGIC_NUMBER,
+            sizeof(header.magic_number)) != 0)
    {
       rv = -EINVAL;
       goto error;
@@ -256,6 +326,10 @@ int libretrodb_open(const char *path, libretrodb_t *db)
 
    db->count              = md.count;
    db->first_index_offset = filestream_tell(fd);
+
+   if ((rv = libretrodb_load_data(db, fd)) < 0)
+      goto error;
+
    db->fd                 = fd;
    return 0;
 
@@ -265,52 +339,204 @@ error:
    return rv;
 }
 
+static const struct rmsgpack_dom_value *libretrodb_view_get(
+      const struct rmsgpack_dom_value *map, const char *key_name)
+{
+   struct rmsgpack_dom_value key;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = (uint32_t)strlen(key_name);
+   key.val.string.buff = (char*)key_name;
+
+   return rmsgpack_dom_value_map_value(map, &key);
+}
+
+static uint64_t libretrodb_view_uint(const struct rmsgpack_dom_value *map,
+      const char *key_name)
+{
+   const struct rmsgpack_dom_value *value =
+      libretrodb_view_get(map, key_name);
+
+   if (!value)
+      return 0;
+   if (value->type == RDT_UINT)
+      return value->val.uint_;
+   if (value->type == RDT_INT && value->val.int_ >= 0)
+      return (uint64_t)value->val.int_;
+   if (value->type == RDT_BOOL)
+      return value->val.bool_;
+   return 0;
+}
+
+static void libretrodb_view_string(const struct rmsgpack_dom_value *map,
+      const char *key_name, char *s, size_t len)
+{
+   size_t copy                            = 0;
+   const struct rmsgpack_dom_value *value =
+      libretrodb_view_get(map, key_name);
+
+   if (value && value->type == RDT_STRING)
+   {
+      copy = value->val.string.len;
+      if (copy >= len)
+         copy = len - 1;
+      memcpy(s, value->val.string.buff, copy);
+   }
+
+   s[copy] = '\0';
+}
+
+/* Looks up an index by name or, if @index_name is NULL, a field
+ * index on @field; on success *data_offset is where its sorted
+ * (key, record offset) table starts. */
 static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
-      libretrodb_index_t *idx)
+      const char *field, size_t field_len,
+      libretrodb_index_t *idx, size_t *data_offset)
 {
-   ssize_t eof    = filestream_get_size(db->fd);
-   ssize_t offset = filestream_seek(db->fd,
-         (ssize_t)db->first_index_offset,
-         RETRO_VFS_SEEK_POSITION_START);
+   int rv                          = -1;
+   size_t pos                      = (size_t)db->first_index_offset;
+   struct rmsgpack_dom_arena arena = {0};
 
-   /* TODO: this should use filestream_eof instead */
-   while (offset < eof)
+   while (pos < db->size)
    {
-      libretrodb_read_index_header(db->fd, idx);
+      struct rmsgpack_dom_value header;
+
+      if (rmsgpack_dom_read_view(db->data, (size_t)db->size,
+               &pos, &arena, &header) < 0)
+         break;
+
+      libretrodb_view_string(&header, "name", idx->name, sizeof(idx->name));
+      libretrodb_view_string(&header, "field",
+            idx->field, sizeof(idx->field));
+      idx->key_size = libretrodb_view_uint(&header, "key_size");
+      idx->next     = libretrodb_view_uint(&header, "next");
+      idx->count    = libretrodb_view_uint(&header, "count");
+      idx->numeric  = (int)libretrodb_view_uint(&header, "numeric");
+      idx->multi    = (int)libretrodb_view_uint(&header, "multi");
+
+      /* Unique indexes hold one entry per record */
+      if (string_is_empty(idx->field))
+         idx->count = db->count;
+
+      if (index_name
+            ? string_is_equal(idx->name, index_name)
+            : (     strlen(idx->field) == field_len
+               && !memcmp(idx->field, field, field_len)))
+      {
+         *data_offset = pos;
+         rv           = 0;
+         break;
+      }
 
-      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0)
-         return 0;
+      if (idx->next > db->size - pos)
+         break;
+      pos += (size_t)idx->next;
+   }
+
+   rmsgpack_dom_arena_free(&arena);
+
+   if (rv == 0 && (idx->key_size == 0
+            || idx->key_size > 255
+            || idx->next > db->size - *data_offset
+            || idx->count > idx->next / (idx->key_size + sizeof(uint64_t))))
+      return -EINVAL;
+
+   return rv;
+}
+
+int libretrodb_find_field_index(libretrodb_t *db,
+      const char *field, size_t field_len, libretrodb_field_index_t *out)
+{
+   libretrodb_index_t idx;
+   size_t data_offset = 0;
+
+   if (!db || !db->data)
+      return -1;
+
+   if (libretrodb_find_index(db, NULL, field, field_len,
+            &idx, &data_offset) != 0)
+      return -1;
 
-      filestream_seek(db->fd, (ssize_t)idx->next,
-            RETRO_VFS_SEEK_POSITION_CURRENT);
-      offset = filestream_tell(db->fd);
+   if (idx.key_size > LIBRETRODB_MAX_FIELD_KEY_SIZE)
+      return -1;
+
+   out->offset   = data_offset;
+   out->count    = idx.count;
+   out->key_size = (unsigned)idx.key_size;
+   out->numeric  = idx.numeric;
+   out->multi    = idx.multi;
+   return 0;
+}
+
+int libretrodb_field_index_key(const struct rmsgpack_dom_value *value,
+      const libretrodb_field_index_t *index, uint8_t *key)
+{
+   memset(key, 0, index->key_size);
+
+   if (index->numeric)
+   {
+      unsigned i;
+      uint64_t v;
+
+      if (index->key_size != sizeof(uint64_t))
+         return -1;
+
+      /* Flipping the sign bit makes big-endian byte order
+       * match signed order */
+      if (value->type == RDT_INT)
+         v = (uint64_t)value->val.int_ ^ UINT64_C(0x8000000000000000);
+      else if (value->type == RDT_UINT)
+         v = (value->val.uint_ > (uint64_t)INT64_MAX)
+            ? UINT64_MAX
+            : value->val.uint_ ^ UINT64_C(0x8000000000000000);
+      else
+         return -1;
+
+      for (i = 0; i < sizeof(uint64_t); i++)
+         key[i] = (uint8_t)(v >> (56 - i * 8));
    }
+   else
+   {
+      uint32_t len;
 
-   return -1;
+      if (value->type != RDT_STRING)
+         return -1;
+
+      len = value->val.string.len;
+      if (len > index->key_size)
+         len = index->key_size;
+      memcpy(key, value->val.string.buff, len);
+   }
+
+   return 0;
 }
 
-static int binsearch(const void *buff, const void *item,
+static int binsearch(const uint8_t *buff, const void *item,
       uint64_t count, uint8_t field_size, uint64_t *offset)
 {
-   int mid            = (int)(count / 2);
-   int item_size      = field_size + sizeof(uint64_t);
-   uint64_t *current  = (uint64_t *)buff + (mid * item_size);
-   int rv             = memcmp(current, item, field_size);
+   uint64_t low     = 0;
+   uint64_t high    = count;
+   size_t item_size = field_size + sizeof(uint64_t);
 
-   if (rv == 0)
+   while (low < high)
    {
-      *offset = *(uint64_t *)(current + field_size);
-      return 0;
-   }
+      uint64_t mid         = low + (high - low) / 2;
+      const uint8_t *entry = buff + mid * item_size;
+      int rv               = memcmp(entry, item, field_size);
 
-   if (count == 0)
-      return -1;
+      if (rv == 0)
+      {
+         memcpy(offset, entry + field_size, sizeof(uint64_t));
+         return 0;
+      }
 
-   if (rv > 0)
-      return binsearch(buff, item, mid, field_size, offset);
+      if (rv > 0)
+         high = mid;
+      else
+         low  = mid + 1;
+   }
 
-   return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
+   return -1;
 }
 
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
@@ -318,40 +544,105 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
 {
    libretrodb_index_t idx;
    int rv;
-   void *buff;
    uint64_t offset;
-   ssize_t bufflen, nread = 0;
+   size_t pos;
+   size_t data_offset              = 0;
+   struct rmsgpack_dom_value view;
+   struct rmsgpack_dom_arena arena = {0};
+
+   if ((rv = libretrodb_find_index(db, index_name, NULL, 0,
+               &idx, &data_offset)) != 0)
+      return rv;
 
-   if (libretrodb_find_index(db, index_name, &idx) < 0)
+   /* The index table is searched in place */
+   if (binsearch(db->data + data_offset, key, idx.count,
+            (uint8_t)idx.key_size, &offset) != 0)
       return -1;
 
-   bufflen = idx.next;
-   buff = malloc(bufflen);
+   if (offset >= db->size)
+      return -EINVAL;
 
-   if (!buff)
-      return -ENOMEM;
+   pos = (size_t)offset;
+   rv  = rmsgpack_dom_read_view(db->data, (size_t)db->size,
+         &pos, &arena, &view);
+
+   if (rv == 0)
+      rv = rmsgpack_dom_value_copy(out, &view);
 
-   while (nread < bufflen)
+   rmsgpack_dom_arena_free(&arena);
+   return rv;
+}
+
+static int libretrodb_offset_cmp(const void *a, const void *b)
+{
+   uint64_t x = *(const uint64_t*)a;
+   uint64_t y = *(const uint64_t*)b;
+   return (x > y) - (x < y);
+}
+
+/* Collects the records of the planned key range. The index is
+ * sorted by key, so they are put back in database order, which
+ * also drops records listed more than once (truncated keys,
+ * several items of a multi-valued field). */
+static int libretrodb_cursor_plan_offsets(libretrodb_cursor_t *cursor)
+{
+   const libretrodb_field_index_t *idx = &cursor->plan->index;
+   const uint8_t *table = cursor->db->data + idx->offset;
+   size_t item_size     = idx->key_size + sizeof(uint64_t);
+   uint64_t low         = 0;
+   uint64_t high        = idx->count;
+   uint64_t first;
+   size_t i, count      = 0;
+
+   free(cursor->plan_offsets);
+   cursor->plan_offsets = NULL;
+   cursor->plan_count   = 0;
+   cursor->plan_pos     = 0;
+
+   /* Lower bound of the planned key range */
+   while (low < high)
    {
-      void *buff_ = (uint64_t *)buff + nread;
-      rv = (int)filestream_read(db->fd, buff_, bufflen - nread);
+      uint64_t mid = low + (high - low) / 2;
 
-      if (rv <= 0)
-      {
-         free(buff);
-         return -errno;
-      }
-      nread += rv;
+      if (memcmp(table + mid * item_size,
+               cursor->plan->lo, idx->key_size) < 0)
+         low  = mid + 1;
+      else
+         high = mid;
    }
 
-   rv = binsearch(buff, key, db->count, (ssize_t)idx.key_size, &offset);
-   free(buff);
+   for (first = low, high = low; high < idx->count; high++)
+      if (memcmp(table + high * item_size,
+               cursor->plan->hi, idx->key_size) > 0)
+         break;
 
-   if (rv == 0)
-      filestream_seek(db->fd, (ssize_t)offset,
-            RETRO_VFS_SEEK_POSITION_START);
+   if (high == first)
+      return 0;
+
+   cursor->plan_offsets = (uint64_t*)
+      malloc((size_t)(high - first) * sizeof(uint64_t));
+   if (!cursor->plan_offsets)
+      return -1;
+
+   for (low = first; low < high; low++)
+   {
+      uint64_t offset;
+      memcpy(&offset, table + low * item_size + idx->key_size,
+            sizeof(uint64_t));
+      if (offset < cursor->db->size)
+         cursor->plan_offsets[count++] = offset;
+   }
+
+   qsort(cursor->plan_offsets, count, sizeof(uint64_t),
+         libretrodb_offset_cmp);
 
-   return rmsgpack_dom_read(db->fd, out);
+   for (i = 0; i < count; i++)
+      if (!cursor->plan_count
+            || cursor->plan_offsets[cursor->plan_count - 1]
+            != cursor->plan_offsets[i])
+         cursor->plan_offsets[cursor->plan_count++] = cursor->plan_offsets[i];
+
+   return 0;
 }
 
 /**
@@ -365,12 +656,39 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
    cursor->eof = 0;
-   return (int)filestream_seek(cursor->fd,
-         (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
-         RETRO_VFS_SEEK_POSITION_START);
+   cursor->pos = (size_t)(cursor->db->root + sizeof(libretrodb_header_t));
+
+   /* Without memory for the offsets, fall back to a full scan;
+    * the filter runs on every record either way. */
+   if (cursor->plan && libretrodb_cursor_plan_offsets(cursor) != 0)
+      cursor->plan = NULL;
+
+   return 0;
 }
 
-int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+/* Reads the next record from the planned index range */
+static int libretrodb_cursor_next_planned(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   while (cursor->plan_pos < cursor->plan_count)
+   {
+      int rv;
+
+      cursor->pos = (size_t)cursor->plan_offsets[cursor->plan_pos++];
+      rv          = rmsgpack_dom_read_view(cursor->db->data,
+            (size_t)cursor->db->size, &cursor->pos, &cursor->arena, out);
+      if (rv < 0)
+         return rv;
+
+      if (libretrodb_query_filter(cursor->query, out))
+         return 0;
+   }
+
+   cursor->eof = 1;
+   return EOF;
+}
+
+int libretrodb_cursor_read_item_view(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out)
 {
    int rv;
@@ -378,29 +696,41 @@ int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
    if (cursor->eof)
       return EOF;
 
-retry:
-   rv = rmsgpack_dom_read(cursor->fd, out);
-   if (rv < 0)
-      return rv;
+   if (cursor->plan)
+      return libretrodb_cursor_next_planned(cursor, out);
 
-   if (out->type == RDT_NULL)
+   do
    {
-      cursor->eof = 1;
-      return EOF;
-   }
+      rv = rmsgpack_dom_read_view(cursor->db->data,
+            (size_t)cursor->db->size, &cursor->pos, &cursor->arena, out);
+      if (rv < 0)
+         return rv;
 
-   if (cursor->query)
-   {
-      if (!libretrodb_query_filter(cursor->query, out))
+      if (out->type == RDT_NULL)
       {
-         rmsgpack_dom_value_free(out);
-         goto retry;
+         cursor->eof = 1;
+         return EOF;
       }
-   }
+   } while (cursor->query && !libretrodb_query_filter(cursor->query, out));
 
    return 0;
 }
 
+int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   struct rmsgpack_dom_value view;
+   int rv = libretrodb_cursor_read_item_view(cursor, &view);
+
+   if (rv != 0)
+   {
+      out->type = RDT_NULL;
+      return rv;
+   }
+
+   return rmsgpack_dom_value_copy(out, &view);
+}
+
 /**
  * libretrodb_cursor_close:
  * @cursor              : Handle to database cursor.
@@ -418,11 +748,17 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
-   cursor->eof      = 1;
-   cursor->fd       = NULL;
-   cursor->db       = NULL;
-   cursor->query    = NULL;
+   rmsgpack_dom_arena_free(&cursor->arena);
+   free(cursor->plan_offsets);
+
+   cursor->is_valid     = 0;
+   cursor->eof          = 1;
+   cursor->fd           = NULL;
+   cursor->db           = NULL;
+   cursor->query        = NULL;
+   cursor->plan         = NULL;
+   cursor->plan_offsets = NULL;
+   cursor->plan_count   = 0;
 }
 
 /**
@@ -438,25 +774,31 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
 int libretrodb_cursor_open(libretrodb_t *db, libretrodb_cursor_t *cursor,
       libretrodb_query_t *q)
 {
-   RFILE *fd = NULL;
-   if (!db || string_is_empty(db->path))
-      return -errno;
-
-   fd = filestream_open(db->path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-
-   if (!fd)
-      return -errno;
+   if (!db || !db->data)
+      return -EINVAL;
 
-   cursor->fd       = fd;
+   cursor->fd       = NULL;
    cursor->db       = db;
    cursor->is_valid = 1;
-   libretrodb_cursor_reset(cursor);
    cursor->query    = q;
+   cursor->plan     = NULL;
 
    if (q)
+   {
+      const libretrodb_query_plan_t *plan = libretrodb_query_get_plan(q);
+
+      /* Only trust a plan made against this very database */
+      if (     plan
+            && plan->db == db
+            && plan->index.offset <= db->size
+            && plan->index.count <= (db->size - plan->index.offset)
+               / (plan->index.key_size + sizeof(uint64_t)))
+         cursor->plan = plan;
+
       libretrodb_query_inc_ref(q);
+   }
+
+   libretrodb_cursor_reset(cursor);
 
    return 0;
 }
@@ -465,24 +807,34 @@ static int node_iter(void *value, void *ctx)
 {
    struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
 
-   if (filestream_write(nictx->db->fd, value,
+   if (filestream_write(nictx->fd, value,
             (ssize_t)(nictx->idx->key_size + sizeof(uint64_t))) > 0)
       return 0;
 
    return -1;
 }
 
-static uint64_t libretrodb_tell(libretrodb_t *db)
+static int node_compare(const void *a, const void *b, void *ctx)
 {
-   return filestream_tell(db->fd);
+   return memcmp(a, b, *(uint8_t *)ctx);
 }
 
-static int node_compare(const void *a, const void *b, void *ctx)
+/* The database itself is opened read-only,
+ * indexes are appended through a second handle */
+static RFILE *libretrodb_open_append(libretrodb_t *db)
 {
-   return memcmp(a, b, *(uint8_t *)ctx);
+   RFILE *fd = filestream_open(db->path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (fd)
+      filestream_seek(fd, 0, RETRO_VFS_SEEK_POSITION_END);
+
+   return fd;
 }
 
-int libretrodb_create_index(libretrodb_t *db,
+static int libretrodb_create_unique_index(libretrodb_t *db,
       const char *name, const char *field_name)
 {
    struct node_iter_ctx nictx;
@@ -494,7 +846,9 @@ int libretrodb_create_index(libretrodb_t *db,
    void *buff                       = NULL;
    uint64_t *buff_u64               = NULL;
    uint8_t field_size               = 0;
-   uint64_t item_loc                = libretrodb_tell(db);
+   uint64_t item_loc                = 0;
+   int rv                           = -1;
+   RFILE *fd                        = NULL;
    bintree_t *tree                  = bintree_new(node_compare, &field_size);
 
    item.type                        = RDT_NULL;
@@ -506,8 +860,14 @@ int libretrodb_create_index(libretrodb_t *db,
    key.val.string.len  = (uint32_t)strlen(field_name);
    key.val.string.buff = (char *) field_name;   /* We know we aren't going to change it */
 
-   while (libretrodb_cursor_read_item(&cur, &item) == 0)
+   for (;;)
    {
+      /* The cursor has no query, so each read starts at its own record */
+      item_loc = cur.pos;
+
+      if (libretrodb_cursor_read_item(&cur, &item) != 0)
+         break;
+
       if (item.type != RDT_MAP)
       {
          printf("Only map keys are supported\n");
@@ -548,7 +908,7 @@ int libretrodb_create_index(libretrodb_t *db,
 
       memcpy(buff, field->val.binary.buff, field_size);
 
-      buff_u64 = (uint64_t *)buff + field_size;
+      buff_u64 = (uint64_t *)((uint8_t *)buff + field_size);
 
       memcpy(buff_u64, &item_loc, sizeof(uint64_t));
 
@@ -561,24 +921,25 @@ int libretrodb_create_index(libretrodb_t *db,
       }
       buff     = NULL;
       rmsgpack_dom_value_free(&item);
-      item_loc = libretrodb_tell(db);
    }
 
-   filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
-
-   strncpy(idx.name, name, 50);
+   if (!(fd = libretrodb_open_append(db)))
+      goto clean;
 
-   idx.name[49] = '\0';
+   memset(&idx, 0, sizeof(idx));
+   strlcpy(idx.name, name, sizeof(idx.name));
    idx.key_size = field_size;
    idx.next     = db->count * (field_size + sizeof(uint64_t));
-   libretrodb_write_index_header(db->fd, &idx);
+   libretrodb_write_index_header(fd, &idx);
 
-   nictx.db  = db;
+   nictx.fd  = fd;
    nictx.idx = &idx;
-   bintree_iterate(tree, node_iter, &nictx);
+   rv        = bintree_iterate(tree, node_iter, &nictx);
 
 clean:
    rmsgpack_dom_value_free(&item);
+   if (fd)
+      filestream_close(fd);
    if (buff)
       free(buff);
    if (cur.is_valid)
@@ -586,9 +947,226 @@ clean:
    if (tree)
       bintree_free(tree);
    free(tree);
+   return rv;
+}
+
+typedef struct libretrodb_field_entry
+{
+   uint8_t key[LIBRETRODB_MAX_FIELD_KEY_SIZE];
+   uint64_t offset;
+} libretrodb_field_entry_t;
+
+typedef struct libretrodb_field_entries
+{
+   libretrodb_field_entry_t *data;
+   size_t count;
+   size_t capacity;
+} libretrodb_field_entries_t;
+
+static int libretrodb_field_entry_compare(const void *a, const void *b)
+{
+   const libretrodb_field_entry_t *ea = (const libretrodb_field_entry_t*)a;
+   const libretrodb_field_entry_t *eb = (const libretrodb_field_entry_t*)b;
+   /* Unused key bytes are zero, so the whole array compares */
+   int rv = memcmp(ea->key, eb->key, sizeof(ea->key));
+
+   if (rv)
+      return rv;
+   if (ea->offset != eb->offset)
+      return (ea->offset < eb->offset) ? -1 : 1;
+   return 0;
+}
+
+static int libretrodb_field_entries_add(libretrodb_field_entries_t *entries,
+      const libretrodb_field_index_t *index,
+      const struct rmsgpack_dom_value *value, uint64_t offset)
+{
+   libretrodb_field_entry_t *entry = NULL;
+
+   if (entries->count == entries->capacity)
+   {
+      size_t new_cap = entries->capacity ? entries->capacity * 2 : 1024;
+      libretrodb_field_entry_t *new_data = (libretrodb_field_entry_t*)
+         realloc(entries->data, new_cap * sizeof(*new_data));
+
+      if (!new_data)
+         return -ENOMEM;
+
+      entries->data     = new_data;
+      entries->capacity = new_cap;
+   }
+
+   entry = &entries->data[entries->count];
+   memset(entry->key, 0, sizeof(entry->key));
+
+   if (libretrodb_field_index_key(value, index, entry->key) != 0)
+      return 0;
+
+   entry->offset = offset;
+   entries->count++;
    return 0;
 }
 
+/* Non-unique index on a string or integer field. Records without
+ * the field, or with a value of another type, are left out: no
+ * predicate the query planner maps onto this index can match them. */
+static int libretrodb_create_field_index(libretrodb_t *db,
+      const char *name, const char *field_name, bool numeric)
+{
+   size_t i;
+   libretrodb_index_t idx;
+   libretrodb_field_index_t index;
+   struct rmsgpack_dom_value item;
+   libretrodb_field_entries_t entries = {0};
+   libretrodb_cursor_t cur            = {0};
+   uint64_t written                   = 0;
+   uint64_t item_loc                  = 0;
+   int rv                             = -1;
+   RFILE *fd                          = NULL;
+
+   index.key_size = numeric
+      ? sizeof(uint64_t) : LIBRETRODB_MAX_FIELD_KEY_SIZE;
+   index.numeric  = numeric;
+   index.multi    = 0;
+
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
+      goto clean;
+
+   for (;;)
+   {
+      const struct rmsgpack_dom_value *field = NULL;
+
+      item_loc = cur.pos;
+
+      if (libretrodb_cursor_read_item_view(&cur, &item) != 0)
+         break;
+
+      if (item.type != RDT_MAP)
+         continue;
+
+      if (!(field = libretrodb_view_get(&item, field_name)))
+         continue;
+
+      if (!numeric && field->type == RDT_STRING
+            && memchr(field->val.string.buff, '|', field->val.string.len))
+      {
+         /* Index every item of a '|'-separated list */
+         struct rmsgpack_dom_value part;
+         const char *str = field->val.string.buff;
+         const char *end = str + field->val.string.len;
+
+         index.multi     = 1;
+         part.type       = RDT_STRING;
+
+         while (str <= end)
+         {
+            const char *sep = (const char*)memchr(str, '|', end - str);
+
+            if (!sep)
+               sep = end;
+
+            part.val.string.buff = (char*)str;
+            part.val.string.len  = (uint32_t)(sep - str);
+
+            if (part.val.string.len > 0 && libretrodb_field_entries_add(
+                     &entries, &index, &part, item_loc) != 0)
+               goto clean;
+
+            str = sep + 1;
+         }
+      }
+      else if (libretrodb_field_entries_add(
+               &entries, &index, field, item_loc) != 0)
+         goto clean;
+   }
+
+   if (entries.count)
+      qsort(entries.data, entries.count, sizeof(*entries.data),
+            libretrodb_field_entry_compare);
+
+   /* Drop repeated items within one record */
+   for (i = 0; i < entries.count; i++)
+      if (i == 0 || libretrodb_field_entry_compare(
+               &entries.data[i - 1], &entries.data[i]) != 0)
+         entries.data[written++] = entries.data[i];
+
+   if (!(fd = libretrodb_open_append(db)))
+      goto clean;
+
+   memset(&idx, 0, sizeof(idx));
+   strlcpy(idx.name,  name,       sizeof(idx.name));
+   strlcpy(idx.field, field_name, sizeof(idx.field));
+   idx.key_size = index.key_size;
+   idx.count    = written;
+   idx.next     = written * (index.key_size + sizeof(uint64_t));
+   idx.numeric  = index.numeric;
+   idx.multi    = index.multi;
+   libretrodb_write_index_header(fd, &idx);
+
+   rv = 0;
+   for (i = 0; i < written; i++)
+   {
+      if (     filestream_write(fd, entries.data[i].key, index.key_size)
+                  != (int64_t)index.key_size
+            || filestream_write(fd, &entries.data[i].offset,
+                  sizeof(uint64_t)) != sizeof(uint64_t))
+      {
+         rv = -1;
+         break;
+      }
+   }
+
+clean:
+   if (fd)
+      filestream_close(fd);
+   if (cur.is_valid)
+      libretrodb_cursor_close(&cur);
+   free(entries.data);
+   return rv;
+}
+
+int libretrodb_create_index(libretrodb_t *db,
+      const char *name, const char *field_name)
+{
+   struct rmsgpack_dom_value item;
+   libretrodb_cursor_t cur = {0};
+   enum rmsgpack_dom_type type = RDT_NULL;
+
+   if (!db || !db->data || string_is_empty(db->path))
+      return -EINVAL;
+
+   /* The first record carrying the field decides the kind of index */
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
+      return -EINVAL;
+
+   while (type == RDT_NULL
+         && libretrodb_cursor_read_item_view(&cur, &item) == 0)
+   {
+      const struct rmsgpack_dom_value *field = (item.type == RDT_MAP)
+         ? libretrodb_view_get(&item, field_name) : NULL;
+
+      if (field)
+         type = field->type;
+   }
+
+   libretrodb_cursor_close(&cur);
+
+   switch (type)
+   {
+      case RDT_STRING:
+         return libretrodb_create_field_index(db, name, field_name, false);
+      case RDT_INT:
+      case RDT_UINT:
+         return libretrodb_create_field_index(db, name, field_name, true);
+      case RDT_BINARY:
+         return libretrodb_create_unique_index(db, name, field_name);
+      default:
+         break;
+   }
+
+   return -EINVAL;
+}
+
 libretrodb_cursor_t *libretrodb_cursor_new(void)
 {
    libretrodb_cursor_t *dbc = (libretrodb_cursor_t*)
@@ -45,15 +45,85 @@ typedef struct libretrodb_index libretrodb_index_t;
 
 typedef int (*libretrodb_value_provider)(void *ctx, struct rmsgpack_dom_value *out);
 
+/* Keys of field (secondary) indexes are at most this long;
+ * longer strings are truncated, so lookups may yield extra
+ * candidates that the query filter then rejects */
+#define LIBRETRODB_MAX_FIELD_KEY_SIZE 32
+
+typedef struct libretrodb_field_index
+{
+   uint64_t offset;   /* start of the sorted (key, record offset) table */
+   uint64_t count;    /* number of table entries */
+   unsigned key_size;
+   int numeric;       /* keys are encoded integers, otherwise strings */
+   int multi;         /* '|'-separated values were indexed one by one */
+} libretrodb_field_index_t;
+
+/* Index range a compiled query can be answered from,
+ * see libretrodb_query_get_plan() */
+typedef struct libretrodb_query_plan
+{
+   const libretrodb_t *db;
+   libretrodb_field_index_t index;
+   uint8_t lo[LIBRETRODB_MAX_FIELD_KEY_SIZE];   /* inclusive */
+   uint8_t hi[LIBRETRODB_MAX_FIELD_KEY_SIZE];   /* inclusive */
+} libretrodb_query_plan_t;
+
 int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider, void *ctx);
 
 void libretrodb_close(libretrodb_t *db);
 
 int libretrodb_open(const char *path, libretrodb_t *db);
 
+/**
+ * libretrodb_create_index:
+ * @db                  : Handle to database.
+ * @name                : Name of the new index.
+ * @field_name          : Field to index.
+ *
+ * Appends an index on @field_name to the database file.
+ *
+ * Binary fields get a unique index usable by libretrodb_find_entry().
+ * String and integer fields get a field index that may hold several
+ * records per key; string values containing '|' are indexed once per
+ * item. Field indexes are picked up by libretrodb_query_compile().
+ *
+ * The index is visible once the database is opened again.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
 int libretrodb_create_index(libretrodb_t *db, const char *name,
       const char *field_name);
 
+/**
+ * libretrodb_find_field_index:
+ * @db                  : Handle to database.
+ * @field               : Field name, not necessarily NUL-terminated.
+ * @field_len           : Length of @field.
+ * @out                 : Index description.
+ *
+ * Looks for a field index created on @field.
+ *
+ * Returns: 0 if found, otherwise -1.
+ **/
+int libretrodb_find_field_index(libretrodb_t *db,
+      const char *field, size_t field_len, libretrodb_field_index_t *out);
+
+/**
+ * libretrodb_field_index_key:
+ * @value               : Value to encode.
+ * @index               : Field index the key is meant for.
+ * @key                 : Output, index->key_size bytes.
+ *
+ * Encodes @value so that memcmp() order of keys matches
+ * the order of values.
+ *
+ * Returns: 0 if successful, -1 if @value cannot be stored
+ * in @index.
+ **/
+int libretrodb_field_index_key(const struct rmsgpack_dom_value *value,
+      const libretrodb_field_index_t *index, uint8_t *key);
+
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
         const void *key, struct rmsgpack_dom_value *out);
 
@@ -105,6 +175,21 @@ void libretrodb_query_free(void *q);
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_cursor_read_item_view:
+ * @cursor              : Handle to database cursor.
+ * @out                 : Decoded record.
+ *
+ * Like libretrodb_cursor_read_item(), but @out points into the
+ * database image: strings and binaries are not NUL-terminated and
+ * the value is only valid until the next read on @cursor.
+ * Do not call rmsgpack_dom_value_free() on it.
+ *
+ * Returns: 0 if successful, EOF at the end, otherwise negative.
+ **/
+int libretrodb_cursor_read_item_view(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out);
+
 RETRO_END_DECLS
 
 #endif
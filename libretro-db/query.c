@@ -82,6 +82,9 @@ struct query
 {
    unsigned ref_count;
    struct invocation root;
+   /* Index range worked out by query_plan() */
+   int has_plan;
+   libretrodb_query_plan_t plan;
 };
 
 struct registered_func
@@ -256,24 +259,84 @@ static struct rmsgpack_dom_value query_func_glob(
       unsigned argc, const struct argument * argv)
 {
    struct rmsgpack_dom_value res;
-   unsigned i = 0;
+   char stack_buf[256];
+   char *str     = stack_buf;
+   uint32_t len  = 0;
 
    res.type      = RDT_BOOL;
    res.val.bool_ = 0;
 
-   (void)i;
-
    if (argc != 1)
       return res;
    if (argv[0].type != AT_VALUE || argv[0].a.value.type != RDT_STRING)
       return res;
    if (input.type != RDT_STRING)
       return res;
+
+   /* Input may be a view into the database image,
+    * which is not NUL-terminated */
+   len = input.val.string.len;
+   if (len >= sizeof(stack_buf))
+   {
+      if (!(str = (char*)malloc(len + 1)))
+         return res;
+   }
+   memcpy(str, input.val.string.buff, len);
+   str[len] = '\0';
+
    res.val.bool_ = rl_fnmatch(
          argv[0].a.value.val.string.buff,
-         input.val.string.buff,
+         str,
          0
          ) == 0;
+
+   if (str != stack_buf)
+      free(str);
+   return res;
+}
+
+/* True if one item of a '|'-separated list equals the argument */
+static struct rmsgpack_dom_value query_func_has(
+      struct rmsgpack_dom_value input,
+      unsigned argc, const struct argument * argv)
+{
+   struct rmsgpack_dom_value res;
+   const char *str = NULL;
+   const char *end = NULL;
+   const char *item;
+   uint32_t item_len;
+
+   res.type      = RDT_BOOL;
+   res.val.bool_ = 0;
+
+   if (argc != 1)
+      return res;
+   if (argv[0].type != AT_VALUE || argv[0].a.value.type != RDT_STRING)
+      return res;
+   if (input.type != RDT_STRING)
+      return res;
+
+   item     = argv[0].a.value.val.string.buff;
+   item_len = argv[0].a.value.val.string.len;
+   str      = input.val.string.buff;
+   end      = str + input.val.string.len;
+
+   while (str <= end)
+   {
+      const char *sep = (const char*)memchr(str, '|', end - str);
+
+      if (!sep)
+         sep = end;
+
+      if ((uint32_t)(sep - str) == item_len && !memcmp(str, item, item_len))
+      {
+         res.val.bool_ = 1;
+         break;
+      }
+
+      str = sep + 1;
+   }
+
    return res;
 }
 
@@ -283,6 +346,7 @@ struct registered_func registered_functions[100] = {
    {"and",     query_func_operator_and},
    {"between", query_func_between},
    {"glob",    query_func_glob},
+   {"has",     query_func_has},
    {NULL, NULL}
 };
 
@@ -916,6 +980,129 @@ void libretrodb_query_free(void *q)
    free(real_q);
 }
 
+/* Ranks how narrow an index range a table entry
+ * 'field: predicate' allows; 0 means none */
+static int query_plan_predicate(const struct argument *pred,
+      libretrodb_query_plan_t *plan)
+{
+   const libretrodb_field_index_t *idx = &plan->index;
+
+   if (pred->type == AT_VALUE)
+   {
+      struct rmsgpack_dom_value value = pred->a.value;
+
+      /* A multi-valued index has an entry per list item,
+       * so look up the first item */
+      if (idx->multi && value.type == RDT_STRING)
+      {
+         const char *sep = (const char*)memchr(
+               value.val.string.buff, '|', value.val.string.len);
+         if (sep)
+            value.val.string.len = (uint32_t)(sep - value.val.string.buff);
+      }
+
+      if (libretrodb_field_index_key(&value, idx, plan->lo) != 0)
+         return 0;
+      memcpy(plan->hi, plan->lo, idx->key_size);
+      return 3;
+   }
+
+   if (     pred->a.invocation.argc < 1
+         || pred->a.invocation.argv[0].type != AT_VALUE)
+      return 0;
+
+   if (pred->a.invocation.func == query_func_has)
+   {
+      if (libretrodb_field_index_key(
+               &pred->a.invocation.argv[0].a.value, idx, plan->lo) != 0)
+         return 0;
+      memcpy(plan->hi, plan->lo, idx->key_size);
+      return 3;
+   }
+
+   if (pred->a.invocation.func == query_func_glob)
+   {
+      /* Literal prefix of the pattern bounds the range; items of a
+       * multi-valued index would turn up once per matching item */
+      struct rmsgpack_dom_value prefix = pred->a.invocation.argv[0].a.value;
+      uint32_t i;
+
+      if (idx->multi || prefix.type != RDT_STRING)
+         return 0;
+
+      for (i = 0; i < prefix.val.string.len; i++)
+         if (strchr("*?[\\", prefix.val.string.buff[i]))
+            break;
+
+      if (i == 0)
+         return 0;
+
+      prefix.val.string.len = i;
+
+      if (libretrodb_field_index_key(&prefix, idx, plan->lo) != 0)
+         return 0;
+
+      memcpy(plan->hi, plan->lo, idx->key_size);
+      if (i < idx->key_size)
+         memset(plan->hi + i, 0xFF, idx->key_size - i);
+      return 2;
+   }
+
+   if (pred->a.invocation.func == query_func_between)
+   {
+      if (     pred->a.invocation.argc != 2
+            || pred->a.invocation.argv[1].type != AT_VALUE
+            || pred->a.invocation.argv[0].a.value.type != RDT_INT
+            || pred->a.invocation.argv[1].a.value.type != RDT_INT)
+         return 0;
+
+      if (     libretrodb_field_index_key(
+               &pred->a.invocation.argv[0].a.value, idx, plan->lo) != 0
+            || libretrodb_field_index_key(
+               &pred->a.invocation.argv[1].a.value, idx, plan->hi) != 0)
+         return 0;
+      return 1;
+   }
+
+   return 0;
+}
+
+/* Picks the field index that narrows a table query the most.
+ * The filter still runs on every record, the index only
+ * limits which records get looked at. */
+static void query_plan(libretrodb_t *db, struct query *q)
+{
+   unsigned i;
+   int best = 0;
+
+   if (!db || q->root.func != query_func_all_map)
+      return;
+
+   for (i = 0; i + 1 < q->root.argc; i += 2)
+   {
+      libretrodb_query_plan_t plan;
+      int rank                   = 0;
+      const struct argument *key = &q->root.argv[i];
+
+      if (key->type != AT_VALUE || key->a.value.type != RDT_STRING)
+         continue;
+
+      if (libretrodb_find_field_index(db, key->a.value.val.string.buff,
+               key->a.value.val.string.len, &plan.index) != 0)
+         continue;
+
+      plan.db = db;
+      rank    = query_plan_predicate(&q->root.argv[i + 1], &plan);
+
+      if (rank > best)
+      {
+         best        = rank;
+         q->plan     = plan;
+         q->has_plan = 1;
+      }
+   }
+}
+
 void *libretrodb_query_compile(libretrodb_t *db,
       const char *query, size_t buff_len, const char **error_string)
 {
@@ -952,6 +1139,8 @@ void *libretrodb_query_compile(libretrodb_t *db,
       goto error;
    }
 
+   query_plan(db, q);
+
    return q;
 
 error:
@@ -974,3 +1163,10 @@ int libretrodb_query_filter(libretrodb_query_t *q,
    struct rmsgpack_dom_value res = inv.func(*v, inv.argc, inv.argv);
    return (res.type == RDT_BOOL && res.val.bool_);
 }
+
+const libretrodb_query_plan_t *libretrodb_query_get_plan(
+      libretrodb_query_t *q)
+{
+   struct query *rq = (struct query*)q;
+   return (rq && rq->has_plan) ? &rq->plan : NULL;
+}
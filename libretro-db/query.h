@@ -38,6 +38,11 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/* Returns the index range chosen when the query was compiled,
+ * or NULL if it has to be answered by a full scan */
+const struct libretrodb_query_plan *libretrodb_query_get_plan(
+      libretrodb_query_t *q);
+
 RETRO_END_DECLS
 
 #endif
@@ -271,8 +271,7 @@ int rmsgpack_write_bool(RFILE *fd, int value)
       if (filestream_write(fd, &MPF_TRUE, sizeof(MPF_TRUE)) == -1)
          goto error;
    }
-
-   if (filestream_write(fd, &MPF_FALSE, sizeof(MPF_FALSE)) == -1)
+   else if (filestream_write(fd, &MPF_FALSE, sizeof(MPF_FALSE)) == -1)
       goto error;
 
    return sizeof(uint8_t);
@@ -503,3 +503,315 @@ clean:
    rmsgpack_dom_value_free(&map);
    return 0;
 }
+
+static uint64_t dom_view_read_be(const uint8_t *p, unsigned len)
+{
+   unsigned i;
+   uint64_t value = 0;
+
+   for (i = 0; i < len; i++)
+      value = (value << 8) | p[i];
+
+   return value;
+}
+
+static void *dom_view_alloc(struct rmsgpack_dom_arena *arena, size_t len)
+{
+   void *ptr;
+   /* Keep every allocation aligned for struct rmsgpack_dom_value */
+   size_t aligned = (len + 7) & ~(size_t)7;
+
+   if (arena->size - arena->used < aligned)
+      return NULL;
+
+   ptr          = arena->data + arena->used;
+   arena->used += aligned;
+   return ptr;
+}
+
+/* Returns -ENOMEM when the arena is too small; the caller grows it
+ * and decodes again from the start. */
+static int dom_read_view(const uint8_t *data, size_t size, size_t *pos,
+      struct rmsgpack_dom_arena *arena, struct rmsgpack_dom_value *out,
+      unsigned depth)
+{
+   int rv;
+   uint8_t type;
+   unsigned i;
+   unsigned len_size = 0;
+   uint64_t len      = 0;
+   size_t p          = *pos;
+
+   if (p >= size || depth >= MAX_DEPTH)
+      return -EINVAL;
+
+   type = data[p++];
+
+   if (type < 0x80)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = type;
+      goto end;
+   }
+   else if (type < 0x90)
+   {
+      len = type - 0x80;
+      goto map;
+   }
+   else if (type < 0xa0)
+   {
+      len = type - 0x90;
+      goto array;
+   }
+   else if (type < 0xc0)
+   {
+      len = type - 0xa0;
+      goto string;
+   }
+   else if (type >= 0xe0)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = (int8_t)type;
+      goto end;
+   }
+
+   switch (type)
+   {
+      case 0xc0:
+         out->type      = RDT_NULL;
+         goto end;
+      case 0xc2:
+      case 0xc3:
+         out->type      = RDT_BOOL;
+         out->val.bool_ = type == 0xc3;
+         goto end;
+      case 0xc4:
+      case 0xc5:
+      case 0xc6:
+         len_size = 1 << (type - 0xc4);
+         if (size - p < len_size)
+            return -EINVAL;
+         len = dom_view_read_be(data + p, len_size);
+         p  += len_size;
+         if (size - p < len)
+            return -EINVAL;
+         out->type            = RDT_BINARY;
+         out->val.binary.len  = (uint32_t)len;
+         out->val.binary.buff = (char*)data + p;
+         p                   += (size_t)len;
+         goto end;
+      case 0xcc:
+      case 0xcd:
+      case 0xce:
+      case 0xcf:
+         len_size = 1 << (type - 0xcc);
+         if (size - p < len_size)
+            return -EINVAL;
+         out->type      = RDT_UINT;
+         out->val.uint_ = dom_view_read_be(data + p, len_size);
+         p             += len_size;
+         goto end;
+      case 0xd0:
+      case 0xd1:
+      case 0xd2:
+      case 0xd3:
+         len_size = 1 << (type - 0xd0);
+         if (size - p < len_size)
+            return -EINVAL;
+         len       = dom_view_read_be(data + p, len_size);
+         p        += len_size;
+         out->type = RDT_INT;
+         /* Sign-extend from the encoded width */
+         if (len_size < 8 && (len >> (len_size * 8 - 1)))
+            len |= ~(uint64_t)0 << (len_size * 8);
+         out->val.int_ = (int64_t)len;
+         goto end;
+      case 0xd9:
+      case 0xda:
+      case 0xdb:
+         len_size = 1 << (type - 0xd9);
+         if (size - p < len_size)
+            return -EINVAL;
+         len = dom_view_read_be(data + p, len_size);
+         p  += len_size;
+         goto string;
+      case 0xdc:
+      case 0xdd:
+         len_size = 2 << (type - 0xdc);
+         if (size - p < len_size)
+            return -EINVAL;
+         len = dom_view_read_be(data + p, len_size);
+         p  += len_size;
+         goto array;
+      case 0xde:
+      case 0xdf:
+         len_size = 2 << (type - 0xde);
+         if (size - p < len_size)
+            return -EINVAL;
+         len = dom_view_read_be(data + p, len_size);
+         p  += len_size;
+         goto map;
+      default:
+         /* Floats and extension types are never written */
+         return -EINVAL;
+   }
+
+string:
+   if (size - p < len)
+      return -EINVAL;
+   out->type            = RDT_STRING;
+   out->val.string.len  = (uint32_t)len;
+   out->val.string.buff = (char*)data + p;
+   p                   += (size_t)len;
+   goto end;
+
+map:
+   /* Every pair needs at least two bytes */
+   if (len > (size - p) / 2)
+      return -EINVAL;
+   out->type          = RDT_MAP;
+   out->val.map.len   = (uint32_t)len;
+   out->val.map.items = (struct rmsgpack_dom_pair*)dom_view_alloc(arena,
+         (size_t)len * sizeof(struct rmsgpack_dom_pair));
+   if (len && !out->val.map.items)
+      return -ENOMEM;
+   for (i = 0; i < len; i++)
+   {
+      if ((rv = dom_read_view(data, size, &p, arena,
+                  &out->val.map.items[i].key, depth + 1)) < 0)
+         return rv;
+      if ((rv = dom_read_view(data, size, &p, arena,
+                  &out->val.map.items[i].value, depth + 1)) < 0)
+         return rv;
+   }
+   goto end;
+
+array:
+   if (len > size - p)
+      return -EINVAL;
+   out->type            = RDT_ARRAY;
+   out->val.array.len   = (uint32_t)len;
+   out->val.array.items = (struct rmsgpack_dom_value*)dom_view_alloc(arena,
+         (size_t)len * sizeof(struct rmsgpack_dom_value));
+   if (len && !out->val.array.items)
+      return -ENOMEM;
+   for (i = 0; i < len; i++)
+   {
+      if ((rv = dom_read_view(data, size, &p, arena,
+                  &out->val.array.items[i], depth + 1)) < 0)
+         return rv;
+   }
+
+end:
+   *pos = p;
+   return 0;
+}
+
+int rmsgpack_dom_read_view(const uint8_t *data, size_t size, size_t *pos,
+      struct rmsgpack_dom_arena *arena, struct rmsgpack_dom_value *out)
+{
+   for (;;)
+   {
+      int rv;
+      uint8_t *new_data;
+      size_t new_size;
+      size_t p    = *pos;
+
+      arena->used = 0;
+      rv          = dom_read_view(data, size, &p, arena, out, 0);
+
+      if (rv == 0)
+         *pos = p;
+      if (rv != -ENOMEM)
+         return rv;
+
+      new_size = arena->size ? arena->size * 2 : 4096;
+      new_data = (uint8_t*)realloc(arena->data, new_size);
+
+      if (!new_data)
+         return -ENOMEM;
+
+      arena->data = new_data;
+      arena->size = new_size;
+   }
+}
+
+void rmsgpack_dom_arena_free(struct rmsgpack_dom_arena *arena)
+{
+   if (!arena)
+      return;
+
+   free(arena->data);
+   arena->data = NULL;
+   arena->size = 0;
+   arena->used = 0;
+}
+
+int rmsgpack_dom_value_copy(struct rmsgpack_dom_value *dst,
+      const struct rmsgpack_dom_value *src)
+{
+   unsigned i;
+
+   *dst = *src;
+
+   switch (src->type)
+   {
+      case RDT_STRING:
+      case RDT_BINARY:
+         /* string and binary share the same layout */
+         dst->val.string.buff = (char*)malloc(src->val.string.len + 1);
+         if (!dst->val.string.buff)
+         {
+            dst->type = RDT_NULL;
+            return -ENOMEM;
+         }
+         memcpy(dst->val.string.buff, src->val.string.buff,
+               src->val.string.len);
+         dst->val.string.buff[src->val.string.len] = '\0';
+         break;
+      case RDT_MAP:
+         dst->val.map.items = (struct rmsgpack_dom_pair*)calloc(
+               src->val.map.len, sizeof(struct rmsgpack_dom_pair));
+         if (src->val.map.len && !dst->val.map.items)
+         {
+            dst->type = RDT_NULL;
+            return -ENOMEM;
+         }
+         for (i = 0; i < src->val.map.len; i++)
+         {
+            if (     rmsgpack_dom_value_copy(&dst->val.map.items[i].key,
+                        &src->val.map.items[i].key) < 0
+                  || rmsgpack_dom_value_copy(&dst->val.map.items[i].value,
+                        &src->val.map.items[i].value) < 0)
+            {
+               rmsgpack_dom_value_free(dst);
+               dst->type = RDT_NULL;
+               return -ENOMEM;
+            }
+         }
+         break;
+      case RDT_ARRAY:
+         dst->val.array.items = (struct rmsgpack_dom_value*)calloc(
+               src->val.array.len, sizeof(struct rmsgpack_dom_value));
+         if (src->val.array.len && !dst->val.array.items)
+         {
+            dst->type = RDT_NULL;
+            return -ENOMEM;
+         }
+         for (i = 0; i < src->val.array.len; i++)
+         {
+            if (rmsgpack_dom_value_copy(&dst->val.array.items[i],
+                     &src->val.array.items[i]) < 0)
+            {
+               rmsgpack_dom_value_free(dst);
+               dst->type = RDT_NULL;
+               return -ENOMEM;
+            }
+         }
+         break;
+      default:
+         break;
+   }
+
+   return 0;
+}
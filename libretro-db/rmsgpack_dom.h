@@ -79,6 +79,16 @@ struct rmsgpack_dom_pair
 	struct rmsgpack_dom_value value;
 };
 
+/* Scratch storage for the map and array items of values decoded
+ * by rmsgpack_dom_read_view(). Reused (and overwritten) by every
+ * call; release with rmsgpack_dom_arena_free(). */
+struct rmsgpack_dom_arena
+{
+   uint8_t *data;
+   size_t size;
+   size_t used;
+};
+
 void rmsgpack_dom_value_print(struct rmsgpack_dom_value *obj);
 void rmsgpack_dom_value_free(struct rmsgpack_dom_value *v);
 
@@ -95,6 +105,39 @@ int rmsgpack_dom_write(RFILE *fd, const struct rmsgpack_dom_value *obj);
 
 int rmsgpack_dom_read_into(RFILE *fd, ...);
 
+/**
+ * rmsgpack_dom_read_view:
+ * @data               : msgpack encoded buffer
+ * @size               : size of @data
+ * @pos                : offset to decode at, advanced past the value
+ * @arena              : scratch storage for map/array items
+ * @out                : decoded value
+ *
+ * Decodes one value in place. Strings and binaries point into
+ * @data and are NOT NUL-terminated; use their length. @out stays
+ * valid until the next call using the same @arena, and must not be
+ * passed to rmsgpack_dom_value_free().
+ *
+ * Returns: 0 on success, otherwise negative.
+ **/
+int rmsgpack_dom_read_view(const uint8_t *data, size_t size, size_t *pos,
+      struct rmsgpack_dom_arena *arena, struct rmsgpack_dom_value *out);
+
+void rmsgpack_dom_arena_free(struct rmsgpack_dom_arena *arena);
+
+/**
+ * rmsgpack_dom_value_copy:
+ * @dst                : receives an allocated deep copy
+ * @src                : value to copy, e.g. a view
+ *
+ * Strings and binaries of the copy are NUL-terminated, like those
+ * returned by rmsgpack_dom_read(). Free with rmsgpack_dom_value_free().
+ *
+ * Returns: 0 on success, otherwise negative.
+ **/
+int rmsgpack_dom_value_copy(struct rmsgpack_dom_value *dst,
+      const struct rmsgpack_dom_value *src);
+
 RETRO_END_DECLS
 
 #endif
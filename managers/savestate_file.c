@@ -0,0 +1,556 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_endianness.h>
+#include <retro_miscellaneous.h>
+#include <streams/trans_stream.h>
+
+#include "savestate_file.h"
+
+/* Compression level for SAVESTATE_FILE_CODEC_DEFLATE.
+ * Saving happens while the user is playing, so favour speed. */
+#define SAVESTATE_FILE_DEFLATE_LEVEL 1
+
+/* Bounds for the chunk layout, to reject corrupt or crafted
+ * headers before allocating anything. The chunk count cap keeps
+ * the chunk table at 4 MB, i.e. 256 GB of state at the default
+ * chunk size. */
+#define SAVESTATE_FILE_MIN_CHUNK_SIZE (4 * 1024)
+#define SAVESTATE_FILE_MAX_CHUNK_SIZE (64 * 1024 * 1024)
+#define SAVESTATE_FILE_MAX_CHUNKS     (1024 * 1024)
+
+struct savestate_file_writer
+{
+   intfstream_t *file;
+   const uint8_t *state;
+   size_t size;
+   uint32_t *table;
+   uint8_t *out;
+   uint32_t out_size;
+   void *stream;
+   const struct trans_stream_backend *backend;
+   int64_t table_offset;
+   size_t written;
+   uint32_t chunk;
+   uint32_t num_chunks;
+   uint32_t chunk_size;
+};
+
+struct savestate_file_reader
+{
+   intfstream_t *file;
+   savestate_file_header_t header;
+   uint32_t *table;
+   uint8_t *in;
+   void *stream;
+   const struct trans_stream_backend *backend;
+   int64_t meta_offset;
+   int64_t thumb_offset;
+   uint32_t chunk;
+};
+
+static void savestate_file_put32(uint8_t *p, uint32_t val)
+{
+   val = swap_if_big32(val);
+   memcpy(p, &val, sizeof(val));
+}
+
+static void savestate_file_put64(uint8_t *p, uint64_t val)
+{
+   val = swap_if_big64(val);
+   memcpy(p, &val, sizeof(val));
+}
+
+static uint32_t savestate_file_get32(const uint8_t *p)
+{
+   uint32_t val;
+   memcpy(&val, p, sizeof(val));
+   return swap_if_big32(val);
+}
+
+static uint64_t savestate_file_get64(const uint8_t *p)
+{
+   uint64_t val;
+   memcpy(&val, p, sizeof(val));
+   return swap_if_big64(val);
+}
+
+static bool savestate_file_write(intfstream_t *file,
+      const void *data, size_t size, size_t *written)
+{
+   if (!size)
+      return true;
+   if (intfstream_write(file, data, size) != (int64_t)size)
+      return false;
+   if (written)
+      *written += size;
+   return true;
+}
+
+/* Sets up a fresh deflate/inflate stream. Each chunk is
+ * a complete stream, so this is also how a stream that did
+ * not reach its end is discarded. */
+static void *savestate_file_stream_new(
+      const struct trans_stream_backend *backend, bool deflate)
+{
+   void *stream = backend->stream_new();
+
+   if (stream && deflate && backend->define)
+      backend->define(stream, "level", SAVESTATE_FILE_DEFLATE_LEVEL);
+
+   return stream;
+}
+
+savestate_file_writer_t *savestate_file_writer_new(intfstream_t *file,
+      const void *state, size_t size,
+      enum savestate_file_codec codec,
+      const char *meta,
+      const void *thumb, size_t thumb_size)
+{
+   uint8_t header[SAVESTATE_FILE_HEADER_SIZE];
+   size_t meta_size                = meta ? strlen(meta) : 0;
+   savestate_file_writer_t *writer = NULL;
+
+   if (!file || !state || !size)
+      return NULL;
+
+   writer = (savestate_file_writer_t*)calloc(1, sizeof(*writer));
+   if (!writer)
+      return NULL;
+
+   writer->file       = file;
+   writer->state      = (const uint8_t*)state;
+   writer->size       = size;
+   writer->chunk_size = SAVESTATE_FILE_CHUNK_SIZE;
+   writer->num_chunks = (uint32_t)
+      ((size + writer->chunk_size - 1) / writer->chunk_size);
+   writer->table      = (uint32_t*)calloc(writer->num_chunks,
+         sizeof(*writer->table));
+
+   if (!writer->table)
+      goto error;
+
+   if (codec == SAVESTATE_FILE_CODEC_DEFLATE)
+   {
+      writer->backend = trans_stream_get_zlib_deflate_backend();
+
+      /* Built without zlib, store the chunks raw */
+      if (!writer->backend)
+         codec = SAVESTATE_FILE_CODEC_NONE;
+   }
+
+   if (writer->backend)
+   {
+      /* Comfortably above deflateBound() for one chunk */
+      writer->out_size = writer->chunk_size + writer->chunk_size / 8 + 64;
+      writer->out      = (uint8_t*)malloc(writer->out_size);
+      writer->stream   = savestate_file_stream_new(writer->backend, true);
+
+      if (!writer->out || !writer->stream)
+         goto error;
+   }
+
+   memset(header, 0, sizeof(header));
+   memcpy(header, SAVESTATE_FILE_MAGIC, SAVESTATE_FILE_MAGIC_SIZE);
+   savestate_file_put32(header +  8, SAVESTATE_FILE_VERSION);
+   savestate_file_put32(header + 12, SAVESTATE_FILE_HEADER_SIZE);
+   savestate_file_put32(header + 16, codec);
+   savestate_file_put32(header + 20, writer->chunk_size);
+   savestate_file_put64(header + 24, size);
+   savestate_file_put32(header + 32, writer->num_chunks);
+   savestate_file_put32(header + 36, (uint32_t)meta_size);
+   savestate_file_put32(header + 40, thumb ? (uint32_t)thumb_size : 0);
+
+   if (     !savestate_file_write(file, header, sizeof(header), &writer->written)
+         || !savestate_file_write(file, meta, meta_size, &writer->written)
+         || (thumb && !savestate_file_write(file, thumb, thumb_size,
+               &writer->written)))
+      goto error;
+
+   /* Reserve the chunk table; it is filled in once every
+    * chunk's stored size is known. */
+   writer->table_offset = (int64_t)writer->written;
+
+   if (!savestate_file_write(file, writer->table,
+            writer->num_chunks * sizeof(*writer->table), &writer->written))
+      goto error;
+
+   return writer;
+
+error:
+   savestate_file_writer_free(writer);
+   return NULL;
+}
+
+int savestate_file_writer_step(savestate_file_writer_t *writer)
+{
+   size_t offset;
+   uint32_t len;
+   uint32_t stored;
+   const uint8_t *src;
+   const uint8_t *data;
+
+   if (!writer)
+      return -1;
+
+   if (writer->chunk < writer->num_chunks)
+   {
+      offset = (size_t)writer->chunk * writer->chunk_size;
+      len    = (uint32_t)MIN(writer->size - offset, writer->chunk_size);
+      src    = writer->state + offset;
+      data   = src;
+      stored = len;
+
+      if (writer->backend)
+      {
+         uint32_t rd = 0, wn = 0;
+         enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+         bool ret;
+
+         writer->backend->set_in(writer->stream, src, len);
+         writer->backend->set_out(writer->stream, writer->out,
+               writer->out_size);
+         ret = writer->backend->trans(writer->stream, true, &rd, &wn, &err);
+
+         if (ret && err == TRANS_STREAM_ERROR_NONE && rd == len)
+         {
+            /* Incompressible chunks are stored raw */
+            if (wn < len)
+            {
+               data   = writer->out;
+               stored = wn;
+            }
+         }
+         else
+         {
+            writer->backend->stream_free(writer->stream);
+            writer->stream = savestate_file_stream_new(writer->backend, true);
+            if (!writer->stream)
+               return -1;
+         }
+      }
+
+      if (!savestate_file_write(writer->file, data, stored, &writer->written))
+         return -1;
+
+      writer->table[writer->chunk++] = stored;
+
+      if (writer->chunk < writer->num_chunks)
+         return 0;
+   }
+
+   /* All chunks are written, fill in the table */
+   {
+      uint32_t i;
+
+      for (i = 0; i < writer->num_chunks; i++)
+         savestate_file_put32((uint8_t*)&writer->table[i], writer->table[i]);
+
+      if (intfstream_seek(writer->file, writer->table_offset, SEEK_SET) < 0)
+         return -1;
+      if (!savestate_file_write(writer->file, writer->table,
+               writer->num_chunks * sizeof(*writer->table), NULL))
+         return -1;
+      if (intfstream_seek(writer->file, 0, SEEK_END) < 0)
+         return -1;
+   }
+
+   return 1;
+}
+
+float savestate_file_writer_progress(savestate_file_writer_t *writer)
+{
+   if (!writer || !writer->num_chunks)
+      return 0.0f;
+   return writer->chunk / (float)writer->num_chunks;
+}
+
+size_t savestate_file_writer_written(savestate_file_writer_t *writer)
+{
+   if (!writer)
+      return 0;
+   return writer->written;
+}
+
+void savestate_file_writer_free(savestate_file_writer_t *writer)
+{
+   if (!writer)
+      return;
+
+   if (writer->stream)
+      writer->backend->stream_free(writer->stream);
+   if (writer->out)
+      free(writer->out);
+   if (writer->table)
+      free(writer->table);
+   free(writer);
+}
+
+savestate_file_reader_t *savestate_file_reader_open(intfstream_t *file,
+      bool *is_container)
+{
+   uint8_t header[SAVESTATE_FILE_HEADER_SIZE];
+   uint32_t i;
+   uint32_t header_size;
+   uint64_t expected_chunks;
+   size_t table_size;
+   int64_t table_offset;
+   savestate_file_reader_t *reader = NULL;
+   savestate_file_header_t *hdr    = NULL;
+
+   if (is_container)
+      *is_container = false;
+
+   if (!file)
+      return NULL;
+
+   if (     intfstream_read(file, header, sizeof(header)) != sizeof(header)
+         || memcmp(header, SAVESTATE_FILE_MAGIC, SAVESTATE_FILE_MAGIC_SIZE))
+   {
+      intfstream_rewind(file);
+      return NULL;
+   }
+
+   if (is_container)
+      *is_container = true;
+
+   reader = (savestate_file_reader_t*)calloc(1, sizeof(*reader));
+   if (!reader)
+      return NULL;
+
+   reader->file       = file;
+   hdr                = &reader->header;
+   hdr->version       = savestate_file_get32(header +  8);
+   header_size        = savestate_file_get32(header + 12);
+   hdr->codec         = savestate_file_get32(header + 16);
+   hdr->chunk_size    = savestate_file_get32(header + 20);
+   hdr->state_size    = savestate_file_get64(header + 24);
+   hdr->num_chunks    = savestate_file_get32(header + 32);
+   hdr->meta_size     = savestate_file_get32(header + 36);
+   hdr->thumb_size    = savestate_file_get32(header + 40);
+
+   if (     hdr->version != SAVESTATE_FILE_VERSION
+         || header_size  <  SAVESTATE_FILE_HEADER_SIZE
+         || hdr->chunk_size <  SAVESTATE_FILE_MIN_CHUNK_SIZE
+         || hdr->chunk_size >  SAVESTATE_FILE_MAX_CHUNK_SIZE
+         || hdr->state_size == 0
+         || hdr->state_size > (uint64_t)((size_t)-1))
+      goto error;
+
+   /* Rounded up without overflowing for huge state sizes */
+   expected_chunks = hdr->state_size / hdr->chunk_size
+      + (hdr->state_size % hdr->chunk_size != 0);
+   if (     expected_chunks != hdr->num_chunks
+         || hdr->num_chunks > SAVESTATE_FILE_MAX_CHUNKS
+         || hdr->num_chunks > ((size_t)-1) / sizeof(*reader->table))
+      goto error;
+
+   table_size = (size_t)hdr->num_chunks * sizeof(*reader->table);
+
+   switch (hdr->codec)
+   {
+      case SAVESTATE_FILE_CODEC_NONE:
+         break;
+      case SAVESTATE_FILE_CODEC_DEFLATE:
+         reader->backend = trans_stream_get_zlib_inflate_backend();
+         if (!reader->backend)
+            goto error;
+         reader->stream  = savestate_file_stream_new(reader->backend, false);
+         reader->in      = (uint8_t*)malloc(hdr->chunk_size);
+         if (!reader->stream || !reader->in)
+            goto error;
+         break;
+      default:
+         goto error;
+   }
+
+   reader->meta_offset  = header_size;
+   reader->thumb_offset = reader->meta_offset  + hdr->meta_size;
+   table_offset         = reader->thumb_offset + hdr->thumb_size;
+
+   reader->table = (uint32_t*)malloc(table_size);
+   if (!reader->table)
+      goto error;
+
+   if (     intfstream_seek(file, table_offset, SEEK_SET) < 0
+         || intfstream_read(file, reader->table, table_size)
+            != (int64_t)table_size)
+      goto error;
+
+   for (i = 0; i < hdr->num_chunks; i++)
+   {
+      uint64_t offset = (uint64_t)i * hdr->chunk_size;
+      uint32_t len    = (uint32_t)MIN(hdr->state_size - offset,
+            hdr->chunk_size);
+
+      reader->table[i] = savestate_file_get32((const uint8_t*)&reader->table[i]);
+
+      if (     reader->table[i] > len
+            || (hdr->codec == SAVESTATE_FILE_CODEC_NONE
+               && reader->table[i] != len))
+         goto error;
+   }
+
+   return reader;
+
+error:
+   savestate_file_reader_free(reader);
+   return NULL;
+}
+
+const savestate_file_header_t *savestate_file_reader_header(
+      savestate_file_reader_t *reader)
+{
+   if (!reader)
+      return NULL;
+   return &reader->header;
+}
+
+/* Reads a block outside the chunk area, leaving the stream
+ * where the next chunk starts. */
+static bool savestate_file_reader_read_block(savestate_file_reader_t *reader,
+      int64_t offset, void *s, size_t len)
+{
+   bool ret    = false;
+   int64_t pos = intfstream_tell(reader->file);
+
+   if (pos < 0)
+      return false;
+
+   if (intfstream_seek(reader->file, offset, SEEK_SET) >= 0)
+      ret = intfstream_read(reader->file, s, len) == (int64_t)len;
+
+   if (intfstream_seek(reader->file, pos, SEEK_SET) < 0)
+      return false;
+
+   return ret;
+}
+
+bool savestate_file_reader_read_metadata(savestate_file_reader_t *reader,
+      char *s, size_t len)
+{
+   size_t size;
+
+   if (!reader || !s || !len)
+      return false;
+
+   size = MIN(reader->header.meta_size, len - 1);
+
+   if (!savestate_file_reader_read_block(reader,
+            reader->meta_offset, s, size))
+      return false;
+
+   s[size] = '\0';
+   return true;
+}
+
+bool savestate_file_reader_read_thumbnail(savestate_file_reader_t *reader,
+      void **data, size_t *size)
+{
+   void *buf = NULL;
+
+   if (!reader || !data || !size || !reader->header.thumb_size)
+      return false;
+
+   buf = malloc(reader->header.thumb_size);
+   if (!buf)
+      return false;
+
+   if (!savestate_file_reader_read_block(reader,
+            reader->thumb_offset, buf, reader->header.thumb_size))
+   {
+      free(buf);
+      return false;
+   }
+
+   *data = buf;
+   *size = reader->header.thumb_size;
+   return true;
+}
+
+int savestate_file_reader_step(savestate_file_reader_t *reader,
+      void *state)
+{
+   uint64_t offset;
+   uint32_t len;
+   uint32_t stored;
+   uint8_t *dst;
+
+   if (!reader || !state)
+      return -1;
+
+   if (reader->chunk >= reader->header.num_chunks)
+      return 1;
+
+   offset = (uint64_t)reader->chunk * reader->header.chunk_size;
+   len    = (uint32_t)MIN(reader->header.state_size - offset,
+         reader->header.chunk_size);
+   stored = reader->table[reader->chunk];
+   dst    = (uint8_t*)state + offset;
+
+   if (stored == len)
+   {
+      if (intfstream_read(reader->file, dst, len) != (int64_t)len)
+         return -1;
+   }
+   else
+   {
+      uint32_t rd = 0, wn = 0;
+      enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+      bool ret;
+
+      if (intfstream_read(reader->file, reader->in, stored) != (int64_t)stored)
+         return -1;
+
+      reader->backend->set_in(reader->stream, reader->in, stored);
+      reader->backend->set_out(reader->stream, dst, len);
+      ret = reader->backend->trans(reader->stream, true, &rd, &wn, &err);
+
+      /* The chunk must inflate to exactly its size and use up
+       * exactly the stored bytes */
+      if (     !ret || err != TRANS_STREAM_ERROR_NONE
+            || wn != len || rd != stored)
+         return -1;
+   }
+
+   reader->chunk++;
+
+   return reader->chunk < reader->header.num_chunks ? 0 : 1;
+}
+
+float savestate_file_reader_progress(savestate_file_reader_t *reader)
+{
+   if (!reader || !reader->header.num_chunks)
+      return 0.0f;
+   return reader->chunk / (float)reader->header.num_chunks;
+}
+
+void savestate_file_reader_free(savestate_file_reader_t *reader)
+{
+   if (!reader)
+      return;
+
+   if (reader->stream)
+      reader->backend->stream_free(reader->stream);
+   if (reader->in)
+      free(reader->in);
+   if (reader->table)
+      free(reader->table);
+   free(reader);
+}
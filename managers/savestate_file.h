@@ -0,0 +1,174 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SAVESTATE_FILE_H
+#define __SAVESTATE_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+#include <streams/interface_stream.h>
+
+RETRO_BEGIN_DECLS
+
+/* Savestate container.
+ *
+ * All fields are little endian.
+ *
+ *   header       SAVESTATE_FILE_HEADER_SIZE bytes, see below
+ *   metadata     meta_size bytes of key = "value" lines; backslash,
+ *                double quote, CR and LF in values are escaped
+ *                as \\, \", \r and \n
+ *   thumbnail    thumb_size bytes (PNG), may be empty
+ *   chunk table  num_chunks uint32 stored chunk sizes
+ *   chunks       each chunk_size bytes of state (the last one
+ *                may be shorter), compressed independently
+ *
+ * A chunk whose stored size equals its uncompressed size is
+ * stored raw. Files without the magic are legacy raw states. */
+#define SAVESTATE_FILE_MAGIC        "RASTATE\x1a"
+#define SAVESTATE_FILE_MAGIC_SIZE   8
+#define SAVESTATE_FILE_VERSION      1
+#define SAVESTATE_FILE_HEADER_SIZE  48
+#define SAVESTATE_FILE_CHUNK_SIZE   (256 * 1024)
+
+enum savestate_file_codec
+{
+   SAVESTATE_FILE_CODEC_NONE = 0,
+   SAVESTATE_FILE_CODEC_DEFLATE
+};
+
+typedef struct savestate_file_header
+{
+   uint32_t version;
+   uint32_t codec;
+   uint32_t chunk_size;
+   uint32_t num_chunks;
+   uint64_t state_size;
+   uint32_t meta_size;
+   uint32_t thumb_size;
+} savestate_file_header_t;
+
+typedef struct savestate_file_writer savestate_file_writer_t;
+typedef struct savestate_file_reader savestate_file_reader_t;
+
+/**
+ * savestate_file_writer_new:
+ * @file            : stream positioned at the start of an empty file
+ * @state           : serialized state, must stay valid until freed
+ * @size            : size of @state
+ * @codec           : chunk codec
+ * @meta            : (optional) metadata text
+ * @thumb           : (optional) thumbnail data
+ * @thumb_size      : size of @thumb
+ *
+ * Writes the header, metadata and thumbnail blocks and prepares
+ * to write @state one chunk at a time.
+ *
+ * Returns: writer handle, or NULL on failure.
+ **/
+savestate_file_writer_t *savestate_file_writer_new(intfstream_t *file,
+      const void *state, size_t size,
+      enum savestate_file_codec codec,
+      const char *meta,
+      const void *thumb, size_t thumb_size);
+
+/**
+ * savestate_file_writer_step:
+ * @writer          : writer handle
+ *
+ * Compresses and writes the next chunk. The chunk table is
+ * filled in after the last one.
+ *
+ * Returns: 1 when the file is complete, 0 if there are more
+ * chunks to write, -1 on error.
+ **/
+int savestate_file_writer_step(savestate_file_writer_t *writer);
+
+/* Fraction of the state written so far, in [0, 1]. */
+float savestate_file_writer_progress(savestate_file_writer_t *writer);
+
+/* Bytes written to the file so far. */
+size_t savestate_file_writer_written(savestate_file_writer_t *writer);
+
+void savestate_file_writer_free(savestate_file_writer_t *writer);
+
+/**
+ * savestate_file_reader_open:
+ * @file            : stream positioned at the start of the file
+ * @is_container    : output, true if @file starts with the magic
+ *
+ * Reads the header and chunk table. If the file is not a
+ * container, the stream is rewound so it can be read as a
+ * legacy raw state.
+ *
+ * Returns: reader handle, or NULL if @file is not a container
+ * or the container is corrupt or uses an unsupported codec.
+ **/
+savestate_file_reader_t *savestate_file_reader_open(intfstream_t *file,
+      bool *is_container);
+
+const savestate_file_header_t *savestate_file_reader_header(
+      savestate_file_reader_t *reader);
+
+/**
+ * savestate_file_reader_read_metadata:
+ * @reader          : reader handle
+ * @s               : output buffer
+ * @len             : size of @s
+ *
+ * Reads the metadata block, truncated to fit @s, without
+ * touching the state chunks.
+ *
+ * Returns: true if successful, false otherwise.
+ **/
+bool savestate_file_reader_read_metadata(savestate_file_reader_t *reader,
+      char *s, size_t len);
+
+/**
+ * savestate_file_reader_read_thumbnail:
+ * @reader          : reader handle
+ * @data            : output, thumbnail data allocated with malloc()
+ * @size            : output, size of @data
+ *
+ * Returns: true if a thumbnail was read, false otherwise.
+ **/
+bool savestate_file_reader_read_thumbnail(savestate_file_reader_t *reader,
+      void **data, size_t *size);
+
+/**
+ * savestate_file_reader_step:
+ * @reader          : reader handle
+ * @state           : buffer of at least header.state_size bytes
+ *
+ * Reads the next chunk and decompresses it straight into its
+ * place in @state.
+ *
+ * Returns: 1 when the whole state has been read, 0 if there are
+ * more chunks to read, -1 on error.
+ **/
+int savestate_file_reader_step(savestate_file_reader_t *reader,
+      void *state);
+
+/* Fraction of the state read so far, in [0, 1]. */
+float savestate_file_reader_progress(savestate_file_reader_t *reader);
+
+void savestate_file_reader_free(savestate_file_reader_t *reader);
+
+RETRO_END_DECLS
+
+#endif
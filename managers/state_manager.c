@@ -26,6 +26,11 @@
 #include <retro_inline.h>
 #include <compat/strl.h>
 #include <compat/intrinsics.h>
+#include <features/features_cpu.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "state_manager.h"
 #include "../msg_hash.h"
@@ -59,10 +64,20 @@
 #define NO_UNALIGNED_MEM
 #endif
 
-#if __SSE2__
+/* The AVX2 scanners are compiled per function and only used
+ * when the CPU reports AVX2 at runtime. */
+#if defined(CPU_X86) && defined(__SSE2__) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define STATE_MANAGER_AVX2
+#include <immintrin.h>
+#elif __SSE2__
 #include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define STATE_MANAGER_NEON
 #endif
 
+typedef size_t (*state_manager_scan_t)(const uint16_t *a, const uint16_t *b);
+
 /* There's no equivalent in libc, you'd think so ...
  * std::mismatch exists, but it's not optimized at all. */
 static size_t find_change(const uint16_t *a, const uint16_t *b)
@@ -88,6 +103,30 @@ static size_t find_change(const uint16_t *a, const uint16_t *b)
       a128++;
       b128++;
    }
+#elif defined(STATE_MANAGER_NEON)
+   const uint8_t *a8 = (const uint8_t*)a;
+   const uint8_t *b8 = (const uint8_t*)b;
+
+   for (;;)
+   {
+      /* Byte loads, so we don't care about alignment. */
+      uint32x4_t v0 = vreinterpretq_u32_u8(vld1q_u8(a8));
+      uint32x4_t v1 = vreinterpretq_u32_u8(vld1q_u8(b8));
+      uint64x2_t c  = vreinterpretq_u64_u32(vceqq_u32(v0, v1));
+
+      if ((vgetq_lane_u64(c, 0) & vgetq_lane_u64(c, 1)) != UINT64_MAX)
+      {
+         /* Something has changed, figure out where. */
+         size_t ret = (a8 - (const uint8_t*)a) >> 1;
+
+         while (a[ret] == b[ret])
+            ret++;
+         return ret;
+      }
+
+      a8 += 16;
+      b8 += 16;
+   }
 #else
    const uint16_t *a_org = a;
 #ifdef NO_UNALIGNED_MEM
@@ -143,11 +182,49 @@ static size_t find_same(const uint16_t *a, const uint16_t *b)
       const uint32_t *a_big = (const uint32_t*)a;
       const uint32_t *b_big = (const uint32_t*)b;
 
+#if __SSE2__
+      for (;;)
+      {
+         __m128i v0    = _mm_loadu_si128((const __m128i*)a_big);
+         __m128i v1    = _mm_loadu_si128((const __m128i*)b_big);
+         uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi32(v0, v1));
+
+         if (mask)
+         {
+            a_big += compat_ctz(mask) >> 2;
+            b_big += compat_ctz(mask) >> 2;
+            break;
+         }
+
+         a_big += 4;
+         b_big += 4;
+      }
+#elif defined(STATE_MANAGER_NEON)
+      for (;;)
+      {
+         uint32x4_t v0 = vreinterpretq_u32_u8(vld1q_u8((const uint8_t*)a_big));
+         uint32x4_t v1 = vreinterpretq_u32_u8(vld1q_u8((const uint8_t*)b_big));
+         uint64x2_t c  = vreinterpretq_u64_u32(vceqq_u32(v0, v1));
+
+         if (vgetq_lane_u64(c, 0) | vgetq_lane_u64(c, 1))
+            break;
+
+         a_big += 4;
+         b_big += 4;
+      }
+
+      while (*a_big != *b_big)
+      {
+         a_big++;
+         b_big++;
+      }
+#else
       while (*a_big != *b_big)
       {
          a_big++;
          b_big++;
       }
+#endif
       a = (const uint16_t*)a_big;
       b = (const uint16_t*)b_big;
 
@@ -160,6 +237,82 @@ static size_t find_same(const uint16_t *a, const uint16_t *b)
    return a - a_org;
 }
 
+#ifdef STATE_MANAGER_AVX2
+/* compat_ctz only covers 16 bits on some compilers. */
+static INLINE unsigned ctz32(uint32_t x)
+{
+   if (x & 0xffff)
+      return compat_ctz(x & 0xffff);
+   return 16 + compat_ctz(x >> 16);
+}
+
+/* Same as find_change() and find_same(), 32 bytes at a time. */
+__attribute__((target("avx2")))
+static size_t find_change_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi32(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask != 0xffffffff) /* Something has changed, figure out where. */
+      {
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               ctz32(~mask)) >> 1;
+         return ret | (a[ret] == b[ret]);
+      }
+
+      a256++;
+      b256++;
+   }
+}
+
+__attribute__((target("avx2")))
+static size_t find_same_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+
+   if (*a != *b)
+   {
+      const uint32_t *a_big = (const uint32_t*)a;
+      const uint32_t *b_big = (const uint32_t*)b;
+
+      for (;;)
+      {
+         __m256i v0    = _mm256_loadu_si256((const __m256i*)a_big);
+         __m256i v1    = _mm256_loadu_si256((const __m256i*)b_big);
+         uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+               _mm256_cmpeq_epi32(v0, v1));
+
+         if (mask)
+         {
+            a_big += ctz32(mask) >> 2;
+            b_big += ctz32(mask) >> 2;
+            break;
+         }
+
+         a_big += 8;
+         b_big += 8;
+      }
+
+      a = (const uint16_t*)a_big;
+      b = (const uint16_t*)b_big;
+
+      if (a != a_org && a[-1] == b[-1])
+      {
+         a--;
+         b--;
+      }
+   }
+   return a - a_org;
+}
+#endif
+
 struct state_manager
 {
    uint8_t *data;
@@ -182,6 +335,24 @@ struct state_manager
 
    unsigned entries;
    bool thisblock_valid;
+
+   /* Statistics, logged when rewind is deinitialized. */
+   uint64_t stat_frames;
+   uint64_t stat_bytes;
+   retro_time_t stat_usec;
+
+#ifdef HAVE_THREADS
+   /* In threaded mode, compression of the last pushed
+    * state runs on a worker while the core runs the
+    * next frame. The worker owns 'oldblock' and
+    * 'thisblock' until state_manager_sync() returns. */
+   uint8_t *oldblock;
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   bool job_pending;
+   bool thread_quit;
+#endif
 #if STRICT_BUF_SIZE
    size_t debugsize;
    uint8_t *debugblock;
@@ -220,7 +391,7 @@ static bool frame_is_reversed                         = false;
 
 /* Returns the maximum compressed size of a savestate.
  * It is very likely to compress to far less. */
-static size_t state_manager_raw_maxsize(size_t uncomp)
+size_t state_manager_raw_maxsize(size_t uncomp)
 {
    /* bytes covered by a compressed block */
    const int maxcblkcover = UINT16_MAX * sizeof(uint16_t);
@@ -236,10 +407,10 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
  * See state_manager_raw_compress for information about this.
  * When you're done with it, send it to free().
  */
-static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
+void *state_manager_raw_alloc(size_t len, uint16_t uniq)
 {
    size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 32, 1);
 
    /* Force in a different byte at the end, so we don't need to check
     * bounds in the innermost loop (it's expensive).
@@ -250,23 +421,17 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
     * There is also some padding at the end. This is so we don't
     * read outside the buffer end if we're reading in large blocks;
     *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
-    * Valgrind happy is worth it. */
+    * It doesn't make any difference to us, but sacrificing 32 bytes (one
+    * AVX2 load) to get Valgrind happy is worth it. */
    ret[len16/sizeof(uint16_t) + 3] = uniq;
 
    return ret;
 }
 
-/*
- * Takes two savestates and creates a patch that turns 'src' into 'dst'.
- * Both 'src' and 'dst' must be returned from state_manager_raw_alloc(),
- * with the same 'len', and different 'uniq'.
- *
- * 'patch' must be size 'state_manager_raw_maxsize(len)' or more.
- * Returns the number of bytes actually written to 'patch'.
- */
-static size_t state_manager_raw_compress(const void *src,
-      const void *dst, size_t len, void *patch)
+/* state_manager_raw_compress() with the given scanners. */
+static size_t state_manager_raw_compress_scan(const void *src,
+      const void *dst, size_t len, void *patch,
+      state_manager_scan_t change, state_manager_scan_t same)
 {
    const uint16_t  *old16 = (const uint16_t*)src;
    const uint16_t  *new16 = (const uint16_t*)dst;
@@ -277,7 +442,7 @@ static size_t state_manager_raw_compress(const void *src,
    while (num16s)
    {
       size_t i, changed;
-      size_t skip = find_change(old16, new16);
+      size_t skip = change(old16, new16);
 
       if (skip >= num16s)
          break;
@@ -301,7 +466,7 @@ static size_t state_manager_raw_compress(const void *src,
          continue;
       }
 
-      changed = find_same(old16, new16);
+      changed = same(old16, new16);
       if (changed > UINT16_MAX)
          changed = UINT16_MAX;
 
@@ -324,6 +489,26 @@ static size_t state_manager_raw_compress(const void *src,
    return (uint8_t*)(compressed16+3) - (uint8_t*)patch;
 }
 
+/*
+ * Takes two savestates and creates a patch that turns 'src' into 'dst'.
+ * Both 'src' and 'dst' must be returned from state_manager_raw_alloc(),
+ * with the same 'len', and different 'uniq'.
+ *
+ * 'patch' must be size 'state_manager_raw_maxsize(len)' or more.
+ * Returns the number of bytes actually written to 'patch'.
+ */
+size_t state_manager_raw_compress(const void *src,
+      const void *dst, size_t len, void *patch)
+{
+#ifdef STATE_MANAGER_AVX2
+   if (cpu_features_get() & RETRO_SIMD_AVX2)
+      return state_manager_raw_compress_scan(src, dst, len, patch,
+            find_change_avx2, find_same_avx2);
+#endif
+   return state_manager_raw_compress_scan(src, dst, len, patch,
+         find_change, find_same);
+}
+
 /*
  * Takes 'patch' from a previous call to 'state_manager_raw_compress'
  * and applies it to 'data' ('src' from that call),
@@ -409,11 +594,120 @@ static INLINE size_t read_size_t(const void *ptr)
    return ret;
 }
 
+/* Appends the patch turning 'newb' back into 'oldb' to the buffer. */
+static void state_manager_push_compress(state_manager_t *state,
+      const uint8_t *oldb, const uint8_t *newb)
+{
+   uint8_t *compressed;
+   size_t headpos, tailpos, remaining;
+   retro_time_t start = cpu_features_get_time_usec();
+
+recheckcapacity:;
+
+   headpos = state->head - state->data;
+   tailpos = state->tail - state->data;
+   remaining = (tailpos + state->capacity -
+         sizeof(size_t) - headpos - 1) % state->capacity + 1;
+
+   if (remaining <= state->maxcompsize)
+   {
+      state->tail = state->data + read_size_t(state->tail);
+      state->entries--;
+      goto recheckcapacity;
+   }
+
+   compressed  = state->head + sizeof(size_t);
+
+   compressed += state_manager_raw_compress(oldb, newb,
+         state->blocksize, compressed);
+
+   state->stat_bytes += compressed - state->head;
+
+   if (compressed - state->data + state->maxcompsize > state->capacity)
+   {
+      compressed = state->data;
+      if (state->tail == state->data + sizeof(size_t))
+         state->tail = state->data + read_size_t(state->tail);
+   }
+   write_size_t(compressed, state->head-state->data);
+   compressed += sizeof(size_t);
+   write_size_t(state->head, compressed-state->data);
+   state->head = compressed;
+
+   state->stat_frames++;
+   state->stat_usec += cpu_features_get_time_usec() - start;
+}
+
+#ifdef HAVE_THREADS
+static void state_manager_thread_loop(void *data)
+{
+   state_manager_t *state = (state_manager_t*)data;
+
+   slock_lock(state->lock);
+
+   for (;;)
+   {
+      while (!state->job_pending && !state->thread_quit)
+         scond_wait(state->cond, state->lock);
+
+      if (state->thread_quit)
+         break;
+
+      slock_unlock(state->lock);
+      state_manager_push_compress(state,
+            state->oldblock, state->thisblock);
+      state->entries++;
+      slock_lock(state->lock);
+
+      state->job_pending = false;
+      scond_signal(state->cond);
+   }
+
+   slock_unlock(state->lock);
+}
+
+/* Waits until the worker is done with the last pushed state. */
+static void state_manager_sync(state_manager_t *state)
+{
+   if (!state->thread)
+      return;
+
+   slock_lock(state->lock);
+   while (state->job_pending)
+      scond_wait(state->cond, state->lock);
+   slock_unlock(state->lock);
+}
+#else
+#define state_manager_sync(state) ((void)0)
+#endif
+
 static void state_manager_free(state_manager_t *state)
 {
    if (!state)
       return;
 
+#ifdef HAVE_THREADS
+   if (state->thread)
+   {
+      slock_lock(state->lock);
+      state->thread_quit = true;
+      scond_signal(state->cond);
+      slock_unlock(state->lock);
+
+      sthread_join(state->thread);
+   }
+   if (state->lock)
+      slock_free(state->lock);
+   if (state->cond)
+      scond_free(state->cond);
+   if (state->oldblock)
+      free(state->oldblock);
+   state->thread   = NULL;
+   state->lock     = NULL;
+   state->cond     = NULL;
+   state->oldblock = NULL;
+#endif
+
    if (state->data)
       free(state->data);
    if (state->thisblock)
@@ -430,7 +724,8 @@ static void state_manager_free(state_manager_t *state)
    state->nextblock  = NULL;
 }
 
-static state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
+static state_manager_t *state_manager_new(size_t state_size,
+      size_t buffer_size, bool threaded)
 {
    size_t max_comp_size, block_size;
    uint8_t *next_block    = NULL;
@@ -471,6 +766,29 @@ static state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
    state->debugblock  = (uint8_t*)malloc(state_size);
 #endif
 
+#ifdef HAVE_THREADS
+   if (threaded)
+   {
+      /* Compared against both other blocks, so it needs
+       * its own sentinel value. */
+      state->oldblock = (uint8_t*)state_manager_raw_alloc(state_size, 2);
+      state->lock     = slock_new();
+      state->cond     = scond_new();
+
+      if (state->oldblock && state->lock && state->cond)
+         state->thread = sthread_create(state_manager_thread_loop, state);
+
+      if (!state->thread)
+      {
+         state_manager_free(state);
+         free(state);
+         return NULL;
+      }
+   }
+#else
+   (void)threaded;
+#endif
+
    return state;
 
 error:
@@ -490,6 +808,8 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data = NULL;
 
+   state_manager_sync(state);
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid = false;
@@ -521,6 +841,8 @@ static void state_manager_push_where(state_manager_t *state, void **data)
     * pushed state, or we could end up applying a 'patch' to wrong
     * savestate, and that'd blow up rather quickly. */
 
+   state_manager_sync(state);
+
    if (!state->thisblock_valid)
    {
       const void *ignored;
@@ -547,43 +869,31 @@ static void state_manager_push_do(state_manager_t *state)
 
    if (state->thisblock_valid)
    {
-      const uint8_t *oldb, *newb;
-      uint8_t *compressed;
-      size_t headpos, tailpos, remaining;
       if (state->capacity < sizeof(size_t) + state->maxcompsize)
          return;
 
-recheckcapacity:;
-
-      headpos = state->head - state->data;
-      tailpos = state->tail - state->data;
-      remaining = (tailpos + state->capacity -
-            sizeof(size_t) - headpos - 1) % state->capacity + 1;
-
-      if (remaining <= state->maxcompsize)
+#ifdef HAVE_THREADS
+      if (state->thread)
       {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
-         goto recheckcapacity;
+         /* Hand the previous and new state to the worker, and give
+          * the buffer it released last time to the core. */
+         state_manager_sync(state);
+
+         swap             = state->oldblock;
+         state->oldblock  = state->thisblock;
+         state->thisblock = state->nextblock;
+         state->nextblock = swap;
+
+         slock_lock(state->lock);
+         state->job_pending = true;
+         scond_signal(state->cond);
+         slock_unlock(state->lock);
+         return;
       }
+#endif
 
-      oldb        = state->thisblock;
-      newb        = state->nextblock;
-      compressed  = state->head + sizeof(size_t);
-
-      compressed += state_manager_raw_compress(oldb, newb,
-            state->blocksize, compressed);
-
-      if (compressed - state->data + state->maxcompsize > state->capacity)
-      {
-         compressed = state->data;
-         if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
-      }
-      write_size_t(compressed, state->head-state->data);
-      compressed += sizeof(size_t);
-      write_size_t(state->head, compressed-state->data);
-      state->head = compressed;
+      state_manager_push_compress(state,
+            state->thisblock, state->nextblock);
    }
    else
       state->thisblock_valid = true;
@@ -613,7 +923,7 @@ static void state_manager_capacity(state_manager_t *state,
 }
 #endif
 
-void state_manager_event_init(unsigned rewind_buffer_size)
+void state_manager_event_init(unsigned rewind_buffer_size, bool threaded)
 {
    retro_ctx_serialize_info_t serial_info;
    retro_ctx_size_info_t info;
@@ -644,10 +954,13 @@ void state_manager_event_init(unsigned rewind_buffer_size)
          (unsigned)(rewind_buffer_size / 1000000));
 
    rewind_state.state = state_manager_new(rewind_state.size,
-         rewind_buffer_size);
+         rewind_buffer_size, threaded);
 
    if (!rewind_state.state)
+   {
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
+      return;
+   }
 
    state_manager_push_where(rewind_state.state, &state);
 
@@ -668,6 +981,18 @@ void state_manager_event_deinit(void)
 {
    if (rewind_state.state)
    {
+      state_manager_t *state = rewind_state.state;
+
+      state_manager_sync(state);
+
+      if (state->stat_frames && state->stat_usec)
+         RARCH_LOG("[Rewind]: %u frames of %u KB, %u bytes stored per frame, %.1f MB/s.\n",
+               (unsigned)state->stat_frames,
+               (unsigned)(state->blocksize / 1024),
+               (unsigned)(state->stat_bytes / state->stat_frames),
+               (double)state->blocksize * state->stat_frames
+               / state->stat_usec);
+
       state_manager_free(rewind_state.state);
       free(rewind_state.state);
    }
@@ -28,11 +28,21 @@ RETRO_BEGIN_DECLS
 
 typedef struct state_manager state_manager_t;
 
+/* Raw patch codec, also used to send savestate deltas over netplay.
+ * Buffers passed to state_manager_raw_compress must come from
+ * state_manager_raw_alloc, with the same 'len' and different 'uniq'. */
+size_t state_manager_raw_maxsize(size_t uncomp);
+
+void *state_manager_raw_alloc(size_t len, uint16_t uniq);
+
+size_t state_manager_raw_compress(const void *src,
+      const void *dst, size_t len, void *patch);
+
 bool state_manager_frame_is_reversed(void);
 
 void state_manager_event_deinit(void);
 
-void state_manager_event_init(unsigned rewind_buffer_size);
+void state_manager_event_init(unsigned rewind_buffer_size, bool threaded);
 
 /**
  * check_rewind:
@@ -378,6 +378,7 @@ default_sublabel_macro(action_bind_sublabel_core_input_remapping_options,
 default_sublabel_macro(action_bind_sublabel_core_options,                          MENU_ENUM_SUBLABEL_CORE_OPTIONS)
 default_sublabel_macro(action_bind_sublabel_show_advanced_settings,                MENU_ENUM_SUBLABEL_SHOW_ADVANCED_SETTINGS)
 default_sublabel_macro(action_bind_sublabel_threaded_data_runloop_enable,          MENU_ENUM_SUBLABEL_THREADED_DATA_RUNLOOP_ENABLE)
+default_sublabel_macro(action_bind_sublabel_task_queue_workers,                    MENU_ENUM_SUBLABEL_TASK_QUEUE_WORKERS)
 default_sublabel_macro(action_bind_sublabel_playlist_entry_rename,                 MENU_ENUM_SUBLABEL_PLAYLIST_ENTRY_RENAME)
 default_sublabel_macro(action_bind_sublabel_playlist_entry_remove,                 MENU_ENUM_SUBLABEL_PLAYLIST_ENTRY_REMOVE)
 default_sublabel_macro(action_bind_sublabel_system_directory,                      MENU_ENUM_SUBLABEL_SYSTEM_DIRECTORY)
@@ -1438,6 +1439,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_THREADED_DATA_RUNLOOP_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_threaded_data_runloop_enable);
             break;
+         case MENU_ENUM_LABEL_TASK_QUEUE_WORKERS:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_task_queue_workers);
+            break;
          case MENU_ENUM_LABEL_SHOW_ADVANCED_SETTINGS:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_show_advanced_settings);
             break;
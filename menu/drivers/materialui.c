@@ -183,6 +183,10 @@ typedef struct materialui_handle
    video_font_raster_block_t raster_block;
    video_font_raster_block_t raster_block2;
 
+   /* Icons of the menu list, kept like the raster blocks
+    * above and only re-recorded when an update is pending */
+   menu_display_batch_t list_batch;
+
 } materialui_handle_t;
 
 static const char *materialui_texture_path(unsigned id)
@@ -1418,6 +1422,10 @@ static void materialui_frame(void *data, video_frame_info_t *video_info)
    font_driver_bind_block(mui->font2, &mui->raster_block2);
 
    if (menu_display_get_update_pending())
+   {
+      menu_display_batch_reset(&mui->list_batch);
+      menu_display_batch_bind(&mui->list_batch);
+
       materialui_render_menu_list(
             video_info,
             mui,
@@ -1429,6 +1437,11 @@ static void materialui_frame(void *data, video_frame_info_t *video_info)
             sublabel_color
             );
 
+      menu_display_batch_bind(NULL);
+   }
+
+   menu_display_batch_draw(&mui->list_batch, video_info);
+
    font_driver_flush(video_info->width, video_info->height, mui->font,
          video_info);
    font_driver_bind_block(mui->font, NULL);
@@ -1707,6 +1720,7 @@ static void materialui_free(void *data)
 
    video_coord_array_free(&mui->raster_block.carr);
    video_coord_array_free(&mui->raster_block2.carr);
+   menu_display_batch_free(&mui->list_batch);
 
    font_driver_bind_block(NULL, NULL);
 }
@@ -1731,6 +1745,9 @@ static void materialui_context_destroy(void *data)
    for (i = 0; i < MUI_TEXTURE_LAST; i++)
       video_driver_texture_unload(&mui->textures.list[i]);
 
+   /* The recorded icons refer to the textures just freed */
+   menu_display_batch_reset(&mui->list_batch);
+
    menu_display_font_free(mui->font);
    menu_display_font_free(mui->font2);
 
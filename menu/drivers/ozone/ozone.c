@@ -177,6 +177,15 @@ static void *ozone_init(void **userdata, bool video_is_threaded)
    if (!ozone->thumbnail_path_data)
       goto error;
 
+   ozone->thumbnail_prefetch_path_data = menu_thumbnail_path_init();
+   if (!ozone->thumbnail_prefetch_path_data)
+      goto error;
+
+   ozone->thumbnail_cache = menu_thumbnail_cache_new(
+         settings->uints.menu_thumbnail_cache_size * 1024 * 1024);
+   if (!ozone->thumbnail_cache)
+      goto error;
+
    ozone_sidebar_update_collapse(ozone, false);
 
    ozone->system_tab_end                = 0;
@@ -356,6 +365,10 @@ static void ozone_free(void *data)
 
       if (ozone->thumbnail_path_data)
          free(ozone->thumbnail_path_data);
+      if (ozone->thumbnail_prefetch_path_data)
+         free(ozone->thumbnail_prefetch_path_data);
+
+      menu_thumbnail_cache_free(ozone->thumbnail_cache);
    }
 }
 
@@ -391,29 +404,121 @@ static void ozone_update_thumbnail_path(void *data, unsigned i, char pos)
 static void ozone_update_thumbnail_image(void *data)
 {
    ozone_handle_t *ozone            = (ozone_handle_t*)data;
+   settings_t *settings             = config_get_ptr();
    const char *right_thumbnail_path = NULL;
    const char *left_thumbnail_path  = NULL;
 
    if (!ozone)
       return;
 
+   menu_thumbnail_cache_begin(ozone->thumbnail_cache);
+
    if (menu_thumbnail_get_path(ozone->thumbnail_path_data, MENU_THUMBNAIL_RIGHT, &right_thumbnail_path))
    {
       if (filestream_exists(right_thumbnail_path))
-         task_push_image_load(right_thumbnail_path,
-               menu_display_handle_thumbnail_upload, NULL);
+      {
+         strlcpy(ozone->thumbnail_file_path, right_thumbnail_path,
+               sizeof(ozone->thumbnail_file_path));
+         menu_thumbnail_cache_request(ozone->thumbnail_cache,
+               right_thumbnail_path, false);
+      }
       else
-         video_driver_texture_unload(&ozone->thumbnail);
+         ozone->thumbnail_file_path[0] = '\0';
    }
 
    if (menu_thumbnail_get_path(ozone->thumbnail_path_data, MENU_THUMBNAIL_LEFT, &left_thumbnail_path))
    {
       if (filestream_exists(left_thumbnail_path))
-         task_push_image_load(left_thumbnail_path,
-               menu_display_handle_left_thumbnail_upload, NULL);
+      {
+         strlcpy(ozone->left_thumbnail_file_path, left_thumbnail_path,
+               sizeof(ozone->left_thumbnail_file_path));
+         menu_thumbnail_cache_request(ozone->thumbnail_cache,
+               left_thumbnail_path, false);
+      }
       else
-         video_driver_texture_unload(&ozone->left_thumbnail);
+         ozone->left_thumbnail_file_path[0] = '\0';
    }
+
+   /* Keep what is on screen until its replacement is in */
+   menu_thumbnail_cache_get(ozone->thumbnail_cache,
+         ozone->thumbnail_shown_path, NULL);
+   menu_thumbnail_cache_get(ozone->thumbnail_cache,
+         ozone->left_thumbnail_shown_path, NULL);
+
+   if (ozone->is_playlist)
+      menu_thumbnail_cache_prefetch_playlist(ozone->thumbnail_cache,
+            ozone->thumbnail_prefetch_path_data, playlist_get_cached(),
+            menu_navigation_get_selection(),
+            settings->uints.menu_thumbnail_prefetch);
+
+   menu_thumbnail_cache_end(ozone->thumbnail_cache);
+}
+
+/* Fits an image into the thumbnail bar, keeping its aspect ratio */
+static bool ozone_thumbnail_dimensions(ozone_handle_t *ozone,
+      unsigned image_width, unsigned image_height,
+      float *width, float *height)
+{
+   unsigned sidebar_height;
+   unsigned video_height;
+   unsigned maximum_height, maximum_width;
+   float display_aspect_ratio;
+
+   video_driver_get_size(NULL, &video_height);
+
+   sidebar_height = video_height - ozone->dimensions.header_height - 55 - ozone->dimensions.footer_height;
+   maximum_height = sidebar_height / 2;
+   maximum_width  = ozone->dimensions.thumbnail_bar_width - ozone->dimensions.sidebar_entry_icon_padding * 2;
+   if (maximum_height > 0)
+      display_aspect_ratio = (float)maximum_width / (float)maximum_height;
+   else
+      display_aspect_ratio = 0.0f;
+
+   if (image_width > 0 && image_height > 0 && display_aspect_ratio > 0.0001f)
+   {
+      float thumb_aspect_ratio = (float)image_width / (float)image_height;
+
+      if (thumb_aspect_ratio > display_aspect_ratio)
+      {
+         *width  = (float)maximum_width;
+         *height = (float)image_height * (float)maximum_width / (float)image_width;
+      }
+      else
+      {
+         *height = (float)maximum_height;
+         *width  = (float)image_width * (float)maximum_height / (float)image_height;
+      }
+
+      return true;
+   }
+
+   *width  = 0.0f;
+   *height = 0.0f;
+   return false;
+}
+
+static void ozone_resolve_thumbnail_textures(ozone_handle_t *ozone)
+{
+   menu_thumbnail_cache_image_t image;
+
+   ozone->thumbnail      = 0;
+   ozone->left_thumbnail = 0;
+
+   if (menu_thumbnail_cache_resolve(ozone->thumbnail_cache,
+            ozone->thumbnail_file_path, ozone->thumbnail_shown_path,
+            sizeof(ozone->thumbnail_shown_path), &image)
+         && ozone_thumbnail_dimensions(ozone, image.width, image.height,
+            &ozone->dimensions.thumbnail_width,
+            &ozone->dimensions.thumbnail_height))
+      ozone->thumbnail = image.texture;
+
+   if (menu_thumbnail_cache_resolve(ozone->thumbnail_cache,
+            ozone->left_thumbnail_file_path, ozone->left_thumbnail_shown_path,
+            sizeof(ozone->left_thumbnail_shown_path), &image)
+         && ozone_thumbnail_dimensions(ozone, image.width, image.height,
+            &ozone->dimensions.left_thumbnail_width,
+            &ozone->dimensions.left_thumbnail_height))
+      ozone->left_thumbnail = image.texture;
 }
 
 /* TODO: Scale text */
@@ -649,8 +754,9 @@ static void ozone_context_destroy(void *data)
       video_driver_texture_unload(&ozone->tab_textures[i]);
 
    /* Thumbnails */
-   video_driver_texture_unload(&ozone->thumbnail);
-   video_driver_texture_unload(&ozone->left_thumbnail);
+   menu_thumbnail_cache_clear(ozone->thumbnail_cache);
+   ozone->thumbnail      = 0;
+   ozone->left_thumbnail = 0;
 
    video_driver_texture_unload(&menu_display_white_texture);
 
@@ -957,6 +1063,8 @@ static void ozone_render(void *data, bool is_idle)
       menu_entries_ctl(MENU_ENTRIES_CTL_SET_START, &i);
    }
 
+   ozone_resolve_thumbnail_textures(ozone);
+
    menu_animation_ctl(MENU_ANIMATION_CTL_CLEAR_ACTIVE, NULL);
 }
 
@@ -1277,10 +1385,13 @@ static void ozone_unload_thumbnail_textures(void *data)
    if (!ozone)
       return;
 
-   if (ozone->thumbnail)
-      video_driver_texture_unload(&ozone->thumbnail);
-   if (ozone->left_thumbnail)
-      video_driver_texture_unload(&ozone->left_thumbnail);
+   /* The textures stay in the cache */
+   ozone->thumbnail                    = 0;
+   ozone->left_thumbnail               = 0;
+   ozone->thumbnail_file_path[0]       = '\0';
+   ozone->left_thumbnail_file_path[0]  = '\0';
+   ozone->thumbnail_shown_path[0]      = '\0';
+   ozone->left_thumbnail_shown_path[0] = '\0';
 }
 
 static void ozone_set_thumbnail_system(void *data, char*s, size_t len)
@@ -1290,6 +1401,7 @@ static void ozone_set_thumbnail_system(void *data, char*s, size_t len)
       return;
 
    menu_thumbnail_set_system(ozone->thumbnail_path_data, s);
+   menu_thumbnail_set_system(ozone->thumbnail_prefetch_path_data, s);
 }
 
 static void ozone_selection_changed(ozone_handle_t *ozone, bool allow_animation)
@@ -1468,6 +1580,8 @@ static void ozone_frame(void *data, video_frame_info_t *video_info)
    ozone->raster_blocks.entries_sublabel.carr.coords.vertices = 0;
    ozone->raster_blocks.sidebar.carr.coords.vertices = 0;
 
+   menu_display_batch_begin(video_info);
+
    /* Background */
    menu_display_draw_quad(video_info,
       0, 0, video_info->width, video_info->height,
@@ -1514,6 +1628,8 @@ static void ozone_frame(void *data, video_frame_info_t *video_info)
 
    menu_display_scissor_end(video_info);
 
+   menu_display_batch_end(video_info);
+
    /* Flush first layer of text */
    font_driver_flush(video_info->width, video_info->height, ozone->fonts.footer, video_info);
    font_driver_flush(video_info->width, video_info->height, ozone->fonts.title, video_info);
@@ -2181,93 +2297,11 @@ static int ozone_pointer_tap(void *userdata,
 static bool ozone_load_image(void *userdata, void *data, enum menu_image_type type)
 {
    ozone_handle_t *ozone = (ozone_handle_t*) userdata;
-   unsigned sidebar_height;
-   unsigned height;
-   unsigned maximum_height, maximum_width;
-   float display_aspect_ratio;
 
    if (!ozone || !data)
       return false;
 
-   video_driver_get_size(NULL, &height);
-
-   sidebar_height = height - ozone->dimensions.header_height - 55 - ozone->dimensions.footer_height;
-   maximum_height = sidebar_height / 2;
-   maximum_width  = ozone->dimensions.thumbnail_bar_width - ozone->dimensions.sidebar_entry_icon_padding * 2;
-   if (maximum_height > 0)
-      display_aspect_ratio = (float)maximum_width / (float)maximum_height;
-   else
-      display_aspect_ratio = 0.0f;
-
-   switch (type)
-   {
-      case MENU_IMAGE_THUMBNAIL:
-      {
-         struct texture_image *img = (struct texture_image*)data;
-
-         if (img->width > 0 && img->height > 0 && display_aspect_ratio > 0.0001f)
-         {
-            float thumb_aspect_ratio = (float)img->width / (float)img->height;
-
-            if (thumb_aspect_ratio > display_aspect_ratio)
-            {
-               ozone->dimensions.thumbnail_width = (float)maximum_width;
-               ozone->dimensions.thumbnail_height = (float)img->height * (float)maximum_width / (float)img->width;
-            }
-            else
-            {
-               ozone->dimensions.thumbnail_height = (float)maximum_height;
-               ozone->dimensions.thumbnail_width = (float)img->width * (float)maximum_height / (float)img->height;
-            }
-
-            video_driver_texture_unload(&ozone->thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &ozone->thumbnail);
-         }
-         else
-         {
-            ozone->dimensions.thumbnail_width = 0.0f;
-            ozone->dimensions.thumbnail_height = 0.0f;
-            video_driver_texture_unload(&ozone->thumbnail);
-         }
-
-         break;
-      }
-      case MENU_IMAGE_LEFT_THUMBNAIL:
-      {
-         struct texture_image *img = (struct texture_image*)data;
-
-         if (img->width > 0 && img->height > 0 && display_aspect_ratio > 0.0001f)
-         {
-            float thumb_aspect_ratio = (float)img->width / (float)img->height;
-
-            if (thumb_aspect_ratio > display_aspect_ratio)
-            {
-               ozone->dimensions.left_thumbnail_width = (float)maximum_width;
-               ozone->dimensions.left_thumbnail_height = (float)img->height * (float)maximum_width / (float)img->width;
-            }
-            else
-            {
-               ozone->dimensions.left_thumbnail_height = (float)maximum_height;
-               ozone->dimensions.left_thumbnail_width = (float)img->width * (float)maximum_height / (float)img->height;
-            }
-
-            video_driver_texture_unload(&ozone->left_thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &ozone->left_thumbnail);
-         }
-         else
-         {
-            ozone->dimensions.left_thumbnail_width = 0.0f;
-            ozone->dimensions.left_thumbnail_height = 0.0f;
-            video_driver_texture_unload(&ozone->left_thumbnail);
-         }
-
-         break;
-      }
-      default:
-         break;
-   }
+   /* Thumbnails are loaded through ozone->thumbnail_cache */
    return true;
 }
 
@@ -25,6 +25,7 @@ typedef struct ozone_handle ozone_handle_t;
 #include <retro_miscellaneous.h>
 
 #include "../../menu_thumbnail_path.h"
+#include "../../menu_thumbnail_cache.h"
 #include "../../menu_driver.h"
 
 #include "../../../retroarch.h"
@@ -235,6 +236,13 @@ struct ozone_handle
    uintptr_t left_thumbnail;
 
    menu_thumbnail_path_data_t *thumbnail_path_data;
+   menu_thumbnail_path_data_t *thumbnail_prefetch_path_data;
+   menu_thumbnail_cache_t *thumbnail_cache;
+
+   char thumbnail_file_path[PATH_MAX_LENGTH];
+   char left_thumbnail_file_path[PATH_MAX_LENGTH];
+   char thumbnail_shown_path[PATH_MAX_LENGTH];
+   char left_thumbnail_shown_path[PATH_MAX_LENGTH];
 
    char selection_core_name[255];
    char selection_playtime[255];
@@ -605,6 +605,7 @@ icons_iterate:
    }
 
    /* Text layer */
+   menu_display_batch_flush(video_info);
    font_driver_flush(video_info->width, video_info->height, ozone->fonts.entries_label, video_info);
    font_driver_flush(video_info->width, video_info->height, ozone->fonts.entries_sublabel, video_info);
 }
@@ -253,6 +253,7 @@ console_iterate:
       menu_display_blend_end(video_info);
    }
 
+   menu_display_batch_flush(video_info);
    font_driver_flush(video_info->width, video_info->height, ozone->fonts.sidebar, video_info);
    ozone->raster_blocks.sidebar.carr.coords.vertices = 0;
 
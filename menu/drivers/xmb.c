@@ -46,6 +46,7 @@
 #include "../menu_entries.h"
 #include "../menu_input.h"
 #include "../menu_thumbnail_path.h"
+#include "../menu_thumbnail_cache.h"
 
 #include "../../core_info.h"
 #include "../../core.h"
@@ -311,6 +312,10 @@ typedef struct xmb_handle
    char *box_message;
    char *savestate_thumbnail_file_path;
    char *bg_file_path;
+   char thumbnail_file_path[PATH_MAX_LENGTH];
+   char left_thumbnail_file_path[PATH_MAX_LENGTH];
+   char thumbnail_shown_path[PATH_MAX_LENGTH];
+   char left_thumbnail_shown_path[PATH_MAX_LENGTH];
 
    file_list_t *selection_buf_old;
    file_list_t *horizontal_list;
@@ -341,6 +346,8 @@ typedef struct xmb_handle
    video_font_raster_block_t raster_block2;
 
    menu_thumbnail_path_data_t *thumbnail_path_data;
+   menu_thumbnail_path_data_t *thumbnail_prefetch_path_data;
+   menu_thumbnail_cache_t *thumbnail_cache;
 } xmb_handle_t;
 
 float scale_mod[8] = {
@@ -1006,28 +1013,79 @@ static void xmb_update_savestate_thumbnail_path(void *data, unsigned i)
 static void xmb_update_thumbnail_image(void *data)
 {
    xmb_handle_t *xmb                = (xmb_handle_t*)data;
+   settings_t *settings             = config_get_ptr();
    const char *right_thumbnail_path = NULL;
    const char *left_thumbnail_path  = NULL;
 
    if (!xmb)
       return;
 
+   menu_thumbnail_cache_begin(xmb->thumbnail_cache);
+
    if (menu_thumbnail_get_path(xmb->thumbnail_path_data, MENU_THUMBNAIL_RIGHT, &right_thumbnail_path))
    {
       if (filestream_exists(right_thumbnail_path))
-         task_push_image_load(right_thumbnail_path,
-               menu_display_handle_thumbnail_upload, NULL);
+      {
+         strlcpy(xmb->thumbnail_file_path, right_thumbnail_path,
+               sizeof(xmb->thumbnail_file_path));
+         menu_thumbnail_cache_request(xmb->thumbnail_cache,
+               right_thumbnail_path, false);
+      }
       else
-         video_driver_texture_unload(&xmb->thumbnail);
+         xmb->thumbnail_file_path[0] = '\0';
    }
 
    if (menu_thumbnail_get_path(xmb->thumbnail_path_data, MENU_THUMBNAIL_LEFT, &left_thumbnail_path))
    {
       if (filestream_exists(left_thumbnail_path))
-         task_push_image_load(left_thumbnail_path,
-               menu_display_handle_left_thumbnail_upload, NULL);
+      {
+         strlcpy(xmb->left_thumbnail_file_path, left_thumbnail_path,
+               sizeof(xmb->left_thumbnail_file_path));
+         menu_thumbnail_cache_request(xmb->thumbnail_cache,
+               left_thumbnail_path, false);
+      }
       else
-         video_driver_texture_unload(&xmb->left_thumbnail);
+         xmb->left_thumbnail_file_path[0] = '\0';
+   }
+
+   /* Keep what is on screen until its replacement is in */
+   menu_thumbnail_cache_get(xmb->thumbnail_cache,
+         xmb->thumbnail_shown_path, NULL);
+   menu_thumbnail_cache_get(xmb->thumbnail_cache,
+         xmb->left_thumbnail_shown_path, NULL);
+
+   if (xmb->is_playlist)
+      menu_thumbnail_cache_prefetch_playlist(xmb->thumbnail_cache,
+            xmb->thumbnail_prefetch_path_data, playlist_get_cached(),
+            menu_navigation_get_selection(),
+            settings->uints.menu_thumbnail_prefetch);
+
+   menu_thumbnail_cache_end(xmb->thumbnail_cache);
+}
+
+static void xmb_resolve_thumbnail_textures(xmb_handle_t *xmb)
+{
+   menu_thumbnail_cache_image_t image;
+
+   xmb->thumbnail      = 0;
+   xmb->left_thumbnail = 0;
+
+   if (menu_thumbnail_cache_resolve(xmb->thumbnail_cache,
+            xmb->thumbnail_file_path, xmb->thumbnail_shown_path,
+            sizeof(xmb->thumbnail_shown_path), &image))
+   {
+      xmb->thumbnail        = image.texture;
+      xmb->thumbnail_height = xmb->thumbnail_width
+         * (float)image.height / (float)image.width;
+   }
+
+   if (menu_thumbnail_cache_resolve(xmb->thumbnail_cache,
+            xmb->left_thumbnail_file_path, xmb->left_thumbnail_shown_path,
+            sizeof(xmb->left_thumbnail_shown_path), &image))
+   {
+      xmb->left_thumbnail        = image.texture;
+      xmb->left_thumbnail_height = xmb->left_thumbnail_width
+         * (float)image.height / (float)image.width;
    }
 }
 
@@ -1038,6 +1096,7 @@ static void xmb_set_thumbnail_system(void *data, char*s, size_t len)
       return;
 
    menu_thumbnail_set_system(xmb->thumbnail_path_data, s);
+   menu_thumbnail_set_system(xmb->thumbnail_prefetch_path_data, s);
 }
 
 static void xmb_unload_thumbnail_textures(void *data)
@@ -1046,10 +1105,13 @@ static void xmb_unload_thumbnail_textures(void *data)
    if (!xmb)
       return;
 
-   if (xmb->thumbnail)
-      video_driver_texture_unload(&xmb->thumbnail);
-   if (xmb->left_thumbnail)
-      video_driver_texture_unload(&xmb->left_thumbnail);
+   /* The textures stay in the cache */
+   xmb->thumbnail                    = 0;
+   xmb->left_thumbnail               = 0;
+   xmb->thumbnail_file_path[0]       = '\0';
+   xmb->left_thumbnail_file_path[0]  = '\0';
+   xmb->thumbnail_shown_path[0]      = '\0';
+   xmb->left_thumbnail_shown_path[0] = '\0';
 }
 
 static void xmb_set_thumbnail_content(void *data, const char *s)
@@ -3070,6 +3132,8 @@ static void xmb_render(void *data, bool is_idle)
       menu_entries_ctl(MENU_ENTRIES_CTL_SET_START, &i);
    }
 
+   xmb_resolve_thumbnail_textures(xmb);
+
    menu_animation_ctl(MENU_ANIMATION_CTL_CLEAR_ACTIVE, NULL);
 }
 
@@ -3320,6 +3384,10 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
    rotate_draw.scale_enable = true;
 
    menu_display_rotate_z(&rotate_draw, video_info);
+
+   /* Thumbnails, tabs and list icons are collected and drawn
+    * together; their text is queued in the raster blocks. */
+   menu_display_batch_begin(video_info);
    menu_display_blend_begin(video_info);
 
    /* Save State thumbnail, right side */
@@ -3944,6 +4012,8 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
             width,
             height);
 
+   menu_display_batch_end(video_info);
+
    font_driver_flush(video_info->width, video_info->height, xmb->font,
          video_info);
    font_driver_bind_block(xmb->font, NULL);
@@ -4374,6 +4444,15 @@ static void *xmb_init(void **userdata, bool video_is_threaded)
    if (!xmb->thumbnail_path_data)
       goto error;
 
+   xmb->thumbnail_prefetch_path_data = menu_thumbnail_path_init();
+   if (!xmb->thumbnail_prefetch_path_data)
+      goto error;
+
+   xmb->thumbnail_cache = menu_thumbnail_cache_new(
+         settings->uints.menu_thumbnail_cache_size * 1024 * 1024);
+   if (!xmb->thumbnail_cache)
+      goto error;
+
    return menu;
 
 error:
@@ -4428,6 +4507,10 @@ static void xmb_free(void *data)
 
       if (xmb->thumbnail_path_data)
          free(xmb->thumbnail_path_data);
+      if (xmb->thumbnail_prefetch_path_data)
+         free(xmb->thumbnail_prefetch_path_data);
+
+      menu_thumbnail_cache_free(xmb->thumbnail_cache);
    }
 
    font_driver_bind_block(NULL, NULL);
@@ -4461,24 +4544,8 @@ static bool xmb_load_image(void *userdata, void *data, enum menu_image_type type
          menu_display_allocate_white_texture();
          break;
       case MENU_IMAGE_THUMBNAIL:
-         {
-            struct texture_image *img  = (struct texture_image*)data;
-            xmb->thumbnail_height      = xmb->thumbnail_width
-               * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&xmb->thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &xmb->thumbnail);
-         }
-         break;
       case MENU_IMAGE_LEFT_THUMBNAIL:
-         {
-            struct texture_image *img  = (struct texture_image*)data;
-            xmb->left_thumbnail_height      = xmb->left_thumbnail_width
-               * (float)img->height / (float)img->width;
-            video_driver_texture_unload(&xmb->left_thumbnail);
-            video_driver_texture_load(data,
-                  TEXTURE_FILTER_MIPMAP_LINEAR, &xmb->left_thumbnail);
-         }
+         /* Loaded through xmb->thumbnail_cache */
          break;
       case MENU_IMAGE_SAVESTATE_THUMBNAIL:
          {
@@ -5258,8 +5325,9 @@ static void xmb_context_destroy(void *data)
    for (i = 0; i < XMB_TEXTURE_LAST; i++)
       video_driver_texture_unload(&xmb->textures.list[i]);
 
-   video_driver_texture_unload(&xmb->thumbnail);
-   video_driver_texture_unload(&xmb->left_thumbnail);
+   menu_thumbnail_cache_clear(xmb->thumbnail_cache);
+   xmb->thumbnail      = 0;
+   xmb->left_thumbnail = 0;
    video_driver_texture_unload(&xmb->savestate_thumbnail);
 
    xmb_context_destroy_horizontal_list(xmb);
@@ -184,6 +184,11 @@ static bool menu_display_msg_force               = false;
 static bool menu_display_framebuf_dirty          = false;
 static menu_display_ctx_driver_t *menu_disp      = NULL;
 
+/* Blend state last requested through menu_display_blend_*() */
+static bool menu_display_blend_enabled           = false;
+static menu_display_batch_t menu_disp_batch;
+static menu_display_batch_t *menu_disp_batch_bound = NULL;
+
 /* when enabled, on next iteration the 'Quick Menu' list will
  * be pushed onto the stack */
 static bool menu_driver_pending_quick_menu      = false;
@@ -421,6 +426,7 @@ void menu_display_timedate(menu_display_ctx_datetime_t *datetime)
 /* Begin blending operation */
 void menu_display_blend_begin(video_frame_info_t *video_info)
 {
+   menu_display_blend_enabled = true;
    if (menu_disp && menu_disp->blend_begin)
       menu_disp->blend_begin(video_info);
 }
@@ -428,6 +434,7 @@ void menu_display_blend_begin(video_frame_info_t *video_info)
 /* End blending operation */
 void menu_display_blend_end(video_frame_info_t *video_info)
 {
+   menu_display_blend_enabled = false;
    if (menu_disp && menu_disp->blend_end)
       menu_disp->blend_end(video_info);
 }
@@ -435,6 +442,7 @@ void menu_display_blend_end(video_frame_info_t *video_info)
 /* Begin scissoring operation */
 void menu_display_scissor_begin(video_frame_info_t *video_info, int x, int y, unsigned width, unsigned height)
 {
+   menu_display_batch_flush(video_info);
    if (menu_disp && menu_disp->scissor_begin)
       menu_disp->scissor_begin(video_info, x, y, width, height);
 }
@@ -442,10 +450,458 @@ void menu_display_scissor_begin(video_frame_info_t *video_info, int x, int y, un
 /* End scissoring operation */
 void menu_display_scissor_end(video_frame_info_t *video_info)
 {
+   menu_display_batch_flush(video_info);
    if (menu_disp && menu_disp->scissor_end)
       menu_disp->scissor_end(video_info);
 }
 
+/* Quads are stored as two triangles so that any number of
+ * them can be drawn with one call. */
+#define MENU_DISPLAY_BATCH_QUAD_VERTICES 6
+
+/* How many runs back a quad may be moved to join one with the
+ * same state. Each step costs a bounding box test. */
+#define MENU_DISPLAY_BATCH_LOOKBACK      16
+
+struct menu_display_batch_quad
+{
+   float vertex[2 * MENU_DISPLAY_BATCH_QUAD_VERTICES];
+   float tex_coord[2 * MENU_DISPLAY_BATCH_QUAD_VERTICES];
+   float color[4 * MENU_DISPLAY_BATCH_QUAD_VERTICES];
+   size_t run;
+};
+
+struct menu_display_batch_run
+{
+   uintptr_t texture;
+   bool blend;
+   size_t count;
+   size_t first;
+   size_t filled;
+   /* Bounding box of every quad in the run */
+   float x0, y0, x1, y1;
+};
+
+static const float menu_display_batch_white[16] = {
+   1.0f, 1.0f, 1.0f, 1.0f,
+   1.0f, 1.0f, 1.0f, 1.0f,
+   1.0f, 1.0f, 1.0f, 1.0f,
+   1.0f, 1.0f, 1.0f, 1.0f,
+};
+
+static bool menu_display_batch_supported(void)
+{
+   if (!menu_disp || menu_disp->handles_transform)
+      return false;
+
+   /* These draw in the viewport set from the draw rectangle
+    * with a [0, 1] orthographic MVP, which lets quads from
+    * different draws be moved into one full screen draw. */
+   switch (menu_disp->type)
+   {
+      case MENU_VIDEO_DRIVER_OPENGL:
+      case MENU_VIDEO_DRIVER_OPENGL_CORE:
+      case MENU_VIDEO_DRIVER_VULKAN:
+         return true;
+      default:
+         break;
+   }
+
+   return false;
+}
+
+static bool menu_display_batch_is_affine(const math_matrix_4x4 *mat)
+{
+   return MAT_ELEM_4X4(*mat, 3, 0) == 0.0f
+      &&  MAT_ELEM_4X4(*mat, 3, 1) == 0.0f
+      &&  MAT_ELEM_4X4(*mat, 3, 3) == 1.0f;
+}
+
+static bool menu_display_batch_accepts(const menu_display_ctx_draw_t *draw,
+      video_frame_info_t *video_info)
+{
+   const math_matrix_4x4 *mat = NULL;
+   const math_matrix_4x4 *mvp = NULL;
+
+   if (  !draw->coords
+       || draw->coords->vertices != 4
+       || draw->prim_type != MENU_DISPLAY_PRIM_TRIANGLESTRIP
+       || draw->pipeline.id != 0
+       || !video_info->width
+       || !video_info->height)
+      return false;
+
+   if (!draw->matrix_data)
+      return true;
+
+   if (!menu_disp->get_default_mvp)
+      return false;
+
+   mat = (const math_matrix_4x4*)draw->matrix_data;
+   mvp = (const math_matrix_4x4*)menu_disp->get_default_mvp(video_info);
+
+   /* Rotation and scale are folded into the vertices, which
+    * takes 2D affine matrices and an invertible default MVP */
+   return mvp
+      && menu_display_batch_is_affine(mat)
+      && menu_display_batch_is_affine(mvp)
+      && MAT_ELEM_4X4(*mvp, 0, 0) * MAT_ELEM_4X4(*mvp, 1, 1)
+         != MAT_ELEM_4X4(*mvp, 0, 1) * MAT_ELEM_4X4(*mvp, 1, 0);
+}
+
+static bool menu_display_batch_reserve(void **ptr, size_t *capacity,
+      size_t count, size_t size)
+{
+   void *tmp;
+   size_t new_capacity;
+
+   if (count <= *capacity)
+      return true;
+
+   new_capacity = *capacity ? *capacity * 2 : 64;
+   while (new_capacity < count)
+      new_capacity *= 2;
+
+   tmp = realloc(*ptr, new_capacity * size);
+   if (!tmp)
+      return false;
+
+   *ptr      = tmp;
+   *capacity = new_capacity;
+   return true;
+}
+
+/* Converts a quad in draw rectangle space to full screen
+ * space and appends it to @batch. Returns false if it has to
+ * be drawn on its own. */
+static bool menu_display_batch_add(menu_display_batch_t *batch,
+      const menu_display_ctx_draw_t *draw,
+      video_frame_info_t *video_info)
+{
+   /* Triangle strip order to two triangles */
+   static const unsigned order[MENU_DISPLAY_BATCH_QUAD_VERTICES] = {
+      0, 1, 2, 2, 1, 3 };
+   unsigned i;
+   size_t j, last;
+   struct menu_display_batch_quad *quad = NULL;
+   struct menu_display_batch_run *run   = NULL;
+   const float *vertex    = draw->coords->vertex;
+   const float *tex_coord = draw->coords->tex_coord;
+   const float *color     = draw->coords->color;
+   float x                = draw->x / (float)video_info->width;
+   float y                = draw->y / (float)video_info->height;
+   float w                = draw->width  / (float)video_info->width;
+   float h                = draw->height / (float)video_info->height;
+   float x0               = 1.0f;
+   float y0               = 1.0f;
+   float x1               = 0.0f;
+   float y1               = 0.0f;
+   const math_matrix_4x4 *mat = (const math_matrix_4x4*)draw->matrix_data;
+   const math_matrix_4x4 *mvp = NULL;
+   float inv[4];
+
+   if (mat)
+   {
+      mvp = (const math_matrix_4x4*)menu_disp->get_default_mvp(video_info);
+
+      if (!memcmp(mat->data, mvp->data, sizeof(mat->data)))
+         mat = NULL;
+      else
+      {
+         float det = MAT_ELEM_4X4(*mvp, 0, 0) * MAT_ELEM_4X4(*mvp, 1, 1)
+            - MAT_ELEM_4X4(*mvp, 0, 1) * MAT_ELEM_4X4(*mvp, 1, 0);
+
+         inv[0] =  MAT_ELEM_4X4(*mvp, 1, 1) / det;
+         inv[1] = -MAT_ELEM_4X4(*mvp, 0, 1) / det;
+         inv[2] = -MAT_ELEM_4X4(*mvp, 1, 0) / det;
+         inv[3] =  MAT_ELEM_4X4(*mvp, 0, 0) / det;
+      }
+   }
+
+   if (!vertex)
+      vertex    = menu_disp->get_default_vertices();
+   if (!tex_coord)
+      tex_coord = menu_disp->get_default_tex_coords();
+   if (!color)
+      color     = menu_display_batch_white;
+
+   if (!vertex || !tex_coord)
+      return false;
+
+   if (!menu_display_batch_reserve((void**)&batch->quads,
+            &batch->quads_capacity, batch->quads_count + 1,
+            sizeof(*batch->quads)))
+      return false;
+
+   quad = &batch->quads[batch->quads_count];
+
+   for (i = 0; i < MENU_DISPLAY_BATCH_QUAD_VERTICES; i++)
+   {
+      unsigned v           = order[i];
+      float vx             = x + vertex[2 * v + 0] * w;
+      float vy             = y + vertex[2 * v + 1] * h;
+
+      if (mat)
+      {
+         /* Clip space of the quad's own draw... */
+         float cx = MAT_ELEM_4X4(*mat, 0, 0) * vertex[2 * v + 0]
+            + MAT_ELEM_4X4(*mat, 0, 1) * vertex[2 * v + 1]
+            + MAT_ELEM_4X4(*mat, 0, 3);
+         float cy = MAT_ELEM_4X4(*mat, 1, 0) * vertex[2 * v + 0]
+            + MAT_ELEM_4X4(*mat, 1, 1) * vertex[2 * v + 1]
+            + MAT_ELEM_4X4(*mat, 1, 3);
+
+         /* ...which clips to the draw rectangle. The slack
+          * covers rounding in quarter turns. */
+         if (     cx < -1.0001f || cx > 1.0001f
+               || cy < -1.0001f || cy > 1.0001f)
+            return false;
+
+         /* Full screen clip space, back through the default MVP */
+         cx = 2.0f * x - 1.0f + (cx + 1.0f) * w - MAT_ELEM_4X4(*mvp, 0, 3);
+         cy = 2.0f * y - 1.0f + (cy + 1.0f) * h - MAT_ELEM_4X4(*mvp, 1, 3);
+         vx = inv[0] * cx + inv[1] * cy;
+         vy = inv[2] * cx + inv[3] * cy;
+      }
+
+      quad->vertex[2 * i + 0]    = vx;
+      quad->vertex[2 * i + 1]    = vy;
+      quad->tex_coord[2 * i + 0] = tex_coord[2 * v + 0];
+      quad->tex_coord[2 * i + 1] = tex_coord[2 * v + 1];
+      memcpy(&quad->color[4 * i], &color[4 * v], 4 * sizeof(float));
+
+      x0 = MIN(x0, vx);
+      y0 = MIN(y0, vy);
+      x1 = MAX(x1, vx);
+      y1 = MAX(y1, vy);
+   }
+
+   /* Join the latest run with the same state, as long as
+    * no run drawn after it overlaps this quad. */
+   last = batch->runs_count;
+   for (j = batch->runs_count; j > 0 &&
+         batch->runs_count - j < MENU_DISPLAY_BATCH_LOOKBACK; j--)
+   {
+      struct menu_display_batch_run *r = &batch->runs[j - 1];
+
+      if (     r->texture == draw->texture
+            && r->blend   == menu_display_blend_enabled)
+      {
+         last = j - 1;
+         break;
+      }
+
+      if (x0 < r->x1 && r->x0 < x1 && y0 < r->y1 && r->y0 < y1)
+         break;
+   }
+
+   if (last == batch->runs_count)
+   {
+      if (!menu_display_batch_reserve((void**)&batch->runs,
+               &batch->runs_capacity, batch->runs_count + 1,
+               sizeof(*batch->runs)))
+         return false;
+
+      run          = &batch->runs[batch->runs_count++];
+      run->texture = draw->texture;
+      run->blend   = menu_display_blend_enabled;
+      run->count   = 0;
+      run->x0      = x0;
+      run->y0      = y0;
+      run->x1      = x1;
+      run->y1      = y1;
+   }
+   else
+   {
+      run          = &batch->runs[last];
+      run->x0      = MIN(run->x0, x0);
+      run->y0      = MIN(run->y0, y0);
+      run->x1      = MAX(run->x1, x1);
+      run->y1      = MAX(run->y1, y1);
+   }
+
+   run->count++;
+   quad->run     = last;
+   batch->quads_count++;
+   batch->merged = false;
+
+   return true;
+}
+
+/* Sorts the quads into one contiguous range per run. */
+static bool menu_display_batch_merge(menu_display_batch_t *batch)
+{
+   size_t i, first;
+   size_t vertices = batch->quads_count * MENU_DISPLAY_BATCH_QUAD_VERTICES;
+
+   if (batch->merged)
+      return true;
+
+   if (vertices > batch->merged_capacity)
+   {
+      size_t capacity = MAX(vertices, batch->merged_capacity * 2);
+      float *vertex   = (float*)realloc(batch->vertex,
+            capacity * 2 * sizeof(float));
+      float *tex_coord;
+      float *color;
+
+      if (vertex)
+         batch->vertex    = vertex;
+      tex_coord = (float*)realloc(batch->tex_coord,
+            capacity * 2 * sizeof(float));
+      if (tex_coord)
+         batch->tex_coord = tex_coord;
+      color     = (float*)realloc(batch->color,
+            capacity * 4 * sizeof(float));
+      if (color)
+         batch->color     = color;
+
+      if (!vertex || !tex_coord || !color)
+         return false;
+
+      batch->merged_capacity = capacity;
+   }
+
+   for (i = 0, first = 0; i < batch->runs_count; i++)
+   {
+      batch->runs[i].first  = first;
+      batch->runs[i].filled = 0;
+      first                += batch->runs[i].count;
+   }
+
+   for (i = 0; i < batch->quads_count; i++)
+   {
+      const struct menu_display_batch_quad *quad = &batch->quads[i];
+      struct menu_display_batch_run *run         = &batch->runs[quad->run];
+      size_t v = (run->first + run->filled++)
+         * MENU_DISPLAY_BATCH_QUAD_VERTICES;
+
+      memcpy(&batch->vertex[2 * v], quad->vertex, sizeof(quad->vertex));
+      memcpy(&batch->tex_coord[2 * v], quad->tex_coord,
+            sizeof(quad->tex_coord));
+      memcpy(&batch->color[4 * v], quad->color, sizeof(quad->color));
+   }
+
+   batch->merged = true;
+   return true;
+}
+
+void menu_display_batch_draw(menu_display_batch_t *batch,
+      video_frame_info_t *video_info)
+{
+   size_t i;
+   bool blend;
+
+   if (  !batch
+       || !batch->quads_count
+       || !menu_display_batch_supported()
+       || !menu_disp->draw
+       || !menu_display_batch_merge(batch))
+      return;
+
+   blend = menu_display_blend_enabled;
+
+   for (i = 0; i < batch->runs_count; i++)
+   {
+      menu_display_ctx_draw_t draw;
+      struct video_coords coords;
+      const struct menu_display_batch_run *run = &batch->runs[i];
+      size_t v = run->first * MENU_DISPLAY_BATCH_QUAD_VERTICES;
+
+      if (run->blend != blend)
+      {
+         if (run->blend && menu_disp->blend_begin)
+            menu_disp->blend_begin(video_info);
+         else if (!run->blend && menu_disp->blend_end)
+            menu_disp->blend_end(video_info);
+         blend = run->blend;
+      }
+
+      coords.vertices      = (unsigned)(run->count
+            * MENU_DISPLAY_BATCH_QUAD_VERTICES);
+      coords.vertex        = &batch->vertex[2 * v];
+      coords.tex_coord     = &batch->tex_coord[2 * v];
+      coords.lut_tex_coord = &batch->tex_coord[2 * v];
+      coords.color         = &batch->color[4 * v];
+
+      draw.x               = 0;
+      draw.y               = 0;
+      draw.width           = video_info->width;
+      draw.height          = video_info->height;
+      draw.coords          = &coords;
+      draw.matrix_data     = NULL;
+      draw.texture         = run->texture;
+      draw.prim_type       = MENU_DISPLAY_PRIM_TRIANGLES;
+      draw.pipeline.id     = 0;
+      draw.scale_factor    = 1.0f;
+      draw.rotation        = 0.0f;
+
+      menu_disp->draw(&draw, video_info);
+   }
+
+   /* Leave the blend state as the menu driver last set it */
+   if (blend != menu_display_blend_enabled)
+   {
+      if (menu_display_blend_enabled && menu_disp->blend_begin)
+         menu_disp->blend_begin(video_info);
+      else if (!menu_display_blend_enabled && menu_disp->blend_end)
+         menu_disp->blend_end(video_info);
+   }
+}
+
+void menu_display_batch_reset(menu_display_batch_t *batch)
+{
+   if (!batch)
+      return;
+
+   batch->quads_count = 0;
+   batch->runs_count  = 0;
+   batch->merged      = false;
+}
+
+void menu_display_batch_free(menu_display_batch_t *batch)
+{
+   if (!batch)
+      return;
+
+   if (menu_disp_batch_bound == batch)
+      menu_disp_batch_bound = NULL;
+
+   free(batch->quads);
+   free(batch->runs);
+   free(batch->vertex);
+   free(batch->tex_coord);
+   free(batch->color);
+   memset(batch, 0, sizeof(*batch));
+}
+
+void menu_display_batch_bind(menu_display_batch_t *batch)
+{
+   menu_disp_batch_bound = batch;
+}
+
+void menu_display_batch_flush(video_frame_info_t *video_info)
+{
+   if (!menu_disp_batch_bound || !menu_disp_batch_bound->quads_count)
+      return;
+
+   menu_display_batch_draw(menu_disp_batch_bound, video_info);
+   menu_display_batch_reset(menu_disp_batch_bound);
+}
+
+void menu_display_batch_begin(video_frame_info_t *video_info)
+{
+   menu_display_batch_flush(video_info);
+   menu_display_batch_reset(&menu_disp_batch);
+   menu_display_batch_bind(&menu_disp_batch);
+}
+
+void menu_display_batch_end(video_frame_info_t *video_info)
+{
+   menu_display_batch_flush(video_info);
+   menu_display_batch_bind(NULL);
+}
+
 /* Teardown; deinitializes and frees all
  * fonts associated to the menu driver */
 void menu_display_font_free(font_data_t *font)
@@ -712,6 +1168,7 @@ bool menu_display_restore_clear_color(void)
 void menu_display_clear_color(menu_display_ctx_clearcolor_t *color,
       video_frame_info_t *video_info)
 {
+   menu_display_batch_flush(video_info);
    if (menu_disp && menu_disp->clear_color)
       menu_disp->clear_color(color, video_info);
 }
@@ -726,12 +1183,24 @@ void menu_display_draw(menu_display_ctx_draw_t *draw,
    if (draw->height <= 0)
       draw->height = 1;
 
+   if (menu_disp_batch_bound)
+   {
+      if (     menu_display_batch_supported()
+            && menu_display_batch_accepts(draw, video_info)
+            && menu_display_batch_add(menu_disp_batch_bound,
+               draw, video_info))
+         return;
+
+      menu_display_batch_flush(video_info);
+   }
+
    menu_disp->draw(draw, video_info);
 }
 
 void menu_display_draw_pipeline(menu_display_ctx_draw_t *draw,
       video_frame_info_t *video_info)
 {
+   menu_display_batch_flush(video_info);
    if (menu_disp && draw && menu_disp->draw_pipeline)
       menu_disp->draw_pipeline(draw, video_info);
 }
@@ -804,8 +1273,7 @@ void menu_display_draw_quad(
    coords.lut_tex_coord = NULL;
    coords.color         = color;
 
-   if (menu_disp && menu_disp->blend_begin)
-      menu_disp->blend_begin(video_info);
+   menu_display_blend_begin(video_info);
 
    draw.x            = x;
    draw.y            = (int)height - y - (int)h;
@@ -821,8 +1289,7 @@ void menu_display_draw_quad(
 
    menu_display_draw(&draw, video_info);
 
-   if (menu_disp && menu_disp->blend_end)
-      menu_disp->blend_end(video_info);
+   menu_display_blend_end(video_info);
 }
 
 void menu_display_draw_polygon(
@@ -854,8 +1321,7 @@ void menu_display_draw_polygon(
    coords.lut_tex_coord = NULL;
    coords.color         = color;
 
-   if (menu_disp && menu_disp->blend_begin)
-      menu_disp->blend_begin(video_info);
+   menu_display_blend_begin(video_info);
 
    draw.x            = 0;
    draw.y            = 0;
@@ -871,8 +1337,7 @@ void menu_display_draw_polygon(
 
    menu_display_draw(&draw, video_info);
 
-   if (menu_disp && menu_disp->blend_end)
-      menu_disp->blend_end(video_info);
+   menu_display_blend_end(video_info);
 }
 
 void menu_display_draw_texture(
@@ -1355,8 +1820,7 @@ void menu_display_draw_cursor(
    coords.lut_tex_coord = NULL;
    coords.color         = (const float*)color;
 
-   if (menu_disp && menu_disp->blend_begin)
-      menu_disp->blend_begin(video_info);
+   menu_display_blend_begin(video_info);
 
    draw.x               = x - (cursor_size / 2);
    draw.y               = (int)height - y - (cursor_size / 2);
@@ -1370,8 +1834,7 @@ void menu_display_draw_cursor(
 
    menu_display_draw(&draw, video_info);
 
-   if (menu_disp && menu_disp->blend_end)
-      menu_disp->blend_end(video_info);
+   menu_display_blend_end(video_info);
 }
 
 static INLINE float menu_display_scalef(float val,
@@ -2338,6 +2801,7 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
             }
 
             video_coord_array_free(&menu_disp_ca);
+            menu_display_batch_free(&menu_disp_batch);
             menu_display_msg_force       = false;
             menu_display_header_height   = 0;
             menu_disp                    = NULL;
@@ -304,6 +304,28 @@ typedef struct menu_display_ctx_coord_draw
    const float *ptr;
 } menu_display_ctx_coord_draw_t;
 
+/* Textured quads recorded by menu_display_draw() while the
+ * batch is bound, drawn with one call per texture/blend run.
+ *
+ * The contents persist until menu_display_batch_reset(), so a
+ * menu driver can keep drawing the same batch every frame and
+ * only re-record it when something has changed - much like a
+ * font raster block. */
+typedef struct menu_display_batch
+{
+   struct menu_display_batch_quad *quads;
+   struct menu_display_batch_run *runs;
+   float *vertex;
+   float *tex_coord;
+   float *color;
+   size_t quads_count;
+   size_t quads_capacity;
+   size_t runs_count;
+   size_t runs_capacity;
+   size_t merged_capacity;
+   bool merged;
+} menu_display_batch_t;
+
 typedef struct menu_display_ctx_datetime
 {
    char *s;
@@ -545,6 +567,37 @@ void menu_display_blend_end(video_frame_info_t *video_info);
 void menu_display_scissor_begin(video_frame_info_t *video_info, int x, int y, unsigned width, unsigned height);
 void menu_display_scissor_end(video_frame_info_t *video_info);
 
+/**
+ * menu_display_batch_begin:
+ * @video_info      : frame info
+ *
+ * Starts batching quads drawn with menu_display_draw() into
+ * the display's own batch. Anything that cannot be batched
+ * (pipelines, scissor changes, other primitives) draws what
+ * has been collected so far first, so ordering is kept.
+ *
+ * Text drawn in between must go to a bound font raster block,
+ * and the batch must be flushed before that block is.
+ **/
+void menu_display_batch_begin(video_frame_info_t *video_info);
+
+/* Draws the collected quads and stops batching. */
+void menu_display_batch_end(video_frame_info_t *video_info);
+
+/* Draws and clears the quads collected so far. */
+void menu_display_batch_flush(video_frame_info_t *video_info);
+
+/* Records into @batch until unbound with NULL. */
+void menu_display_batch_bind(menu_display_batch_t *batch);
+
+void menu_display_batch_reset(menu_display_batch_t *batch);
+
+/* Draws everything recorded into @batch, leaving it intact. */
+void menu_display_batch_draw(menu_display_batch_t *batch,
+      video_frame_info_t *video_info);
+
+void menu_display_batch_free(menu_display_batch_t *batch);
+
 void menu_display_font_free(font_data_t *font);
 
 void menu_display_coords_array_reset(void);
@@ -8670,6 +8670,21 @@ static bool setting_append_list(
                general_read_handler,
                SD_FLAG_ADVANCED
                );
+
+         CONFIG_UINT(
+               list, list_info,
+               &settings->uints.task_queue_workers,
+               MENU_ENUM_LABEL_TASK_QUEUE_WORKERS,
+               MENU_ENUM_LABEL_VALUE_TASK_QUEUE_WORKERS,
+               task_queue_workers,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler);
+         (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+         menu_settings_list_current_add_range(list, list_info, 1, 8, 1, true, true);
+         settings_data_list_current_add_flags(list, list_info, SD_FLAG_ADVANCED);
 #endif
 
          END_SUB_GROUP(list, list_info, parent_group);
@@ -0,0 +1,640 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <compat/strl.h>
+#include <formats/image.h>
+#include <queues/task_queue.h>
+#include <rhash.h>
+#include <string/stdstring.h>
+
+#include "../gfx/video_driver.h"
+#include "../tasks/tasks_internal.h"
+
+#include "menu_thumbnail_cache.h"
+
+#define MENU_THUMBNAIL_CACHE_BUCKETS     256
+
+/* Image tasks in flight at once. Enough to keep the task
+ * queue workers busy without queueing up work that a fast
+ * scroll is about to cancel. */
+#define MENU_THUMBNAIL_CACHE_MAX_LOADS   4
+
+/* Paths that failed to load that are remembered */
+#define MENU_THUMBNAIL_CACHE_MAX_MISSING 1024
+
+typedef struct menu_thumbnail_cache_entry
+{
+   char *path;
+   uint32_t hash;
+   struct menu_thumbnail_cache_entry *next;
+   struct menu_thumbnail_cache_entry *lru_prev;
+   struct menu_thumbnail_cache_entry *lru_next;
+   uintptr_t texture;
+   unsigned width;
+   unsigned height;
+   size_t size;
+   /* Last request window that wanted this entry */
+   unsigned window;
+   bool missing;
+} menu_thumbnail_cache_entry_t;
+
+typedef struct menu_thumbnail_cache_load
+{
+   /* NULL once the cache has let go of this load */
+   menu_thumbnail_cache_t *cache;
+   char *path;
+   uint32_t hash;
+   /* NULL while queued */
+   void *task;
+   struct menu_thumbnail_cache_load *next;
+   unsigned window;
+   bool prefetch;
+   bool cancelled;
+} menu_thumbnail_cache_load_t;
+
+struct menu_thumbnail_cache
+{
+   menu_thumbnail_cache_entry_t *buckets[MENU_THUMBNAIL_CACHE_BUCKETS];
+   /* Most recently used first */
+   menu_thumbnail_cache_entry_t *lru_head;
+   menu_thumbnail_cache_entry_t *lru_tail;
+   /* Queued and in flight, in the order they will be started */
+   menu_thumbnail_cache_load_t *loads;
+   size_t budget;
+   size_t used;
+   unsigned missing;
+   unsigned in_flight;
+   unsigned window;
+};
+
+static menu_thumbnail_cache_entry_t *menu_thumbnail_cache_find(
+      menu_thumbnail_cache_t *cache, const char *path, uint32_t hash)
+{
+   menu_thumbnail_cache_entry_t *entry =
+      cache->buckets[hash % MENU_THUMBNAIL_CACHE_BUCKETS];
+
+   for (; entry; entry = entry->next)
+      if (entry->hash == hash && string_is_equal(entry->path, path))
+         return entry;
+
+   return NULL;
+}
+
+static void menu_thumbnail_cache_lru_unlink(menu_thumbnail_cache_t *cache,
+      menu_thumbnail_cache_entry_t *entry)
+{
+   if (entry->lru_prev)
+      entry->lru_prev->lru_next = entry->lru_next;
+   else
+      cache->lru_head           = entry->lru_next;
+
+   if (entry->lru_next)
+      entry->lru_next->lru_prev = entry->lru_prev;
+   else
+      cache->lru_tail           = entry->lru_prev;
+
+   entry->lru_prev = NULL;
+   entry->lru_next = NULL;
+}
+
+static void menu_thumbnail_cache_lru_push(menu_thumbnail_cache_t *cache,
+      menu_thumbnail_cache_entry_t *entry)
+{
+   entry->lru_prev = NULL;
+   entry->lru_next = cache->lru_head;
+
+   if (cache->lru_head)
+      cache->lru_head->lru_prev = entry;
+   else
+      cache->lru_tail           = entry;
+
+   cache->lru_head = entry;
+}
+
+static void menu_thumbnail_cache_touch(menu_thumbnail_cache_t *cache,
+      menu_thumbnail_cache_entry_t *entry)
+{
+   entry->window = cache->window;
+
+   if (cache->lru_head == entry)
+      return;
+
+   menu_thumbnail_cache_lru_unlink(cache, entry);
+   menu_thumbnail_cache_lru_push(cache, entry);
+}
+
+static void menu_thumbnail_cache_remove(menu_thumbnail_cache_t *cache,
+      menu_thumbnail_cache_entry_t *entry)
+{
+   menu_thumbnail_cache_entry_t **link =
+      &cache->buckets[entry->hash % MENU_THUMBNAIL_CACHE_BUCKETS];
+
+   while (*link != entry)
+      link = &(*link)->next;
+   *link = entry->next;
+
+   menu_thumbnail_cache_lru_unlink(cache, entry);
+
+   if (entry->missing)
+      cache->missing--;
+   else
+   {
+      cache->used -= entry->size;
+      video_driver_texture_unload(&entry->texture);
+   }
+
+   free(entry->path);
+   free(entry);
+}
+
+/* Makes room for @size bytes, oldest first. Entries wanted by
+ * the current request window stay, even over budget. */
+static void menu_thumbnail_cache_evict(menu_thumbnail_cache_t *cache,
+      size_t size)
+{
+   menu_thumbnail_cache_entry_t *entry = cache->lru_tail;
+
+   while (entry && cache->used + size > cache->budget)
+   {
+      menu_thumbnail_cache_entry_t *prev = entry->lru_prev;
+
+      if (!entry->missing && entry->window != cache->window)
+         menu_thumbnail_cache_remove(cache, entry);
+
+      entry = prev;
+   }
+
+   entry = cache->lru_tail;
+
+   while (entry && cache->missing >= MENU_THUMBNAIL_CACHE_MAX_MISSING)
+   {
+      menu_thumbnail_cache_entry_t *prev = entry->lru_prev;
+
+      if (entry->missing)
+         menu_thumbnail_cache_remove(cache, entry);
+
+      entry = prev;
+   }
+}
+
+/* Takes ownership of @path. A NULL or empty @img records
+ * @path as missing. */
+static void menu_thumbnail_cache_insert(menu_thumbnail_cache_t *cache,
+      char *path, uint32_t hash, unsigned window,
+      struct texture_image *img)
+{
+   menu_thumbnail_cache_entry_t *entry = NULL;
+   bool missing = !img || !img->pixels || !img->width || !img->height;
+   size_t size  = 0;
+
+   if (!path)
+      return;
+
+   entry = menu_thumbnail_cache_find(cache, path, hash);
+
+   if (entry)
+      menu_thumbnail_cache_remove(cache, entry);
+
+   /* Including the mipmap chain */
+   if (!missing)
+      size = (size_t)img->width * img->height * sizeof(uint32_t) * 4 / 3;
+
+   menu_thumbnail_cache_evict(cache, size);
+
+   entry = (menu_thumbnail_cache_entry_t*)calloc(1, sizeof(*entry));
+   if (!entry)
+   {
+      free(path);
+      return;
+   }
+
+   if (!missing)
+   {
+      if (!video_driver_texture_load(img,
+               TEXTURE_FILTER_MIPMAP_LINEAR, &entry->texture))
+         missing = true;
+   }
+
+   entry->path    = path;
+   entry->hash    = hash;
+   entry->window  = window;
+   entry->missing = missing;
+
+   if (missing)
+      cache->missing++;
+   else
+   {
+      entry->width  = img->width;
+      entry->height = img->height;
+      entry->size   = size;
+      cache->used  += size;
+   }
+
+   entry->next = cache->buckets[entry->hash % MENU_THUMBNAIL_CACHE_BUCKETS];
+   cache->buckets[entry->hash % MENU_THUMBNAIL_CACHE_BUCKETS] = entry;
+   menu_thumbnail_cache_lru_push(cache, entry);
+}
+
+static void menu_thumbnail_cache_unlink_load(menu_thumbnail_cache_t *cache,
+      menu_thumbnail_cache_load_t *load)
+{
+   menu_thumbnail_cache_load_t **link = &cache->loads;
+
+   while (*link && *link != load)
+      link = &(*link)->next;
+
+   if (*link)
+      *link = load->next;
+
+   load->next = NULL;
+}
+
+static void menu_thumbnail_cache_free_load(menu_thumbnail_cache_load_t *load)
+{
+   free(load->path);
+   free(load);
+}
+
+static void menu_thumbnail_cache_pump(menu_thumbnail_cache_t *cache);
+
+static void menu_thumbnail_cache_loaded(retro_task_t *task,
+      void *task_data, void *user_data, const char *err)
+{
+   struct texture_image *img         = (struct texture_image*)task_data;
+   menu_thumbnail_cache_load_t *load = (menu_thumbnail_cache_load_t*)user_data;
+   menu_thumbnail_cache_t *cache     = load ? load->cache : NULL;
+
+   if (cache)
+   {
+      menu_thumbnail_cache_unlink_load(cache, load);
+      cache->in_flight--;
+
+      /* A cancelled load says nothing about the file, but
+       * an image that made it is worth keeping */
+      if (!load->cancelled || (img && img->pixels))
+      {
+         menu_thumbnail_cache_insert(cache, load->path, load->hash,
+               load->window, img);
+         load->path = NULL;
+      }
+
+      menu_thumbnail_cache_pump(cache);
+   }
+
+   if (img)
+   {
+      image_texture_free(img);
+      free(img);
+   }
+
+   if (load)
+      menu_thumbnail_cache_free_load(load);
+}
+
+/* Starts queued loads, in order, while there is room. */
+static void menu_thumbnail_cache_pump(menu_thumbnail_cache_t *cache)
+{
+   menu_thumbnail_cache_load_t *load = cache->loads;
+
+   while (load && cache->in_flight < MENU_THUMBNAIL_CACHE_MAX_LOADS)
+   {
+      menu_thumbnail_cache_load_t *next = load->next;
+
+      if (!load->task)
+      {
+         load->task = task_push_image_load_priority(load->path,
+               load->prefetch ? TASK_PRIORITY_IO : TASK_PRIORITY_INTERACTIVE,
+               menu_thumbnail_cache_loaded, load);
+
+         if (load->task)
+            cache->in_flight++;
+         else
+         {
+            menu_thumbnail_cache_unlink_load(cache, load);
+            menu_thumbnail_cache_insert(cache, load->path, load->hash,
+                  load->window, NULL);
+            load->path = NULL;
+            menu_thumbnail_cache_free_load(load);
+         }
+      }
+
+      load = next;
+   }
+}
+
+menu_thumbnail_cache_t *menu_thumbnail_cache_new(size_t budget)
+{
+   menu_thumbnail_cache_t *cache = (menu_thumbnail_cache_t*)
+      calloc(1, sizeof(*cache));
+
+   if (!cache)
+      return NULL;
+
+   cache->budget = budget;
+   cache->window = 1;
+
+   return cache;
+}
+
+void menu_thumbnail_cache_clear(menu_thumbnail_cache_t *cache)
+{
+   menu_thumbnail_cache_load_t *load = NULL;
+
+   if (!cache)
+      return;
+
+   load = cache->loads;
+
+   while (load)
+   {
+      menu_thumbnail_cache_load_t *next = load->next;
+
+      if (load->task)
+      {
+         /* Frees itself when its callback runs */
+         load->cache     = NULL;
+         load->cancelled = true;
+         load->next      = NULL;
+         task_queue_cancel_task(load->task);
+      }
+      else
+         menu_thumbnail_cache_free_load(load);
+
+      load = next;
+   }
+
+   cache->loads     = NULL;
+   cache->in_flight = 0;
+
+   while (cache->lru_head)
+      menu_thumbnail_cache_remove(cache, cache->lru_head);
+}
+
+void menu_thumbnail_cache_free(menu_thumbnail_cache_t *cache)
+{
+   if (!cache)
+      return;
+
+   menu_thumbnail_cache_clear(cache);
+   free(cache);
+}
+
+bool menu_thumbnail_cache_get(menu_thumbnail_cache_t *cache,
+      const char *path, menu_thumbnail_cache_image_t *image)
+{
+   menu_thumbnail_cache_entry_t *entry = NULL;
+
+   if (!cache || string_is_empty(path))
+      return false;
+
+   entry = menu_thumbnail_cache_find(cache, path,
+         djb2_calculate(path));
+
+   if (!entry || entry->missing)
+      return false;
+
+   menu_thumbnail_cache_touch(cache, entry);
+
+   if (image)
+   {
+      image->texture = entry->texture;
+      image->width   = entry->width;
+      image->height  = entry->height;
+   }
+
+   return true;
+}
+
+static menu_thumbnail_cache_load_t *menu_thumbnail_cache_find_load(
+      menu_thumbnail_cache_t *cache, const char *path, uint32_t hash)
+{
+   menu_thumbnail_cache_load_t *load = cache->loads;
+
+   for (; load; load = load->next)
+      if (     !load->cancelled
+            && load->hash == hash
+            && string_is_equal(load->path, path))
+         return load;
+
+   return NULL;
+}
+
+bool menu_thumbnail_cache_pending(menu_thumbnail_cache_t *cache,
+      const char *path)
+{
+   if (!cache || string_is_empty(path))
+      return false;
+
+   return menu_thumbnail_cache_find_load(cache, path,
+         djb2_calculate(path)) != NULL;
+}
+
+bool menu_thumbnail_cache_resolve(menu_thumbnail_cache_t *cache,
+      const char *path, char *shown, size_t shown_size,
+      menu_thumbnail_cache_image_t *image)
+{
+   if (menu_thumbnail_cache_get(cache, path, image))
+   {
+      if (shown != path)
+         strlcpy(shown, path, shown_size);
+      return true;
+   }
+
+   if (     menu_thumbnail_cache_pending(cache, path)
+         && menu_thumbnail_cache_get(cache, shown, image))
+      return true;
+
+   shown[0] = '\0';
+   return false;
+}
+
+void menu_thumbnail_cache_begin(menu_thumbnail_cache_t *cache)
+{
+   if (!cache)
+      return;
+
+   /* Zero is never a current window */
+   if (++cache->window == 0)
+      cache->window = 1;
+}
+
+void menu_thumbnail_cache_request(menu_thumbnail_cache_t *cache,
+      const char *path, bool prefetch)
+{
+   uint32_t hash;
+   menu_thumbnail_cache_entry_t *entry = NULL;
+   menu_thumbnail_cache_load_t *load   = NULL;
+   menu_thumbnail_cache_load_t **link  = NULL;
+
+   if (!cache || string_is_empty(path))
+      return;
+
+   hash  = djb2_calculate(path);
+   entry = menu_thumbnail_cache_find(cache, path, hash);
+
+   if (entry)
+   {
+      /* The caller has seen the file, so it may be
+       * there now - e.g. thumbnails were just downloaded */
+      if (!(entry->missing && !prefetch))
+      {
+         menu_thumbnail_cache_touch(cache, entry);
+         return;
+      }
+
+      menu_thumbnail_cache_remove(cache, entry);
+   }
+
+   load = menu_thumbnail_cache_find_load(cache, path, hash);
+
+   if (load)
+   {
+      load->window = cache->window;
+
+      /* Already running */
+      if (load->task)
+         return;
+
+      menu_thumbnail_cache_unlink_load(cache, load);
+      load->prefetch = load->prefetch && prefetch;
+   }
+   else
+   {
+      load = (menu_thumbnail_cache_load_t*)calloc(1, sizeof(*load));
+      if (!load)
+         return;
+
+      load->cache    = cache;
+      load->path     = strdup(path);
+      load->hash     = hash;
+      load->window   = cache->window;
+      load->prefetch = prefetch;
+   }
+
+   /* On screen images go first, then prefetches in the
+    * order they were asked for */
+   link = &cache->loads;
+   if (load->prefetch)
+      while (*link)
+         link = &(*link)->next;
+   else
+      while (*link && !(*link)->prefetch)
+         link = &(*link)->next;
+
+   load->next = *link;
+   *link      = load;
+}
+
+void menu_thumbnail_cache_end(menu_thumbnail_cache_t *cache)
+{
+   menu_thumbnail_cache_load_t *load = NULL;
+
+   if (!cache)
+      return;
+
+   load = cache->loads;
+
+   /* Drop whatever is no longer wanted */
+   while (load)
+   {
+      menu_thumbnail_cache_load_t *next = load->next;
+
+      if (load->window != cache->window)
+      {
+         if (!load->task)
+         {
+            menu_thumbnail_cache_unlink_load(cache, load);
+            menu_thumbnail_cache_free_load(load);
+         }
+         else if (!load->cancelled)
+         {
+            load->cancelled = true;
+            task_queue_cancel_task(load->task);
+         }
+      }
+
+      load = next;
+   }
+
+   menu_thumbnail_cache_pump(cache);
+}
+
+static void menu_thumbnail_cache_prefetch_path(menu_thumbnail_cache_t *cache,
+      const char *path)
+{
+   uint32_t hash                       = djb2_calculate(path);
+   menu_thumbnail_cache_entry_t *entry = menu_thumbnail_cache_find(
+         cache, path, hash);
+
+   /* Most playlists have gaps. A missing file makes the
+    * load fail quietly on a worker, which records it as
+    * missing, rather than stat'ing it here on the menu thread */
+   if (entry)
+      menu_thumbnail_cache_touch(cache, entry);
+   else
+      menu_thumbnail_cache_request(cache, path, true);
+}
+
+static void menu_thumbnail_cache_prefetch_entry(menu_thumbnail_cache_t *cache,
+      menu_thumbnail_path_data_t *path_data, playlist_t *playlist,
+      size_t idx)
+{
+   const char *core_name = NULL;
+   const char *path      = NULL;
+   bool right_only       = false;
+
+   if (!menu_thumbnail_set_content_playlist(path_data, playlist, idx))
+      return;
+
+   /* imageviewer content is its own thumbnail, shown once */
+   menu_thumbnail_get_core_name(path_data, &core_name);
+   right_only = string_is_equal(core_name, "imageviewer")
+      && menu_thumbnail_is_enabled(MENU_THUMBNAIL_RIGHT);
+
+   if (     menu_thumbnail_update_path(path_data, MENU_THUMBNAIL_RIGHT)
+         && menu_thumbnail_get_path(path_data, MENU_THUMBNAIL_RIGHT, &path))
+      menu_thumbnail_cache_prefetch_path(cache, path);
+
+   if (     !right_only
+         && menu_thumbnail_update_path(path_data, MENU_THUMBNAIL_LEFT)
+         && menu_thumbnail_get_path(path_data, MENU_THUMBNAIL_LEFT, &path))
+      menu_thumbnail_cache_prefetch_path(cache, path);
+}
+
+void menu_thumbnail_cache_prefetch_playlist(menu_thumbnail_cache_t *cache,
+      menu_thumbnail_path_data_t *path_data, playlist_t *playlist,
+      size_t selection, unsigned radius)
+{
+   unsigned i;
+   size_t size;
+
+   if (!cache || !path_data || !playlist)
+      return;
+
+   size = playlist_get_size(playlist);
+
+   for (i = 1; i <= radius; i++)
+   {
+      if (selection + i < size)
+         menu_thumbnail_cache_prefetch_entry(cache, path_data, playlist,
+               selection + i);
+      if (selection >= i)
+         menu_thumbnail_cache_prefetch_entry(cache, path_data, playlist,
+               selection - i);
+   }
+}
@@ -0,0 +1,143 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __MENU_THUMBNAIL_CACHE_H
+#define __MENU_THUMBNAIL_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+#include "../playlist.h"
+
+#include "menu_thumbnail_path.h"
+
+RETRO_BEGIN_DECLS
+
+/* Thumbnail textures, keyed by image path.
+ *
+ * Uploaded textures are kept in LRU order within a memory
+ * budget; files that failed to load are remembered as well so
+ * they are not requested again. Loads run as image tasks on
+ * the task queue workers, a few at a time.
+ *
+ * Menu drivers open a request window with
+ * menu_thumbnail_cache_begin(), request what they want to see
+ * (nearest first), and close it with menu_thumbnail_cache_end(),
+ * which cancels whatever the previous window asked for and is
+ * no longer wanted. Entries requested in the current window are
+ * never evicted.
+ *
+ * The cache owns its textures: handles returned by
+ * menu_thumbnail_cache_get() are only valid until the next
+ * task queue update, so callers look them up again every frame. */
+
+typedef struct menu_thumbnail_cache menu_thumbnail_cache_t;
+
+typedef struct menu_thumbnail_cache_image
+{
+   uintptr_t texture;
+   unsigned width;
+   unsigned height;
+} menu_thumbnail_cache_image_t;
+
+/**
+ * menu_thumbnail_cache_new:
+ * @budget          : bytes of texture memory to keep around
+ *
+ * Returns: new cache, or NULL on failure.
+ **/
+menu_thumbnail_cache_t *menu_thumbnail_cache_new(size_t budget);
+
+/* Unloads all textures and detaches loads still in flight. */
+void menu_thumbnail_cache_free(menu_thumbnail_cache_t *cache);
+
+/* Forgets everything, e.g. when the video context goes away.
+ * Textures are unloaded and pending loads are cancelled. */
+void menu_thumbnail_cache_clear(menu_thumbnail_cache_t *cache);
+
+/**
+ * menu_thumbnail_cache_get:
+ * @cache           : cache handle
+ * @path            : image path
+ * @image           : output, texture and image size
+ *
+ * Looks up an uploaded thumbnail and marks it as recently used.
+ *
+ * Returns: true if @path is uploaded, false otherwise.
+ **/
+bool menu_thumbnail_cache_get(menu_thumbnail_cache_t *cache,
+      const char *path, menu_thumbnail_cache_image_t *image);
+
+/* Returns: true while @path is queued or loading, i.e. while
+ * it is worth keeping the previous thumbnail on screen. */
+bool menu_thumbnail_cache_pending(menu_thumbnail_cache_t *cache,
+      const char *path);
+
+/**
+ * menu_thumbnail_cache_resolve:
+ * @cache           : cache handle
+ * @path            : image the menu wants to show
+ * @shown           : image shown last time, updated
+ * @shown_size      : size of @shown
+ * @image           : output, texture and image size
+ *
+ * Picks the texture to draw for @path: its own once it is
+ * uploaded, the one in @shown while it is still loading, and
+ * nothing if it is missing. Call once per frame.
+ *
+ * Returns: true if there is something to draw.
+ **/
+bool menu_thumbnail_cache_resolve(menu_thumbnail_cache_t *cache,
+      const char *path, char *shown, size_t shown_size,
+      menu_thumbnail_cache_image_t *image);
+
+void menu_thumbnail_cache_begin(menu_thumbnail_cache_t *cache);
+
+/**
+ * menu_thumbnail_cache_request:
+ * @cache           : cache handle
+ * @path            : image path
+ * @prefetch        : false for an image that is on screen now,
+ *                    which is loaded first and retried even if
+ *                    it failed before
+ *
+ * Adds @path to the current request window.
+ **/
+void menu_thumbnail_cache_request(menu_thumbnail_cache_t *cache,
+      const char *path, bool prefetch);
+
+void menu_thumbnail_cache_end(menu_thumbnail_cache_t *cache);
+
+/**
+ * menu_thumbnail_cache_prefetch_playlist:
+ * @cache           : cache handle
+ * @path_data       : scratch path data with the system set
+ * @playlist        : playlist being browsed
+ * @selection       : selected entry
+ * @radius          : entries to prefetch on each side
+ *
+ * Requests the enabled thumbnails of the entries around
+ * @selection, nearest first.
+ **/
+void menu_thumbnail_cache_prefetch_playlist(menu_thumbnail_cache_t *cache,
+      menu_thumbnail_path_data_t *path_data, playlist_t *playlist,
+      size_t selection, unsigned radius);
+
+RETRO_END_DECLS
+
+#endif
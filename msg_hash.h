@@ -877,6 +877,7 @@ enum msg_hash_enums
    MENU_LABEL(NAVIGATION_WRAPAROUND),
    MENU_LABEL(SHOW_ADVANCED_SETTINGS),
    MENU_LABEL(THREADED_DATA_RUNLOOP_ENABLE),
+   MENU_LABEL(TASK_QUEUE_WORKERS),
    MENU_LABEL(XMB_ALPHA_FACTOR),
    MENU_LABEL(XMB_SCALE_FACTOR),
    MENU_LABEL(MENU_FONT_COLOR_RED),
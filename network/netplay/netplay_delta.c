@@ -16,6 +16,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include <boolean.h>
@@ -23,6 +24,8 @@
 
 #include "netplay_private.h"
 
+#include "../../managers/state_manager.h"
+
 static void clear_input(netplay_input_state_t istate)
 {
    while (istate)
@@ -120,6 +123,151 @@ void netplay_delta_frame_free(struct delta_frame *delta)
    }
 }
 
+/**
+ * netplay_savestate_delta_init
+ *
+ * Allocate the buffers used for delta encoded savestates.
+ */
+bool netplay_savestate_delta_init(netplay_t *netplay)
+{
+   if (netplay->delta_ref)
+      return true;
+
+   netplay->delta_patch_size = state_manager_raw_maxsize(netplay->state_size);
+   netplay->delta_ref        = (uint8_t*)state_manager_raw_alloc(
+         netplay->state_size, 0);
+   netplay->delta_scratch    = (uint8_t*)state_manager_raw_alloc(
+         netplay->state_size, 0xFFFF);
+   netplay->delta_patch      = (uint8_t*)malloc(netplay->delta_patch_size);
+   netplay->delta_ref_crc    = 0;
+
+   if (!netplay->delta_ref || !netplay->delta_scratch || !netplay->delta_patch)
+   {
+      netplay_savestate_delta_free(netplay);
+      return false;
+   }
+
+   return true;
+}
+
+/**
+ * netplay_savestate_delta_free
+ *
+ * Free the buffers used for delta encoded savestates.
+ */
+void netplay_savestate_delta_free(netplay_t *netplay)
+{
+   free(netplay->delta_ref);
+   free(netplay->delta_scratch);
+   free(netplay->delta_patch);
+   netplay->delta_ref        = NULL;
+   netplay->delta_scratch    = NULL;
+   netplay->delta_patch      = NULL;
+   netplay->delta_patch_size = 0;
+}
+
+/**
+ * netplay_savestate_delta_encode
+ *
+ * Encode a savestate as a patch against the reference state into
+ * netplay->delta_patch.
+ *
+ * Returns: The size of the patch.
+ */
+size_t netplay_savestate_delta_encode(netplay_t *netplay, const void *state)
+{
+   /* The scanner relies on the guard words state_manager_raw_alloc puts
+    * after the state, so the state has to be copied in first. The patch
+    * carries the words of its first argument. */
+   memcpy(netplay->delta_scratch, state, netplay->state_size);
+   return state_manager_raw_compress(netplay->delta_scratch,
+         netplay->delta_ref, netplay->state_size, netplay->delta_patch);
+}
+
+/**
+ * netplay_savestate_delta_decode
+ *
+ * Apply a patch to the reference state, leaving the result in
+ * netplay->delta_scratch.
+ *
+ * This is the state_manager patch format, but the patch comes from the
+ * network, so unlike the rewind decoder every run is bounds checked.
+ *
+ * Returns: False if the patch is malformed.
+ */
+bool netplay_savestate_delta_decode(netplay_t *netplay,
+      const uint8_t *patch, size_t patch_size)
+{
+   size_t out_pos        = 0;
+   size_t patch_pos      = 0;
+   size_t out_len        = (netplay->state_size + 1) / 2;
+   size_t patch_len      = patch_size / 2;
+   uint16_t *out16       = (uint16_t*)netplay->delta_scratch;
+   const uint16_t *in16  = (const uint16_t*)patch;
+
+   if ((uintptr_t)patch & 1)
+      return false;
+
+   memcpy(netplay->delta_scratch, netplay->delta_ref, netplay->state_size);
+
+   for (;;)
+   {
+      uint16_t numchanged;
+
+      if (patch_pos >= patch_len)
+         return false;
+
+      numchanged = in16[patch_pos++];
+
+      if (numchanged)
+      {
+         if (patch_pos + 1 + numchanged > patch_len)
+            return false;
+
+         out_pos += in16[patch_pos++];
+         if (out_pos + numchanged > out_len)
+            return false;
+
+         memcpy(&out16[out_pos], &in16[patch_pos],
+               numchanged * sizeof(uint16_t));
+         patch_pos += numchanged;
+         out_pos   += numchanged;
+      }
+      else
+      {
+         uint32_t numunchanged;
+
+         if (patch_pos + 2 > patch_len)
+            return false;
+
+         numunchanged = in16[patch_pos] | ((uint32_t)in16[patch_pos + 1] << 16);
+         patch_pos   += 2;
+
+         if (!numunchanged)
+            break;
+
+         out_pos += numunchanged;
+         if (out_pos > out_len)
+            return false;
+      }
+   }
+
+   return true;
+}
+
+/**
+ * netplay_savestate_delta_set_ref
+ *
+ * Make a state the reference for future delta encoded savestates.
+ */
+void netplay_savestate_delta_set_ref(netplay_t *netplay, const void *state,
+      uint32_t crc)
+{
+   if (state != netplay->delta_ref)
+      memcpy(netplay->delta_ref, state, netplay->state_size);
+   netplay->delta_ref_crc = crc;
+}
+
 /**
  * netplay_input_state_for
  *
@@ -22,6 +22,7 @@
 
 #include <boolean.h>
 #include <compat/strl.h>
+#include <encodings/crc32.h>
 #include <retro_assert.h>
 #include <string/stdstring.h>
 #include <net/net_http.h>
@@ -44,6 +45,7 @@
 #include "../../paths.h"
 #include "../../command.h"
 #include "../../dynamic.h"
+#include "../../performance_counters.h"
 #include "../../retroarch.h"
 
 /* Only used before init_netplay */
@@ -1183,56 +1185,121 @@ static void netplay_force_future(netplay_t *netplay)
    }
 }
 
+/**
+ * netplay_compress_savestate
+ * @netplay              : pointer to netplay object
+ * @data                 : data to compress
+ * @size                 : size of the data
+ * @z                    : compression backend to use
+ * @wn                   : receives the compressed size
+ *
+ * Compress a savestate or savestate patch into the zbuffer.
+ */
+static bool netplay_compress_savestate(netplay_t *netplay,
+   const uint8_t *data, size_t size, struct compression_transcoder *z,
+   uint32_t *wn)
+{
+   uint32_t rd;
+
+   z->compression_backend->set_in(z->compression_stream,
+      data, (uint32_t)size);
+   z->compression_backend->set_out(z->compression_stream,
+      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+   return z->compression_backend->trans(z->compression_stream, true, &rd,
+         wn, NULL);
+}
+
 /**
  * netplay_send_savestate
  * @netplay              : pointer to netplay object
  * @serial_info          : the savestate being loaded
  * @cx                   : compression type
  * @z                    : compression backend to use
+ * @crc                  : CRC of the savestate, if delta encoding is possible
  *
  * Send a loaded savestate to those connected peers using the given compression
- * scheme.
+ * scheme. Peers supporting delta encoding which hold the reference state get
+ * a patch against it, the rest get the full state.
  */
 void netplay_send_savestate(netplay_t *netplay,
    retro_ctx_serialize_info_t *serial_info, uint32_t cx,
-   struct compression_transcoder *z)
+   struct compression_transcoder *z, uint32_t crc)
 {
-   uint32_t header[4];
-   uint32_t rd, wn;
+   uint32_t header[7];
+   uint32_t wn;
    size_t i;
+   int pass;
+   bool can_delta = netplay->delta_ref &&
+      serial_info->size == netplay->state_size;
 
-   /* Compress it */
-   z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
-   z->compression_backend->set_out(z->compression_stream,
-      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
-   if (!z->compression_backend->trans(z->compression_stream, true, &rd,
-         &wn, NULL))
+   /* First the patch, then the full state, both through the zbuffer */
+   for (pass = can_delta ? NETPLAY_SAVESTATE_DELTA : NETPLAY_SAVESTATE_FULL;
+         pass >= NETPLAY_SAVESTATE_FULL; pass--)
    {
-      /* Catastrophe! */
+      bool compressed = false;
+
       for (i = 0; i < netplay->connections_size; i++)
-         netplay_hangup(netplay, &netplay->connections[i]);
-      return;
-   }
+      {
+         struct netplay_connection *connection = &netplay->connections[i];
+         bool delta_peer = !!(connection->compression_supported &
+               NETPLAY_COMPRESSION_DELTA);
+         size_t header_size;
+
+         if (!connection->active ||
+             connection->mode < NETPLAY_CONNECTION_CONNECTED ||
+             (connection->compression_supported & NETPLAY_COMPRESSION_ZLIB)
+               != cx)
+            continue;
+
+         if ((pass == NETPLAY_SAVESTATE_DELTA) !=
+               (delta_peer && connection->delta_ref_valid && can_delta))
+            continue;
+
+         if (!compressed)
+         {
+            bool okay;
+
+            if (pass == NETPLAY_SAVESTATE_DELTA)
+               okay = netplay_compress_savestate(netplay,
+                     netplay->delta_patch,
+                     netplay_savestate_delta_encode(netplay,
+                        serial_info->data_const), z, &wn);
+            else
+               okay = netplay_compress_savestate(netplay,
+                     (const uint8_t*)serial_info->data_const,
+                     serial_info->size, z, &wn);
+
+            if (!okay)
+            {
+               /* Catastrophe! */
+               for (i = 0; i < netplay->connections_size; i++)
+                  netplay_hangup(netplay, &netplay->connections[i]);
+               return;
+            }
+            compressed = true;
+         }
 
-   /* Send it to relevant peers */
-   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
-   header[1] = htonl(wn + 2*sizeof(uint32_t));
-   header[2] = htonl(netplay->run_frame_count);
-   header[3] = htonl(serial_info->size);
+         header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+         header[2] = htonl(netplay->run_frame_count);
+         header[3] = htonl(serial_info->size);
+         header_size = 4 * sizeof(uint32_t);
 
-   for (i = 0; i < netplay->connections_size; i++)
-   {
-      struct netplay_connection *connection = &netplay->connections[i];
-      if (!connection->active ||
-          connection->mode < NETPLAY_CONNECTION_CONNECTED ||
-          connection->compression_supported != cx) continue;
+         if (delta_peer)
+         {
+            header[4] = htonl(pass);
+            header[5] = htonl(netplay->delta_ref_crc);
+            header[6] = htonl(crc);
+            header_size = sizeof(header);
+         }
 
-      if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
-            sizeof(header)) ||
-          !netplay_send(&connection->send_packet_buffer, connection->fd,
-            netplay->zbuffer, wn))
-         netplay_hangup(netplay, connection);
+         header[1] = htonl(wn + header_size - 2*sizeof(uint32_t));
+
+         if (!netplay_send(&connection->send_packet_buffer, connection->fd,
+               header, header_size) ||
+             !netplay_send(&connection->send_packet_buffer, connection->fd,
+               netplay->zbuffer, wn))
+            netplay_hangup(netplay, connection);
+      }
    }
 }
 
@@ -1250,6 +1317,7 @@ void netplay_load_savestate(netplay_t *netplay,
       retro_ctx_serialize_info_t *serial_info, bool save)
 {
    retro_ctx_serialize_info_t tmp_serial_info;
+   uint32_t crc = 0;
 
    netplay_force_future(netplay);
 
@@ -1295,11 +1363,30 @@ void netplay_load_savestate(netplay_t *netplay,
       return;
 
    /* Send this to every peer */
+   if (netplay->delta_ref && serial_info->size == netplay->state_size)
+      crc = encoding_crc32(0L, (const unsigned char*)serial_info->data_const,
+            serial_info->size);
    if (netplay->compress_nil.compression_backend)
-      netplay_send_savestate(netplay, serial_info, 0, &netplay->compress_nil);
+      netplay_send_savestate(netplay, serial_info, 0, &netplay->compress_nil,
+         crc);
    if (netplay->compress_zlib.compression_backend)
       netplay_send_savestate(netplay, serial_info, NETPLAY_COMPRESSION_ZLIB,
-         &netplay->compress_zlib);
+         &netplay->compress_zlib, crc);
+
+   /* Every peer we just sent it to now holds this state */
+   if (netplay->delta_ref && serial_info->size == netplay->state_size)
+   {
+      size_t i;
+
+      netplay_savestate_delta_set_ref(netplay, serial_info->data_const, crc);
+      for (i = 0; i < netplay->connections_size; i++)
+      {
+         struct netplay_connection *connection = &netplay->connections[i];
+         connection->delta_ref_valid = connection->active &&
+            connection->mode >= NETPLAY_CONNECTION_CONNECTED &&
+            (connection->compression_supported & NETPLAY_COMPRESSION_DELTA);
+      }
+   }
 }
 
 /**
@@ -1619,10 +1706,14 @@ bool netplay_driver_ctl(enum rarch_netplay_ctl_state state, void *data)
          ret = netplay_data->is_connected;
          goto done;
       case RARCH_NETPLAY_CTL_POST_FRAME:
+         PERF_TRACE_BEGIN("netplay_post_frame");
          netplay_post_frame(netplay_data);
+         PERF_TRACE_END("netplay_post_frame");
          break;
       case RARCH_NETPLAY_CTL_PRE_FRAME:
+         PERF_TRACE_BEGIN("netplay_pre_frame");
          ret = netplay_pre_frame(netplay_data);
+         PERF_TRACE_END("netplay_pre_frame");
          goto done;
       case RARCH_NETPLAY_CTL_GAME_WATCH:
          netplay_toggle_play_spectate(netplay_data);
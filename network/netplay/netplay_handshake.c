@@ -197,6 +197,19 @@ static uint32_t simple_rand_uint32(void)
             parts[2]);
 }
 
+/**
+ * netplay_compression_supported
+ *
+ * The compression flags we can handle. Delta encoded savestates need
+ * the delta buffers, which may have failed to allocate.
+ */
+static uint32_t netplay_compression_supported(netplay_t *netplay)
+{
+   if (netplay->state_size && !netplay->delta_ref)
+      return NETPLAY_COMPRESSION_SUPPORTED & ~NETPLAY_COMPRESSION_DELTA;
+   return NETPLAY_COMPRESSION_SUPPORTED;
+}
+
 /**
  * netplay_handshake_init_send
  *
@@ -210,7 +223,7 @@ bool netplay_handshake_init_send(netplay_t *netplay,
 
    header[0] = htonl(netplay_magic);
    header[1] = htonl(netplay_platform_magic());
-   header[2] = htonl(NETPLAY_COMPRESSION_SUPPORTED);
+   header[2] = htonl(netplay_compression_supported(netplay));
    header[3] = 0;
    header[4] = htonl(NETPLAY_PROTOCOL_VERSION);
    header[5] = htonl(netplay_impl_magic());
@@ -374,7 +387,7 @@ bool netplay_handshake_init(netplay_t *netplay,
 
    /* Check what compression is supported */
    compression  = ntohl(header[2]);
-   compression &= NETPLAY_COMPRESSION_SUPPORTED;
+   compression &= netplay_compression_supported(netplay);
 
    if (compression & NETPLAY_COMPRESSION_ZLIB)
    {
@@ -399,6 +412,12 @@ bool netplay_handshake_init(netplay_t *netplay,
       connection->compression_supported = 0;
    }
 
+   /* Patches are in native byte order */
+   if ((compression & NETPLAY_COMPRESSION_DELTA) &&
+       !netplay_endian_mismatch(local_pmagic, remote_pmagic))
+      connection->compression_supported |= NETPLAY_COMPRESSION_DELTA;
+   connection->delta_ref_valid = false;
+
    if (!ctrans->decompression_backend)
       ctrans->decompression_backend = ctrans->compression_backend->reverse;
 
@@ -305,6 +305,11 @@ bool netplay_init_serialization(netplay_t *netplay)
       return false;
    }
 
+   /* Without the delta buffers, savestates are simply sent in full */
+   if (!netplay_savestate_delta_init(netplay))
+      RARCH_WARN("Could not allocate savestate delta buffers, "
+            "sending full savestates.\n");
+
    return true;
 }
 
@@ -561,6 +566,8 @@ void netplay_free(netplay_t *netplay)
    if (netplay->zbuffer)
       free(netplay->zbuffer);
 
+   netplay_savestate_delta_free(netplay);
+
    if (netplay->compress_nil.compression_stream)
    {
       netplay->compress_nil.compression_backend->stream_free(netplay->compress_nil.compression_stream);
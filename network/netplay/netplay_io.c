@@ -21,6 +21,7 @@
 
 #include <boolean.h>
 #include <compat/strl.h>
+#include <encodings/crc32.h>
 
 #include "netplay_private.h"
 
@@ -461,18 +462,19 @@ bool netplay_cmd_crc(netplay_t *netplay, struct delta_frame *delta)
 /**
  * netplay_cmd_request_savestate
  *
- * Send a savestate request command.
+ * Send a savestate request command to the given connection.
  */
-bool netplay_cmd_request_savestate(netplay_t *netplay)
+bool netplay_cmd_request_savestate(netplay_t *netplay,
+   struct netplay_connection *connection)
 {
-   if (netplay->connections_size == 0 ||
-       !netplay->connections[0].active ||
-       netplay->connections[0].mode < NETPLAY_CONNECTION_CONNECTED)
+   if (!connection ||
+       !connection->active ||
+       connection->mode < NETPLAY_CONNECTION_CONNECTED)
       return false;
    if (netplay->savestate_request_outstanding)
       return true;
    netplay->savestate_request_outstanding = true;
-   return netplay_send_raw_cmd(netplay, &netplay->connections[0],
+   return netplay_send_raw_cmd(netplay, connection,
       NETPLAY_CMD_REQUEST_SAVESTATE, NULL, 0);
 }
 
@@ -1543,7 +1545,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
                if (buffer[1] != local_crc)
                {
                   /* Problem! */
-                  netplay_cmd_request_savestate(netplay);
+                  netplay_cmd_request_savestate(netplay, connection);
                }
             }
             else
@@ -1557,7 +1559,9 @@ static bool netplay_get_cmd(netplay_t *netplay,
 
       case NETPLAY_CMD_REQUEST_SAVESTATE:
          /* Delay until next frame so we don't send the savestate after the
-          * input */
+          * input. The peer may be asking because a patch didn't apply, so
+          * send it the full state. */
+         connection->delta_ref_valid   = false;
          netplay->force_send_savestate = true;
          break;
 
@@ -1567,6 +1571,8 @@ static bool netplay_get_cmd(netplay_t *netplay,
             uint32_t frame;
             uint32_t isize;
             uint32_t rd, wn;
+            uint32_t delta_header[3];
+            size_t header_size = 2*sizeof(uint32_t);
             uint32_t client;
             uint32_t load_frame_count;
             size_t load_ptr;
@@ -1619,8 +1625,10 @@ static bool netplay_get_cmd(netplay_t *netplay,
              * too many places. */
 
             /* Check the payload size */
+            if (connection->compression_supported & NETPLAY_COMPRESSION_DELTA)
+               header_size += sizeof(delta_header);
             if ((cmd == NETPLAY_CMD_LOAD_SAVESTATE &&
-                 (cmd_size < 2*sizeof(uint32_t) || cmd_size > netplay->zbuffer_size + 2*sizeof(uint32_t))) ||
+                 (cmd_size < header_size || cmd_size > netplay->zbuffer_size + header_size)) ||
                 (cmd == NETPLAY_CMD_RESET && cmd_size != sizeof(uint32_t)))
             {
                RARCH_ERR("CMD_LOAD_SAVESTATE received an unexpected payload size.\n");
@@ -1673,14 +1681,28 @@ static bool netplay_get_cmd(netplay_t *netplay,
                   return netplay_cmd_nak(netplay, connection);
                }
 
-               RECV(netplay->zbuffer, cmd_size - 2*sizeof(uint32_t))
+               if (connection->compression_supported & NETPLAY_COMPRESSION_DELTA)
+               {
+                  RECV(delta_header, sizeof(delta_header))
+                  {
+                     RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive savestate encoding.\n");
+                     return netplay_cmd_nak(netplay, connection);
+                  }
+                  delta_header[0] = ntohl(delta_header[0]);
+                  delta_header[1] = ntohl(delta_header[1]);
+                  delta_header[2] = ntohl(delta_header[2]);
+               }
+               else
+                  delta_header[0] = NETPLAY_SAVESTATE_FULL;
+
+               RECV(netplay->zbuffer, cmd_size - header_size)
                {
                   RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive savestate.\n");
                   return netplay_cmd_nak(netplay, connection);
                }
 
                /* And decompress it */
-               switch (connection->compression_supported)
+               switch (connection->compression_supported & NETPLAY_COMPRESSION_ZLIB)
                {
                   case NETPLAY_COMPRESSION_ZLIB:
                      ctrans = &netplay->compress_zlib;
@@ -1688,13 +1710,65 @@ static bool netplay_get_cmd(netplay_t *netplay,
                   default:
                      ctrans = &netplay->compress_nil;
                }
-               ctrans->decompression_backend->set_in(ctrans->decompression_stream,
-                  netplay->zbuffer, cmd_size - 2*sizeof(uint32_t));
-               ctrans->decompression_backend->set_out(ctrans->decompression_stream,
-                  (uint8_t*)netplay->buffer[load_ptr].state,
-                  (unsigned)netplay->state_size);
-               ctrans->decompression_backend->trans(ctrans->decompression_stream,
-                  true, &rd, &wn, NULL);
+
+               if (delta_header[0] == NETPLAY_SAVESTATE_DELTA)
+               {
+                  bool okay = false;
+
+                  /* A patch is only usable against the very state it was
+                   * made from; otherwise, ask for the full state and carry
+                   * on desynced until it arrives */
+                  if (netplay->delta_ref && connection->delta_ref_valid &&
+                        delta_header[1] == netplay->delta_ref_crc)
+                  {
+                     ctrans->decompression_backend->set_in(ctrans->decompression_stream,
+                        netplay->zbuffer, (uint32_t)(cmd_size - header_size));
+                     ctrans->decompression_backend->set_out(ctrans->decompression_stream,
+                        netplay->delta_patch, (uint32_t)netplay->delta_patch_size);
+                     ctrans->decompression_backend->trans(ctrans->decompression_stream,
+                        true, &rd, &wn, NULL);
+
+                     okay = netplay_savestate_delta_decode(netplay,
+                           netplay->delta_patch, wn) &&
+                        encoding_crc32(0L, netplay->delta_scratch,
+                              netplay->state_size) == delta_header[2];
+                  }
+
+                  if (!okay)
+                  {
+                     RARCH_WARN("CMD_LOAD_SAVESTATE could not apply savestate patch, requesting the full state.\n");
+                     connection->delta_ref_valid = false;
+                     netplay->savestate_request_outstanding = false;
+                     netplay_cmd_request_savestate(netplay, connection);
+                     break;
+                  }
+
+                  memcpy(netplay->buffer[load_ptr].state,
+                     netplay->delta_scratch, netplay->state_size);
+               }
+               else
+               {
+                  ctrans->decompression_backend->set_in(ctrans->decompression_stream,
+                     netplay->zbuffer, (uint32_t)(cmd_size - header_size));
+                  ctrans->decompression_backend->set_out(ctrans->decompression_stream,
+                     (uint8_t*)netplay->buffer[load_ptr].state,
+                     (unsigned)netplay->state_size);
+                  ctrans->decompression_backend->trans(ctrans->decompression_stream,
+                     true, &rd, &wn, NULL);
+               }
+
+               /* This is now the state both of us hold */
+               if (netplay->delta_ref &&
+                     (connection->compression_supported & NETPLAY_COMPRESSION_DELTA))
+               {
+                  size_t i;
+
+                  netplay_savestate_delta_set_ref(netplay,
+                        netplay->buffer[load_ptr].state, delta_header[2]);
+                  for (i = 0; i < netplay->connections_size; i++)
+                     netplay->connections[i].delta_ref_valid = false;
+                  connection->delta_ref_valid = true;
+               }
 
                /* Force a rewind to the relevant frame */
                netplay->force_rewind = true;
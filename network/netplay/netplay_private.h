@@ -89,12 +89,22 @@ typedef uint32_t client_bitmap_t;
 
 /* Compression protocols supported */
 #define NETPLAY_COMPRESSION_ZLIB (1<<0)
+/* Savestates may be sent as a patch against the last state both sides
+ * hold. Combines with the other compression flags. */
+#define NETPLAY_COMPRESSION_DELTA (1<<1)
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_SUPPORTED (NETPLAY_COMPRESSION_ZLIB | NETPLAY_COMPRESSION_DELTA)
 #else
-#define NETPLAY_COMPRESSION_SUPPORTED 0
+#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_DELTA
 #endif
 
+/* Savestate encodings, for peers supporting NETPLAY_COMPRESSION_DELTA */
+enum netplay_savestate_encoding
+{
+   NETPLAY_SAVESTATE_FULL = 0,
+   NETPLAY_SAVESTATE_DELTA
+};
+
 enum netplay_cmd
 {
    /* Basic commands */
@@ -359,6 +369,9 @@ struct netplay_connection
    /* What compression does this peer support? */
    uint32_t compression_supported;
 
+   /* Does this peer hold our delta reference savestate? */
+   bool delta_ref_valid;
+
    /* Is this player paused? */
    bool paused;
 
@@ -459,6 +472,15 @@ struct netplay
    uint8_t *zbuffer;
    size_t zbuffer_size;
 
+   /* The last savestate sent or received, which delta encoded savestates
+    * are relative to, a scratch state and a patch buffer. The states are
+    * allocated with state_manager_raw_alloc. */
+   uint8_t *delta_ref;
+   uint8_t *delta_scratch;
+   uint8_t *delta_patch;
+   size_t delta_patch_size;
+   uint32_t delta_ref_crc;
+
    /* The size of our packet buffers */
    size_t packet_buffer_size;
 
@@ -668,6 +690,49 @@ uint32_t netplay_delta_frame_crc(netplay_t *netplay, struct delta_frame *delta);
  */
 void netplay_delta_frame_free(struct delta_frame *delta);
 
+/**
+ * netplay_savestate_delta_init
+ *
+ * Allocate the buffers used for delta encoded savestates.
+ */
+bool netplay_savestate_delta_init(netplay_t *netplay);
+
+/**
+ * netplay_savestate_delta_free
+ *
+ * Free the buffers used for delta encoded savestates.
+ */
+void netplay_savestate_delta_free(netplay_t *netplay);
+
+/**
+ * netplay_savestate_delta_encode
+ *
+ * Encode a savestate as a patch against the reference state into
+ * netplay->delta_patch.
+ *
+ * Returns: The size of the patch.
+ */
+size_t netplay_savestate_delta_encode(netplay_t *netplay, const void *state);
+
+/**
+ * netplay_savestate_delta_decode
+ *
+ * Apply a patch to the reference state, leaving the result in
+ * netplay->delta_scratch.
+ *
+ * Returns: False if the patch is malformed.
+ */
+bool netplay_savestate_delta_decode(netplay_t *netplay,
+      const uint8_t *patch, size_t patch_size);
+
+/**
+ * netplay_savestate_delta_set_ref
+ *
+ * Make a state the reference for future delta encoded savestates.
+ */
+void netplay_savestate_delta_set_ref(netplay_t *netplay, const void *state,
+      uint32_t crc);
+
 /**
  * netplay_input_state_for
  *
@@ -858,9 +923,10 @@ bool netplay_cmd_crc(netplay_t *netplay, struct delta_frame *delta);
 /**
  * netplay_cmd_request_savestate
  *
- * Send a savestate request command.
+ * Send a savestate request command to the given connection.
  */
-bool netplay_cmd_request_savestate(netplay_t *netplay);
+bool netplay_cmd_request_savestate(netplay_t *netplay,
+   struct netplay_connection *connection);
 
 /**
  * netplay_cmd_mode
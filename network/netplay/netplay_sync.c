@@ -527,8 +527,9 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
                /* Just report */
                RARCH_ERR("Netplay CRCs mismatch!\n");
             }
-            else
-               netplay_cmd_request_savestate(netplay);
+            else if (netplay->connections_size)
+               netplay_cmd_request_savestate(netplay,
+                     &netplay->connections[0]);
          }
       }
       else if (!netplay->crc_validity_checked)
@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef _WIN32
@@ -24,6 +25,13 @@
 #endif
 
 #include <compat/strl.h>
+#include <retro_atomic.h>
+#include <retro_miscellaneous.h>
+#include <streams/file_stream.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "performance_counters.h"
 
@@ -36,6 +44,52 @@
 #define PERF_LOG_FMT "[PERF]: Avg (%s): %llu ticks, %llu runs.\n"
 #endif
 
+/* Distinct threads named in a trace dump */
+#define PERF_TRACE_MAX_THREADS 32
+
+typedef struct perf_trace_slot
+{
+   const char *name;
+   retro_time_t time;
+   uintptr_t thread;
+   /* event index + 1 once the slot is fully written,
+    * 0 while a writer is filling it in */
+   retro_atomic_size_t seq;
+   bool begin;
+} perf_trace_slot_t;
+
+bool perf_trace_enabled = false;
+
+static perf_trace_slot_t *perf_trace_ring = NULL;
+/* Wraps around rather than overflowing; only the low bits
+ * pick the slot */
+static retro_atomic_size_t perf_trace_head = 0;
+static uintptr_t perf_trace_main_thread   = 0;
+
+/* Histogram buckets: values below PERF_METRICS_LINEAR get a
+ * bucket each, then every power of two is split into
+ * 1 << PERF_METRICS_SUB_BITS buckets up to 2^32. */
+#define PERF_METRICS_LINEAR   64
+#define PERF_METRICS_SUB_BITS 5
+#define PERF_METRICS_BUCKETS  (PERF_METRICS_LINEAR + (32 - 6) * (1 << PERF_METRICS_SUB_BITS))
+
+typedef struct perf_metric
+{
+   uint64_t count;
+   uint32_t samples[PERF_METRICS_WINDOW];
+   uint16_t buckets[PERF_METRICS_BUCKETS];
+} perf_metric_t;
+
+static perf_metric_t perf_metrics[PERF_METRIC_LAST];
+static retro_time_t perf_metrics_poll_time = 0;
+
+static const char *perf_metrics_names[PERF_METRIC_LAST] = {
+   "frame_time_us",
+   "core_run_us",
+   "audio_fill_pct",
+   "latency_us"
+};
+
 static struct retro_perf_counter *perf_counters_rarch[MAX_COUNTERS];
 static struct retro_perf_counter *perf_counters_libretro[MAX_COUNTERS];
 static unsigned perf_ptr_rarch;
@@ -120,6 +174,300 @@ void retro_perf_log(void)
    log_counters(perf_counters_libretro, perf_ptr_libretro);
 }
 
+static uintptr_t perf_trace_thread_id(void)
+{
+#ifdef HAVE_THREADS
+   return sthread_get_current_thread_id();
+#else
+   return 0;
+#endif
+}
+
+#define PERF_TRACE_SLOT(idx) \
+   (&perf_trace_ring[(idx) & (size_t)(PERF_TRACE_MAX_EVENTS - 1)])
+
+/* Each slot is a seqlock: the fences keep the plain name/time/
+ * thread accesses between the two sequence accesses, on the
+ * writer and on the reader side. */
+#ifdef RETRO_ATOMIC_LOCK_FREE
+#define perf_trace_seq_load(p)      retro_atomic_size_load(p)
+#define perf_trace_seq_store(p, v)  retro_atomic_size_store(p, v)
+#define perf_trace_head_next()      retro_atomic_size_fetch_add(&perf_trace_head, 1)
+#define perf_trace_fence_acquire()  retro_atomic_fence_acquire()
+#define perf_trace_fence_release()  retro_atomic_fence_release()
+#else
+/* Only one thread records reliably without atomics */
+#define perf_trace_seq_load(p)      (*(p))
+#define perf_trace_seq_store(p, v)  (*(p) = (v))
+#define perf_trace_head_next()      (perf_trace_head++)
+#define perf_trace_fence_acquire()  ((void)0)
+#define perf_trace_fence_release()  ((void)0)
+#endif
+
+bool perf_trace_set_enabled(bool enable)
+{
+   if (enable && !perf_trace_ring)
+   {
+      perf_trace_ring = (perf_trace_slot_t*)
+         calloc(PERF_TRACE_MAX_EVENTS, sizeof(*perf_trace_ring));
+      if (!perf_trace_ring)
+         return false;
+      perf_trace_main_thread = perf_trace_thread_id();
+   }
+
+   perf_trace_enabled = enable;
+   return true;
+}
+
+void perf_trace_event(const char *name, bool begin)
+{
+   size_t idx;
+   perf_trace_slot_t *slot;
+   retro_time_t time = cpu_features_get_time_usec();
+
+   if (!perf_trace_ring)
+      return;
+
+   idx  = perf_trace_head_next();
+   slot = PERF_TRACE_SLOT(idx);
+
+   perf_trace_seq_store(&slot->seq, 0);
+   /* No reader may see the new fields with the old sequence */
+   perf_trace_fence_release();
+   slot->name   = name;
+   slot->time   = time;
+   slot->thread = perf_trace_thread_id();
+   slot->begin  = begin;
+   perf_trace_seq_store(&slot->seq, idx + 1);
+}
+
+bool perf_trace_dump(const char *path)
+{
+   size_t i;
+   size_t head;
+   size_t count;
+   unsigned num_threads = 0;
+   bool first           = true;
+   uintptr_t threads[PERF_TRACE_MAX_THREADS];
+   RFILE *file          = NULL;
+
+   if (!perf_trace_ring)
+      return false;
+
+   file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!file)
+      return false;
+
+   /* Writers keep going while we dump. Slots they are
+    * filling in or have already reused for newer events
+    * fail the sequence check and are skipped. */
+   head  = perf_trace_seq_load(&perf_trace_head);
+   count = head < PERF_TRACE_MAX_EVENTS ? head : PERF_TRACE_MAX_EVENTS;
+
+   threads[num_threads++] = perf_trace_main_thread;
+
+   filestream_printf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+   for (i = 0; i < count; i++)
+   {
+      unsigned tid;
+      perf_trace_slot_t slot;
+      size_t idx               = head - count + i;
+      perf_trace_slot_t *entry = PERF_TRACE_SLOT(idx);
+
+      if (perf_trace_seq_load(&entry->seq) != idx + 1)
+         continue;
+      slot.name   = entry->name;
+      slot.time   = entry->time;
+      slot.thread = entry->thread;
+      slot.begin  = entry->begin;
+      /* The copy must be done before the sequence is checked again */
+      perf_trace_fence_acquire();
+      if (perf_trace_seq_load(&entry->seq) != idx + 1)
+         continue;
+
+      for (tid = 0; tid < num_threads; tid++)
+         if (threads[tid] == slot.thread)
+            break;
+      if (tid == num_threads)
+      {
+         if (num_threads == PERF_TRACE_MAX_THREADS)
+            continue;
+         threads[num_threads++] = slot.thread;
+      }
+
+      filestream_printf(file,
+            "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,\"pid\":1,\"tid\":%u}",
+            first ? "" : ",\n",
+            slot.name, slot.begin ? 'B' : 'E',
+            (long long)slot.time, tid + 1);
+      first = false;
+   }
+
+   for (i = 0; i < num_threads; i++)
+   {
+      char name[32];
+
+      if (i == 0)
+         strlcpy(name, "main", sizeof(name));
+      else
+         snprintf(name, sizeof(name), "thread %u", (unsigned)i);
+
+      filestream_printf(file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+            "\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n", (unsigned)i + 1, name);
+      first = false;
+   }
+
+   filestream_printf(file, "\n]}\n");
+
+   return filestream_close(file) == 0;
+}
+
+void perf_trace_deinit(void)
+{
+   perf_trace_enabled = false;
+
+   if (perf_trace_ring)
+      free(perf_trace_ring);
+   perf_trace_ring = NULL;
+   perf_trace_seq_store(&perf_trace_head, 0);
+}
+
+static unsigned perf_metrics_bucket(uint32_t value)
+{
+   unsigned e = 6;
+
+   if (value < PERF_METRICS_LINEAR)
+      return value;
+
+   /* e = floor(log2(value)) */
+   while (e < 31 && (value >> (e + 1)))
+      e++;
+
+   return PERF_METRICS_LINEAR + ((e - 6) << PERF_METRICS_SUB_BITS)
+      + ((value >> (e - PERF_METRICS_SUB_BITS))
+            & ((1 << PERF_METRICS_SUB_BITS) - 1));
+}
+
+/* Middle of the value range covered by a bucket */
+static uint32_t perf_metrics_bucket_value(unsigned bucket)
+{
+   unsigned e, m;
+
+   if (bucket < PERF_METRICS_LINEAR)
+      return bucket;
+
+   e = 6 + ((bucket - PERF_METRICS_LINEAR) >> PERF_METRICS_SUB_BITS);
+   m = (bucket - PERF_METRICS_LINEAR) & ((1 << PERF_METRICS_SUB_BITS) - 1);
+
+   return (((1 << PERF_METRICS_SUB_BITS) + m) << (e - PERF_METRICS_SUB_BITS))
+      + ((1u << (e - PERF_METRICS_SUB_BITS)) >> 1);
+}
+
+void perf_metrics_record(enum perf_metric_type type, uint32_t value)
+{
+   perf_metric_t *metric = &perf_metrics[type];
+   unsigned idx          = (unsigned)(metric->count
+         & (PERF_METRICS_WINDOW - 1));
+
+   if (metric->count >= PERF_METRICS_WINDOW)
+      metric->buckets[perf_metrics_bucket(metric->samples[idx])]--;
+
+   metric->samples[idx] = value;
+   metric->buckets[perf_metrics_bucket(value)]++;
+   metric->count++;
+}
+
+void perf_metrics_input_polled(void)
+{
+   perf_metrics_poll_time = cpu_features_get_time_usec();
+}
+
+void perf_metrics_frame_submitted(void)
+{
+   retro_time_t now;
+
+   /* Frames with no input poll since the previous one
+    * (menu, pause) say nothing about input latency. */
+   if (!perf_metrics_poll_time)
+      return;
+
+   now                    = cpu_features_get_time_usec();
+   perf_metrics_record(PERF_METRIC_LATENCY,
+         (uint32_t)(now - perf_metrics_poll_time));
+   perf_metrics_poll_time = 0;
+}
+
+const char *perf_metrics_name(enum perf_metric_type type)
+{
+   if (type >= PERF_METRIC_LAST)
+      return "unknown";
+   return perf_metrics_names[type];
+}
+
+bool perf_metrics_get(enum perf_metric_type type,
+      perf_metric_stats_t *stats)
+{
+   unsigned i, n, rank50, rank95, rank99;
+   unsigned seen          = 0;
+   const perf_metric_t *metric;
+
+   if (type >= PERF_METRIC_LAST || !stats)
+      return false;
+
+   metric = &perf_metrics[type];
+   n      = (unsigned)MIN(metric->count, PERF_METRICS_WINDOW);
+
+   memset(stats, 0, sizeof(*stats));
+
+   if (n == 0)
+      return false;
+
+   stats->samples = n;
+
+   for (i = 0; i < n; i++)
+      if (metric->samples[i] > stats->max)
+         stats->max = metric->samples[i];
+
+   /* Nearest-rank percentiles */
+   rank50 = (n * 50 + 99) / 100;
+   rank95 = (n * 95 + 99) / 100;
+   rank99 = (n * 99 + 99) / 100;
+
+   for (i = 0; i < PERF_METRICS_BUCKETS; i++)
+   {
+      unsigned prev = seen;
+      uint32_t val;
+
+      if (!metric->buckets[i])
+         continue;
+
+      seen += metric->buckets[i];
+      val   = MIN(perf_metrics_bucket_value(i), stats->max);
+
+      if (prev < rank50 && seen >= rank50)
+         stats->p50 = val;
+      if (prev < rank95 && seen >= rank95)
+         stats->p95 = val;
+      if (prev < rank99 && seen >= rank99)
+      {
+         stats->p99 = val;
+         break;
+      }
+   }
+
+   return true;
+}
+
+void perf_metrics_reset(void)
+{
+   memset(perf_metrics, 0, sizeof(perf_metrics));
+   perf_metrics_poll_time = 0;
+}
+
 void rarch_timer_tick(rarch_timer_t *timer)
 {
    if (!timer)
@@ -89,6 +89,100 @@ void rarch_perf_register(struct retro_perf_counter *perf);
  **/
 #define performance_counter_stop_plus(is_perfcnt_enable, perf) performance_counter_stop_internal(is_perfcnt_enable, perf)
 
+/* Frame tracer.
+ *
+ * Records begin/end timestamps of named spans into a fixed
+ * ring buffer, from any thread, and writes the last
+ * PERF_TRACE_MAX_EVENTS of them as Chrome trace_event JSON
+ * (chrome://tracing, Perfetto).
+ *
+ * Span names must be string literals. When tracing is off
+ * a span costs one predictable branch on perf_trace_enabled. */
+#ifndef PERF_TRACE_MAX_EVENTS
+#define PERF_TRACE_MAX_EVENTS (1 << 16)
+#endif
+
+extern bool perf_trace_enabled;
+
+#define PERF_TRACE_BEGIN(name) \
+   do { if (perf_trace_enabled) perf_trace_event(name, true); } while (0)
+
+#define PERF_TRACE_END(name) \
+   do { if (perf_trace_enabled) perf_trace_event(name, false); } while (0)
+
+/**
+ * perf_trace_set_enabled:
+ * @enable             : start or stop recording
+ *
+ * The ring buffer is allocated the first time tracing is
+ * enabled. Events recorded so far are kept when stopping.
+ *
+ * Returns: true if tracing is now in the requested state.
+ **/
+bool perf_trace_set_enabled(bool enable);
+
+void perf_trace_event(const char *name, bool begin);
+
+/**
+ * perf_trace_dump:
+ * @path               : JSON file to write
+ *
+ * Writes the events currently in the ring buffer.
+ *
+ * Returns: true if successful, false otherwise.
+ **/
+bool perf_trace_dump(const char *path);
+
+void perf_trace_deinit(void);
+
+/* Rolling metrics.
+ *
+ * Each metric keeps its last PERF_METRICS_WINDOW samples and a
+ * log-linear histogram of them (exact below 64, ~3% wide
+ * buckets above), so percentiles can be read at any time
+ * without sorting. Main thread only. */
+#define PERF_METRICS_WINDOW 1024
+
+enum perf_metric_type
+{
+   PERF_METRIC_FRAME_TIME = 0, /* usec between two video frames */
+   PERF_METRIC_CORE_RUN,       /* usec spent in retro_run */
+   PERF_METRIC_AUDIO_FILL,     /* audio buffer fill, percent */
+   PERF_METRIC_LATENCY,        /* usec from input poll to frame submission */
+   PERF_METRIC_LAST
+};
+
+typedef struct perf_metric_stats
+{
+   unsigned samples;
+   uint32_t p50;
+   uint32_t p95;
+   uint32_t p99;
+   uint32_t max;
+} perf_metric_stats_t;
+
+void perf_metrics_record(enum perf_metric_type type, uint32_t value);
+
+/* Marks the time of the last input poll, and records the
+ * latency estimate when the next frame is submitted. */
+void perf_metrics_input_polled(void);
+
+void perf_metrics_frame_submitted(void);
+
+const char *perf_metrics_name(enum perf_metric_type type);
+
+/**
+ * perf_metrics_get:
+ * @type               : metric
+ * @stats              : output
+ *
+ * Returns: true if @type has at least one sample.
+ **/
+bool perf_metrics_get(enum perf_metric_type type,
+      perf_metric_stats_t *stats);
+
+void perf_metrics_reset(void);
+
 void rarch_timer_tick(rarch_timer_t *timer);
 
 bool rarch_timer_is_running(rarch_timer_t *timer);
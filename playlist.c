@@ -23,6 +23,7 @@
 #include <boolean.h>
 #include <retro_assert.h>
 #include <compat/posix_string.h>
+#include <compat/strl.h>
 #include <string/stdstring.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
@@ -38,6 +39,61 @@
 #define PLAYLIST_ENTRIES 6
 #endif
 
+#define PLAYLIST_SIDECAR_MAGIC   "RAPLCACH"
+#define PLAYLIST_SIDECAR_VERSION 2
+
+/* Pushes kept only in the sidecar journal before the JSON file
+ * is rewritten to include them. */
+#define PLAYLIST_JSON_MAX_PENDING_PUSHES 32
+
+/* Binary sidecar cache of a JSON playlist (see playlist_sidecar_load()).
+ *
+ * Layout: header, 'count' fixed-size records, a string table of
+ * 'strings_size' bytes, then a journal of playlist_push() calls made
+ * since the records were built. Each journal entry is a record
+ * followed by its own string table of 'strings_size' bytes.
+ *
+ * The records always match the JSON file. Pushes are appended to the
+ * journal on their own; the first 'json_journal_size' bytes of the
+ * journal are in the JSON file as well, the rest is written to it
+ * later in one go. The cache is only used while 'json_size' and
+ * 'json_mtime' match the playlist file. */
+typedef struct playlist_sidecar_header
+{
+   char magic[8];
+   uint32_t version;
+   uint32_t record_size;
+   int64_t json_size;
+   int64_t json_mtime;
+   uint32_t count;
+   uint32_t strings_size;
+   uint32_t json_journal_size;
+   uint32_t reserved;
+} playlist_sidecar_header_t;
+
+/* Strings are stored as offset + 1 into the string table,
+ * 0 means the field is unset. */
+typedef struct playlist_sidecar_record
+{
+   uint32_t path;
+   uint32_t label;
+   uint32_t core_path;
+   uint32_t core_name;
+   uint32_t db_name;
+   uint32_t crc32;
+   uint32_t runtime_hours;
+   uint32_t runtime_minutes;
+   uint32_t runtime_seconds;
+   uint32_t last_played_year;
+   uint32_t last_played_month;
+   uint32_t last_played_day;
+   uint32_t last_played_hour;
+   uint32_t last_played_minute;
+   uint32_t last_played_second;
+   /* Journal entries only */
+   uint32_t strings_size;
+} playlist_sidecar_record_t;
+
 struct playlist_entry
 {
    char *path;
@@ -58,16 +114,43 @@ struct playlist_entry
    unsigned last_played_hour;
    unsigned last_played_minute;
    unsigned last_played_second;
+   /* Not yet materialized, fields above are unset */
+   const playlist_sidecar_record_t *record;
 };
 
 struct content_playlist
 {
    bool modified;
+   /* Every change since the last write was a playlist_push() */
+   bool only_pushes;
+   /* The sidecar on disk matches the last written state */
+   bool sidecar_synced;
    size_t size;
    size_t cap;
 
    char *conf_path;
+   char *sidecar_path;
    struct playlist_entry *entries;
+
+   /* Loaded sidecar, entry strings may point into it */
+   RFILE *sidecar_file;
+   const uint8_t *sidecar_data;
+   uint8_t *sidecar_owned;
+   int64_t sidecar_size;
+   const char *sidecar_strings;
+   uint32_t sidecar_strings_size;
+   int64_t sidecar_disk_size;
+   /* JSON file stamp stored in the sidecar on disk */
+   int64_t sidecar_json_size;
+   int64_t sidecar_json_mtime;
+
+   /* Journal entries for pushes made since the last write */
+   uint8_t *journal;
+   size_t journal_size;
+   size_t journal_cap;
+   size_t journal_count;
+   /* Pushes in the sidecar journal that the JSON file lacks */
+   size_t json_pending;
 };
 
 typedef struct
@@ -92,6 +175,75 @@ typedef int (playlist_sort_fun_t)(
       const struct playlist_entry *a,
       const struct playlist_entry *b);
 
+static char *playlist_sidecar_string(const char *strings,
+      uint32_t strings_size, uint32_t ref)
+{
+   /* The string table is NUL-terminated, so any
+    * in-range offset yields a terminated string */
+   if (!ref || ref > strings_size)
+      return NULL;
+   return (char*)(strings + ref - 1);
+}
+
+static void playlist_sidecar_fill(struct playlist_entry *entry,
+      const playlist_sidecar_record_t *record,
+      const char *strings, uint32_t strings_size)
+{
+   entry->path               = playlist_sidecar_string(strings, strings_size, record->path);
+   entry->label              = playlist_sidecar_string(strings, strings_size, record->label);
+   entry->core_path          = playlist_sidecar_string(strings, strings_size, record->core_path);
+   entry->core_name          = playlist_sidecar_string(strings, strings_size, record->core_name);
+   entry->db_name            = playlist_sidecar_string(strings, strings_size, record->db_name);
+   entry->crc32              = playlist_sidecar_string(strings, strings_size, record->crc32);
+   entry->runtime_hours      = record->runtime_hours;
+   entry->runtime_minutes    = record->runtime_minutes;
+   entry->runtime_seconds    = record->runtime_seconds;
+   entry->last_played_year   = record->last_played_year;
+   entry->last_played_month  = record->last_played_month;
+   entry->last_played_day    = record->last_played_day;
+   entry->last_played_hour   = record->last_played_hour;
+   entry->last_played_minute = record->last_played_minute;
+   entry->last_played_second = record->last_played_second;
+   entry->record             = NULL;
+}
+
+/**
+ * playlist_entry_get:
+ * @playlist            : Playlist handle.
+ * @idx                 : Index of playlist entry.
+ *
+ * Entries loaded from the sidecar are only decoded on first
+ * access; their strings are borrowed from the sidecar data.
+ *
+ * Returns: the materialized entry at @idx.
+ **/
+static struct playlist_entry *playlist_entry_get(
+      playlist_t *playlist, size_t idx)
+{
+   struct playlist_entry *entry = &playlist->entries[idx];
+
+   if (entry->record)
+      playlist_sidecar_fill(entry, entry->record,
+            playlist->sidecar_strings, playlist->sidecar_strings_size);
+
+   return entry;
+}
+
+static void playlist_free_string(playlist_t *playlist, char *str)
+{
+   const uint8_t *data = playlist->sidecar_data;
+
+   if (!str)
+      return;
+
+   /* Borrowed from the sidecar */
+   if (data && (const uint8_t*)str >= data &&
+         (const uint8_t*)str < data + playlist->sidecar_size)
+      return;
+
+   free(str);
+}
+
 uint32_t playlist_get_size(playlist_t *playlist)
 {
    if (!playlist)
@@ -123,21 +275,25 @@ void playlist_get_index(playlist_t *playlist,
       const char **crc32,
       const char **db_name)
 {
+   const struct playlist_entry *entry = NULL;
+
    if (!playlist)
       return;
 
+   entry = playlist_entry_get(playlist, idx);
+
    if (path)
-      *path      = playlist->entries[idx].path;
+      *path      = entry->path;
    if (label)
-      *label     = playlist->entries[idx].label;
+      *label     = entry->label;
    if (core_path)
-      *core_path = playlist->entries[idx].core_path;
+      *core_path = entry->core_path;
    if (core_name)
-      *core_name = playlist->entries[idx].core_name;
+      *core_name = entry->core_name;
    if (db_name)
-      *db_name   = playlist->entries[idx].db_name;
+      *db_name   = entry->db_name;
    if (crc32)
-      *crc32     = playlist->entries[idx].crc32;
+      *crc32     = entry->crc32;
 }
 
 void playlist_get_runtime_index(playlist_t *playlist,
@@ -150,6 +306,8 @@ void playlist_get_runtime_index(playlist_t *playlist,
    if (!playlist)
       return;
 
+   playlist_entry_get(playlist, idx);
+
    if (path)
       *path      = playlist->entries[idx].path;
    if (core_path)
@@ -192,7 +350,8 @@ void playlist_delete_index(playlist_t *playlist,
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
          (playlist->size - idx) * sizeof(struct playlist_entry));
 
-   playlist->modified = true;
+   playlist->modified    = true;
+   playlist->only_pushes = false;
 }
 
 void playlist_get_index_by_path(playlist_t *playlist,
@@ -208,7 +367,7 @@ void playlist_get_index_by_path(playlist_t *playlist,
 
    for (i = 0; i < playlist->size; i++)
    {
-      if (!string_is_equal(playlist->entries[i].path, search_path))
+      if (!string_is_equal(playlist_entry_get(playlist, i)->path, search_path))
          continue;
 
       if (path)
@@ -236,7 +395,7 @@ bool playlist_entry_exists(playlist_t *playlist,
       return false;
 
    for (i = 0; i < playlist->size; i++)
-      if (string_is_equal(playlist->entries[i].path, path))
+      if (string_is_equal(playlist_entry_get(playlist, i)->path, path))
          return true;
 
    return false;
@@ -244,27 +403,23 @@ bool playlist_entry_exists(playlist_t *playlist,
 
 /**
  * playlist_free_entry:
+ * @playlist            : Playlist handle.
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
-   if (entry->path != NULL)
-      free(entry->path);
-   if (entry->label != NULL)
-      free(entry->label);
-   if (entry->core_path != NULL)
-      free(entry->core_path);
-   if (entry->core_name != NULL)
-      free(entry->core_name);
-   if (entry->db_name != NULL)
-      free(entry->db_name);
-   if (entry->crc32 != NULL)
-      free(entry->crc32);
+   playlist_free_string(playlist, entry->path);
+   playlist_free_string(playlist, entry->label);
+   playlist_free_string(playlist, entry->core_path);
+   playlist_free_string(playlist, entry->core_name);
+   playlist_free_string(playlist, entry->db_name);
+   playlist_free_string(playlist, entry->crc32);
 
    entry->path      = NULL;
    entry->label     = NULL;
@@ -281,6 +436,7 @@ static void playlist_free_entry(struct playlist_entry *entry)
    entry->last_played_hour = 0;
    entry->last_played_minute = 0;
    entry->last_played_second = 0;
+   entry->record = NULL;
 }
 
 void playlist_update(playlist_t *playlist, size_t idx,
@@ -294,28 +450,25 @@ void playlist_update(playlist_t *playlist, size_t idx,
    if (!playlist || idx > playlist->size)
       return;
 
-   entry            = &playlist->entries[idx];
+   entry            = playlist_entry_get(playlist, idx);
 
    if (path && (path != entry->path))
    {
-      if (entry->path != NULL)
-         free(entry->path);
+      playlist_free_string(playlist, entry->path);
       entry->path        = strdup(path);
       playlist->modified = true;
    }
 
    if (label && (label != entry->label))
    {
-      if (entry->label != NULL)
-         free(entry->label);
+      playlist_free_string(playlist, entry->label);
       entry->label       = strdup(label);
       playlist->modified = true;
    }
 
    if (core_path && (core_path != entry->core_path))
    {
-      if (entry->core_path != NULL)
-         free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(core_path);
       playlist->modified = true;
@@ -323,27 +476,27 @@ void playlist_update(playlist_t *playlist, size_t idx,
 
    if (core_name && (core_name != entry->core_name))
    {
-      if (entry->core_name != NULL)
-         free(entry->core_name);
+      playlist_free_string(playlist, entry->core_name);
       entry->core_name   = strdup(core_name);
       playlist->modified = true;
    }
 
    if (db_name && (db_name != entry->db_name))
    {
-      if (entry->db_name != NULL)
-         free(entry->db_name);
+      playlist_free_string(playlist, entry->db_name);
       entry->db_name     = strdup(db_name);
       playlist->modified = true;
    }
 
    if (crc32 && (crc32 != entry->crc32))
    {
-      if (entry->crc32 != NULL)
-         free(entry->crc32);
+      playlist_free_string(playlist, entry->crc32);
       entry->crc32       = strdup(crc32);
       playlist->modified = true;
    }
+
+   if (playlist->modified)
+      playlist->only_pushes = false;
 }
 
 void playlist_update_runtime(playlist_t *playlist, size_t idx,
@@ -358,20 +511,18 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
    if (!playlist || idx > playlist->size)
       return;
 
-   entry            = &playlist->entries[idx];
+   entry            = playlist_entry_get(playlist, idx);
 
    if (path && (path != entry->path))
    {
-      if (entry->path != NULL)
-         free(entry->path);
+      playlist_free_string(playlist, entry->path);
       entry->path        = strdup(path);
       playlist->modified = playlist->modified || register_update;
    }
 
    if (core_path && (core_path != entry->core_path))
    {
-      if (entry->core_path != NULL)
-         free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(core_path);
       playlist->modified = playlist->modified || register_update;
@@ -430,6 +581,9 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
       entry->last_played_second = last_played_second;
       playlist->modified = playlist->modified || register_update;
    }
+
+   if (playlist->modified)
+      playlist->only_pushes = false;
 }
 
 bool playlist_push_runtime(playlist_t *playlist,
@@ -457,14 +611,15 @@ bool playlist_push_runtime(playlist_t *playlist,
    {
       struct playlist_entry tmp;
       bool equal_path;
+      const struct playlist_entry *entry = playlist_entry_get(playlist, i);
 
-      equal_path = (!path && !playlist->entries[i].path) ||
-         (path && playlist->entries[i].path &&
+      equal_path = (!path && !entry->path) ||
+         (path && entry->path &&
 #ifdef _WIN32
           /*prevent duplicates on case-insensitive operating systems*/
-          string_is_equal_noncase(path,playlist->entries[i].path)
+          string_is_equal_noncase(path,entry->path)
 #else
-          string_is_equal(path,playlist->entries[i].path)
+          string_is_equal(path,entry->path)
 #endif
           );
 
@@ -473,7 +628,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       if (!equal_path)
          continue;
 
-      if (!string_is_equal(playlist->entries[i].core_path, core_path))
+      if (!string_is_equal(entry->core_path, core_path))
          continue;
 
       /* If top entry, we don't want to push a new entry since
@@ -495,7 +650,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       struct playlist_entry *entry = &playlist->entries[playlist->cap - 1];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
       playlist->size--;
    }
 
@@ -506,6 +661,7 @@ bool playlist_push_runtime(playlist_t *playlist,
 
       playlist->entries[0].path            = NULL;
       playlist->entries[0].core_path       = NULL;
+      playlist->entries[0].record          = NULL;
 
       if (!string_is_empty(path))
          playlist->entries[0].path      = strdup(path);
@@ -526,64 +682,42 @@ bool playlist_push_runtime(playlist_t *playlist,
    playlist->size++;
 
 success:
-   playlist->modified = true;
+   playlist->modified    = true;
+   playlist->only_pushes = false;
 
    return true;
 }
 
 /**
- * playlist_push:
- * @playlist        	   : Playlist handle.
- * @path                : Path of new playlist entry.
- * @core_path           : Core path of new playlist entry.
- * @core_name           : Core name of new playlist entry.
+ * playlist_push_entry:
  *
- * Push entry to top of playlist.
+ * Pushes an entry to the top of the playlist, bumping an
+ * existing entry with the same path and core path instead.
+ * With @borrowed set the strings are owned by the sidecar
+ * and are stored as-is.
  **/
-bool playlist_push(playlist_t *playlist,
+static bool playlist_push_entry(playlist_t *playlist,
       const char *path, const char *label,
       const char *core_path, const char *core_name,
       const char *crc32,
-      const char *db_name)
+      const char *db_name,
+      bool borrowed)
 {
    size_t i;
-   bool core_path_empty = string_is_empty(core_path);
-   bool core_name_empty = string_is_empty(core_name);
-
-   if (core_path_empty || core_name_empty)
-   {
-      if (core_name_empty && !core_path_empty)
-      {
-         static char base_path[255] = {0};
-         fill_pathname_base_noext(base_path, core_path, sizeof(base_path));
-         core_name = base_path;
-      }
-
-      if (core_path_empty || core_name_empty)
-      {
-         RARCH_ERR("cannot push NULL or empty core name into the playlist.\n");
-         return false;
-      }
-   }
-
-   if (string_is_empty(path))
-      path = NULL;
-
-   if (!playlist)
-      return false;
 
    for (i = 0; i < playlist->size; i++)
    {
       struct playlist_entry tmp;
       bool equal_path;
+      const struct playlist_entry *entry = playlist_entry_get(playlist, i);
 
-      equal_path = (!path && !playlist->entries[i].path) ||
-         (path && playlist->entries[i].path &&
+      equal_path = (!path && !entry->path) ||
+         (path && entry->path &&
 #ifdef _WIN32
           /*prevent duplicates on case-insensitive operating systems*/
-          string_is_equal_noncase(path,playlist->entries[i].path)
+          string_is_equal_noncase(path,entry->path)
 #else
-          string_is_equal(path,playlist->entries[i].path)
+          string_is_equal(path,entry->path)
 #endif
           );
 
@@ -592,7 +726,7 @@ bool playlist_push(playlist_t *playlist,
       if (!equal_path)
          continue;
 
-      if (!string_is_equal(playlist->entries[i].core_path, core_path))
+      if (!string_is_equal(entry->core_path, core_path))
          continue;
 
       /* If top entry, we don't want to push a new entry since
@@ -606,7 +740,7 @@ bool playlist_push(playlist_t *playlist,
             i * sizeof(struct playlist_entry));
       playlist->entries[0] = tmp;
 
-      goto success;
+      return true;
    }
 
    if (playlist->size == playlist->cap)
@@ -614,47 +748,189 @@ bool playlist_push(playlist_t *playlist,
       struct playlist_entry *entry = &playlist->entries[playlist->cap - 1];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
       playlist->size--;
    }
 
    if (playlist->entries)
    {
+      struct playlist_entry *entry = &playlist->entries[0];
+
       memmove(playlist->entries + 1, playlist->entries,
             (playlist->cap - 1) * sizeof(struct playlist_entry));
 
-      playlist->entries[0].path               = NULL;
-      playlist->entries[0].label              = NULL;
-      playlist->entries[0].core_path          = NULL;
-      playlist->entries[0].core_name          = NULL;
-      playlist->entries[0].db_name            = NULL;
-      playlist->entries[0].crc32              = NULL;
-      playlist->entries[0].runtime_hours      = 0;
-      playlist->entries[0].runtime_minutes    = 0;
-      playlist->entries[0].runtime_seconds    = 0;
-      playlist->entries[0].last_played_year   = 0;
-      playlist->entries[0].last_played_month  = 0;
-      playlist->entries[0].last_played_day    = 0;
-      playlist->entries[0].last_played_hour   = 0;
-      playlist->entries[0].last_played_minute = 0;
-      playlist->entries[0].last_played_second = 0;
-      if (!string_is_empty(path))
-         playlist->entries[0].path      = strdup(path);
-      if (!string_is_empty(label))
-         playlist->entries[0].label     = strdup(label);
-      if (!string_is_empty(core_path))
-         playlist->entries[0].core_path = strdup(core_path);
-      if (!string_is_empty(core_name))
-         playlist->entries[0].core_name = strdup(core_name);
-      if (!string_is_empty(db_name))
-         playlist->entries[0].db_name   = strdup(db_name);
-      if (!string_is_empty(crc32))
-         playlist->entries[0].crc32     = strdup(crc32);
+      entry->path               = NULL;
+      entry->label              = NULL;
+      entry->core_path          = NULL;
+      entry->core_name          = NULL;
+      entry->db_name            = NULL;
+      entry->crc32              = NULL;
+      entry->runtime_hours      = 0;
+      entry->runtime_minutes    = 0;
+      entry->runtime_seconds    = 0;
+      entry->last_played_year   = 0;
+      entry->last_played_month  = 0;
+      entry->last_played_day    = 0;
+      entry->last_played_hour   = 0;
+      entry->last_played_minute = 0;
+      entry->last_played_second = 0;
+      entry->record             = NULL;
+
+      if (borrowed)
+      {
+         entry->path      = (char*)path;
+         entry->label     = (char*)label;
+         entry->core_path = (char*)core_path;
+         entry->core_name = (char*)core_name;
+         entry->db_name   = (char*)db_name;
+         entry->crc32     = (char*)crc32;
+      }
+      else
+      {
+         if (!string_is_empty(path))
+            entry->path      = strdup(path);
+         if (!string_is_empty(label))
+            entry->label     = strdup(label);
+         if (!string_is_empty(core_path))
+            entry->core_path = strdup(core_path);
+         if (!string_is_empty(core_name))
+            entry->core_name = strdup(core_name);
+         if (!string_is_empty(db_name))
+            entry->db_name   = strdup(db_name);
+         if (!string_is_empty(crc32))
+            entry->crc32     = strdup(crc32);
+      }
    }
 
    playlist->size++;
 
-success:
+   return true;
+}
+
+static uint32_t playlist_sidecar_put_string(uint8_t *strings,
+      uint32_t *strings_size, const char *str)
+{
+   uint32_t ref;
+   size_t len;
+
+   if (string_is_empty(str))
+      return 0;
+
+   len = strlen(str) + 1;
+   ref = *strings_size + 1;
+
+   if (strings)
+      memcpy(strings + *strings_size, str, len);
+   *strings_size += (uint32_t)len;
+
+   return ref;
+}
+
+/* Records a playlist_push() so playlist_write_file()
+ * can append it to the sidecar journal. */
+static void playlist_journal_push(playlist_t *playlist,
+      const char *path, const char *label,
+      const char *core_path, const char *core_name,
+      const char *crc32,
+      const char *db_name)
+{
+   playlist_sidecar_record_t record = {0};
+   uint32_t strings_size            = 0;
+   uint8_t *strings                 = NULL;
+   size_t needed;
+
+   playlist_sidecar_put_string(NULL, &strings_size, path);
+   playlist_sidecar_put_string(NULL, &strings_size, label);
+   playlist_sidecar_put_string(NULL, &strings_size, core_path);
+   playlist_sidecar_put_string(NULL, &strings_size, core_name);
+   playlist_sidecar_put_string(NULL, &strings_size, db_name);
+   playlist_sidecar_put_string(NULL, &strings_size, crc32);
+
+   needed = playlist->journal_size + sizeof(record) + strings_size;
+
+   if (needed > playlist->journal_cap)
+   {
+      size_t cap   = playlist->journal_cap ? playlist->journal_cap * 2 : 1024;
+      uint8_t *tmp = NULL;
+
+      while (cap < needed)
+         cap *= 2;
+
+      tmp = (uint8_t*)realloc(playlist->journal, cap);
+      if (!tmp)
+      {
+         /* Falls back to a full write */
+         playlist->only_pushes = false;
+         return;
+      }
+
+      playlist->journal     = tmp;
+      playlist->journal_cap = cap;
+   }
+
+   strings             = playlist->journal + playlist->journal_size + sizeof(record);
+   strings_size        = 0;
+   record.path         = playlist_sidecar_put_string(strings, &strings_size, path);
+   record.label        = playlist_sidecar_put_string(strings, &strings_size, label);
+   record.core_path    = playlist_sidecar_put_string(strings, &strings_size, core_path);
+   record.core_name    = playlist_sidecar_put_string(strings, &strings_size, core_name);
+   record.db_name      = playlist_sidecar_put_string(strings, &strings_size, db_name);
+   record.crc32        = playlist_sidecar_put_string(strings, &strings_size, crc32);
+   record.strings_size = strings_size;
+
+   memcpy(playlist->journal + playlist->journal_size, &record, sizeof(record));
+   playlist->journal_size = needed;
+   playlist->journal_count++;
+}
+
+/**
+ * playlist_push:
+ * @playlist        	   : Playlist handle.
+ * @path                : Path of new playlist entry.
+ * @core_path           : Core path of new playlist entry.
+ * @core_name           : Core name of new playlist entry.
+ *
+ * Push entry to top of playlist.
+ **/
+bool playlist_push(playlist_t *playlist,
+      const char *path, const char *label,
+      const char *core_path, const char *core_name,
+      const char *crc32,
+      const char *db_name)
+{
+   bool core_path_empty = string_is_empty(core_path);
+   bool core_name_empty = string_is_empty(core_name);
+
+   if (core_path_empty || core_name_empty)
+   {
+      if (core_name_empty && !core_path_empty)
+      {
+         static char base_path[255] = {0};
+         fill_pathname_base_noext(base_path, core_path, sizeof(base_path));
+         core_name = base_path;
+      }
+
+      if (core_path_empty || core_name_empty)
+      {
+         RARCH_ERR("cannot push NULL or empty core name into the playlist.\n");
+         return false;
+      }
+   }
+
+   if (string_is_empty(path))
+      path = NULL;
+
+   if (!playlist)
+      return false;
+
+   if (!playlist_push_entry(playlist, path, label,
+            core_path, core_name, crc32, db_name, false))
+      return false;
+
+   if (playlist->only_pushes)
+      playlist_journal_push(playlist, path, label,
+            core_path, core_name, crc32, db_name);
+
    playlist->modified = true;
 
    return true;
@@ -687,6 +963,397 @@ static void JSONLogError(JSONContext *pCtx)
    }
 }
 
+/**
+ * playlist_sidecar_write:
+ * @playlist            : Playlist handle.
+ *
+ * Rebuilds the sidecar from the current entries, stamped with
+ * the JSON file that was just written. The new file replaces the
+ * old one by rename, so a sidecar still mapped stays readable.
+ *
+ * Returns: true if the sidecar was written.
+ **/
+static bool playlist_sidecar_write(playlist_t *playlist)
+{
+   size_t i;
+   char tmp_path[PATH_MAX_LENGTH];
+   playlist_sidecar_header_t header    = {{0}};
+   playlist_sidecar_record_t *records  = NULL;
+   uint8_t *strings                    = NULL;
+   uint8_t *buf                        = NULL;
+   uint32_t strings_size               = 0;
+   size_t total                        = 0;
+   bool ret                            = false;
+
+   playlist->sidecar_synced = false;
+
+   if (string_is_empty(playlist->sidecar_path) ||
+         !path_get_stamp(playlist->conf_path,
+            &header.json_size, &header.json_mtime))
+      return false;
+
+   for (i = 0; i < playlist->size; i++)
+   {
+      const struct playlist_entry *entry = playlist_entry_get(playlist, i);
+
+      playlist_sidecar_put_string(NULL, &strings_size, entry->path);
+      playlist_sidecar_put_string(NULL, &strings_size, entry->label);
+      playlist_sidecar_put_string(NULL, &strings_size, entry->core_path);
+      playlist_sidecar_put_string(NULL, &strings_size, entry->core_name);
+      playlist_sidecar_put_string(NULL, &strings_size, entry->db_name);
+      playlist_sidecar_put_string(NULL, &strings_size, entry->crc32);
+   }
+
+   total = sizeof(header)
+      + playlist->size * sizeof(playlist_sidecar_record_t)
+      + strings_size;
+   buf   = (uint8_t*)calloc(1, total);
+
+   if (!buf)
+      return false;
+
+   memcpy(header.magic, PLAYLIST_SIDECAR_MAGIC, sizeof(header.magic));
+   header.version      = PLAYLIST_SIDECAR_VERSION;
+   header.record_size  = sizeof(playlist_sidecar_record_t);
+   header.count        = (uint32_t)playlist->size;
+   header.strings_size = strings_size;
+   memcpy(buf, &header, sizeof(header));
+
+   records      = (playlist_sidecar_record_t*)(buf + sizeof(header));
+   strings      = buf + sizeof(header)
+      + playlist->size * sizeof(playlist_sidecar_record_t);
+   strings_size = 0;
+
+   for (i = 0; i < playlist->size; i++)
+   {
+      const struct playlist_entry *entry = &playlist->entries[i];
+      playlist_sidecar_record_t *record  = &records[i];
+
+      record->path               = playlist_sidecar_put_string(strings, &strings_size, entry->path);
+      record->label              = playlist_sidecar_put_string(strings, &strings_size, entry->label);
+      record->core_path          = playlist_sidecar_put_string(strings, &strings_size, entry->core_path);
+      record->core_name          = playlist_sidecar_put_string(strings, &strings_size, entry->core_name);
+      record->db_name            = playlist_sidecar_put_string(strings, &strings_size, entry->db_name);
+      record->crc32              = playlist_sidecar_put_string(strings, &strings_size, entry->crc32);
+      record->runtime_hours      = entry->runtime_hours;
+      record->runtime_minutes    = entry->runtime_minutes;
+      record->runtime_seconds    = entry->runtime_seconds;
+      record->last_played_year   = entry->last_played_year;
+      record->last_played_month  = entry->last_played_month;
+      record->last_played_day    = entry->last_played_day;
+      record->last_played_hour   = entry->last_played_hour;
+      record->last_played_minute = entry->last_played_minute;
+      record->last_played_second = entry->last_played_second;
+   }
+
+   strlcpy(tmp_path, playlist->sidecar_path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (filestream_write_file(tmp_path, buf, (int64_t)total))
+   {
+      filestream_delete(playlist->sidecar_path);
+
+      if (filestream_rename(tmp_path, playlist->sidecar_path) == 0)
+         ret = true;
+      else
+         filestream_delete(tmp_path);
+   }
+
+   free(buf);
+
+   if (ret)
+   {
+      playlist->sidecar_disk_size  = (int64_t)total;
+      playlist->sidecar_json_size  = header.json_size;
+      playlist->sidecar_json_mtime = header.json_mtime;
+      playlist->sidecar_synced     = true;
+   }
+
+   return ret;
+}
+
+/**
+ * playlist_sidecar_open_synced:
+ * @playlist            : Playlist handle.
+ * @header              : Output, header of the sidecar on disk.
+ *
+ * Opens the sidecar for update if it is still the one this
+ * playlist wrote last.
+ *
+ * Returns: file handle, or NULL if the sidecar cannot be updated
+ * in place.
+ **/
+static RFILE *playlist_sidecar_open_synced(playlist_t *playlist,
+      playlist_sidecar_header_t *header)
+{
+   RFILE *file = NULL;
+
+   if (     !playlist->sidecar_synced
+         || string_is_empty(playlist->sidecar_path))
+      return NULL;
+
+   file = filestream_open(playlist->sidecar_path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return NULL;
+
+   /* Replaced behind our back, e.g. by another handle
+    * on the same playlist */
+   if (     filestream_get_size(file) == playlist->sidecar_disk_size
+         && filestream_read(file, header, sizeof(*header))
+            == (int64_t)sizeof(*header)
+         && header->json_size  == playlist->sidecar_json_size
+         && header->json_mtime == playlist->sidecar_json_mtime)
+      return file;
+
+   filestream_close(file);
+   playlist->sidecar_synced = false;
+   return NULL;
+}
+
+/**
+ * playlist_sidecar_append:
+ * @playlist            : Playlist handle.
+ *
+ * Appends the pushes journaled since the last write to the
+ * sidecar, leaving the JSON file as it is. Only possible while
+ * neither file changed since this playlist wrote them.
+ *
+ * Returns: true if the journal was appended.
+ **/
+static bool playlist_sidecar_append(playlist_t *playlist)
+{
+   playlist_sidecar_header_t header;
+   RFILE *file        = NULL;
+   int64_t json_size  = 0;
+   int64_t json_mtime = 0;
+   bool ret           = false;
+
+   if (     !playlist->only_pushes
+         || !playlist->journal_size
+         || !path_get_stamp(playlist->conf_path, &json_size, &json_mtime)
+         || json_size  != playlist->sidecar_json_size
+         || json_mtime != playlist->sidecar_json_mtime)
+      return false;
+
+   if (!(file = playlist_sidecar_open_synced(playlist, &header)))
+      return false;
+
+   filestream_seek(file, 0, RETRO_VFS_SEEK_POSITION_END);
+   ret = filestream_write(file, playlist->journal,
+         playlist->journal_size) == (int64_t)playlist->journal_size;
+
+   filestream_close(file);
+
+   if (ret)
+      playlist->sidecar_disk_size += playlist->journal_size;
+   else
+      playlist->sidecar_synced     = false;
+
+   return ret;
+}
+
+/**
+ * playlist_sidecar_restamp:
+ * @playlist            : Playlist handle.
+ *
+ * Stamps the sidecar with the JSON file that was just written,
+ * after the JSON caught up with the journal. Only possible while
+ * the sidecar on disk holds exactly the playlist's entries.
+ *
+ * Returns: true if the sidecar was restamped.
+ **/
+static bool playlist_sidecar_restamp(playlist_t *playlist)
+{
+   playlist_sidecar_header_t header;
+   RFILE *file        = NULL;
+   int64_t json_size  = 0;
+   int64_t json_mtime = 0;
+   int64_t base_size  = 0;
+   bool ret           = false;
+
+   if (     !playlist->only_pushes
+         || playlist->journal_size
+         || !path_get_stamp(playlist->conf_path, &json_size, &json_mtime))
+      return false;
+
+   if (!(file = playlist_sidecar_open_synced(playlist, &header)))
+      return false;
+
+   base_size = sizeof(header)
+      + (int64_t)header.count * sizeof(playlist_sidecar_record_t)
+      + header.strings_size;
+
+   if (     base_size <= playlist->sidecar_disk_size
+         && playlist->sidecar_disk_size - base_size <= 0xFFFFFFFF)
+   {
+      header.json_size         = json_size;
+      header.json_mtime        = json_mtime;
+      header.json_journal_size = (uint32_t)
+         (playlist->sidecar_disk_size - base_size);
+      filestream_seek(file, 0, RETRO_VFS_SEEK_POSITION_START);
+      ret = filestream_write(file, &header, sizeof(header))
+         == (int64_t)sizeof(header);
+   }
+
+   filestream_close(file);
+
+   if (ret)
+   {
+      playlist->sidecar_json_size  = json_size;
+      playlist->sidecar_json_mtime = json_mtime;
+   }
+   else
+      playlist->sidecar_synced     = false;
+
+   return ret;
+}
+
+/**
+ * playlist_sidecar_load:
+ * @playlist            : Playlist handle.
+ *
+ * Loads the playlist from its sidecar if the sidecar was built
+ * from the current JSON file. The sidecar is memory-mapped where
+ * supported; entries are left unmaterialized and journaled pushes
+ * are replayed on top.
+ *
+ * Returns: true if the playlist was loaded from the sidecar.
+ **/
+static bool playlist_sidecar_load(playlist_t *playlist)
+{
+   size_t i;
+   playlist_sidecar_header_t header;
+   const playlist_sidecar_record_t *records = NULL;
+   const uint8_t *data                      = NULL;
+   RFILE *file                              = NULL;
+   int64_t json_size                        = 0;
+   int64_t json_mtime                       = 0;
+   int64_t size                             = 0;
+   int64_t pos                              = 0;
+   int64_t journal_pos                      = 0;
+   size_t count                             = 0;
+
+   if (string_is_empty(playlist->sidecar_path) ||
+         !path_get_stamp(playlist->conf_path, &json_size, &json_mtime))
+      return false;
+
+   file = filestream_open(playlist->sidecar_path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_FREQUENT_ACCESS);
+
+   if (!file)
+      return false;
+
+   data = (const uint8_t*)filestream_get_mapped(file, &size);
+
+   if (!data)
+   {
+      /* Not mapped, keep a private copy instead */
+      size = filestream_get_size(file);
+
+      if (size >= (int64_t)sizeof(header))
+         playlist->sidecar_owned = (uint8_t*)malloc((size_t)size);
+
+      if (playlist->sidecar_owned &&
+            filestream_read(file, playlist->sidecar_owned, size) == size)
+         data = playlist->sidecar_owned;
+
+      filestream_close(file);
+      file = NULL;
+   }
+
+   if (!data || size < (int64_t)sizeof(header))
+      goto error;
+
+   memcpy(&header, data, sizeof(header));
+
+   if (     memcmp(header.magic, PLAYLIST_SIDECAR_MAGIC, sizeof(header.magic))
+         || header.version     != PLAYLIST_SIDECAR_VERSION
+         || header.record_size != sizeof(playlist_sidecar_record_t)
+         || header.json_size   != json_size
+         || header.json_mtime  != json_mtime)
+      goto error;
+
+   pos = sizeof(header)
+      + (int64_t)header.count * sizeof(playlist_sidecar_record_t)
+      + header.strings_size;
+
+   if (pos > size || (header.strings_size && data[pos - 1] != '\0'))
+      goto error;
+
+   playlist->sidecar_file         = file;
+   playlist->sidecar_data         = data;
+   playlist->sidecar_size         = size;
+   playlist->sidecar_strings      = (const char*)data + pos - header.strings_size;
+   playlist->sidecar_strings_size = header.strings_size;
+
+   records = (const playlist_sidecar_record_t*)(data + sizeof(header));
+   count   = header.count < playlist->cap ? header.count : playlist->cap;
+
+   for (i = 0; i < count; i++)
+      playlist->entries[i].record = &records[i];
+   playlist->size = count;
+
+   /* Replay the pushes journaled since the records were built */
+   journal_pos = pos;
+
+   while (pos + (int64_t)sizeof(playlist_sidecar_record_t) <= size)
+   {
+      struct playlist_entry entry;
+      playlist_sidecar_record_t record;
+      const char *strings = (const char*)data + pos + sizeof(record);
+
+      memcpy(&record, data + pos, sizeof(record));
+
+      if (pos + (int64_t)sizeof(record) + record.strings_size > size ||
+            (record.strings_size && strings[record.strings_size - 1] != '\0'))
+         break;
+
+      playlist_sidecar_fill(&entry, &record, strings, record.strings_size);
+      playlist_push_entry(playlist, entry.path, entry.label,
+            entry.core_path, entry.core_name, entry.crc32, entry.db_name,
+            true);
+
+      /* Not in the JSON file yet */
+      if (pos - journal_pos >= (int64_t)header.json_journal_size)
+         playlist->json_pending++;
+
+      pos += sizeof(record) + record.strings_size;
+   }
+
+   playlist->sidecar_disk_size  = size;
+   playlist->sidecar_json_size  = json_size;
+   playlist->sidecar_json_mtime = json_mtime;
+   /* A torn journal or truncated base makes the next write rebuild it */
+   playlist->sidecar_synced     = pos == size && header.count <= playlist->cap;
+
+   return true;
+
+error:
+   if (file)
+      filestream_close(file);
+   free(playlist->sidecar_owned);
+   playlist->sidecar_owned = NULL;
+   return false;
+}
+
+static void playlist_sidecar_close(playlist_t *playlist)
+{
+   if (playlist->sidecar_file)
+      filestream_close(playlist->sidecar_file);
+   if (playlist->sidecar_owned)
+      free(playlist->sidecar_owned);
+
+   playlist->sidecar_file   = NULL;
+   playlist->sidecar_owned  = NULL;
+   playlist->sidecar_data   = NULL;
+   playlist->sidecar_size   = 0;
+}
+
 void playlist_write_runtime_file(playlist_t *playlist)
 {
    size_t i;
@@ -736,6 +1403,8 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
    for (i = 0; i < playlist->size; i++)
    {
+      const struct playlist_entry *entry = playlist_entry_get(playlist, i);
+
       JSON_Writer_WriteSpace(context.writer, 4);
       JSON_Writer_WriteStartObject(context.writer);
 
@@ -744,7 +1413,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
       JSON_Writer_WriteString(context.writer, "path", strlen("path"), JSON_UTF8);
       JSON_Writer_WriteColon(context.writer);
       JSON_Writer_WriteSpace(context.writer, 1);
-      JSON_Writer_WriteString(context.writer, playlist->entries[i].path ? playlist->entries[i].path : "", playlist->entries[i].path ? strlen(playlist->entries[i].path) : 0, JSON_UTF8);
+      JSON_Writer_WriteString(context.writer, entry->path ? entry->path : "", entry->path ? strlen(entry->path) : 0, JSON_UTF8);
       JSON_Writer_WriteComma(context.writer);
 
       JSON_Writer_WriteNewLine(context.writer);
@@ -752,14 +1421,14 @@ void playlist_write_runtime_file(playlist_t *playlist)
       JSON_Writer_WriteString(context.writer, "core_path", strlen("core_path"), JSON_UTF8);
       JSON_Writer_WriteColon(context.writer);
       JSON_Writer_WriteSpace(context.writer, 1);
-      JSON_Writer_WriteString(context.writer, playlist->entries[i].core_path, strlen(playlist->entries[i].core_path), JSON_UTF8);
+      JSON_Writer_WriteString(context.writer, entry->core_path, strlen(entry->core_path), JSON_UTF8);
       JSON_Writer_WriteComma(context.writer);
       JSON_Writer_WriteNewLine(context.writer);
 
       {
          char tmp[32] = {0};
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].runtime_hours);
+         snprintf(tmp, sizeof(tmp), "%u", entry->runtime_hours);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "runtime_hours", strlen("runtime_hours"), JSON_UTF8);
@@ -771,7 +1440,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].runtime_minutes);
+         snprintf(tmp, sizeof(tmp), "%u", entry->runtime_minutes);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "runtime_minutes", strlen("runtime_minutes"), JSON_UTF8);
@@ -783,7 +1452,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].runtime_seconds);
+         snprintf(tmp, sizeof(tmp), "%u", entry->runtime_seconds);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "runtime_seconds", strlen("runtime_seconds"), JSON_UTF8);
@@ -795,7 +1464,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].last_played_year);
+         snprintf(tmp, sizeof(tmp), "%u", entry->last_played_year);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "last_played_year", strlen("last_played_year"), JSON_UTF8);
@@ -807,7 +1476,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].last_played_month);
+         snprintf(tmp, sizeof(tmp), "%u", entry->last_played_month);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "last_played_month", strlen("last_played_month"), JSON_UTF8);
@@ -819,7 +1488,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].last_played_day);
+         snprintf(tmp, sizeof(tmp), "%u", entry->last_played_day);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "last_played_day", strlen("last_played_day"), JSON_UTF8);
@@ -831,7 +1500,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].last_played_hour);
+         snprintf(tmp, sizeof(tmp), "%u", entry->last_played_hour);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "last_played_hour", strlen("last_played_hour"), JSON_UTF8);
@@ -843,7 +1512,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].last_played_minute);
+         snprintf(tmp, sizeof(tmp), "%u", entry->last_played_minute);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "last_played_minute", strlen("last_played_minute"), JSON_UTF8);
@@ -855,7 +1524,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].last_played_second);
+         snprintf(tmp, sizeof(tmp), "%u", entry->last_played_second);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "last_played_second", strlen("last_played_second"), JSON_UTF8);
@@ -883,21 +1552,33 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
    playlist->modified = false;
 
+   /* Not a playlist the sidecar can describe */
+   playlist->journal_size   = 0;
+   playlist->only_pushes    = true;
+   playlist->sidecar_synced = false;
+
    RARCH_LOG("Written to playlist file: %s\n", playlist->conf_path);
 end:
    filestream_close(file);
 }
 
-void playlist_write_file(playlist_t *playlist)
+/**
+ * playlist_write_file_full:
+ * @playlist            : Playlist handle.
+ *
+ * Writes every entry to the playlist file, then brings the
+ * sidecar in line with it.
+ **/
+static void playlist_write_file_full(playlist_t *playlist)
 {
    size_t i;
-   RFILE *file = NULL;
+   bool use_old_format  = false;
+   bool ret             = false;
+   RFILE *file          = NULL;
    settings_t *settings = config_get_ptr();
 
-   if (!playlist || !playlist->modified)
-      return;
-
-   file = filestream_open(playlist->conf_path,
+   use_old_format = settings->bools.playlist_use_old_format;
+   file           = filestream_open(playlist->conf_path,
          RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
    if (!file)
@@ -906,17 +1587,21 @@ void playlist_write_file(playlist_t *playlist)
       return;
    }
 
-   if (settings->bools.playlist_use_old_format)
+   if (use_old_format)
    {
       for (i = 0; i < playlist->size; i++)
+      {
+         const struct playlist_entry *entry = playlist_entry_get(playlist, i);
+
          filestream_printf(file, "%s\n%s\n%s\n%s\n%s\n%s\n",
-               playlist->entries[i].path    ? playlist->entries[i].path    : "",
-               playlist->entries[i].label   ? playlist->entries[i].label   : "",
-               playlist->entries[i].core_path,
-               playlist->entries[i].core_name,
-               playlist->entries[i].crc32   ? playlist->entries[i].crc32   : "",
-               playlist->entries[i].db_name ? playlist->entries[i].db_name : ""
+               entry->path    ? entry->path    : "",
+               entry->label   ? entry->label   : "",
+               entry->core_path,
+               entry->core_name,
+               entry->crc32   ? entry->crc32   : "",
+               entry->db_name ? entry->db_name : ""
                );
+      }
    }
    else
    {
@@ -952,6 +1637,8 @@ void playlist_write_file(playlist_t *playlist)
 
       for (i = 0; i < playlist->size; i++)
       {
+         const struct playlist_entry *entry = playlist_entry_get(playlist, i);
+
          JSON_Writer_WriteSpace(context.writer, 4);
          JSON_Writer_WriteStartObject(context.writer);
 
@@ -960,7 +1647,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "path", strlen("path"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].path ? playlist->entries[i].path : "", playlist->entries[i].path ? strlen(playlist->entries[i].path) : 0, JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->path ? entry->path : "", entry->path ? strlen(entry->path) : 0, JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -968,7 +1655,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "label", strlen("label"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].label ? playlist->entries[i].label : "", playlist->entries[i].label ? strlen(playlist->entries[i].label) : 0, JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->label ? entry->label : "", entry->label ? strlen(entry->label) : 0, JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -976,7 +1663,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "core_path", strlen("core_path"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].core_path, strlen(playlist->entries[i].core_path), JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->core_path, strlen(entry->core_path), JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -984,7 +1671,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "core_name", strlen("core_name"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].core_name, strlen(playlist->entries[i].core_name), JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->core_name, strlen(entry->core_name), JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -992,7 +1679,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "crc32", strlen("crc32"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].crc32 ? playlist->entries[i].crc32 : "", playlist->entries[i].crc32 ? strlen(playlist->entries[i].crc32) : 0, JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->crc32 ? entry->crc32 : "", entry->crc32 ? strlen(entry->crc32) : 0, JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -1000,7 +1687,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "db_name", strlen("db_name"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].db_name ? playlist->entries[i].db_name : "", playlist->entries[i].db_name ? strlen(playlist->entries[i].db_name) : 0, JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->db_name ? entry->db_name : "", entry->db_name ? strlen(entry->db_name) : 0, JSON_UTF8);
          JSON_Writer_WriteNewLine(context.writer);
 
          JSON_Writer_WriteSpace(context.writer, 4);
@@ -1021,10 +1708,51 @@ void playlist_write_file(playlist_t *playlist)
    }
 
    playlist->modified = false;
+   ret                = true;
 
    RARCH_LOG("Written to playlist file: %s\n", playlist->conf_path);
 end:
    filestream_close(file);
+
+   if (ret)
+   {
+      /* If the sidecar already holds every entry, only
+       * its stamp needs to follow the new JSON file */
+      if (use_old_format)
+         playlist->sidecar_synced = false;
+      else if (!playlist_sidecar_restamp(playlist))
+         playlist_sidecar_write(playlist);
+
+      playlist->journal_size  = 0;
+      playlist->journal_count = 0;
+      playlist->json_pending  = 0;
+      playlist->only_pushes   = true;
+   }
+}
+
+void playlist_write_file(playlist_t *playlist)
+{
+   settings_t *settings = config_get_ptr();
+
+   if (!playlist || !playlist->modified)
+      return;
+
+   /* Pushes alone only go to the sidecar journal. The JSON
+    * file catches up with them every few pushes, and when
+    * the playlist is freed. */
+   if (     !settings->bools.playlist_use_old_format
+         && playlist_sidecar_append(playlist))
+   {
+      playlist->json_pending  += playlist->journal_count;
+      playlist->journal_size   = 0;
+      playlist->journal_count  = 0;
+      playlist->modified       = false;
+
+      if (playlist->json_pending < PLAYLIST_JSON_MAX_PENDING_PUSHES)
+         return;
+   }
+
+   playlist_write_file_full(playlist);
 }
 
 /**
@@ -1040,22 +1768,32 @@ void playlist_free(playlist_t *playlist)
    if (!playlist)
       return;
 
+   /* Deferred pushes must not stay out of the JSON file */
+   if (playlist->json_pending)
+      playlist_write_file_full(playlist);
+
    if (playlist->conf_path != NULL)
       free(playlist->conf_path);
+   if (playlist->sidecar_path != NULL)
+      free(playlist->sidecar_path);
 
-   playlist->conf_path = NULL;
+   playlist->conf_path    = NULL;
+   playlist->sidecar_path = NULL;
 
    for (i = 0; i < playlist->size; i++)
    {
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
 
    free(playlist->entries);
    playlist->entries = NULL;
 
+   playlist_sidecar_close(playlist);
+   free(playlist->journal);
+
    free(playlist);
 }
 
@@ -1076,9 +1814,10 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
-   playlist->size = 0;
+   playlist->size        = 0;
+   playlist->only_pushes = false;
 }
 
 /**
@@ -1323,11 +2062,20 @@ static JSON_Parser_HandlerResult JSONObjectMemberHandler(JSON_Parser parser, cha
    return JSON_Parser_Continue;
 }
 
+/**
+ * playlist_read_file:
+ * @playlist            : Playlist handle.
+ * @path                : Path to playlist contents file.
+ *
+ * Returns: true if a complete JSON playlist was read, i.e.
+ * one that can be mirrored by a sidecar.
+ **/
 static bool playlist_read_file(
-      playlist_t *playlist, const char *path)
+      playlist_t *playlist, const char *path, bool *is_json)
 {
    unsigned i;
    bool new_format = true;
+   bool ret        = false;
    RFILE *file = filestream_open(path,
          RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
@@ -1335,7 +2083,7 @@ static bool playlist_read_file(
     * create an empty playlist instead.
     */
    if (!file)
-      return true;
+      return false;
 
    /* Detect format of playlist */
    {
@@ -1346,7 +2094,7 @@ static bool playlist_read_file(
       if (bytes_read == 0)
       {
          filestream_close(file);
-         return true;
+         return false;
       }
 
       filestream_seek(file, 0, SEEK_SET);
@@ -1373,6 +2121,8 @@ static bool playlist_read_file(
       }
    }
 
+   *is_json = new_format;
+
    if (new_format)
    {
       JSONContext context = {0};
@@ -1441,6 +2191,8 @@ static bool playlist_read_file(
 
       if (context.current_meta_string)
          free(context.current_meta_string);
+
+      ret = true;
    }
    else
    {
@@ -1492,7 +2244,7 @@ static bool playlist_read_file(
 
 end:
    filestream_close(file);
-   return true;
+   return ret;
 }
 
 void playlist_free_cached(void)
@@ -1529,8 +2281,10 @@ bool playlist_init_cached(const char *path, size_t size)
  **/
 playlist_t *playlist_init(const char *path, size_t size)
 {
+   char sidecar_path[PATH_MAX_LENGTH];
+   bool is_json                   = false;
    struct playlist_entry *entries = NULL;
-   playlist_t           *playlist = (playlist_t*)malloc(sizeof(*playlist));
+   playlist_t           *playlist = (playlist_t*)calloc(1, sizeof(*playlist));
    if (!playlist)
       return NULL;
 
@@ -1541,13 +2295,23 @@ playlist_t *playlist_init(const char *path, size_t size)
       return NULL;
    }
 
-   playlist->modified  = false;
-   playlist->size      = 0;
-   playlist->cap       = size;
-   playlist->conf_path = strdup(path);
-   playlist->entries   = entries;
+   fill_pathname(sidecar_path, path,
+         file_path_str(FILE_PATH_PLAYLIST_CACHE_EXTENSION),
+         sizeof(sidecar_path));
+
+   playlist->modified     = false;
+   playlist->only_pushes  = true;
+   playlist->size         = 0;
+   playlist->cap          = size;
+   playlist->conf_path    = strdup(path);
+   playlist->sidecar_path = strdup(sidecar_path);
+   playlist->entries      = entries;
 
-   playlist_read_file(playlist, path);
+   /* Old format playlists get no sidecar */
+   if (     !playlist_sidecar_load(playlist)
+         && playlist_read_file(playlist, path, &is_json)
+         && is_json)
+      playlist_sidecar_write(playlist);
 
    return playlist;
 }
@@ -1629,6 +2393,14 @@ end:
 
 void playlist_qsort(playlist_t *playlist)
 {
+   size_t i;
+
+   for (i = 0; i < playlist->size; i++)
+      playlist_entry_get(playlist, i);
+
+   /* The journal can only replay pushes onto the stored order */
+   playlist->only_pushes = false;
+
    qsort(playlist->entries, playlist->size,
          sizeof(struct playlist_entry),
          (int (*)(const void *, const void *))playlist_qsort_func);
@@ -1689,14 +2461,18 @@ void command_playlist_update_write(
 bool playlist_index_is_valid(playlist_t *playlist, size_t idx,
       const char *path, const char *core_path)
 {
+   const struct playlist_entry *entry = NULL;
+
    if (!playlist)
       return false;
 
    if (idx >= playlist->size)
       return false;
 
-   return string_is_equal(playlist->entries[idx].path, path) &&
-          string_is_equal(path_basename(playlist->entries[idx].core_path), path_basename(core_path));
+   entry = playlist_entry_get(playlist, idx);
+
+   return string_is_equal(entry->path, path) &&
+          string_is_equal(path_basename(entry->core_path), path_basename(core_path));
 }
 
 void playlist_get_crc32(playlist_t *playlist, size_t idx,
@@ -1706,7 +2482,7 @@ void playlist_get_crc32(playlist_t *playlist, size_t idx,
       return;
 
    if (crc32)
-      *crc32 = playlist->entries[idx].crc32;
+      *crc32 = playlist_entry_get(playlist, idx)->crc32;
 }
 
 void playlist_get_db_name(playlist_t *playlist, size_t idx,
@@ -1717,8 +2493,10 @@ void playlist_get_db_name(playlist_t *playlist, size_t idx,
 
    if (db_name)
    {
-      if (!string_is_empty(playlist->entries[idx].db_name))
-         *db_name = playlist->entries[idx].db_name;
+      const struct playlist_entry *entry = playlist_entry_get(playlist, idx);
+
+      if (!string_is_empty(entry->db_name))
+         *db_name = entry->db_name;
       else
       {
          const char *conf_path_basename = path_basename(playlist->conf_path);
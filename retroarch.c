@@ -2181,6 +2181,28 @@ error:
    return false;
 }
 
+static void runloop_task_trace(retro_task_t *task, bool begin)
+{
+   const char *name = "task_io";
+
+   if (!perf_trace_enabled)
+      return;
+
+   switch (task->priority)
+   {
+      case TASK_PRIORITY_INTERACTIVE:
+         name = "task_interactive";
+         break;
+      case TASK_PRIORITY_BACKGROUND:
+         name = "task_background";
+         break;
+      default:
+         break;
+   }
+
+   perf_trace_event(name, begin);
+}
+
 bool rarch_ctl(enum rarch_ctl_state state, void *data)
 {
    static bool has_set_username        = false;
@@ -2262,7 +2284,8 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
 
          command_event(CMD_EVENT_RECORD_DEINIT, NULL);
 
-         event_save_files();
+         /* The task queue and the core go away next */
+         event_save_files(true);
 
          command_event(CMD_EVENT_REWIND_DEINIT, NULL);
          command_event(CMD_EVENT_CHEATS_DEINIT, NULL);
@@ -2608,14 +2631,20 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
          return runloop_paused;
       case RARCH_CTL_TASK_INIT:
          {
-#ifdef HAVE_THREADS
             settings_t *settings = config_get_ptr();
+#ifdef HAVE_THREADS
             bool threaded_enable = settings->bools.threaded_data_runloop_enable;
+
+            task_queue_set_workers(settings->uints.task_queue_workers);
 #else
             bool threaded_enable = false;
 #endif
             task_queue_deinit();
             task_queue_init(threaded_enable, runloop_task_msg_queue_push);
+            task_queue_set_trace_hook(runloop_task_trace);
+
+            if (settings->bools.perf_trace_enable)
+               perf_trace_set_enabled(true);
          }
          break;
       case RARCH_CTL_SET_CORE_SHUTDOWN:
@@ -2631,6 +2660,7 @@ bool rarch_ctl(enum rarch_ctl_state state, void *data)
          return runloop_shutdown_initiated;
       case RARCH_CTL_DATA_DEINIT:
          task_queue_deinit();
+         perf_trace_deinit();
          break;
       case RARCH_CTL_IS_CORE_OPTION_UPDATED:
          if (!runloop_core_options)
@@ -4467,6 +4497,8 @@ int runloop_iterate(unsigned *sleep_ms)
          break;
    }
 
+   PERF_TRACE_BEGIN("runloop_iterate");
+
    if (runloop_autosave)
       autosave_lock();
 
@@ -4562,6 +4594,8 @@ int runloop_iterate(unsigned *sleep_ms)
    if (runloop_autosave)
       autosave_unlock();
 
+   PERF_TRACE_END("runloop_iterate");
+
    /* Condition for max speed x0.0 when vrr_runloop is off to skip that part */
    if (fastforward_ratio || vrr_runloop_enable)
       end:
@@ -1,4 +1,6 @@
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 
 #include <boolean.h>
 #include <dynamic/dylib.h>
@@ -19,6 +21,8 @@ typedef struct InputListElement_t
    unsigned device;
    unsigned index;
    int16_t *state;
+   /* one bit per id the core has read, see input_state_changed */
+   uint32_t *used;
    unsigned int state_size;
 } InputListElement;
 
@@ -42,6 +46,8 @@ static void* InputListElementConstructor(void)
    InputListElement *element = (InputListElement*)ptr;
    element->state_size = initial_state_array_size;
    element->state = (int16_t*)calloc(element->state_size, sizeof(int16_t));
+   element->used  = (uint32_t*)calloc((element->state_size + 31) / 32,
+         sizeof(uint32_t));
    return ptr;
 }
 
@@ -49,8 +55,12 @@ static void InputListElementRealloc(InputListElement *element, unsigned int newS
 {
    if (newSize > element->state_size)
    {
+      unsigned int old_words = (element->state_size + 31) / 32;
+      unsigned int new_words = (newSize + 31) / 32;
       element->state = (int16_t*)realloc(element->state, newSize * sizeof(int16_t));
       memset(&element->state[element->state_size], 0, (newSize - element->state_size) * sizeof(int16_t));
+      element->used  = (uint32_t*)realloc(element->used, new_words * sizeof(uint32_t));
+      memset(&element->used[old_words], 0, (new_words - old_words) * sizeof(uint32_t));
       element->state_size = newSize;
    }
 }
@@ -70,6 +80,7 @@ static void InputListElementDestructor(void* element_ptr)
 {
    InputListElement *element = (InputListElement*)element_ptr;
    free(element->state);
+   free(element->used);
    free(element_ptr);
 }
 
@@ -100,7 +111,8 @@ static void input_state_set_last(unsigned port, unsigned device,
       {
          if (id >= element->state_size)
             InputListElementExpand(element, id);
-         element->state[id] = value;
+         element->state[id]     = value;
+         element->used[id / 32] |= 1u << (id & 31);
          return;
       }
    }
@@ -114,7 +126,8 @@ static void input_state_set_last(unsigned port, unsigned device,
    {
       InputListElementExpand(element, id);
    }
-   element->state[id] = value;
+   element->state[id]     = value;
+   element->used[id / 32] |= 1u << (id & 31);
 }
 
 int16_t input_state_get_last(unsigned port,
@@ -143,6 +156,52 @@ int16_t input_state_get_last(unsigned port,
    return 0;
 }
 
+/* Same as input_state_get_last, but remembers the id as read so
+ * that input_state_changed also watches inputs the core only
+ * looked at while running ahead. */
+int16_t input_state_get_last_tracked(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   int16_t value = input_state_get_last(port, device, index, id);
+   input_state_set_last(port, device, index, id, value);
+   return value;
+}
+
+/* Compares the current input against the last logged values for
+ * every id the core has read, without updating the log. Input
+ * must already have been polled for this frame. */
+bool input_state_changed(void)
+{
+   unsigned i, id;
+
+   if (!input_state_callback_original || !input_state_list)
+      return true;
+
+   for (i = 0; i < (unsigned)input_state_list->size; i++)
+   {
+      InputListElement *element =
+         (InputListElement*)input_state_list->data[i];
+
+      for (id = 0; id < element->state_size; id++)
+      {
+         if (!(element->used[id / 32] & (1u << (id & 31))))
+         {
+            /* skip empty words in one go */
+            if (!element->used[id / 32])
+               id |= 31;
+            continue;
+         }
+
+         if (input_state_callback_original(element->port,
+                  element->device, element->index, id)
+               != element->state[id])
+            return true;
+      }
+   }
+
+   return false;
+}
+
 static int16_t input_state_with_logging(unsigned port,
       unsigned device, unsigned index, unsigned id)
 {
@@ -11,6 +11,9 @@ void add_input_state_hook(void);
 void remove_input_state_hook(void);
 int16_t input_state_get_last(unsigned port,
    unsigned device, unsigned index, unsigned id);
+int16_t input_state_get_last_tracked(unsigned port,
+   unsigned device, unsigned index, unsigned id);
+bool input_state_changed(void);
 
 RETRO_END_DECLS
 
@@ -13,8 +13,12 @@
 #include "../dynamic.h"
 #include "../audio/audio_driver.h"
 #include "../gfx/video_driver.h"
+#include "../input/input_driver.h"
 #include "../configuration.h"
 #include "../retroarch.h"
+#include "../movie.h"
+#include "../performance_counters.h"
+#include "../managers/cheat_manager.h"
 
 static size_t runahead_save_state_size     = 0;
 
@@ -22,8 +26,14 @@ static bool runahead_save_state_size_known = false;
 static bool request_fast_savestate         = false;
 static bool hard_disable_audio             = false;
 
-/* Save State List for Run Ahead */
+/* Save State List for Run Ahead
+ *
+ * Without a secondary core this holds runahead_count + 1 states:
+ * slot 0 is the real state, slot k the state k frames ahead of it
+ * when the last input is held. runahead_ring_frames is the number
+ * of frames ahead the slots are valid for, 0 when they are stale. */
 static MyList *runahead_save_state_list    = NULL;
+static int runahead_ring_frames            = 0;
 
 static void *runahead_save_state_alloc(void)
 {
@@ -69,11 +79,9 @@ static void runahead_save_state_list_destroy(void)
    mylist_destroy(&runahead_save_state_list);
 }
 
-#if 0
 static void runahead_save_state_list_rotate(void)
 {
    int i;
-   void *element;
    void *firstElement;
    firstElement = runahead_save_state_list->data[0];
    for (i = 1; i < runahead_save_state_list->size; i++)
@@ -82,7 +90,6 @@ static void runahead_save_state_list_rotate(void)
    runahead_save_state_list->data[runahead_save_state_list->size - 1] =
       firstElement;
 }
-#endif
 
 /* Hooks - Hooks to cleanup, and add dirty input hooks */
 
@@ -159,6 +166,7 @@ static void runahead_clear_variables(void)
    runahead_secondary_core_available = true;
    runahead_force_input_dirty        = true;
    runahead_last_frame_count         = 0;
+   runahead_ring_frames              = 0;
 }
 
 static uint64_t runahead_get_frame_count()
@@ -183,6 +191,7 @@ static void runahead_check_for_gui(void)
 static void runahead_error(void)
 {
    runahead_available = false;
+   runahead_ring_frames = 0;
    runahead_save_state_list_destroy();
    runahead_remove_hooks();
    runahead_save_state_size = 0;
@@ -213,14 +222,14 @@ static bool runahead_create(void)
    return true;
 }
 
-static bool runahead_save_state(void)
+static bool runahead_save_state(int slot)
 {
    bool okay                                  = false;
    retro_ctx_serialize_info_t *serialize_info;
    if (!runahead_save_state_list)
       return false;
    serialize_info =
-      (retro_ctx_serialize_info_t*)runahead_save_state_list->data[0];
+      (retro_ctx_serialize_info_t*)runahead_save_state_list->data[slot];
    request_fast_savestate = true;
    okay                   = core_serialize(serialize_info);
    request_fast_savestate = false;
@@ -232,11 +241,11 @@ static bool runahead_save_state(void)
    return false;
 }
 
-static bool runahead_load_state(void)
+static bool runahead_load_state(int slot)
 {
    bool okay                                  = false;
    retro_ctx_serialize_info_t *serialize_info = (retro_ctx_serialize_info_t*)
-      runahead_save_state_list->data[0];
+      runahead_save_state_list->data[slot];
    bool last_dirty                            = input_is_dirty;
 
    request_fast_savestate                     = true;
@@ -324,7 +333,7 @@ static bool runahead_core_run_use_last_input(void)
    retro_input_state_t old_input_function = retro_ctx.state_cb;
 
    retro_ctx.poll_cb  = runahead_input_poll_null;
-   retro_ctx.state_cb = input_state_get_last;
+   retro_ctx.state_cb = input_state_get_last_tracked;
 
    current_core.retro_set_input_poll(retro_ctx.poll_cb);
    current_core.retro_set_input_state(retro_ctx.state_cb);
@@ -340,7 +349,115 @@ static bool runahead_core_run_use_last_input(void)
    return true;
 }
 
-void run_ahead(int runahead_count, bool useSecondary)
+/* Runs the real frame and then runahead_count frames with the
+ * last input, saving every state into the list. Only the last
+ * frame is presented, and the core is left at the real state. */
+static bool runahead_replay(int runahead_count, bool input_polled)
+{
+   int frame_number;
+
+   runahead_ring_frames = 0;
+   mylist_resize(runahead_save_state_list, runahead_count + 1, true);
+
+   runahead_suspend_audio();
+   runahead_suspend_video();
+   if (input_polled)
+      core_run_no_input_polling();
+   else
+      core_run();
+   runahead_resume_video();
+   runahead_resume_audio();
+
+   if (!runahead_save_state(0))
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+      return false;
+   }
+
+   for (frame_number = 1; frame_number <= runahead_count; frame_number++)
+   {
+      bool suspended_frame = frame_number != runahead_count;
+
+      if (suspended_frame)
+      {
+         runahead_suspend_audio();
+         runahead_suspend_video();
+      }
+
+      runahead_core_run_use_last_input();
+
+      if (suspended_frame)
+      {
+         runahead_resume_video();
+         runahead_resume_audio();
+      }
+
+      if (!runahead_save_state(frame_number))
+      {
+         runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+         return false;
+      }
+   }
+
+   if (!runahead_load_state(0))
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+      return false;
+   }
+
+   runahead_ring_frames = runahead_count;
+   return true;
+}
+
+/* The input is the same as last frame, so the real frame and all
+ * but the newest speculative frame were already run: continue
+ * from the newest state, then step the real state forward by one
+ * slot. */
+static bool runahead_advance(int runahead_count)
+{
+   runahead_ring_frames = 0;
+
+   if (!runahead_load_state(runahead_count))
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+      return false;
+   }
+
+   runahead_core_run_use_last_input();
+
+   /* the old real state is no longer needed, reuse its slot */
+   runahead_save_state_list_rotate();
+
+   if (!runahead_save_state(runahead_count))
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+      return false;
+   }
+
+   if (!runahead_load_state(0))
+   {
+      runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+      return false;
+   }
+
+   runahead_ring_frames = runahead_count;
+   return true;
+}
+
+/* The saved states can only be reused when nothing but the core
+ * itself touched its state since the last frame. Movies need every
+ * real frame to read input and retro cheats poke the real state
+ * after each frame, so both always replay. */
+static bool runahead_can_advance(int runahead_count)
+{
+   return runahead_ring_frames == runahead_count
+      && !runahead_force_input_dirty
+      && !input_is_dirty
+      && !bsv_movie_ctl(BSV_MOVIE_CTL_IS_INITED, NULL)
+      && cheat_manager_get_size() == 0;
+}
+
+static void run_ahead_internal(int runahead_count, bool useSecondary)
 {
    int frame_number        = 0;
    bool last_frame         = false;
@@ -377,52 +494,33 @@ void run_ahead(int runahead_count, bool useSecondary)
 
    if (!useSecondary || !have_dynamic || !runahead_secondary_core_available)
    {
-      /* TODO: multiple savestates for higher performance
-       * when not using secondary core */
-      for (frame_number = 0; frame_number <= runahead_count; frame_number++)
-      {
-         last_frame      = frame_number == runahead_count;
-         suspended_frame = !last_frame;
-
-         if (suspended_frame)
-         {
-            runahead_suspend_audio();
-            runahead_suspend_video();
-         }
+      bool input_polled = false;
 
-         if (frame_number == 0)
-            core_run();
-         else
-            runahead_core_run_use_last_input();
+      if (runahead_can_advance(runahead_count))
+      {
+         input_poll();
+         current_core.input_polled = true;
+         input_polled              = true;
 
-         if (suspended_frame)
+         if (!input_state_changed())
          {
-            runahead_resume_video();
-            runahead_resume_audio();
+            runahead_advance(runahead_count);
+            return;
          }
+      }
 
-         if (frame_number == 0)
-         {
-            if (!runahead_save_state())
-            {
-               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-               return;
-            }
-         }
+      if (!runahead_replay(runahead_count, input_polled))
+         return;
 
-         if (last_frame)
-         {
-            if (!runahead_load_state())
-            {
-               runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_LOAD_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-               return;
-            }
-         }
-      }
+      /* loading our own states must not count as a state change */
+      input_is_dirty = false;
    }
    else
    {
 #if HAVE_DYNAMIC
+      /* slot 0 is shared with the secondary core */
+      runahead_ring_frames = 0;
+
       if (!secondary_core_ensure_exists())
       {
          runahead_secondary_core_available = false;
@@ -441,7 +539,7 @@ void run_ahead(int runahead_count, bool useSecondary)
       {
          input_is_dirty       = false;
 
-         if (!runahead_save_state())
+         if (!runahead_save_state(0))
          {
             runloop_msg_queue_push(msg_hash_to_str(MSG_RUNAHEAD_FAILED_TO_SAVE_STATE), 0, 3 * 60, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
             return;
@@ -474,6 +572,19 @@ void run_ahead(int runahead_count, bool useSecondary)
    runahead_force_input_dirty = false;
 }
 
+void run_ahead(int runahead_count, bool useSecondary)
+{
+   PERF_TRACE_BEGIN("run_ahead");
+   run_ahead_internal(runahead_count, useSecondary);
+   PERF_TRACE_END("run_ahead");
+}
+
+void runahead_invalidate(void)
+{
+   runahead_ring_frames       = 0;
+   runahead_force_input_dirty = true;
+}
+
 void runahead_destroy(void)
 {
    runahead_save_state_list_destroy();
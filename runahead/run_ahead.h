@@ -12,6 +12,11 @@ void runahead_destroy(void);
 
 void run_ahead(int runAheadCount, bool useSecondary);
 
+/* Call after the frontend changes the core's state behind its
+ * back (memory writes, disk swaps, controller ports) so that run-ahead
+ * does not continue from states saved before the change. */
+void runahead_invalidate(void);
+
 bool want_fast_savestate(void);
 bool get_hard_disable_audio(void);
 
@@ -0,0 +1,259 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Runs the rewind delta compressor over generated savestates,
+ * first with the baseline SSE2/NEON/C scanners and then with
+ * the AVX2 ones when the CPU has them, and reports the
+ * throughput of both. The patches are compared and applied
+ * as well, so a wrong wide scanner shows up here.
+ *
+ * Usage: state_manager_bench [state size in KB] [frames] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+/* The scanners are static, so build the state manager
+ * into the bench. */
+#include "../../../managers/state_manager.c"
+
+/* The state manager only needs these from the rest of
+ * the frontend, and none of them on the paths timed here. */
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return ""; }
+void audio_driver_setup_rewind(void) { }
+bool audio_driver_has_callback(void) { return false; }
+void audio_driver_frame_is_reverse(void) { }
+bool bsv_movie_ctl(enum bsv_ctl_state state, void *data) { return false; }
+bool core_set_rewind_callbacks(void) { return false; }
+bool core_serialize_size(retro_ctx_size_info_t *info) { return false; }
+bool core_serialize(retro_ctx_serialize_info_t *info) { return false; }
+bool core_unserialize(retro_ctx_serialize_info_t *info) { return false; }
+
+enum bench_pattern
+{
+   /* A few short runs per frame, like counters and positions */
+   BENCH_PATTERN_SPARSE = 0,
+   /* A quarter of all 64-byte blocks, like a busy work RAM */
+   BENCH_PATTERN_DENSE,
+   /* Nothing, only the skip scan runs */
+   BENCH_PATTERN_IDLE,
+   BENCH_PATTERN_COUNT
+};
+
+static const char *pattern_names[BENCH_PATTERN_COUNT] = {
+   "sparse", "dense", "idle"
+};
+
+struct bench_scanners
+{
+   const char *name;
+   state_manager_scan_t change;
+   state_manager_scan_t same;
+};
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t bench_rand(uint32_t *seed)
+{
+   *seed = *seed * 1664525u + 1013904223u;
+   return *seed >> 8;
+}
+
+static void bench_mutate(uint8_t *state, size_t len,
+      enum bench_pattern pattern, uint32_t *seed)
+{
+   size_t i;
+
+   switch (pattern)
+   {
+      case BENCH_PATTERN_SPARSE:
+         for (i = 0; i < 16; i++)
+         {
+            size_t pos = bench_rand(seed) % len;
+            size_t run = 1 + bench_rand(seed) % 8;
+
+            while (run-- && pos < len)
+               state[pos++] ^= 1 + (bench_rand(seed) & 0x7f);
+         }
+         break;
+      case BENCH_PATTERN_DENSE:
+         for (i = 0; i + 64 <= len; i += 64)
+            if (!(bench_rand(seed) & 3))
+               state[i + bench_rand(seed) % 64] ^= 0x5a;
+         break;
+      default:
+         break;
+   }
+}
+
+/* Compresses every frame against the previous one. Returns
+ * the throughput in MB/s, or a negative value on a mismatch
+ * with the reference patches or a patch that does not apply. */
+static double bench_run(const struct bench_scanners *scan,
+      uint8_t **frames, unsigned count, size_t len,
+      uint8_t **reference, size_t *reference_size,
+      uint8_t *patch, uint8_t *check, size_t *total)
+{
+   unsigned i;
+   double start, elapsed = 0.0;
+
+   *total = 0;
+
+   for (i = 1; i < count; i++)
+   {
+      size_t size;
+
+      start    = bench_time();
+      size     = state_manager_raw_compress_scan(frames[i - 1], frames[i],
+            len, patch, scan->change, scan->same);
+      elapsed += bench_time() - start;
+      *total  += size;
+
+      if (!reference[i])
+      {
+         reference[i]      = (uint8_t*)malloc(size);
+         reference_size[i] = size;
+         if (reference[i])
+            memcpy(reference[i], patch, size);
+      }
+      else if (size != reference_size[i]
+            || memcmp(reference[i], patch, size))
+         return -1.0;
+
+      /* The patch turns the new state back into the old one */
+      memcpy(check, frames[i], len);
+      state_manager_raw_decompress(patch, size, check, len);
+      if (memcmp(check, frames[i - 1], len))
+         return -1.0;
+   }
+
+   return elapsed > 0.0
+      ? (double)len * (count - 1) / elapsed / (1024.0 * 1024.0)
+      : 0.0;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, p, s;
+   struct bench_scanners scanners[2];
+   unsigned num_scanners = 0;
+   unsigned failures     = 0;
+   size_t len            = (size_t)(argc > 1 ? atoi(argv[1]) : 512) * 1024;
+   unsigned count        = argc > 2 ? (unsigned)atoi(argv[2]) : 200;
+   uint8_t **frames      = NULL;
+   uint8_t **reference   = NULL;
+   size_t *reference_size = NULL;
+   uint8_t *patch        = NULL;
+   uint8_t *check        = NULL;
+
+   if (!len || count < 2)
+   {
+      printf("Usage: %s [state size in KB] [frames]\n", argv[0]);
+      return 1;
+   }
+
+   scanners[num_scanners].name   = "baseline";
+   scanners[num_scanners].change = find_change;
+   scanners[num_scanners].same   = find_same;
+   num_scanners++;
+
+#ifdef STATE_MANAGER_AVX2
+   if (cpu_features_get() & RETRO_SIMD_AVX2)
+   {
+      scanners[num_scanners].name   = "avx2";
+      scanners[num_scanners].change = find_change_avx2;
+      scanners[num_scanners].same   = find_same_avx2;
+      num_scanners++;
+   }
+   else
+      printf("No AVX2 on this CPU, only running the baseline.\n");
+#endif
+
+   frames         = (uint8_t**)calloc(count, sizeof(*frames));
+   reference      = (uint8_t**)calloc(count, sizeof(*reference));
+   reference_size = (size_t*)calloc(count, sizeof(*reference_size));
+   patch          = (uint8_t*)malloc(state_manager_raw_maxsize(len));
+   check          = (uint8_t*)malloc(len);
+
+   if (!frames || !reference || !reference_size || !patch || !check)
+      return 1;
+
+   /* Consecutive frames need different guard words */
+   for (i = 0; i < count; i++)
+      if (!(frames[i] = (uint8_t*)state_manager_raw_alloc(len, i & 1)))
+         return 1;
+
+   printf("%u frames of %u KB\n\n", count, (unsigned)(len / 1024));
+   printf("%-8s %-10s %12s %14s\n", "pattern", "scanners", "MB/s",
+         "bytes/frame");
+
+   for (p = 0; p < BENCH_PATTERN_COUNT; p++)
+   {
+      uint32_t seed = 1;
+
+      for (i = 0; i < len; i++)
+         frames[0][i] = (uint8_t)bench_rand(&seed);
+      for (i = 1; i < count; i++)
+      {
+         memcpy(frames[i], frames[i - 1], len);
+         bench_mutate(frames[i], len, (enum bench_pattern)p, &seed);
+      }
+
+      for (s = 0; s < num_scanners; s++)
+      {
+         size_t total = 0;
+         double mbps  = bench_run(&scanners[s], frames, count, len,
+               reference, reference_size, patch, check, &total);
+
+         if (mbps < 0.0)
+         {
+            printf("%-8s %-10s %12s\n", pattern_names[p],
+                  scanners[s].name, "MISMATCH");
+            failures++;
+            continue;
+         }
+
+         printf("%-8s %-10s %12.1f %14u\n", pattern_names[p],
+               scanners[s].name, mbps, (unsigned)(total / (count - 1)));
+      }
+
+      for (i = 0; i < count; i++)
+      {
+         free(reference[i]);
+         reference[i] = NULL;
+      }
+   }
+
+   for (i = 0; i < count; i++)
+      free(frames[i]);
+   free(frames);
+   free(reference);
+   free(reference_size);
+   free(patch);
+   free(check);
+
+   return failures ? 1 : 0;
+}
@@ -0,0 +1,243 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2017 - Hans-Kristian Arntzen
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Checks the slang shader cache without a GPU:
+ *
+ * - SPIR-V and reflection entries survive a save/load round trip.
+ * - Keys only depend on what the entries are built from; in
+ *   particular not on the iteration order of the semantic maps.
+ * - A corrupted or truncated entry is rejected as a miss.
+ * - slang_cache_dir() builds its path in the caller's buffer.
+ *
+ * Usage: slang_cache_test [scratch directory] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <compat/strl.h>
+#include <file/file_path.h>
+#include <retro_miscellaneous.h>
+#include <streams/file_stream.h>
+
+#include "../../../configuration.h"
+#include "../../../verbosity.h"
+#include "../../../gfx/drivers_shader/slang_cache.h"
+#include "../../../gfx/drivers_shader/slang_reflection.h"
+#include "../../../gfx/drivers_shader/slang_reflection.hpp"
+
+using namespace std;
+
+/* The cache only needs the settings and the logger
+ * from the rest of the frontend. */
+static settings_t test_settings;
+
+settings_t *config_get_ptr(void)
+{
+   return &test_settings;
+}
+
+void RARCH_LOG_V(const char *tag, const char *fmt, va_list ap) { }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+
+void RARCH_WARN(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static unsigned failures = 0;
+
+static void check(bool cond, const char *what)
+{
+   printf("[%s]: %s\n", cond ? "OK" : "FAIL", what);
+   if (!cond)
+      failures++;
+}
+
+static void fill_reflection(slang_reflection *r)
+{
+   r->pass_number                                     = 2;
+   r->ubo_size                                        = 128;
+   r->ubo_binding                                     = 0;
+   r->push_constant_size                              = 16;
+   r->semantics[SLANG_SEMANTIC_MVP].uniform           = true;
+   r->semantics[SLANG_SEMANTIC_MVP].num_components    = 16;
+   r->semantic_textures[SLANG_TEXTURE_SEMANTIC_ORIGINAL][0].binding = 3;
+   r->semantic_textures[SLANG_TEXTURE_SEMANTIC_ORIGINAL][0].texture = true;
+   r->semantic_float_parameters.resize(2);
+   r->semantic_float_parameters[1].push_constant        = true;
+   r->semantic_float_parameters[1].push_constant_offset = 8;
+   r->semantic_float_parameters[1].num_components       = 1;
+}
+
+/* Flips one payload byte of an entry, or cuts it short. */
+static bool damage_entry(const char *dir, const char *key,
+      const char *ext, bool truncate)
+{
+   char path[PATH_MAX_LENGTH];
+   char name[SLANG_CACHE_KEY_SIZE + 8];
+   void *buf   = NULL;
+   int64_t len = 0;
+   bool ret    = false;
+
+   strlcpy(name, key, sizeof(name));
+   strlcat(name, ext, sizeof(name));
+   fill_pathname_join(path, dir, name, sizeof(path));
+
+   if (!filestream_read_file(path, &buf, &len) || len < 40)
+      return false;
+
+   if (truncate)
+      len -= 4;
+   else
+      ((uint8_t*)buf)[len - 1] ^= 0x55;
+
+   ret = filestream_write_file(path, buf, len);
+   free(buf);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   char dir[PATH_MAX_LENGTH];
+   char key[SLANG_CACHE_KEY_SIZE];
+   char key2[SLANG_CACHE_KEY_SIZE];
+   const char *scratch = argc > 1 ? argv[1] : "slang_cache_test.tmp";
+   vector<uint32_t> vertex, fragment, vertex2, fragment2;
+   unordered_map<string, slang_semantic_map> map_a;
+   unordered_map<string, slang_semantic_map> map_b(64);
+   unsigned i;
+
+   if (!path_is_directory(scratch) && !path_mkdir(scratch))
+   {
+      printf("[ERROR]: could not create \"%s\"\n", scratch);
+      return 1;
+   }
+
+   /* slang_cache_dir */
+   check(!slang_cache_dir(dir, sizeof(dir)),
+         "no cache directory without a configured one");
+   strlcpy(test_settings.paths.directory_cache, scratch,
+         sizeof(test_settings.paths.directory_cache));
+   check(slang_cache_dir(dir, sizeof(dir)) && path_is_directory(dir),
+         "cache directory is created in the caller's buffer");
+
+   /* SPIR-V */
+   for (i = 0; i < 256; i++)
+   {
+      vertex.push_back(0x07230203 + i);
+      fragment.push_back(i * 2654435761u);
+   }
+
+   slang_cache_spirv_key(key,  "vertex source", "fragment source");
+   slang_cache_spirv_key(key2, "vertex source", "fragment source");
+   check(!strcmp(key, key2), "SPIR-V key is stable");
+   slang_cache_spirv_key(key2, "vertex source", "fragment source ");
+   check(!!strcmp(key, key2), "SPIR-V key follows the sources");
+   slang_cache_spirv_key(key2, "vertex sourcefragment", " source");
+   check(!!strcmp(key, key2), "SPIR-V key keeps the stages apart");
+
+   check(!slang_cache_load_spirv(dir, key, &vertex2, &fragment2),
+         "missing SPIR-V entry is a miss");
+   check(slang_cache_save_spirv(dir, key, vertex, fragment),
+         "SPIR-V entry is saved");
+   check(slang_cache_load_spirv(dir, key, &vertex2, &fragment2)
+         && vertex2 == vertex && fragment2 == fragment,
+         "SPIR-V entry round trips");
+   check(damage_entry(dir, key, ".spv", false)
+         && !slang_cache_load_spirv(dir, key, &vertex2, &fragment2),
+         "corrupted SPIR-V entry is rejected");
+   slang_cache_save_spirv(dir, key, vertex, fragment);
+   check(damage_entry(dir, key, ".spv", true)
+         && !slang_cache_load_spirv(dir, key, &vertex2, &fragment2),
+         "truncated SPIR-V entry is rejected");
+
+   /* Reflection. The two maps hold the same entries,
+    * inserted in a different order into different
+    * bucket counts. */
+   for (i = 0; i < 32; i++)
+   {
+      char name[32];
+      slang_semantic_map m = { SLANG_SEMANTIC_FLOAT_PARAMETER, i };
+      snprintf(name, sizeof(name), "param%u", i);
+      map_a[name] = m;
+   }
+   for (i = 32; i-- > 0; )
+   {
+      char name[32];
+      slang_semantic_map m = { SLANG_SEMANTIC_FLOAT_PARAMETER, i };
+      snprintf(name, sizeof(name), "param%u", i);
+      map_b[name] = m;
+   }
+
+   {
+      slang_reflection r, r2, r3;
+
+      r.semantic_map  = &map_a;
+      r2.semantic_map = &map_b;
+      r.pass_number   = r2.pass_number = 2;
+
+      slang_cache_reflection_key(key,  vertex, fragment, r);
+      slang_cache_reflection_key(key2, vertex, fragment, r2);
+      check(!strcmp(key, key2),
+            "reflection key ignores semantic map order");
+
+      map_b["param0"].index = 5;
+      slang_cache_reflection_key(key2, vertex, fragment, r2);
+      check(!!strcmp(key, key2),
+            "reflection key follows semantic map contents");
+      map_b["param0"].index = 0;
+
+      r2.pass_number = 3;
+      slang_cache_reflection_key(key2, vertex, fragment, r2);
+      check(!!strcmp(key, key2), "reflection key follows the pass");
+      r2.pass_number = 2;
+
+      fill_reflection(&r);
+      slang_cache_reflection_key(key2, vertex, fragment, r);
+      check(!strcmp(key, key2),
+            "reflection key ignores reflection results");
+
+      check(slang_cache_save_reflection(dir, key, r),
+            "reflection entry is saved");
+      check(slang_cache_load_reflection(dir, key, &r2)
+            && r2.ubo_size == r.ubo_size
+            && r2.push_constant_size == r.push_constant_size
+            && r2.semantics[SLANG_SEMANTIC_MVP].uniform
+            && r2.semantics[SLANG_SEMANTIC_MVP].num_components == 16
+            && r2.semantic_textures[SLANG_TEXTURE_SEMANTIC_ORIGINAL][0].binding == 3
+            && r2.semantic_textures[SLANG_TEXTURE_SEMANTIC_ORIGINAL][0].texture
+            && r2.semantic_float_parameters.size() == 2
+            && r2.semantic_float_parameters[1].push_constant
+            && r2.semantic_float_parameters[1].push_constant_offset == 8
+            && r2.semantic_map == &map_b && r2.pass_number == 2,
+            "reflection entry round trips and keeps its inputs");
+
+      check(damage_entry(dir, key, ".refl", false)
+            && !slang_cache_load_reflection(dir, key, &r3),
+            "corrupted reflection entry is rejected");
+   }
+
+   printf("\n%u failure(s)\n", failures);
+   return failures ? 1 : 0;
+}
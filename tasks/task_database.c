@@ -21,11 +21,16 @@
 #include <retro_endianness.h>
 #include <string/stdstring.h>
 #include <lists/dir_list.h>
+#include <lists/string_map.h>
 #include <file/file_path.h>
 #include <encodings/crc32.h>
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
@@ -43,6 +48,69 @@
 #define COLLECTION_SIZE                99999
 #endif
 
+#define DATABASE_SCAN_CACHE_MAGIC      "RASCANCACHE2"
+#define DATABASE_SCAN_MAX_TASKS        4
+
+/* Identification result for one entry of the scan list. Filled in
+ * by the hashing tasks (or by the scan task itself) and consumed
+ * by the scan task in list order. */
+typedef struct database_scan_job
+{
+   char *path;
+   char *serial;
+   int64_t size;
+   int64_t mtime;
+   uint32_t crc;
+   uint32_t archive_crc;
+   enum database_type type;
+   int rv;
+   bool stamped;
+   bool skip;
+   bool done;
+} database_scan_job_t;
+
+typedef struct database_scan_cache_entry
+{
+   char *path;
+   char *serial;
+   int64_t size;
+   int64_t mtime;
+   uint32_t crc;
+   uint32_t archive_crc;
+   unsigned type;
+   bool seen;
+} database_scan_cache_entry_t;
+
+/* Persistent (path, size, mtime) -> CRC/serial cache, stored
+ * next to the playlists. Read-only while the hashing tasks run. */
+typedef struct database_scan_cache
+{
+   database_scan_cache_entry_t *entries;
+   size_t count;
+   size_t capacity;
+   struct string_map map;
+   char path[PATH_MAX_LENGTH];
+} database_scan_cache_t;
+
+typedef struct database_scan_pool
+{
+   database_scan_job_t *jobs;
+   size_t count;
+   const database_scan_cache_t *cache;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+   scond_t *cond;
+   /* Hashing tasks that still hold a reference to the pool */
+   unsigned tasks;
+   /* Hashing tasks currently running a job */
+   unsigned busy;
+   size_t next;
+   bool quit;
+   /* Set once the scan task no longer uses the pool */
+   bool released;
+#endif
+} database_scan_pool_t;
+
 typedef struct database_state_handle
 {
    uint32_t crc;
@@ -61,11 +129,16 @@ typedef struct db_handle
    bool is_directory;
    bool scan_started;
    bool show_hidden_files;
+   bool scan_finished;
    unsigned status;
    char *playlist_directory;
    char *content_database_path;
    char *fullpath;
    database_info_handle_t *handle;
+   database_scan_cache_t *cache;
+   database_scan_pool_t *pool;
+   struct string_list *resume;
+   struct string_map resume_map;
    database_state_handle_t state;
 } db_handle_t;
 
@@ -609,71 +682,889 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+static void task_database_scan_cache_free(database_scan_cache_t *cache)
 {
+   size_t i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      free(cache->entries[i].path);
+      free(cache->entries[i].serial);
+   }
+
+   string_map_free(&cache->map);
+   free(cache->entries);
+   free(cache);
+}
+
+static database_scan_cache_entry_t *task_database_scan_cache_add(
+      database_scan_cache_t *cache, const char *path)
+{
+   database_scan_cache_entry_t *entry = NULL;
+
+   if (cache->count == cache->capacity)
+   {
+      size_t capacity = cache->capacity ? cache->capacity * 2 : 256;
+      database_scan_cache_entry_t *entries = (database_scan_cache_entry_t*)
+         realloc(cache->entries, capacity * sizeof(*entries));
+
+      if (!entries)
+         return NULL;
+
+      cache->entries  = entries;
+      cache->capacity = capacity;
+   }
+
+   entry = &cache->entries[cache->count];
+   memset(entry, 0, sizeof(*entry));
+   entry->path = strdup(path);
+
+   if (!entry->path || !string_map_insert(&cache->map,
+            entry->path, cache->count))
+   {
+      free(entry->path);
+      return NULL;
+   }
+
+   cache->count++;
+   return entry;
+}
+
+/* Serial and path may contain any byte, so backslash, tab,
+ * newline and carriage return are written as \\, \t, \n and \r.
+ * Returns false if 'dst' is too small. */
+static bool task_database_scan_cache_escape(char *dst, size_t len,
+      const char *src)
+{
+   size_t pos = 0;
+
+   for (; *src; src++)
+   {
+      char esc = '\0';
+
+      switch (*src)
+      {
+         case '\\':
+            esc = '\\';
+            break;
+         case '\t':
+            esc = 't';
+            break;
+         case '\n':
+            esc = 'n';
+            break;
+         case '\r':
+            esc = 'r';
+            break;
+      }
+
+      if (pos + (esc ? 2 : 1) >= len)
+         return false;
+
+      if (esc)
+      {
+         dst[pos++] = '\\';
+         dst[pos++] = esc;
+      }
+      else
+         dst[pos++] = *src;
+   }
+
+   dst[pos] = '\0';
+   return true;
+}
+
+/* Undoes task_database_scan_cache_escape() in place.
+ * Returns false on a malformed escape. */
+static bool task_database_scan_cache_unescape(char *s)
+{
+   char *dst = s;
+
+   for (; *s; s++)
+   {
+      if (*s != '\\')
+      {
+         *dst++ = *s;
+         continue;
+      }
+
+      switch (*++s)
+      {
+         case '\\':
+            *dst++ = '\\';
+            break;
+         case 't':
+            *dst++ = '\t';
+            break;
+         case 'n':
+            *dst++ = '\n';
+            break;
+         case 'r':
+            *dst++ = '\r';
+            break;
+         default:
+            return false;
+      }
+   }
+
+   *dst = '\0';
+   return true;
+}
+
+/* Cache file layout: a magic line, then one line per file:
+ * size \t mtime \t crc \t archive crc \t type \t serial \t path
+ * with serial and path escaped as above. */
+static database_scan_cache_t *task_database_scan_cache_load(
+      const char *playlist_directory)
+{
+   int64_t len                  = 0;
+   char *buf                    = NULL;
+   char *line                   = NULL;
+   database_scan_cache_t *cache = NULL;
+
+   if (string_is_empty(playlist_directory))
+      return NULL;
+
+   cache = (database_scan_cache_t*)calloc(1, sizeof(*cache));
+
+   if (!cache)
+      return NULL;
+
+   fill_pathname_join(cache->path, playlist_directory,
+         file_path_str(FILE_PATH_CONTENT_SCAN_CACHE), sizeof(cache->path));
+
+   if (!filestream_exists(cache->path) ||
+         !filestream_read_file(cache->path, (void**)&buf, &len))
+      return cache;
+
+   line = buf;
+
+   if (strncmp(line, DATABASE_SCAN_CACHE_MAGIC,
+            sizeof(DATABASE_SCAN_CACHE_MAGIC) - 1))
+   {
+      RARCH_WARN("[Scan]: Ignoring unrecognised cache file %s.\n",
+            cache->path);
+      free(buf);
+      return cache;
+   }
+
+   while (line && *line)
+   {
+      char *fields[7];
+      unsigned i;
+      char *next = strchr(line, '\n');
+      database_scan_cache_entry_t *entry = NULL;
+
+      if (next)
+         *next++ = '\0';
+
+      fields[0] = line;
+      for (i = 1; i < 7; i++)
+      {
+         fields[i] = strchr(fields[i - 1], '\t');
+         if (!fields[i])
+            break;
+         *fields[i]++ = '\0';
+      }
+
+      if (     i == 7
+            && !string_is_empty(fields[6])
+            && task_database_scan_cache_unescape(fields[5])
+            && task_database_scan_cache_unescape(fields[6]))
+         entry = task_database_scan_cache_add(cache, fields[6]);
+
+      if (entry)
+      {
+         entry->size        = strtoll(fields[0], NULL, 10);
+         entry->mtime       = strtoll(fields[1], NULL, 10);
+         entry->crc         = (uint32_t)strtoul(fields[2], NULL, 16);
+         entry->archive_crc = (uint32_t)strtoul(fields[3], NULL, 16);
+         entry->type        = (unsigned)strtoul(fields[4], NULL, 10);
+         entry->serial      = string_is_empty(fields[5])
+            ? NULL : strdup(fields[5]);
+      }
+
+      line = next;
+   }
+
+   free(buf);
+
+   RARCH_LOG("[Scan]: Loaded " STRING_REP_USIZE " cached entries from %s.\n",
+         (size_t)cache->count, cache->path);
+
+   return cache;
+}
+
+static bool task_database_scan_cache_lookup(
+      const database_scan_cache_t *cache, database_scan_job_t *job)
+{
+   size_t idx;
+   const database_scan_cache_entry_t *entry = NULL;
+
+   if (!cache || !job->stamped ||
+         !string_map_find(&cache->map, job->path, &idx))
+      return false;
+
+   entry = &cache->entries[idx];
+
+   if (entry->size != job->size || entry->mtime != job->mtime)
+      return false;
+
+   job->crc         = entry->crc;
+   job->archive_crc = entry->archive_crc;
+   job->type        = (enum database_type)entry->type;
+   job->serial      = entry->serial ? strdup(entry->serial) : NULL;
+   job->rv          = 1;
+   return true;
+}
+
+static void task_database_scan_cache_store(database_scan_cache_t *cache,
+      const database_scan_job_t *job)
+{
+   size_t idx;
+   database_scan_cache_entry_t *entry = NULL;
+
+   bool valid = job->done && job->stamped && job->rv == 1;
+
+   if (!cache || !job->path)
+      return;
+
+   if (string_map_find(&cache->map, job->path, &idx))
+      entry = &cache->entries[idx];
+   else if (valid)
+      entry = task_database_scan_cache_add(cache, job->path);
+
+   if (!entry)
+      return;
+
+   entry->seen = true;
+
+   /* Skipped files keep their entry; failed reads are not cached,
+    * so the file is retried next time */
+   if (!valid)
+      return;
+
+   entry->size        = job->size;
+   entry->mtime       = job->mtime;
+   entry->crc         = job->crc;
+   entry->archive_crc = job->archive_crc;
+   entry->type        = job->type;
+
+   free(entry->serial);
+   entry->serial      = job->serial ? strdup(job->serial) : NULL;
+}
+
+/* Writes the cache back to disk. After a completed scan of a
+ * directory, entries below it that were not seen are dropped. */
+static void task_database_scan_cache_write(database_scan_cache_t *cache,
+      const char *scan_root)
+{
+   size_t i;
+   int len;
+   RFILE *file     = NULL;
+   size_t root_len = scan_root ? strlen(scan_root) : 0;
+   char tmp_path[PATH_MAX_LENGTH];
+   char serial[512];
+   char path[PATH_MAX_LENGTH * 2];
+   char line[PATH_MAX_LENGTH * 2 + 640];
+
+   if (!cache)
+      return;
+
+   tmp_path[0] = '\0';
+   strlcpy(tmp_path, cache->path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   file = filestream_open(tmp_path, RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+   {
+      RARCH_ERR("[Scan]: Failed to write cache file %s.\n", tmp_path);
+      return;
+   }
+
+   filestream_write(file, DATABASE_SCAN_CACHE_MAGIC "\n",
+         sizeof(DATABASE_SCAN_CACHE_MAGIC));
+
+   for (i = 0; i < cache->count; i++)
+   {
+      const database_scan_cache_entry_t *entry = &cache->entries[i];
+
+      if (     root_len
+            && !entry->seen
+            && !strncmp(entry->path, scan_root, root_len)
+            && (     path_char_is_slash(entry->path[root_len])
+                  || path_char_is_slash(scan_root[root_len - 1])))
+         continue;
+
+      if (     !task_database_scan_cache_escape(serial, sizeof(serial),
+               entry->serial ? entry->serial : "")
+            || !task_database_scan_cache_escape(path, sizeof(path),
+               entry->path))
+         continue;
+
+      len = snprintf(line, sizeof(line),
+            STRING_REP_INT64 "\t" STRING_REP_INT64 "\t%08x\t%08x\t%u\t%s\t%s\n",
+            entry->size, entry->mtime, entry->crc, entry->archive_crc,
+            entry->type, serial, path);
+
+      if (len > 0 && len < (int)sizeof(line))
+         filestream_write(file, line, len);
+   }
+
+   filestream_close(file);
+
+   filestream_delete(cache->path);
+   filestream_rename(tmp_path, cache->path);
+}
+
+/* Identifies a single file: serial for disc images where possible,
+ * otherwise the CRC of the relevant data. Only touches the job, so
+ * it is safe to run in the hashing tasks. */
+static void task_database_identify(database_scan_job_t *job)
+{
+   char serial[4096];
+   const char *name = job->path;
+
+   serial[0]        = '\0';
+   job->type        = DATABASE_TYPE_ITERATE;
+   job->rv          = 1;
+
    switch (extension_to_file_type(path_get_extension(name)))
    {
       case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
+         job->type = DATABASE_TYPE_CRC_LOOKUP;
          /* first check crc of archive itself */
-         return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
-#else
-         break;
+         job->rv   = intfstream_file_get_crc(name,
+               0, SIZE_MAX, &job->archive_crc);
 #endif
+         break;
       case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (task_database_cue_get_serial(name, serial))
+            job->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_cue_get_crc(name, &db_state->crc);
+            job->type = DATABASE_TYPE_CRC_LOOKUP;
+            job->rv   = task_database_cue_get_crc(name, &job->crc);
          }
          break;
       case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
          /* There are no serial databases, so don't bother with
             serials at the moment */
-         if (0 && task_database_gdi_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (0 && task_database_gdi_get_serial(name, serial))
+            job->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_gdi_get_crc(name, &db_state->crc);
+            job->type = DATABASE_TYPE_CRC_LOOKUP;
+            job->rv   = task_database_gdi_get_crc(name, &job->crc);
          }
          break;
       /* Consider Wii WBFS files similar to ISO files. */
       case FILE_TYPE_WBFS:
       case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial);
-         database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         intfstream_file_get_serial(name, 0, SIZE_MAX, serial);
+         job->type = DATABASE_TYPE_SERIAL_LOOKUP;
          break;
       case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (task_database_chd_get_serial(name, serial))
+            job->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_chd_get_crc(name, &db_state->crc);
+            job->type = DATABASE_TYPE_CRC_LOOKUP;
+            job->rv   = task_database_chd_get_crc(name, &job->crc);
          }
          break;
       case FILE_TYPE_LUTRO:
-         database_info_set_type(db, DATABASE_TYPE_ITERATE_LUTRO);
+         job->type = DATABASE_TYPE_ITERATE_LUTRO;
          break;
       default:
-         database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         job->type = DATABASE_TYPE_CRC_LOOKUP;
+         job->rv   = intfstream_file_get_crc(name, 0, SIZE_MAX, &job->crc);
+         break;
    }
 
-   return 1;
+   if (job->type == DATABASE_TYPE_SERIAL_LOOKUP && !string_is_empty(serial))
+      job->serial = strdup(serial);
+}
+
+static void task_database_scan_job_run(
+      const database_scan_cache_t *cache, database_scan_job_t *job)
+{
+   job->stamped = path_get_stamp(job->path,
+         &job->size, &job->mtime);
+
+   if (!task_database_scan_cache_lookup(cache, job))
+      task_database_identify(job);
+}
+
+#ifdef HAVE_THREADS
+static void task_database_scan_pool_release(database_scan_pool_t *pool)
+{
+   slock_free(pool->lock);
+   scond_free(pool->cond);
+   free(pool);
+}
+
+/* Hashes one job ahead of the scan task per call, on whichever
+ * worker the task queue runs it. */
+static void task_database_scan_hash_handler(retro_task_t *task)
+{
+   database_scan_pool_t *pool = (database_scan_pool_t*)task->state;
+   database_scan_job_t *job   = NULL;
+   bool cancelled             = task_get_cancelled(task);
+   bool last                  = false;
+
+   slock_lock(pool->lock);
+   if (!pool->quit && !cancelled)
+   {
+      while (pool->next < pool->count && pool->jobs[pool->next].skip)
+         pool->next++;
+      if (pool->next < pool->count)
+      {
+         job = &pool->jobs[pool->next++];
+         pool->busy++;
+      }
+   }
+   slock_unlock(pool->lock);
+
+   if (job)
+   {
+      task_database_scan_job_run(pool->cache, job);
+
+      slock_lock(pool->lock);
+      job->done = true;
+      pool->busy--;
+      scond_broadcast(pool->cond);
+      slock_unlock(pool->lock);
+      return;
+   }
+
+   slock_lock(pool->lock);
+   pool->tasks--;
+   last = pool->released && !pool->tasks;
+   slock_unlock(pool->lock);
+
+   task_set_finished(task, true);
+
+   if (last)
+      task_database_scan_pool_release(pool);
+}
+#endif
+
+/* Marks files that a cue/gdi sheet earlier in the list refers to.
+ * The scan task prunes those when it reaches the sheet, so the
+ * hashing tasks should not spend time on them. */
+static void task_database_scan_pool_skip_tracks(database_scan_pool_t *pool)
+{
+   size_t i;
+   struct string_map map;
+   char *path = NULL;
+
+   memset(&map, 0, sizeof(map));
+
+   for (i = 0; i < pool->count; i++)
+   {
+      enum msg_file_type type = extension_to_file_type(
+            path_get_extension(pool->jobs[i].path));
+
+      if (type != FILE_TYPE_CUE && type != FILE_TYPE_GDI)
+         continue;
+
+      if (!map.count)
+      {
+         size_t j;
+         for (j = 0; j < pool->count; j++)
+            string_map_insert(&map, pool->jobs[j].path, j);
+         path = (char*)malloc(PATH_MAX_LENGTH + 1);
+         if (!path)
+            break;
+      }
+
+      {
+         size_t idx;
+         intfstream_t *fd = intfstream_open_file(pool->jobs[i].path,
+               RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+         if (!fd)
+            continue;
+
+         while (type == FILE_TYPE_CUE
+               ? cue_next_file(fd, pool->jobs[i].path, path, PATH_MAX_LENGTH)
+               : gdi_next_file(fd, pool->jobs[i].path, path, PATH_MAX_LENGTH))
+         {
+            if (string_map_find(&map, path, &idx) && idx > i)
+               pool->jobs[idx].skip = true;
+         }
+
+         intfstream_close(fd);
+         free(fd);
+      }
+   }
+
+   free(path);
+   string_map_free(&map);
+}
+
+static database_scan_pool_t *task_database_scan_pool_new(
+      db_handle_t *db, const struct string_list *list)
+{
+   size_t i;
+   database_scan_pool_t *pool = NULL;
+
+   if (!list || !list->size)
+      return NULL;
+
+   pool = (database_scan_pool_t*)calloc(1, sizeof(*pool));
+
+   if (!pool)
+      return NULL;
+
+   pool->jobs  = (database_scan_job_t*)calloc(list->size,
+         sizeof(*pool->jobs));
+   pool->count = list->size;
+   pool->cache = db->cache;
+
+   if (!pool->jobs)
+   {
+      free(pool);
+      return NULL;
+   }
+
+   for (i = 0; i < pool->count; i++)
+   {
+      /* Private copy, the list entries may be pruned while the
+       * hashing tasks are running. */
+      pool->jobs[i].path = strdup(list->elems[i].data);
+      pool->jobs[i].skip = !pool->jobs[i].path
+         || string_map_find(&db->resume_map,
+               pool->jobs[i].path, NULL);
+   }
+
+   task_database_scan_pool_skip_tracks(pool);
+
+#ifdef HAVE_THREADS
+   /* The scan task identifies entries itself as it reaches them;
+    * when the task queue has workers to spare, hashing tasks work
+    * through the rest of the list ahead of it. */
+   if (pool->count > 1 && task_queue_is_threaded())
+   {
+      task_queue_stats_t stats;
+      unsigned tasks = 0;
+
+      task_queue_get_stats(&stats);
+
+      if (stats.workers > 1)
+         tasks = stats.workers - 1;
+      if (tasks > DATABASE_SCAN_MAX_TASKS)
+         tasks = DATABASE_SCAN_MAX_TASKS;
+
+      if (tasks)
+      {
+         pool->lock  = slock_new();
+         pool->cond  = scond_new();
+         pool->tasks = tasks;
+
+         if (!pool->lock || !pool->cond)
+         {
+            if (pool->lock)
+               slock_free(pool->lock);
+            if (pool->cond)
+               scond_free(pool->cond);
+            pool->lock  = NULL;
+            pool->cond  = NULL;
+            pool->tasks = 0;
+            tasks       = 0;
+         }
+      }
+
+      if (tasks)
+         RARCH_LOG("[Scan]: Hashing " STRING_REP_USIZE
+               " files with %u background tasks.\n",
+               (size_t)pool->count, tasks);
+
+      for (i = 0; i < tasks; i++)
+      {
+         retro_task_t *t = task_init();
+
+         if (!t)
+         {
+            slock_lock(pool->lock);
+            pool->tasks--;
+            slock_unlock(pool->lock);
+            continue;
+         }
+
+         t->handler  = task_database_scan_hash_handler;
+         t->state    = pool;
+         t->mute     = true;
+         t->priority = TASK_PRIORITY_BACKGROUND;
+
+         task_queue_push(t);
+      }
+
+   }
+#endif
+
+   return pool;
+}
+
+/* Returns the result for list entry 'index', or NULL if a
+ * hashing task is still working on it. */
+static database_scan_job_t *task_database_scan_pool_get(
+      database_scan_pool_t *pool, size_t index)
+{
+   database_scan_job_t *job = &pool->jobs[index];
+
+#ifdef HAVE_THREADS
+   if (pool->lock && !job->skip)
+   {
+      bool done  = false;
+      bool taken = false;
+
+      slock_lock(pool->lock);
+      /* Not picked up by a hashing task yet, so take it here
+       * rather than wait for one to get to it */
+      if (!job->done && index >= pool->next)
+      {
+         pool->next = index + 1;
+         taken      = true;
+      }
+      done = job->done;
+      slock_unlock(pool->lock);
+
+      if (!done && !taken)
+         return NULL;
+   }
+#endif
+
+   /* Nothing else touches skipped jobs, jobs taken above,
+    * nor any job without hashing tasks */
+   if (!job->done && job->path)
+   {
+      task_database_scan_job_run(pool->cache, job);
+      job->done = true;
+   }
+
+   return job;
+}
+
+/* Stops the hashing tasks and folds every finished result into
+ * the cache, including ones the scan task never got to. */
+static void task_database_scan_pool_free(database_scan_pool_t *pool,
+      database_scan_cache_t *cache)
+{
+   size_t i;
+
+   if (!pool)
+      return;
+
+#ifdef HAVE_THREADS
+   /* The hashing tasks read the cache, wait for the jobs
+    * they are running before it changes below */
+   if (pool->lock)
+   {
+      slock_lock(pool->lock);
+      pool->quit = true;
+      while (pool->busy)
+         scond_wait(pool->cond, pool->lock);
+      slock_unlock(pool->lock);
+   }
+#endif
+
+   for (i = 0; i < pool->count; i++)
+   {
+      task_database_scan_cache_store(cache, &pool->jobs[i]);
+      free(pool->jobs[i].path);
+      free(pool->jobs[i].serial);
+   }
+
+   free(pool->jobs);
+   pool->jobs  = NULL;
+   pool->count = 0;
+
+#ifdef HAVE_THREADS
+   /* Hashing tasks that have not noticed the scan is over
+    * yet free the pool when they do */
+   if (pool->lock)
+   {
+      bool last;
+
+      slock_lock(pool->lock);
+      pool->released = true;
+      last           = !pool->tasks;
+      slock_unlock(pool->lock);
+
+      if (last)
+         task_database_scan_pool_release(pool);
+      return;
+   }
+#endif
+
+   free(pool);
+}
+
+/* The resume file lists the entries a cancelled scan already
+ * processed; it only applies to a rescan of the same path. */
+static void task_database_scan_resume_load(db_handle_t *db)
+{
+   size_t i;
+   int64_t len = 0;
+   char *buf   = NULL;
+   char path[PATH_MAX_LENGTH];
+
+   path[0] = '\0';
+
+   if (string_is_empty(db->playlist_directory))
+      return;
+
+   fill_pathname_join(path, db->playlist_directory,
+         file_path_str(FILE_PATH_CONTENT_SCAN_RESUME), sizeof(path));
+
+   if (!filestream_exists(path) ||
+         !filestream_read_file(path, (void**)&buf, &len))
+      return;
+
+   db->resume = string_split(buf, "\n");
+   free(buf);
+
+   if (!db->resume)
+      return;
+
+   if (     db->resume->size < 2
+         || !string_is_equal(db->resume->elems[0].data, db->fullpath))
+   {
+      string_list_free(db->resume);
+      db->resume = NULL;
+      return;
+   }
+
+   for (i = 1; i < db->resume->size; i++)
+      string_map_insert(&db->resume_map,
+            db->resume->elems[i].data, i);
+
+   RARCH_LOG("[Scan]: Resuming scan of %s, skipping "
+         STRING_REP_USIZE " files.\n",
+         db->fullpath, (size_t)(db->resume->size - 1));
+}
+
+static void task_database_scan_resume_write(db_handle_t *db)
+{
+   size_t i;
+   RFILE *file                   = NULL;
+   database_info_handle_t *dbinfo = db->handle;
+   char path[PATH_MAX_LENGTH];
+
+   path[0] = '\0';
+
+   if (string_is_empty(db->playlist_directory))
+      return;
+
+   fill_pathname_join(path, db->playlist_directory,
+         file_path_str(FILE_PATH_CONTENT_SCAN_RESUME), sizeof(path));
+
+   if (db->scan_finished)
+   {
+      if (db->resume)
+         filestream_delete(path);
+      return;
+   }
+
+   if (!dbinfo || !dbinfo->list)
+      return;
+
+   file = filestream_open(path, RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return;
+
+   filestream_write(file, db->fullpath, strlen(db->fullpath));
+   filestream_putc(file, '\n');
+
+   for (i = 0; i < dbinfo->list->size; i++)
+   {
+      const char *entry = dbinfo->list->elems[i].data;
+
+      if (!entry)
+         continue;
+      if (i < dbinfo->list_ptr
+            || string_map_find(&db->resume_map, entry, NULL))
+      {
+         filestream_write(file, entry, strlen(entry));
+         filestream_putc(file, '\n');
+      }
+   }
+
+   filestream_close(file);
+}
+
+static int task_database_iterate_playlist(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name)
+{
+   int rv;
+   database_scan_job_t local;
+   database_scan_job_t *job     = NULL;
+   enum msg_file_type file_type = extension_to_file_type(
+         path_get_extension(name));
+   bool resumed                 = string_map_find(
+         &_db->resume_map, name, NULL);
+
+   if (!resumed)
+   {
+      if (_db->pool && db->list_ptr < _db->pool->count)
+      {
+         job = task_database_scan_pool_get(_db->pool, db->list_ptr);
+
+         /* Still being hashed, try again on the next iteration */
+         if (!job)
+            return 1;
+      }
+      else
+      {
+         /* Archive members appended after the scan list was built */
+         memset(&local, 0, sizeof(local));
+         local.path = (char*)name;
+         task_database_scan_job_run(_db->cache, &local);
+         job        = &local;
+      }
+   }
+
+   switch (file_type)
+   {
+      case FILE_TYPE_CUE:
+         task_database_cue_prune(db, name);
+         break;
+      case FILE_TYPE_GDI:
+         gdi_prune(db, name);
+         break;
+      default:
+         break;
+   }
+
+   /* Already processed before the previous scan was cancelled */
+   if (resumed)
+      return 0;
+
+   db_state->serial[0]   = '\0';
+   if (job->serial)
+      strlcpy(db_state->serial, job->serial, sizeof(db_state->serial));
+   db_state->crc         = job->crc;
+   db_state->archive_crc = job->archive_crc;
+   rv                    = job->rv;
+
+   database_info_set_type(db, job->type);
+
+   if (job == &local)
+      free(local.serial);
+
+   return rv;
 }
 
 static int database_info_list_iterate_end_no_match(
@@ -1115,7 +2006,7 @@ static int task_database_iterate(
    switch (database_info_get_type(db))
    {
       case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
+         return task_database_iterate_playlist(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_ARCHIVE:
          return task_database_iterate_playlist_archive(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_LUTRO:
@@ -1234,6 +2125,11 @@ static void task_database_handler(retro_task_t *task)
                }
             }
          }
+
+         db->cache      = task_database_scan_cache_load(db->playlist_directory);
+         task_database_scan_resume_load(db);
+         db->pool       = task_database_scan_pool_new(db, dbinfo->list);
+
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
       case DATABASE_STATUS_ITERATE_START:
@@ -1263,6 +2159,7 @@ static void task_database_handler(retro_task_t *task)
                msg = msg_hash_to_str(MSG_SCANNING_OF_DIRECTORY_FINISHED);
             else
                msg = msg_hash_to_str(MSG_SCANNING_OF_FILE_FINISHED);
+            db->scan_finished = true;
 #ifdef RARCH_INTERNAL
             runloop_msg_queue_push(msg, 0, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
 #else
@@ -1291,6 +2188,15 @@ task_finished:
 
    if (db)
    {
+      task_database_scan_pool_free(db->pool, db->cache);
+      task_database_scan_cache_write(db->cache,
+            (db->scan_finished && db->is_directory) ? db->fullpath : NULL);
+      task_database_scan_cache_free(db->cache);
+      task_database_scan_resume_write(db);
+      string_map_free(&db->resume_map);
+      if (db->resume)
+         string_list_free(db->resume);
+
       if (!string_is_empty(db->playlist_directory))
          free(db->playlist_directory);
       if (!string_is_empty(db->content_database_path))
@@ -1327,6 +2233,7 @@ bool task_push_dbscan(
    t->state                  = db;
    t->callback               = cb;
    t->title                  = strdup(msg_hash_to_str(MSG_PREPARING_FOR_CONTENT_SCAN));
+   t->priority               = TASK_PRIORITY_BACKGROUND;
 
    db->show_hidden_files     = db_dir_show_hidden_files;
    db->is_directory          = directory;
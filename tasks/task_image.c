@@ -287,7 +287,9 @@ bool task_image_load_handler(retro_task_t *task)
    return true;
 }
 
-bool task_push_image_load(const char *fullpath, retro_task_callback_t cb, void *user_data)
+static retro_task_t *task_image_load_push(const char *fullpath,
+      enum task_priority priority,
+      retro_task_callback_t cb, void *user_data)
 {
    nbio_handle_t             *nbio   = NULL;
    struct nbio_image_handle   *image = NULL;
@@ -364,10 +366,11 @@ bool task_push_image_load(const char *fullpath, retro_task_callback_t cb, void *
    t->cleanup         = task_image_load_free;
    t->callback        = cb;
    t->user_data       = user_data;
+   t->priority        = priority;
 
    task_queue_push(t);
 
-   return true;
+   return t;
 
 error:
    task_image_load_free(t);
@@ -383,5 +386,18 @@ error_msg:
    RARCH_ERR("[image load] Failed to open '%s': %s.\n",
          fullpath, strerror(errno));
 
-   return false;
+   return NULL;
+}
+
+bool task_push_image_load(const char *fullpath, retro_task_callback_t cb, void *user_data)
+{
+   return task_image_load_push(fullpath,
+         TASK_PRIORITY_INTERACTIVE, cb, user_data) != NULL;
+}
+
+void *task_push_image_load_priority(const char *fullpath,
+      enum task_priority priority,
+      retro_task_callback_t cb, void *user_data)
+{
+   return task_image_load_push(fullpath, priority, cb, user_data);
 }
@@ -27,6 +27,7 @@
 #include <errno.h>
 
 #include <compat/strl.h>
+#include <memalign.h>
 #include <retro_assert.h>
 #include <lists/string_list.h>
 #include <streams/interface_stream.h>
@@ -50,12 +51,24 @@
 #include "../configuration.h"
 #include "../gfx/video_driver.h"
 #include "../msg_hash.h"
+#include "../paths.h"
 #include "../retroarch.h"
 #include "../verbosity.h"
 #include "tasks_internal.h"
 #include "../managers/cheat_manager.h"
+#include "../managers/savestate_file.h"
 
-#define SAVE_STATE_CHUNK 4096
+/* Bytes written per handler call. Large enough that a 16 MB state
+ * does not take thousands of handler calls, small enough that the
+ * non-threaded task queue does not stall a frame on it. */
+#define SAVE_STATE_CHUNK (256 * 1024)
+
+/* Savestate buffers kept around between saves. Two lets one state be
+ * serialized while the previous one is still being written out. */
+#define SAVE_STATE_POOL_BUFFERS 2
+#define SAVE_STATE_POOL_ALIGN   4096
+
+#define SAVE_FILE_TMP_EXTENSION ".tmp"
 
 static bool save_state_in_background = false;
 static struct string_list *task_save_files = NULL;
@@ -80,10 +93,21 @@ struct sram_block
    size_t size;
 };
 
+struct save_state_pool_buf
+{
+   void *data;
+   size_t capacity;
+   bool in_use;
+};
+
 typedef struct
 {
    intfstream_t *file;
+   savestate_file_writer_t *writer;
+   savestate_file_reader_t *reader;
    char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   char meta[1024];
    void *data;
    void *undo_data;
    ssize_t size;
@@ -95,6 +119,7 @@ typedef struct
    bool autosave;
    bool undo_save;
    bool mute;
+   bool compress;
    int state_slot;
    bool thumbnail_enable;
    bool has_valid_framebuffer;
@@ -110,6 +135,209 @@ static struct save_state_buf undo_save_buf;
  * Can be restored with undo_load_state(). */
 static struct save_state_buf undo_load_buf;
 
+/* Page-aligned serialization buffers reused across saves and loads,
+ * so a quick save does not fault in a fresh multi-megabyte
+ * allocation on the main thread every time. */
+static struct save_state_pool_buf save_state_pool[SAVE_STATE_POOL_BUFFERS];
+#ifdef HAVE_THREADS
+static slock_t *save_state_pool_lock = NULL;
+#endif
+
+/**
+ * save_state_pool_acquire:
+ * @size            : number of bytes needed
+ *
+ * Takes a free pool buffer of at least @size bytes, growing one if
+ * needed. Falls back to a plain allocation when every pool buffer
+ * is in use. Release the result with save_state_pool_release().
+ *
+ * Returns: pointer to buffer, or NULL on allocation failure.
+ **/
+static void *save_state_pool_acquire(size_t size)
+{
+   unsigned i;
+   struct save_state_pool_buf *slot = NULL;
+   void *data                       = NULL;
+
+#ifdef HAVE_THREADS
+   if (!save_state_pool_lock)
+      return malloc(size);
+   slock_lock(save_state_pool_lock);
+#endif
+
+   for (i = 0; i < SAVE_STATE_POOL_BUFFERS; i++)
+   {
+      struct save_state_pool_buf *buf = &save_state_pool[i];
+
+      if (buf->in_use)
+         continue;
+      if (buf->capacity >= size)
+      {
+         slot = buf;
+         break;
+      }
+      if (!slot)
+         slot = buf;
+   }
+
+   if (slot)
+   {
+      if (slot->capacity < size)
+      {
+         size_t capacity = (size + SAVE_STATE_POOL_ALIGN - 1)
+            & ~((size_t)SAVE_STATE_POOL_ALIGN - 1);
+
+         if (slot->data)
+            memalign_free(slot->data);
+         slot->capacity = 0;
+         slot->data     = memalign_alloc(SAVE_STATE_POOL_ALIGN, capacity);
+         if (slot->data)
+            slot->capacity = capacity;
+      }
+
+      if (slot->data)
+      {
+         slot->in_use = true;
+         data         = slot->data;
+      }
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(save_state_pool_lock);
+#endif
+
+   if (!data)
+      data = malloc(size);
+
+   return data;
+}
+
+/**
+ * save_state_pool_release:
+ * @data            : buffer from save_state_pool_acquire()
+ *
+ * Returns a pool buffer to the pool, or frees a fallback
+ * allocation. Safe to call from task threads.
+ **/
+static void save_state_pool_release(void *data)
+{
+   unsigned i;
+
+   if (!data)
+      return;
+
+#ifdef HAVE_THREADS
+   if (save_state_pool_lock)
+      slock_lock(save_state_pool_lock);
+#endif
+
+   for (i = 0; i < SAVE_STATE_POOL_BUFFERS; i++)
+   {
+      if (save_state_pool[i].data == data)
+      {
+         save_state_pool[i].in_use = false;
+         data                      = NULL;
+         break;
+      }
+   }
+
+#ifdef HAVE_THREADS
+   if (save_state_pool_lock)
+      slock_unlock(save_state_pool_lock);
+#endif
+
+   if (data)
+      free(data);
+}
+
+/**
+ * save_state_pool_reset:
+ *
+ * Frees every pool buffer that is not held by a running task.
+ **/
+static void save_state_pool_reset(void)
+{
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   if (!save_state_pool_lock)
+      save_state_pool_lock = slock_new();
+   if (save_state_pool_lock)
+      slock_lock(save_state_pool_lock);
+#endif
+
+   for (i = 0; i < SAVE_STATE_POOL_BUFFERS; i++)
+   {
+      struct save_state_pool_buf *buf = &save_state_pool[i];
+
+      if (buf->in_use || !buf->data)
+         continue;
+
+      memalign_free(buf->data);
+      buf->data     = NULL;
+      buf->capacity = 0;
+   }
+
+#ifdef HAVE_THREADS
+   if (save_state_pool_lock)
+      slock_unlock(save_state_pool_lock);
+#endif
+}
+
+/**
+ * save_file_commit:
+ * @tmp_path        : fully written temporary file
+ * @path            : destination path
+ *
+ * Moves @tmp_path over @path, so an interrupted or failed write
+ * never leaves a truncated file behind. rename() replaces the
+ * destination atomically on POSIX; Windows refuses to rename over
+ * an existing file, so delete it first there.
+ *
+ * Returns: true if successful, false otherwise.
+ **/
+static bool save_file_commit(const char *tmp_path, const char *path)
+{
+   if (filestream_rename(tmp_path, path) == 0)
+      return true;
+
+   if (     filestream_exists(path)
+         && filestream_delete(path) == 0
+         && filestream_rename(tmp_path, path) == 0)
+      return true;
+
+   filestream_delete(tmp_path);
+   return false;
+}
+
+/**
+ * save_file_write_atomic:
+ * @path            : destination path
+ * @data            : data to write
+ * @size            : size of @data
+ *
+ * Writes @data to a temporary file next to @path, then
+ * renames it into place.
+ *
+ * Returns: true if successful, false otherwise.
+ **/
+static bool save_file_write_atomic(const char *path,
+      const void *data, size_t size)
+{
+   char tmp_path[PATH_MAX_LENGTH];
+
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, SAVE_FILE_TMP_EXTENSION, sizeof(tmp_path));
+
+   if (!filestream_write_file(tmp_path, data, size))
+   {
+      filestream_delete(tmp_path);
+      return false;
+   }
+
+   return save_file_commit(tmp_path, path);
+}
+
 #ifdef HAVE_THREADS
 typedef struct autosave autosave_t;
 
@@ -125,7 +353,11 @@ struct autosave
    volatile bool quit;
    size_t bufsize;
    unsigned interval;
+   /* last contents written to disk */
    void *buffer;
+   /* snapshot of the core's SRAM; swapped with
+    * buffer whenever it differs */
+   void *back_buffer;
    const void *retro_buffer;
    const char *path;
    slock_t *lock;
@@ -151,40 +383,34 @@ static void autosave_thread(void *data)
    {
       bool differ;
 
+      /* Only the copy runs under the lock, which the main
+       * thread also takes around core_run(); the comparison
+       * is done afterwards on the private snapshot. */
       slock_lock(save->lock);
-      differ = string_is_not_equal_fast(save->buffer, save->retro_buffer,
-            save->bufsize);
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
+      memcpy(save->back_buffer, save->retro_buffer, save->bufsize);
       slock_unlock(save->lock);
 
+      differ = string_is_not_equal_fast(save->buffer, save->back_buffer,
+            save->bufsize);
+
       if (differ)
       {
-         /* Should probably deal with this more elegantly. */
-         intfstream_t *file = intfstream_open_file(save->path,
-               RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+         void *tmp         = save->buffer;
+         save->buffer      = save->back_buffer;
+         save->back_buffer = tmp;
 
-         if (file)
+         /* Avoid spamming down stderr ... */
+         if (first_log)
          {
-            bool failed = false;
-
-            /* Avoid spamming down stderr ... */
-            if (first_log)
-            {
-               RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
-                     save->path, save->interval);
-               first_log = false;
-            }
-            else
-               RARCH_LOG("SRAM changed ... autosaving ...\n");
-
-            failed |= ((size_t)intfstream_write(file, save->buffer, save->bufsize) != save->bufsize);
-            failed |= (intfstream_flush(file) != 0);
-            failed |= (intfstream_close(file) != 0);
-            free(file);
-            if (failed)
-               RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
+            RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
+                  save->path, save->interval);
+            first_log = false;
          }
+         else
+            RARCH_LOG("SRAM changed ... autosaving ...\n");
+
+         if (!save_file_write_atomic(save->path, save->buffer, save->bufsize))
+            RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
       }
 
       slock_lock(save->cond_lock);
@@ -224,10 +450,11 @@ static autosave_t *autosave_new(const char *path,
    handle->bufsize               = size;
    handle->interval              = interval;
    handle->buffer                = malloc(size);
+   handle->back_buffer           = malloc(size);
    handle->retro_buffer          = data;
    handle->path                  = path;
 
-   if (!handle->buffer)
+   if (!handle->buffer || !handle->back_buffer)
       goto error;
 
    memcpy(handle->buffer, handle->retro_buffer, handle->bufsize);
@@ -241,7 +468,13 @@ static autosave_t *autosave_new(const char *path,
 
 error:
    if (handle)
+   {
+      if (handle->buffer)
+         free(handle->buffer);
+      if (handle->back_buffer)
+         free(handle->back_buffer);
       free(handle);
+   }
    return NULL;
 }
 
@@ -265,7 +498,10 @@ static void autosave_free(autosave_t *handle)
 
    if (handle->buffer)
       free(handle->buffer);
-   handle->buffer = NULL;
+   if (handle->back_buffer)
+      free(handle->back_buffer);
+   handle->buffer      = NULL;
+   handle->back_buffer = NULL;
 }
 
 bool autosave_init(void)
@@ -539,12 +775,26 @@ static void task_save_handler_finished(retro_task_t *task,
 
    task_set_finished(task, true);
 
-   intfstream_close(state->file);
-   free(state->file);
+   if (state->writer)
+   {
+      savestate_file_writer_free(state->writer);
+      state->writer = NULL;
+   }
+
+   if (state->file)
+   {
+      intfstream_close(state->file);
+      free(state->file);
+      state->file = NULL;
+   }
 
    if (!task_get_error(task) && task_get_cancelled(task))
       task_set_error(task, strdup("Task canceled"));
 
+   /* Never leave a partial state behind */
+   if (task_get_error(task) && !string_is_empty(state->tmp_path))
+      filestream_delete(state->tmp_path);
+
    task_data = (save_task_state_t*)calloc(1, sizeof(*task_data));
    memcpy(task_data, state, sizeof(*state));
 
@@ -554,7 +804,7 @@ static void task_save_handler_finished(retro_task_t *task,
    {
       if (state->undo_save && state->data == undo_save_buf.data)
          undo_save_buf.data = NULL;
-      free(state->data);
+      save_state_pool_release(state->data);
       state->data = NULL;
    }
 
@@ -570,7 +820,7 @@ void* get_serialized_data(const char *path, size_t serial_size)
    if (!serial_size)
       return NULL;
 
-   data = malloc(serial_size);
+   data = save_state_pool_acquire(serial_size);
 
    if (!data)
       return NULL;
@@ -586,7 +836,7 @@ void* get_serialized_data(const char *path, size_t serial_size)
 
    if (!ret)
    {
-      free(data);
+      save_state_pool_release(data);
       return NULL;
    }
 
@@ -598,6 +848,8 @@ void* get_serialized_data(const char *path, size_t serial_size)
  * @task : the task being worked on
  *
  * Write a chunk of data to the save state file.
+ * The state goes to a temporary file which replaces
+ * the destination once it has been written completely.
  **/
 static void task_save_handler(retro_task_t *task)
 {
@@ -607,58 +859,93 @@ static void task_save_handler(retro_task_t *task)
 
    if (!state->file)
    {
+      strlcpy(state->tmp_path, state->path, sizeof(state->tmp_path));
+      strlcat(state->tmp_path, SAVE_FILE_TMP_EXTENSION,
+            sizeof(state->tmp_path));
+
       state->file   = intfstream_open_file(
-            state->path, RETRO_VFS_FILE_ACCESS_WRITE,
+            state->tmp_path, RETRO_VFS_FILE_ACCESS_WRITE,
             RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
       if (!state->file)
-         return;
+      {
+         state->tmp_path[0] = '\0';
+         goto error;
+      }
    }
 
    if (!state->data)
       state->data  = get_serialized_data(state->path, state->size);
 
-   remaining       = MIN(state->size - state->written, SAVE_STATE_CHUNK);
+   if (state->compress)
+   {
+      int ret;
 
-   if ( state->data )
-      written         = (int)intfstream_write(state->file,
-         (uint8_t*)state->data + state->written, remaining);
-   else
-      written = 0;
+      if (!state->writer)
+      {
+         state->writer = savestate_file_writer_new(state->file,
+               state->data, state->size, SAVESTATE_FILE_CODEC_DEFLATE,
+               state->meta, NULL, 0);
 
-   state->written += written;
+         if (!state->writer)
+            goto error;
+      }
 
-   task_set_progress(task, (state->written / (float)state->size) * 100);
+      ret = savestate_file_writer_step(state->writer);
 
-   if (task_get_cancelled(task) || written != remaining)
-   {
-      char err[8192];
+      task_set_progress(task,
+            savestate_file_writer_progress(state->writer) * 100);
 
-      err[0] = '\0';
+      if (task_get_cancelled(task) || ret < 0)
+         goto error;
 
-      if (state->undo_save)
-      {
-         RARCH_ERR("%s \"%s\".\n",
-            msg_hash_to_str(MSG_FAILED_TO_UNDO_SAVE_STATE),
-            undo_save_buf.path);
+      if (ret == 0)
+         return;
 
-         snprintf(err, sizeof(err), "%s \"%s\".",
-                  msg_hash_to_str(MSG_FAILED_TO_UNDO_SAVE_STATE),
-                  "RAM");
-      }
+      RARCH_LOG("%s: %u -> %u %s.\n",
+            msg_hash_to_str(MSG_STATE_SIZE),
+            (unsigned)state->size,
+            (unsigned)savestate_file_writer_written(state->writer),
+            msg_hash_to_str(MSG_BYTES));
+
+      state->written = state->size;
+   }
+   else
+   {
+      remaining       = MIN(state->size - state->written, SAVE_STATE_CHUNK);
+
+      if ( state->data )
+         written         = (int)intfstream_write(state->file,
+            (uint8_t*)state->data + state->written, remaining);
       else
-         snprintf(err, sizeof(err),
-               "%s %s",
-               msg_hash_to_str(MSG_FAILED_TO_SAVE_STATE_TO), state->path);
+         written = 0;
 
-      task_set_error(task, strdup(err));
-      task_save_handler_finished(task, state);
-      return;
+      state->written += written;
+
+      task_set_progress(task, (state->written / (float)state->size) * 100);
+
+      if (task_get_cancelled(task) || written != remaining)
+         goto error;
    }
 
    if (state->written == state->size)
    {
       char       *msg      = NULL;
+      bool        failed   = false;
+
+      if (state->writer)
+      {
+         savestate_file_writer_free(state->writer);
+         state->writer = NULL;
+      }
+
+      failed |= (intfstream_close(state->file) != 0);
+      free(state->file);
+      state->file = NULL;
+
+      if (failed || !save_file_commit(state->tmp_path, state->path))
+         goto error;
+      state->tmp_path[0] = '\0';
 
       task_free_title(task);
 
@@ -689,6 +976,33 @@ static void task_save_handler(retro_task_t *task)
 
       return;
    }
+
+   return;
+
+error:
+   {
+      char err[8192];
+
+      err[0] = '\0';
+
+      if (state->undo_save)
+      {
+         RARCH_ERR("%s \"%s\".\n",
+            msg_hash_to_str(MSG_FAILED_TO_UNDO_SAVE_STATE),
+            undo_save_buf.path);
+
+         snprintf(err, sizeof(err), "%s \"%s\".",
+                  msg_hash_to_str(MSG_FAILED_TO_UNDO_SAVE_STATE),
+                  "RAM");
+      }
+      else
+         snprintf(err, sizeof(err),
+               "%s %s",
+               msg_hash_to_str(MSG_FAILED_TO_SAVE_STATE_TO), state->path);
+
+      task_set_error(task, strdup(err));
+      task_save_handler_finished(task, state);
+   }
 }
 
 /**
@@ -716,6 +1030,7 @@ static bool task_push_undo_save_state(const char *path, void *data, size_t size)
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
 
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_IO;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = undo_save_state_cb;
@@ -763,6 +1078,12 @@ static void task_load_handler_finished(retro_task_t *task,
 
    task_set_finished(task, true);
 
+   if (state->reader)
+   {
+      savestate_file_reader_free(state->reader);
+      state->reader = NULL;
+   }
+
    if (state->file)
    {
       intfstream_close(state->file);
@@ -789,10 +1110,15 @@ static void task_load_handler_finished(retro_task_t *task,
  * @task : the task being worked on
  *
  * Load a chunk of data from the save state file.
+ * Compressed containers are decompressed chunk by chunk
+ * straight into the state buffer; anything else is read
+ * as a raw state. Backups made for undo keep the file's
+ * bytes as they are.
  **/
 static void task_load_handler(retro_task_t *task)
 {
-   ssize_t remaining, bytes_read;
+   bool failed              = false;
+   bool done                = false;
    save_task_state_t *state = (save_task_state_t*)task->state;
 
    if (!state->file)
@@ -804,31 +1130,73 @@ static void task_load_handler(retro_task_t *task)
       if (!state->file)
          goto error;
 
-      if (intfstream_seek(state->file, 0, SEEK_END) != 0)
-         goto error;
+      if (!state->load_to_backup_buffer)
+      {
+         bool is_container = false;
 
-      state->size = intfstream_tell(state->file);
+         state->reader     = savestate_file_reader_open(state->file,
+               &is_container);
 
-      if (state->size < 0)
-         goto error;
+         if (is_container && !state->reader)
+         {
+            RARCH_ERR("[State]: \"%s\" is corrupt or uses an unsupported codec.\n",
+                  state->path);
+            goto error;
+         }
+      }
+
+      if (state->reader)
+         state->size = (ssize_t)
+            savestate_file_reader_header(state->reader)->state_size;
+      else
+      {
+         if (intfstream_seek(state->file, 0, SEEK_END) != 0)
+            goto error;
+
+         state->size = intfstream_tell(state->file);
 
-      intfstream_rewind(state->file);
+         if (state->size < 0)
+            goto error;
 
-      state->data = malloc(state->size + 1);
+         intfstream_rewind(state->file);
+      }
+
+      state->data = save_state_pool_acquire(state->size + 1);
 
       if (!state->data)
          goto error;
    }
 
-   remaining          = MIN(state->size - state->bytes_read, SAVE_STATE_CHUNK);
-   bytes_read         = intfstream_read(state->file,
-         (uint8_t*)state->data + state->bytes_read, remaining);
-   state->bytes_read += bytes_read;
+   if (state->reader)
+   {
+      int ret = savestate_file_reader_step(state->reader, state->data);
+
+      failed  = ret < 0;
+      done    = ret == 1;
 
-   if (state->size > 0)
-      task_set_progress(task, (state->bytes_read / (float)state->size) * 100);
+      if (done)
+         state->bytes_read = state->size;
 
-   if (task_get_cancelled(task) || bytes_read != remaining)
+      task_set_progress(task,
+            savestate_file_reader_progress(state->reader) * 100);
+   }
+   else
+   {
+      ssize_t remaining  = MIN(state->size - state->bytes_read,
+            SAVE_STATE_CHUNK);
+      ssize_t bytes_read = intfstream_read(state->file,
+            (uint8_t*)state->data + state->bytes_read, remaining);
+      state->bytes_read += bytes_read;
+
+      failed             = bytes_read != remaining;
+      done               = state->bytes_read == state->size;
+
+      if (state->size > 0)
+         task_set_progress(task,
+               (state->bytes_read / (float)state->size) * 100);
+   }
+
+   if (task_get_cancelled(task) || failed)
    {
       if (state->autoload)
       {
@@ -848,13 +1216,13 @@ static void task_load_handler(retro_task_t *task)
       else
          task_set_error(task, strdup(msg_hash_to_str(MSG_FAILED_TO_LOAD_STATE)));
 
-      free(state->data);
+      save_state_pool_release(state->data);
       state->data = NULL;
       task_load_handler_finished(task, state);
       return;
    }
 
-   if (state->bytes_read == state->size)
+   if (done)
    {
       size_t sizeof_msg = 8192;
       char         *msg = (char*)malloc(sizeof_msg * sizeof(char));
@@ -932,14 +1300,16 @@ static void content_load_state_cb(retro_task_t *task,
    can restore it */
    if (load_data->load_to_backup_buffer)
    {
-      /* If we were previously backing up a file, let go of it first */
-      if (undo_save_buf.data)
+      /* If we were previously backing up a file of
+       * another size, let go of it first */
+      if (undo_save_buf.data && undo_save_buf.size != (size_t)size)
       {
          free(undo_save_buf.data);
          undo_save_buf.data = NULL;
       }
 
-      undo_save_buf.data = malloc(size);
+      if (!undo_save_buf.data)
+         undo_save_buf.data = malloc(size);
       if (!undo_save_buf.data)
          goto error;
 
@@ -947,7 +1317,7 @@ static void content_load_state_cb(retro_task_t *task,
       undo_save_buf.size = size;
       strlcpy(undo_save_buf.path, load_data->path, sizeof(undo_save_buf.path));
 
-      free(buf);
+      save_state_pool_release(buf);
       free(load_data);
       return;
    }
@@ -1033,7 +1403,7 @@ static void content_load_state_cb(retro_task_t *task,
    if (!ret)
       goto error;
 
-   free(buf);
+   save_state_pool_release(buf);
    free(load_data);
 
    return;
@@ -1043,7 +1413,7 @@ error:
          msg_hash_to_str(MSG_FAILED_TO_LOAD_STATE),
          load_data->path);
    if (buf)
-      free(buf);
+      save_state_pool_release(buf);
    free(load_data);
 }
 
@@ -1066,6 +1436,104 @@ static void save_state_cb(retro_task_t *task,
    free(state);
 }
 
+/**
+ * save_state_escape_metadata:
+ * @s         : output buffer
+ * @len       : size of @s
+ * @in        : metadata value
+ *
+ * Copies @in with backslashes, double quotes and line breaks
+ * escaped C-style, so it can sit between the quotes of one
+ * metadata line whatever the content is named.
+ **/
+static void save_state_escape_metadata(char *s, size_t len, const char *in)
+{
+   size_t pos = 0;
+
+   if (!len)
+      return;
+
+   for (; *in; in++)
+   {
+      char esc = 0;
+
+      switch (*in)
+      {
+         case '\\':
+         case '"':
+            esc = *in;
+            break;
+         case '\n':
+            esc = 'n';
+            break;
+         case '\r':
+            esc = 'r';
+            break;
+         default:
+            break;
+      }
+
+      if (pos + (esc ? 2 : 1) >= len)
+         break;
+
+      if (esc)
+      {
+         s[pos++] = '\\';
+         s[pos++] = esc;
+      }
+      else
+         s[pos++] = *in;
+   }
+
+   s[pos] = '\0';
+}
+
+/**
+ * save_state_fill_metadata:
+ * @s         : output buffer
+ * @len       : size of @s
+ * @slot      : state slot being saved
+ *
+ * Describes the running core and content for the metadata
+ * block of a savestate container, in config file syntax.
+ **/
+static void save_state_fill_metadata(char *s, size_t len, int slot)
+{
+   time_t time_;
+   char timebuf[64];
+   /* Sized so that the whole block fits in save_task_state_t.meta,
+    * never cutting a line short */
+   char core[128];
+   char core_version[128];
+   char content_name[512];
+   struct retro_system_info *system = runloop_get_libretro_system_info();
+   const char *content              = path_get(RARCH_PATH_BASENAME);
+
+   timebuf[0] = '\0';
+   time(&time_);
+   strftime(timebuf, sizeof(timebuf),
+         "%Y-%m-%d %H:%M:%S", localtime(&time_));
+
+   save_state_escape_metadata(core, sizeof(core),
+         system && system->library_name    ? system->library_name    : "");
+   save_state_escape_metadata(core_version, sizeof(core_version),
+         system && system->library_version ? system->library_version : "");
+   save_state_escape_metadata(content_name, sizeof(content_name),
+         content ? path_basename(content) : "");
+
+   snprintf(s, len,
+         "core = \"%s\"\n"
+         "core_version = \"%s\"\n"
+         "content = \"%s\"\n"
+         "state_slot = \"%d\"\n"
+         "timestamp = \"%s\"\n",
+         core,
+         core_version,
+         content_name,
+         slot,
+         timebuf);
+}
+
 /**
  * task_push_save_state:
  * @path : file path of the save state
@@ -1089,10 +1557,16 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    state->autosave         = autosave;
    state->mute             = autosave; /* don't show OSD messages if we are auto-saving */
    state->thumbnail_enable = settings->bools.savestate_thumbnail_enable;
+   state->compress         = settings->bools.savestate_file_compression;
    state->state_slot       = settings->ints.state_slot;
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
 
+   if (state->compress)
+      save_state_fill_metadata(state->meta, sizeof(state->meta),
+            state->state_slot);
+
    task->type              = TASK_TYPE_BLOCKING;
+   task->priority          = TASK_PRIORITY_IO;
    task->state             = state;
    task->handler           = task_save_handler;
    task->callback          = save_state_cb;
@@ -1103,7 +1577,7 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    {
       /* Another blocking task is already active. */
       if (data)
-         free(data);
+         save_state_pool_release(data);
       if (task->title)
          task_free_title(task);
       free(task);
@@ -1114,7 +1588,7 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
 
 error:
    if (data)
-      free(data);
+      save_state_pool_release(data);
    if (state)
       free(state);
    if (task)
@@ -1181,6 +1655,7 @@ static void task_push_load_and_save_state(const char *path, void *data,
 
    task->state       = state;
    task->type        = TASK_TYPE_BLOCKING;
+   task->priority    = TASK_PRIORITY_IO;
    task->handler     = task_load_handler;
    task->callback    = content_load_and_save_state_cb;
    task->title       = strdup(msg_hash_to_str(MSG_LOADING_STATE));
@@ -1190,7 +1665,7 @@ static void task_push_load_and_save_state(const char *path, void *data,
    {
       /* Another blocking task is already active. */
       if (data)
-         free(data);
+         save_state_pool_release(data);
       if (task->title)
          task_free_title(task);
       free(task);
@@ -1201,7 +1676,7 @@ static void task_push_load_and_save_state(const char *path, void *data,
 
 error:
    if (data)
-      free(data);
+      save_state_pool_release(data);
    if (state)
       free(state);
    if (task)
@@ -1226,6 +1701,46 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
    if (info.size == 0)
       return false;
 
+   /* save_to_disk is false, which means we are saving the state
+   in undo_load_buf to allow content_undo_load_state() to restore it */
+   if (!save_to_disk)
+   {
+      retro_ctx_serialize_info_t serial_info;
+
+      /* Serialize straight into the undo buffer, reusing it
+       * unless the core changed its state size. */
+      if (undo_load_buf.data && undo_load_buf.size != info.size)
+      {
+         free(undo_load_buf.data);
+         undo_load_buf.data = NULL;
+         undo_load_buf.size = 0;
+      }
+
+      if (!undo_load_buf.data)
+         undo_load_buf.data = malloc(info.size);
+
+      if (!undo_load_buf.data)
+         return false;
+
+      serial_info.data = undo_load_buf.data;
+      serial_info.size = info.size;
+
+      if (!core_serialize(&serial_info))
+      {
+         RARCH_ERR("%s \"%s\".\n",
+               msg_hash_to_str(MSG_FAILED_TO_SAVE_STATE_TO),
+               path);
+         free(undo_load_buf.data);
+         undo_load_buf.data = NULL;
+         undo_load_buf.size = 0;
+         return false;
+      }
+
+      undo_load_buf.size = info.size;
+      strlcpy(undo_load_buf.path, path, sizeof(undo_load_buf.path));
+      return true;
+   }
+
    if (!save_state_in_background)
    {
       RARCH_LOG("%s: \"%s\".\n",
@@ -1248,55 +1763,18 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
             msg_hash_to_str(MSG_BYTES));
    }
 
-   if (save_to_disk)
+   if (filestream_exists(path) && !autosave)
    {
-      if (filestream_exists(path) && !autosave)
-      {
-         /* Before overwritting the savestate file, load it into a buffer
-         to allow undo_save_state() to work */
-         /* TODO/FIXME - Use msg_hash_to_str here */
-         RARCH_LOG("%s ...\n",
-               msg_hash_to_str(MSG_FILE_ALREADY_EXISTS_SAVING_TO_BACKUP_BUFFER));
+      /* Before overwritting the savestate file, load it into a buffer
+      to allow undo_save_state() to work */
+      /* TODO/FIXME - Use msg_hash_to_str here */
+      RARCH_LOG("%s ...\n",
+            msg_hash_to_str(MSG_FILE_ALREADY_EXISTS_SAVING_TO_BACKUP_BUFFER));
 
-         task_push_load_and_save_state(path, data, info.size, true, autosave);
-      }
-      else
-         task_push_save_state(path, data, info.size, autosave);
+      task_push_load_and_save_state(path, data, info.size, true, autosave);
    }
    else
-   {
-      if (data == NULL)
-         data = get_serialized_data(path, info.size);
-
-      if (data == NULL)
-      {
-         RARCH_ERR("%s \"%s\".\n",
-               msg_hash_to_str(MSG_FAILED_TO_SAVE_STATE_TO),
-               path);
-         return false;
-      }
-      /* save_to_disk is false, which means we are saving the state
-      in undo_load_buf to allow content_undo_load_state() to restore it */
-
-      /* If we were holding onto an old state already, clean it up first */
-      if (undo_load_buf.data)
-      {
-         free(undo_load_buf.data);
-         undo_load_buf.data = NULL;
-      }
-
-      undo_load_buf.data = malloc(info.size);
-      if (!undo_load_buf.data)
-      {
-         free(data);
-         return false;
-      }
-
-      memcpy(undo_load_buf.data, data, info.size);
-      free(data);
-      undo_load_buf.size = info.size;
-      strlcpy(undo_load_buf.path, path, sizeof(undo_load_buf.path));
-   }
+      task_push_save_state(path, data, info.size, autosave);
 
    return true;
 }
@@ -1328,6 +1806,7 @@ bool content_load_state(const char *path,
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
 
    task->type                   = TASK_TYPE_BLOCKING;
+   task->priority               = TASK_PRIORITY_IO;
    task->state                  = state;
    task->handler                = task_load_handler;
    task->callback               = content_load_state_cb;
@@ -1386,6 +1865,8 @@ bool content_reset_savestate_backups(void)
    undo_load_buf.path[0] = '\0';
    undo_load_buf.size    = 0;
 
+   save_state_pool_reset();
+
    return true;
 }
 
@@ -1508,30 +1989,59 @@ error:
    return false;
 }
 
+/* Snapshot of one SRAM block waiting to be written */
+struct save_ram_file
+{
+   char path[PATH_MAX_LENGTH];
+   void *data;
+   size_t size;
+   unsigned type;
+};
+
+typedef struct
+{
+   struct save_ram_file *files;
+   unsigned count;
+   unsigned sequence;
+} save_ram_task_state_t;
+
+/* Flush tasks pushed and not yet called back. Only touched
+ * on the main thread. */
+static unsigned save_ram_tasks_pending      = 0;
+/* Flushes are numbered so that, with several task workers,
+ * an older snapshot never overwrites a newer one. */
+static unsigned save_ram_sequence           = 0;
+static unsigned save_ram_written_sequence   = 0;
+#ifdef HAVE_THREADS
+static slock_t *save_ram_lock               = NULL;
+#endif
+
+static void save_ram_task_state_free(save_ram_task_state_t *state)
+{
+   unsigned i;
+
+   for (i = 0; i < state->count; i++)
+      free(state->files[i].data);
+   free(state->files);
+   free(state);
+}
+
 /**
- * content_save_ram_file:
- * @path             : path of RAM state that shall be written to.
- * @type             : type of memory
+ * save_ram_file_write:
+ * @file             : SRAM snapshot to write
  *
  * Save a RAM state from memory to disk.
  *
  */
-bool content_save_ram_file(unsigned slot)
+static bool save_ram_file_write(const struct save_ram_file *file)
 {
-   struct ram_type ram;
-   retro_ctx_memory_info_t mem_info;
-
-   if (!content_get_memory(&mem_info, &ram, slot))
-      return false;
-
    RARCH_LOG("%s #%u %s \"%s\".\n",
          msg_hash_to_str(MSG_SAVING_RAM_TYPE),
-         ram.type,
+         file->type,
          msg_hash_to_str(MSG_TO),
-         ram.path);
+         file->path);
 
-   if (!filestream_write_file(
-            ram.path, mem_info.data, mem_info.size))
+   if (!save_file_write_atomic(file->path, file->data, file->size))
    {
       RARCH_ERR("%s.\n",
             msg_hash_to_str(MSG_FAILED_TO_SAVE_SRAM));
@@ -1540,8 +2050,7 @@ bool content_save_ram_file(unsigned slot)
       /* In case the file could not be written to,
        * the fallback function 'dump_to_file_desperate'
        * will be called. */
-      if (!dump_to_file_desperate(
-               mem_info.data, mem_info.size, ram.type))
+      if (!dump_to_file_desperate(file->data, file->size, file->type))
       {
          RARCH_WARN("Failed ... Cannot recover save file.\n");
       }
@@ -1550,24 +2059,146 @@ bool content_save_ram_file(unsigned slot)
 
    RARCH_LOG("%s \"%s\".\n",
          msg_hash_to_str(MSG_SAVED_SUCCESSFULLY_TO),
-         ram.path);
+         file->path);
 
    return true;
 }
 
-bool event_save_files(void)
+static void task_save_ram_handler(retro_task_t *task)
 {
    unsigned i;
+   save_ram_task_state_t *state = (save_ram_task_state_t*)task->state;
+
+   /* SRAM is written even when the task is cancelled;
+    * the snapshot is all that is left of it. */
+#ifdef HAVE_THREADS
+   slock_lock(save_ram_lock);
+#endif
+   if (state->sequence > save_ram_written_sequence)
+   {
+      for (i = 0; i < state->count; i++)
+         save_ram_file_write(&state->files[i]);
+      save_ram_written_sequence = state->sequence;
+   }
+#ifdef HAVE_THREADS
+   slock_unlock(save_ram_lock);
+#endif
+
+   task->state = NULL;
+   save_ram_task_state_free(state);
+   task_set_finished(task, true);
+}
+
+static void save_ram_cb(retro_task_t *task,
+      void *task_data,
+      void *user_data, const char *error)
+{
+   save_ram_tasks_pending--;
+}
+
+static bool save_ram_tasks_are_pending(void *data)
+{
+   return save_ram_tasks_pending != 0;
+}
+
+/**
+ * task_push_save_ram_files:
+ *
+ * Copies every SRAM block of the running core and writes
+ * the copies out from an IO task.
+ *
+ * Returns: true if the task was pushed, false otherwise.
+ **/
+static bool task_push_save_ram_files(void)
+{
+   unsigned i;
+   retro_task_t *task           = NULL;
+   save_ram_task_state_t *state = (save_ram_task_state_t*)
+      calloc(1, sizeof(*state));
+
+   if (!state)
+      return false;
+
+   state->files = (struct save_ram_file*)
+      calloc(task_save_files->size, sizeof(*state->files));
+   if (!state->files)
+      goto error;
+
+   for (i = 0; i < task_save_files->size; i++)
+   {
+      struct ram_type ram;
+      retro_ctx_memory_info_t mem_info;
+      struct save_ram_file *file = &state->files[state->count];
+
+      if (!content_get_memory(&mem_info, &ram, i))
+         continue;
+
+      /* The core's memory keeps changing, and goes away
+       * on unload, so write a copy */
+      if (!(file->data = malloc(mem_info.size)))
+         goto error;
+      memcpy(file->data, mem_info.data, mem_info.size);
+      strlcpy(file->path, ram.path, sizeof(file->path));
+      file->size = mem_info.size;
+      file->type = ram.type;
+      state->count++;
+   }
+
+   if (!state->count)
+   {
+      save_ram_task_state_free(state);
+      return true;
+   }
+
+#ifdef HAVE_THREADS
+   if (!save_ram_lock && !(save_ram_lock = slock_new()))
+      goto error;
+#endif
+
+   if (!(task = task_init()))
+      goto error;
+
+   state->sequence = ++save_ram_sequence;
+
+   task->priority  = TASK_PRIORITY_IO;
+   task->state     = state;
+   task->handler   = task_save_ram_handler;
+   task->callback  = save_ram_cb;
+   task->mute      = true;
+
+   save_ram_tasks_pending++;
+   task_queue_push(task);
+
+   return true;
+
+error:
+   save_ram_task_state_free(state);
+   return false;
+}
+
+/**
+ * event_save_files:
+ * @wait             : wait for the files to be written
+ *
+ * Saves the game specific cheats and flushes every
+ * SRAM block to disk. SRAM is written by a task; set @wait
+ * when the task queue is about to go away.
+ **/
+bool event_save_files(bool wait)
+{
+   bool ret = false;
 
    cheat_manager_save_game_specific_cheats();
    if (!task_save_files ||
          !rarch_ctl(RARCH_CTL_IS_SRAM_USED, NULL))
       return false;
 
-   for (i = 0; i < task_save_files->size; i++)
-      content_save_ram_file(i);
+   ret = task_push_save_ram_files();
 
-   return true;
+   if (wait)
+      task_queue_wait(save_ram_tasks_are_pending, NULL);
+
+   return ret;
 }
 
 bool event_load_save_files(void)
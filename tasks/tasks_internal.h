@@ -61,6 +61,13 @@ bool task_push_netplay_nat_traversal(void *nat_traversal_state, uint16_t port);
 bool task_push_image_load(const char *fullpath,
       retro_task_callback_t cb, void *userdata);
 
+/* Same as task_push_image_load(), in the given priority class.
+ * Returns the task, which can be passed to task_queue_cancel_task()
+ * until its callback has run, or NULL on failure. */
+void *task_push_image_load_priority(const char *fullpath,
+      enum task_priority priority,
+      retro_task_callback_t cb, void *userdata);
+
 #ifdef HAVE_LIBRETRODB
 bool task_push_dbscan(
       const char *playlist_directory,
@@ -94,7 +101,7 @@ bool take_screenshot(const char *path, bool silence,
 
 bool event_load_save_files(void);
 
-bool event_save_files(void);
+bool event_save_files(bool wait);
 
 void path_init_savefile_rtc(const char *savefile_path);
 